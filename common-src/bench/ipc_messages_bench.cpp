@@ -0,0 +1,204 @@
+// Benchmark of the messages between the job server and the watcher.
+//
+// Encodes and decodes the messages the job server sends most: a progress
+// update of one job, an update of a whole job, the list of all jobs and
+// the complete log a client gets on connecting. Each message is run through
+// the JSON text format and through the CBOR format with compression of
+// large payloads, and the size, the time to encode and to decode and
+// the resulting throughput are printed for both.
+//
+// Usage: ipc_messages_bench [JOBS] [ITERATIONS]
+//
+// The exit code is non-zero if a message does not survive the trip
+// through either format or CBOR is not available.
+
+#include "../ipc_messages.h"
+#include "../ipc_defines.h"
+#include "../settings/settings_definitions_core.h"
+#include "../log/styled_log_view_core.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QUuid>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace {
+
+JobProperties sampleJob(int a_index)
+{
+    JobProperties properties;
+    properties.id = QUuid::createUuid();
+    properties.type = JobType::EncodeScriptCLI;
+    properties.jobState = (a_index == 0) ? JobState::Running :
+                          JobState::Waiting;
+    properties.timeStarted = QDateTime::currentDateTimeUtc();
+    properties.scriptName = QString("D:/video/episode_%1/filter.vpy")
+                            .arg(a_index);
+    properties.scriptHash = JobProperties::hashScript(properties.scriptName);
+    properties.executablePath = "C:/tools/x264/x264.exe";
+    properties.arguments = QString("--demuxer y4m --preset slower --crf 16 "
+                                   "--output D:/video/episode_%1/video.264 -").arg(a_index);
+    properties.firstFrame = 0;
+    properties.firstFrameReal = 0;
+    properties.lastFrame = 34523;
+    properties.lastFrameReal = 34523;
+    properties.framesProcessed = 12345 + a_index;
+    properties.fps = 23.456;
+    properties.scriptWaitTime = 12.5;
+    properties.pipeStallTime = 3.25;
+    properties.packingTime = 1.125;
+    properties.encoderCpuTime = 1234.5;
+    properties.runningTime = 526.3;
+    properties.requestWindow = 24;
+    properties.requestWindowLimit = 96;
+    properties.encoderFps = 23.4;
+    properties.encoderBitrate = 4321.7;
+
+    for (int i = 0; i < 4; ++i) {
+        JobSegmentProgress segment;
+        segment.firstFrame = i * 8631;
+        segment.lastFrame = (i + 1) * 8631 - 1;
+        segment.framesProcessed = 3086;
+        properties.segmentsProgress.push_back(segment);
+    }
+
+    properties.segments = 4;
+    return properties;
+}
+
+struct Sample {
+    const char *name;
+    QString command;
+    QJsonValue arguments;
+};
+
+struct Result {
+    int bytes;
+    double encodeMicroseconds;
+    double decodeMicroseconds;
+    bool roundTrip;
+};
+
+double bestMicroseconds(int a_iterations, std::function<void()> a_run)
+{
+    typedef std::chrono::steady_clock clock;
+    double best = 0.0;
+
+    for (int i = 0; i < 5; ++i) {
+        clock::time_point start = clock::now();
+
+        for (int j = 0; j < a_iterations; ++j) {
+            a_run();
+        }
+
+        std::chrono::duration<double, std::micro> passed = clock::now() - start;
+        double perMessage = passed.count() / a_iterations;
+
+        if ((i == 0) || (perMessage < best)) {
+            best = perMessage;
+        }
+    }
+
+    return best;
+}
+
+Result measure(vsedit::MessageFormat a_format, const Sample &a_sample,
+               int a_iterations)
+{
+    Result result;
+    QByteArray message = vsedit::encodeMessage(a_format, a_sample.command,
+                         a_sample.arguments);
+    result.bytes = message.size();
+
+    QString command;
+    QJsonValue arguments;
+    result.roundTrip = vsedit::decodeMessage(message, &command, &arguments) &&
+                       (command == a_sample.command) && (arguments == a_sample.arguments);
+
+    result.encodeMicroseconds = bestMicroseconds(a_iterations, [&]() {
+        message = vsedit::encodeMessage(a_format, a_sample.command,
+                                        a_sample.arguments);
+    });
+
+    result.decodeMicroseconds = bestMicroseconds(a_iterations, [&]() {
+        vsedit::decodeMessage(message, &command, &arguments);
+    });
+
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int jobsCount = 50;
+    int iterations = 200;
+
+    if (argc > 1) {
+        jobsCount = std::max(atoi(argv[1]), 1);
+    }
+
+    if (argc > 2) {
+        iterations = std::max(atoi(argv[2]), 1);
+    }
+
+    if (!vsedit::cborMessagesSupported()) {
+        printf("CBOR messages need Qt 5.12 or newer.\n");
+        return 1;
+    }
+
+    QJsonArray jsJobs;
+
+    for (int i = 0; i < jobsCount; ++i) {
+        jsJobs.push_back(sampleJob(i).toJson());
+    }
+
+    QJsonArray jsEntries;
+
+    for (int i = 0; i < 1000; ++i) {
+        LogEntry entry(QString("Job \"D:/video/episode_%1/filter.vpy\" "
+                               "started.").arg(i % jobsCount), LOG_STYLE_DEFAULT);
+        jsEntries.push_back(entry.toJson());
+    }
+
+    JobProperties job = sampleJob(0);
+
+    std::vector<Sample> samples = {
+        {"progress update", SMSG_JOB_PROGRESS_UPDATE, job.progressToJson()},
+        {"job update", SMSG_JOB_UPDATE, job.toJson()},
+        {"jobs info", SMSG_JOBS_INFO, jsJobs},
+        {"complete log", SMSG_COMPLETE_LOG, jsEntries},
+    };
+
+    bool mismatch = false;
+
+    printf("%d jobs, %d iterations\n", jobsCount, iterations);
+    printf("%-16s %6s %10s %10s %10s %12s\n", "message", "format", "bytes",
+           "encode us", "decode us", "messages/s");
+
+    for (const Sample &sample : samples) {
+        const vsedit::MessageFormat formats[] = {vsedit::MessageFormat::Json,
+                                                 vsedit::MessageFormat::Cbor
+                                                };
+
+        for (vsedit::MessageFormat format : formats) {
+            Result result = measure(format, sample, iterations);
+            mismatch = mismatch || !result.roundTrip;
+            double total = result.encodeMicroseconds +
+                           result.decodeMicroseconds;
+
+            printf("%-16s %6s %10d %10.2f %10.2f %12.0f%s\n", sample.name,
+                   vsedit::messageFormatName(format).toUtf8().constData(),
+                   result.bytes, result.encodeMicroseconds,
+                   result.decodeMicroseconds, 1000000.0 / total,
+                   result.roundTrip ? "" : "  MISMATCH");
+        }
+    }
+
+    return mismatch ? 1 : 0;
+}
@@ -9,9 +9,11 @@ static const char JOB_SERVER_NAME[] = "vsedit_job_server";
 static const uint16_t JOB_SERVER_PORT = 3370;
 
 // Client messages
+static const char MSG_SET_PROTOCOL[] = "SP";
 static const char MSG_GET_JOBS_INFO[] = "GJI";
 static const char MSG_GET_LOG[] = "GL";
 static const char MSG_SUBSCRIBE[] = "SS";
+static const char MSG_SYNC_JOBS[] = "SYJ";
 static const char MSG_UNSUBSCRIBE[] = "USS";
 static const char MSG_CLOSE_SERVER[] = "CS";
 static const char MSG_GET_TRUSTED_CLIENTS[] = "GTC";
@@ -45,6 +47,48 @@ static const char SMSG_JOBS_DELETED[] = "JD";
 static const char SMSG_REFUSE[] = "RF";
 static const char SMSG_CLOSING_SERVER[] = "SCS";
 static const char SMSG_TRUSTED_CLIENTS_INFO[] = "TCI";
+static const char SMSG_PROTOCOL[] = "PR";
+static const char SMSG_JOBS_SYNC[] = "JSY";
+static const char SMSG_JOB_CHANGE[] = "JCH";
+
+// A client asks for a message format by name and the server answers with
+// the format it sends from then on.
+static const char PROTOCOL_FORMAT[] = "format";
+
+// Every change of the jobs gets the next sequence number of the server.
+// A client asks to sync with the last number it has seen and gets the
+// changes since then, or all jobs if the server no longer has them.
+// Afterwards it gets each change wrapped with its number.
+static const char SYNC_SERVER_ID[] = "server";
+static const char SYNC_SEQUENCE[] = "seq";
+static const char SYNC_CHANGES[] = "changes";
+static const char SYNC_JOBS[] = "jobs";
+static const char SYNC_COMMAND[] = "command";
+static const char SYNC_ARGUMENTS[] = "arguments";
+
+// Job server <-> Job worker communication
+
+// The job server starts itself with this argument and the name of
+// a local server to run a job in a worker process.
+static const char JOB_WORKER_ARGUMENT[] = "--worker";
+static const char JOB_WORKER_SERVER_NAME_PREFIX[] = "vsedit_job_worker_";
+
+// Server messages to a worker
+static const char WKMSG_START_JOB[] = "WSJ";
+static const char WKMSG_PAUSE_JOB[] = "WPJ";
+static const char WKMSG_RESUME_JOB[] = "WRJ";
+static const char WKMSG_ABORT_JOB[] = "WAJ";
+static const char WKMSG_SET_SCRIPT_THREADS[] = "WST";
+
+// Worker messages
+static const char WKSMSG_JOB_UPDATE[] = "WJU";
+static const char WKSMSG_JOB_STATE_UPDATE[] = "WJSU";
+static const char WKSMSG_JOB_PROGRESS_UPDATE[] = "WJPU";
+static const char WKSMSG_LOG_MESSAGE[] = "WLM";
+
+static const char WK_PROPERTIES[] = "properties";
+static const char WK_FRAMES_MEMORY_BUDGET[] = "frames_memory_budget";
+static const char WK_SCRIPT_THREADS[] = "script_threads";
 
 // Editor <-> Watcher communication
 
@@ -0,0 +1,210 @@
+#include "ipc_messages.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtEndian>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QCborValue>
+#endif
+
+//==============================================================================
+
+// UTF-8 continuation byte, so no text message starts with it.
+static const char CBOR_MESSAGE_MARK = char(0xB7);
+
+static const char FLAG_COMPRESSED = 0x01;
+
+// Arguments larger than that are compressed, like the list of jobs
+// or the log sent to a client that has just connected.
+static const int COMPRESSION_THRESHOLD = 1024;
+
+// Fastest zlib level. Messages consist of the same keys over and over,
+// which compress well at any level.
+static const int COMPRESSION_LEVEL = 1;
+
+// qUncompress() allocates whatever size the payload claims. Even the jobs
+// and the log of a busy server stay far below that.
+static const quint32 MAX_UNCOMPRESSED_SIZE = 256 * 1024 * 1024;
+
+static const char FORMAT_NAME_JSON[] = "json";
+static const char FORMAT_NAME_CBOR[] = "cbor";
+
+//==============================================================================
+
+bool vsedit::cborMessagesSupported()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// END OF bool vsedit::cborMessagesSupported()
+//==============================================================================
+
+QString vsedit::messageFormatName(MessageFormat a_format)
+{
+    if (a_format == MessageFormat::Cbor) {
+        return FORMAT_NAME_CBOR;
+    }
+
+    return FORMAT_NAME_JSON;
+}
+
+// END OF QString vsedit::messageFormatName(MessageFormat a_format)
+//==============================================================================
+
+vsedit::MessageFormat vsedit::messageFormatFromName(const QString &a_name)
+{
+    if ((a_name == FORMAT_NAME_CBOR) && cborMessagesSupported()) {
+        return MessageFormat::Cbor;
+    }
+
+    return MessageFormat::Json;
+}
+
+// END OF vsedit::MessageFormat vsedit::messageFormatFromName(
+//		const QString & a_name)
+//==============================================================================
+
+QByteArray vsedit::encodeMessage(MessageFormat a_format,
+                                 const QString &a_command, const QJsonValue &a_arguments)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    if (a_format == MessageFormat::Cbor) {
+        char flags = 0;
+        QByteArray payload;
+
+        if (!a_arguments.isUndefined()) {
+            payload = QCborValue::fromJsonValue(a_arguments).toCbor();
+        }
+
+        if (payload.size() > COMPRESSION_THRESHOLD) {
+            QByteArray compressed = qCompress(payload, COMPRESSION_LEVEL);
+
+            if (compressed.size() < payload.size()) {
+                payload = compressed;
+                flags |= FLAG_COMPRESSED;
+            }
+        }
+
+        QByteArray command = a_command.toUtf8();
+        QByteArray message;
+        message.reserve(command.size() + payload.size() + 3);
+        message += CBOR_MESSAGE_MARK;
+        message += flags;
+        message += command;
+        message += '\0';
+        message += payload;
+        return message;
+    }
+#else
+    (void)a_format;
+#endif
+
+    if (a_arguments.isObject()) {
+        return a_command.toUtf8() + ' ' +
+               QJsonDocument(a_arguments.toObject()).toJson();
+    }
+
+    if (a_arguments.isArray()) {
+        return a_command.toUtf8() + ' ' +
+               QJsonDocument(a_arguments.toArray()).toJson();
+    }
+
+    return a_command.toUtf8();
+}
+
+// END OF QByteArray vsedit::encodeMessage(MessageFormat a_format,
+//		const QString & a_command, const QJsonValue & a_arguments)
+//==============================================================================
+
+bool vsedit::decodeMessage(const QByteArray &a_message, QString *a_pCommand,
+                           QJsonValue *a_pArguments, MessageFormat *a_pFormat,
+                           bool a_acceptCompressed)
+{
+    Q_ASSERT(a_pCommand);
+    Q_ASSERT(a_pArguments);
+
+    *a_pArguments = QJsonValue(QJsonValue::Undefined);
+
+    if (a_message.startsWith(CBOR_MESSAGE_MARK)) {
+        if (a_pFormat) {
+            *a_pFormat = MessageFormat::Cbor;
+        }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        int commandEnd = a_message.indexOf('\0', 2);
+
+        if ((a_message.size() < 3) || (commandEnd < 0)) {
+            return false;
+        }
+
+        char flags = a_message[1];
+        *a_pCommand = QString::fromUtf8(a_message.constData() + 2,
+                                        commandEnd - 2);
+        QByteArray payload = a_message.mid(commandEnd + 1);
+
+        if (payload.isEmpty()) {
+            return true;
+        }
+
+        if (flags & FLAG_COMPRESSED) {
+            if (!a_acceptCompressed || (payload.size() < 4) ||
+                    (qFromBigEndian<quint32>(payload.constData()) >
+                     MAX_UNCOMPRESSED_SIZE)) {
+                return false;
+            }
+
+            payload = qUncompress(payload);
+
+            if (payload.isEmpty()) {
+                return false;
+            }
+        }
+
+        QCborParserError error;
+        QCborValue value = QCborValue::fromCbor(payload, &error);
+
+        if (error.error != QCborError::NoError) {
+            return false;
+        }
+
+        *a_pArguments = value.toJsonValue();
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    if (a_pFormat) {
+        *a_pFormat = MessageFormat::Json;
+    }
+
+    int spaceIndex = a_message.indexOf(' ');
+
+    if (spaceIndex < 0) {
+        *a_pCommand = QString::fromUtf8(a_message);
+        return true;
+    }
+
+    *a_pCommand = QString::fromUtf8(a_message.left(spaceIndex));
+    QJsonDocument document = QJsonDocument::fromJson(
+                                 a_message.mid(spaceIndex + 1));
+
+    if (document.isObject()) {
+        *a_pArguments = document.object();
+    } else if (document.isArray()) {
+        *a_pArguments = document.array();
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::decodeMessage(const QByteArray & a_message,
+//		QString * a_pCommand, QJsonValue * a_pArguments,
+//		MessageFormat * a_pFormat, bool a_acceptCompressed)
+//==============================================================================
@@ -0,0 +1,40 @@
+#ifndef IPC_MESSAGES_H_INCLUDED
+#define IPC_MESSAGES_H_INCLUDED
+
+#include <QByteArray>
+#include <QString>
+#include <QJsonValue>
+
+namespace vsedit {
+
+// Format of the messages between the job server and its clients.
+// A JSON message is the command followed by a space and JSON text.
+// A CBOR message starts with a byte no UTF-8 text starts with, then a byte
+// of flags, the command ended by a zero byte and the arguments in CBOR,
+// compressed when they are large. Clients ask for CBOR, JSON is what
+// everybody understands.
+enum class MessageFormat : int {
+    Json,
+    Cbor,
+};
+
+// CBOR needs Qt 5.12 or newer.
+bool cborMessagesSupported();
+
+QString messageFormatName(MessageFormat a_format);
+MessageFormat messageFormatFromName(const QString &a_name);
+
+QByteArray encodeMessage(MessageFormat a_format, const QString &a_command,
+                         const QJsonValue &a_arguments = QJsonValue());
+
+// Reads a message of either format. Arguments are undefined if there are
+// none or they are no JSON object or array. False if the message is broken,
+// or compressed when a_acceptCompressed is false. Clients never compress,
+// so the server refuses what could make it allocate a lot of memory.
+bool decodeMessage(const QByteArray &a_message, QString *a_pCommand,
+                   QJsonValue *a_pArguments, MessageFormat *a_pFormat = nullptr,
+                   bool a_acceptCompressed = true);
+
+}
+
+#endif // IPC_MESSAGES_H_INCLUDED
@@ -0,0 +1,298 @@
+#include "checksum_file.h"
+
+#include <QtEndian>
+
+#include <cstring>
+#include <vector>
+
+//==============================================================================
+
+static const char CHECKSUM_FILE_MAGIC[8] = {'V', 'S', 'E', 'C', 'R', 'C', '3', '2'};
+
+static const qint64 CHECKSUM_FILE_HEADER_SIZE = 16;
+
+//==============================================================================
+
+void vsedit::ChecksumResults::add(const ChecksumResults &a_other)
+{
+    framesCompared += a_other.framesCompared;
+    framesDiffering += a_other.framesDiffering;
+    framesMissing += a_other.framesMissing;
+
+    if ((a_other.firstDifferingFrame >= 0) &&
+            ((firstDifferingFrame < 0) ||
+             (a_other.firstDifferingFrame < firstDifferingFrame))) {
+        firstDifferingFrame = a_other.firstDifferingFrame;
+        firstDifferingPlane = a_other.firstDifferingPlane;
+    }
+}
+
+// END OF void vsedit::ChecksumResults::add(const ChecksumResults & a_other)
+//==============================================================================
+
+vsedit::ChecksumFile::ChecksumFile():
+    m_mode(Mode::Write)
+    , m_planes(0)
+    , m_firstFrame(0)
+    , m_framesCompared(0)
+    , m_framesDiffering(0)
+    , m_framesMissing(0)
+    , m_firstDifferingFrame(-1)
+    , m_firstDifferingPlane(-1)
+{
+}
+
+// END OF vsedit::ChecksumFile::ChecksumFile()
+//==============================================================================
+
+vsedit::ChecksumFile::~ChecksumFile()
+{
+    close();
+}
+
+// END OF vsedit::ChecksumFile::~ChecksumFile()
+//==============================================================================
+
+bool vsedit::ChecksumFile::open(const QString &a_filePath, Mode a_mode,
+                                int a_planes, int a_firstFrame)
+{
+    close();
+
+    m_mode = a_mode;
+    m_planes = a_planes;
+    m_firstFrame = a_firstFrame;
+    m_framesCompared = 0;
+    m_framesDiffering = 0;
+    m_framesMissing = 0;
+    m_firstDifferingFrame = -1;
+    m_firstDifferingPlane = -1;
+    m_errorString.clear();
+
+    m_file.setFileName(a_filePath);
+
+    QIODevice::OpenMode openMode = QIODevice::ReadWrite;
+
+    if (m_mode == Mode::Write) {
+        openMode |= QIODevice::Truncate;
+    } else if (m_mode == Mode::Compare) {
+        openMode = QIODevice::ReadOnly;
+    }
+
+    if (!m_file.open(openMode)) {
+        m_errorString = QObject::tr("Could not open checksum file "
+                                    "\"%1\": %2").arg(a_filePath).arg(m_file.errorString());
+        return false;
+    }
+
+    if (m_mode != Mode::Write) {
+        if (!readHeader()) {
+            m_file.close();
+            return false;
+        }
+
+        return true;
+    }
+
+    char header[CHECKSUM_FILE_HEADER_SIZE] = {};
+    memcpy(header, CHECKSUM_FILE_MAGIC, sizeof(CHECKSUM_FILE_MAGIC));
+    qToLittleEndian<quint32>((quint32)m_planes, header + 8);
+    qToLittleEndian<qint32>((qint32)m_firstFrame, header + 12);
+
+    // Flushed at once, so other jobs can open the file for update.
+    if ((m_file.write(header, CHECKSUM_FILE_HEADER_SIZE) !=
+            CHECKSUM_FILE_HEADER_SIZE) || (!m_file.flush())) {
+        m_errorString = QObject::tr("Could not write checksum file "
+                                    "\"%1\": %2").arg(a_filePath).arg(m_file.errorString());
+        m_file.close();
+        return false;
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::ChecksumFile::open(const QString & a_filePath,
+//		Mode a_mode, int a_planes, int a_firstFrame)
+//==============================================================================
+
+bool vsedit::ChecksumFile::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+// END OF bool vsedit::ChecksumFile::isOpen() const
+//==============================================================================
+
+vsedit::ChecksumFile::Mode vsedit::ChecksumFile::mode() const
+{
+    return m_mode;
+}
+
+// END OF vsedit::ChecksumFile::Mode vsedit::ChecksumFile::mode() const
+//==============================================================================
+
+void vsedit::ChecksumFile::close()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+// END OF void vsedit::ChecksumFile::close()
+//==============================================================================
+
+bool vsedit::ChecksumFile::addFrame(int a_frameNumber,
+                                    const uint32_t *a_cpChecksums)
+{
+    Q_ASSERT(m_file.isOpen());
+
+    qint64 recordSize = (qint64)m_planes * 4;
+    qint64 offset = CHECKSUM_FILE_HEADER_SIZE +
+                    (qint64)(a_frameNumber - m_firstFrame) * recordSize;
+    std::vector<char> record((size_t)recordSize);
+
+    if (m_mode != Mode::Compare) {
+        for (int i = 0; i < m_planes; ++i) {
+            qToLittleEndian<quint32>(a_cpChecksums[i], record.data() + i * 4);
+        }
+
+        if ((!m_file.seek(offset)) ||
+                (m_file.write(record.data(), recordSize) != recordSize)) {
+            m_errorString = QObject::tr("Could not write checksum file "
+                                        "\"%1\": %2").arg(m_file.fileName())
+                            .arg(m_file.errorString());
+            return false;
+        }
+
+        return true;
+    }
+
+    if ((a_frameNumber < m_firstFrame) ||
+            (offset + recordSize > m_file.size())) {
+        m_framesMissing++;
+        return true;
+    }
+
+    if ((!m_file.seek(offset)) ||
+            (m_file.read(record.data(), recordSize) != recordSize)) {
+        m_errorString = QObject::tr("Could not read checksum file "
+                                    "\"%1\": %2").arg(m_file.fileName())
+                        .arg(m_file.errorString());
+        return false;
+    }
+
+    m_framesCompared++;
+
+    for (int i = 0; i < m_planes; ++i) {
+        if (qFromLittleEndian<quint32>(record.data() + i * 4) ==
+                a_cpChecksums[i]) {
+            continue;
+        }
+
+        m_framesDiffering++;
+
+        if ((m_firstDifferingFrame < 0) ||
+                (a_frameNumber < m_firstDifferingFrame)) {
+            m_firstDifferingFrame = a_frameNumber;
+            m_firstDifferingPlane = i;
+        }
+
+        break;
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::ChecksumFile::addFrame(int a_frameNumber,
+//		const uint32_t * a_cpChecksums)
+//==============================================================================
+
+int vsedit::ChecksumFile::framesCompared() const
+{
+    return m_framesCompared;
+}
+
+// END OF int vsedit::ChecksumFile::framesCompared() const
+//==============================================================================
+
+int vsedit::ChecksumFile::framesDiffering() const
+{
+    return m_framesDiffering;
+}
+
+// END OF int vsedit::ChecksumFile::framesDiffering() const
+//==============================================================================
+
+int vsedit::ChecksumFile::framesMissing() const
+{
+    return m_framesMissing;
+}
+
+// END OF int vsedit::ChecksumFile::framesMissing() const
+//==============================================================================
+
+int vsedit::ChecksumFile::firstDifferingFrame() const
+{
+    return m_firstDifferingFrame;
+}
+
+// END OF int vsedit::ChecksumFile::firstDifferingFrame() const
+//==============================================================================
+
+int vsedit::ChecksumFile::firstDifferingPlane() const
+{
+    return m_firstDifferingPlane;
+}
+
+// END OF int vsedit::ChecksumFile::firstDifferingPlane() const
+//==============================================================================
+
+vsedit::ChecksumResults vsedit::ChecksumFile::results() const
+{
+    ChecksumResults results;
+    results.framesCompared = m_framesCompared;
+    results.framesDiffering = m_framesDiffering;
+    results.framesMissing = m_framesMissing;
+    results.firstDifferingFrame = m_firstDifferingFrame;
+    results.firstDifferingPlane = m_firstDifferingPlane;
+    return results;
+}
+
+// END OF vsedit::ChecksumResults vsedit::ChecksumFile::results() const
+//==============================================================================
+
+QString vsedit::ChecksumFile::errorString() const
+{
+    return m_errorString;
+}
+
+// END OF QString vsedit::ChecksumFile::errorString() const
+//==============================================================================
+
+bool vsedit::ChecksumFile::readHeader()
+{
+    char header[CHECKSUM_FILE_HEADER_SIZE];
+
+    if ((m_file.read(header, CHECKSUM_FILE_HEADER_SIZE) !=
+            CHECKSUM_FILE_HEADER_SIZE) ||
+            (memcmp(header, CHECKSUM_FILE_MAGIC,
+                    sizeof(CHECKSUM_FILE_MAGIC)) != 0)) {
+        m_errorString = QObject::tr("\"%1\" is not a checksum file.")
+                        .arg(m_file.fileName());
+        return false;
+    }
+
+    int planes = (int)qFromLittleEndian<quint32>(header + 8);
+
+    if (planes != m_planes) {
+        m_errorString = QObject::tr("Checksum file \"%1\" is for frames "
+                                    "with %2 planes, not %3.").arg(m_file.fileName())
+                        .arg(planes).arg(m_planes);
+        return false;
+    }
+
+    m_firstFrame = (int)qFromLittleEndian<qint32>(header + 12);
+    return true;
+}
+
+// END OF bool vsedit::ChecksumFile::readHeader()
+//==============================================================================
@@ -0,0 +1,91 @@
+#ifndef CHECKSUM_FILE_H_INCLUDED
+#define CHECKSUM_FILE_H_INCLUDED
+
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+
+namespace vsedit {
+
+// Comparison counts of one or more checksum files.
+struct ChecksumResults {
+    int framesCompared = 0;
+    int framesDiffering = 0;
+    int framesMissing = 0;
+    // -1 if all compared frames match.
+    int firstDifferingFrame = -1;
+    int firstDifferingPlane = -1;
+
+    // Adds the counts of another range of frames.
+    void add(const ChecksumResults &a_other);
+};
+
+// Sidecar file with one CRC-32C per plane of every encoded frame.
+// A 16 byte header holds a magic, the number of planes and the first frame,
+// then fixed size records follow in frame order, so segments of a job can
+// write their frames into one file independently.
+// All numbers are little-endian.
+class ChecksumFile
+{
+public:
+
+    enum class Mode {
+        // Creates or truncates the file.
+        Write,
+        // Writes frames into a file created by another job.
+        Update,
+        // Checks frames against the file instead of writing them.
+        Compare,
+    };
+
+    ChecksumFile();
+    virtual ~ChecksumFile();
+
+    // a_firstFrame is only used to create the file. Otherwise it comes
+    // from the header, which must be for a_planes planes.
+    bool open(const QString &a_filePath, Mode a_mode, int a_planes,
+              int a_firstFrame);
+
+    bool isOpen() const;
+
+    Mode mode() const;
+
+    void close();
+
+    // Writes or compares the a_planes checksums of a frame.
+    // Returns false on a file error only, not on a difference.
+    bool addFrame(int a_frameNumber, const uint32_t *a_cpChecksums);
+
+    // Results of the comparison.
+    int framesCompared() const;
+    int framesDiffering() const;
+    int framesMissing() const;
+    // -1 if all compared frames match.
+    int firstDifferingFrame() const;
+    int firstDifferingPlane() const;
+    ChecksumResults results() const;
+
+    QString errorString() const;
+
+private:
+
+    bool readHeader();
+
+    QFile m_file;
+    Mode m_mode;
+    int m_planes;
+    int m_firstFrame;
+
+    int m_framesCompared;
+    int m_framesDiffering;
+    int m_framesMissing;
+    int m_firstDifferingFrame;
+    int m_firstDifferingPlane;
+
+    QString m_errorString;
+};
+
+}
+
+#endif // CHECKSUM_FILE_H_INCLUDED
@@ -0,0 +1,490 @@
+#include "encoder_file_writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+
+// Big enough for a few HD frames, so most writes carry several of them.
+// Must be a multiple of the block alignment.
+const size_t FILE_WRITE_BLOCK_SIZE = 8 << 20;
+
+//==============================================================================
+
+vsedit::EncoderFileWriter::EncoderFileWriter(const VSAPI *a_cpVSAPI,
+                                             QObject *a_pParent) :
+    QObject(a_pParent)
+    , m_cpVSAPI(a_cpVSAPI)
+    , m_unbuffered(false)
+    , m_blockFill(0)
+    , m_closing(false)
+    , m_aborting(false)
+    , m_running(false)
+    , m_packingTime(0)
+{
+    Q_ASSERT(m_cpVSAPI);
+}
+
+// END OF vsedit::EncoderFileWriter::EncoderFileWriter(const VSAPI * a_cpVSAPI,
+//		QObject * a_pParent)
+//==============================================================================
+
+vsedit::EncoderFileWriter::~EncoderFileWriter()
+{
+    stopThread();
+}
+
+// END OF vsedit::EncoderFileWriter::~EncoderFileWriter()
+//==============================================================================
+
+bool vsedit::EncoderFileWriter::open(const QString &a_filePath,
+                                     bool a_unbuffered)
+{
+    stopThread();
+
+    m_errorString.clear();
+    m_closing = false;
+    m_aborting = false;
+    m_unbuffered = false;
+    m_blockFill = 0;
+
+    m_file.setFileName(a_filePath);
+
+    // Data is always handed over in large blocks,
+    // so QFile buffering would only add a copy.
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                     QIODevice::Unbuffered)) {
+        m_errorString = tr("Could not open file \"%1\": %2")
+                        .arg(a_filePath).arg(m_file.errorString());
+        return false;
+    }
+
+#ifdef Q_OS_LINUX
+    if (a_unbuffered) {
+        int fd = m_file.handle();
+        int flags = fcntl(fd, F_GETFL);
+
+        // File systems without direct I/O refuse the flag here.
+        m_unbuffered = (flags != -1) &&
+                       (fcntl(fd, F_SETFL, flags | O_DIRECT) == 0);
+    }
+#else
+    (void)a_unbuffered;
+#endif
+
+    m_block.resize(FILE_WRITE_BLOCK_SIZE);
+    m_running = true;
+    m_thread = std::thread(&EncoderFileWriter::writerLoop, this);
+    return true;
+}
+
+// END OF bool vsedit::EncoderFileWriter::open(const QString & a_filePath,
+//		bool a_unbuffered)
+//==============================================================================
+
+bool vsedit::EncoderFileWriter::isOpen() const
+{
+    return m_thread.joinable();
+}
+
+// END OF bool vsedit::EncoderFileWriter::isOpen() const
+//==============================================================================
+
+bool vsedit::EncoderFileWriter::isUnbuffered() const
+{
+    return m_unbuffered;
+}
+
+// END OF bool vsedit::EncoderFileWriter::isUnbuffered() const
+//==============================================================================
+
+qint64 vsedit::EncoderFileWriter::write(const QByteArray &a_data)
+{
+    if (a_data.isEmpty()) {
+        return 0;
+    }
+
+    WriteRequest *pRequest = new WriteRequest;
+    pRequest->prefix = a_data;
+    pRequest->bytes = (size_t)a_data.size();
+    return enqueue(pRequest);
+}
+
+// END OF qint64 vsedit::EncoderFileWriter::write(const QByteArray & a_data)
+//==============================================================================
+
+qint64 vsedit::EncoderFileWriter::writeFrame(const QByteArray &a_prefix,
+                                             const VSFrameRef *a_cpFrameRef, const QByteArray &a_postfix)
+{
+    Q_ASSERT(a_cpFrameRef);
+
+    WriteRequest *pRequest = new WriteRequest;
+    pRequest->prefix = a_prefix;
+    pRequest->postfix = a_postfix;
+    pRequest->cpFrameRef = m_cpVSAPI->cloneFrameRef(a_cpFrameRef);
+
+    const VSFormat *cpFormat = m_cpVSAPI->getFrameFormat(a_cpFrameRef);
+
+    for (int i = 0; i < cpFormat->numPlanes; ++i) {
+        pRequest->bytes += (size_t)m_cpVSAPI->getFrameWidth(a_cpFrameRef, i) *
+                           cpFormat->bytesPerSample *
+                           m_cpVSAPI->getFrameHeight(a_cpFrameRef, i);
+    }
+
+    pRequest->bytes += a_prefix.size() + a_postfix.size();
+    return enqueue(pRequest);
+}
+
+// END OF qint64 vsedit::EncoderFileWriter::writeFrame(
+//		const QByteArray & a_prefix, const VSFrameRef * a_cpFrameRef,
+//		const QByteArray & a_postfix)
+//==============================================================================
+
+void vsedit::EncoderFileWriter::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_requestQueued.notify_one();
+}
+
+// END OF void vsedit::EncoderFileWriter::close()
+//==============================================================================
+
+void vsedit::EncoderFileWriter::abort()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_aborting = true;
+    }
+    m_requestQueued.notify_one();
+}
+
+// END OF void vsedit::EncoderFileWriter::abort()
+//==============================================================================
+
+bool vsedit::EncoderFileWriter::isRunning() const
+{
+    return m_running;
+}
+
+// END OF bool vsedit::EncoderFileWriter::isRunning() const
+//==============================================================================
+
+void vsedit::EncoderFileWriter::waitForFinished()
+{
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    releaseQueued();
+
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+
+    // Do not keep a big buffer around between jobs.
+    Block().swap(m_block);
+}
+
+// END OF void vsedit::EncoderFileWriter::waitForFinished()
+//==============================================================================
+
+QString vsedit::EncoderFileWriter::errorString() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_errorString;
+}
+
+// END OF QString vsedit::EncoderFileWriter::errorString() const
+//==============================================================================
+
+double vsedit::EncoderFileWriter::packingTime() const
+{
+    return (double)m_packingTime / 1e9;
+}
+
+// END OF double vsedit::EncoderFileWriter::packingTime() const
+//==============================================================================
+
+qint64 vsedit::EncoderFileWriter::enqueue(WriteRequest *a_pRequest)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (!m_thread.joinable() || m_closing || m_aborting) {
+        lock.unlock();
+        releaseRequest(a_pRequest);
+        return -1;
+    }
+
+    qint64 bytes = (qint64)a_pRequest->bytes;
+    m_queue.push_back(a_pRequest);
+    lock.unlock();
+    m_requestQueued.notify_one();
+    return bytes;
+}
+
+// END OF qint64 vsedit::EncoderFileWriter::enqueue(WriteRequest * a_pRequest)
+//==============================================================================
+
+void vsedit::EncoderFileWriter::writerLoop()
+{
+    bool written = true;
+
+    for (;;) {
+        WriteRequest *pRequest = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestQueued.wait(lock, [this]() {
+                return m_aborting || m_closing || !m_queue.empty();
+            });
+
+            // An empty queue here means close() was called.
+            if (m_aborting || m_queue.empty()) {
+                break;
+            }
+
+            pRequest = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        hr_time_point packingStart = hr_clock::now();
+        written = packRequest(pRequest);
+        m_packingTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            hr_clock::now() - packingStart).count();
+        size_t bytes = pRequest->bytes;
+        releaseRequest(pRequest);
+
+        if (!written) {
+            break;
+        }
+
+        emit signalBytesWritten((qint64)bytes);
+    }
+
+    releaseQueued();
+
+    if (written && !m_aborting && (m_blockFill > 0)) {
+        writeBlock(m_block.data(), m_blockFill, true);
+    }
+
+    m_blockFill = 0;
+    m_running = false;
+    emit signalFinished();
+}
+
+// END OF void vsedit::EncoderFileWriter::writerLoop()
+//==============================================================================
+
+bool vsedit::EncoderFileWriter::packRequest(const WriteRequest *a_pRequest)
+{
+    if (!append(a_pRequest->prefix.constData(),
+                (size_t)a_pRequest->prefix.size())) {
+        return false;
+    }
+
+    if (a_pRequest->cpFrameRef) {
+        const VSFrameRef *cpFrameRef = a_pRequest->cpFrameRef;
+        const VSFormat *cpFormat = m_cpVSAPI->getFrameFormat(cpFrameRef);
+
+        for (int i = 0; i < cpFormat->numPlanes; ++i) {
+            const uint8_t *cpPlane = m_cpVSAPI->getReadPtr(cpFrameRef, i);
+            size_t stride = (size_t)m_cpVSAPI->getStride(cpFrameRef, i);
+            int height = m_cpVSAPI->getFrameHeight(cpFrameRef, i);
+            size_t rowSize = (size_t)m_cpVSAPI->getFrameWidth(cpFrameRef, i) *
+                             cpFormat->bytesPerSample;
+
+            // Drop the line padding on the way into the block.
+            if (stride == rowSize) {
+                if (!append(cpPlane, rowSize * height)) {
+                    return false;
+                }
+
+                continue;
+            }
+
+            for (int y = 0; y < height; ++y) {
+                if (!append(cpPlane + stride * y, rowSize)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return append(a_pRequest->postfix.constData(),
+                  (size_t)a_pRequest->postfix.size());
+}
+
+// END OF bool vsedit::EncoderFileWriter::packRequest(
+//		const WriteRequest * a_pRequest)
+//==============================================================================
+
+bool vsedit::EncoderFileWriter::append(const void *a_cpData, size_t a_size)
+{
+    const char *cpData = (const char *)a_cpData;
+
+    while (a_size > 0) {
+        size_t portion = std::min(a_size, m_block.size() - m_blockFill);
+        memcpy(m_block.data() + m_blockFill, cpData, portion);
+        m_blockFill += portion;
+        cpData += portion;
+        a_size -= portion;
+
+        if (m_blockFill < m_block.size()) {
+            continue;
+        }
+
+        if (m_aborting) {
+            return false;
+        }
+
+        // The write is not part of the packing time.
+        hr_time_point writeStart = hr_clock::now();
+        bool written = writeBlock(m_block.data(), m_block.size(), false);
+        m_packingTime -= std::chrono::duration_cast<std::chrono::nanoseconds>(
+            hr_clock::now() - writeStart).count();
+
+        if (!written) {
+            return false;
+        }
+
+        m_blockFill = 0;
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::EncoderFileWriter::append(const void * a_cpData,
+//		size_t a_size)
+//==============================================================================
+
+bool vsedit::EncoderFileWriter::writeBlock(const char *a_cpData,
+                                           size_t a_size, bool a_last)
+{
+#ifdef Q_OS_LINUX
+    int fd = m_file.handle();
+
+    // The tail is rarely aligned. Write it through the page cache
+    // rather than padding the file and truncating it back.
+    if (a_last && m_unbuffered && (a_size % BLOCK_ALIGNMENT != 0)) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+    }
+
+    while (a_size > 0) {
+        ssize_t result = ::write(fd, a_cpData, a_size);
+
+        if (result < 0) {
+            int error = errno;
+
+            if (error == EINTR) {
+                continue;
+            }
+
+            // Some file systems accept O_DIRECT on open
+            // and only refuse it on write.
+            int flags = fcntl(fd, F_GETFL);
+
+            if ((error == EINVAL) && (flags != -1) && (flags & O_DIRECT)) {
+                fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+                continue;
+            }
+
+            setError(tr("Error on writing to file \"%1\": %2")
+                     .arg(m_file.fileName())
+                     .arg(QString::fromLocal8Bit(strerror(error))));
+            return false;
+        }
+
+        a_cpData += result;
+        a_size -= (size_t)result;
+    }
+
+    return true;
+#else
+    (void)a_last;
+
+    if (m_file.write(a_cpData, (qint64)a_size) != (qint64)a_size) {
+        setError(tr("Error on writing to file \"%1\": %2")
+                 .arg(m_file.fileName()).arg(m_file.errorString()));
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+// END OF bool vsedit::EncoderFileWriter::writeBlock(const char * a_cpData,
+//		size_t a_size, bool a_last)
+//==============================================================================
+
+void vsedit::EncoderFileWriter::releaseRequest(WriteRequest *a_pRequest)
+{
+    if (a_pRequest->cpFrameRef) {
+        m_cpVSAPI->freeFrame(a_pRequest->cpFrameRef);
+    }
+
+    delete a_pRequest;
+}
+
+// END OF void vsedit::EncoderFileWriter::releaseRequest(
+//		WriteRequest * a_pRequest)
+//==============================================================================
+
+void vsedit::EncoderFileWriter::releaseQueued()
+{
+    std::deque<WriteRequest *> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        dropped.swap(m_queue);
+    }
+
+    for (WriteRequest *pRequest : dropped) {
+        releaseRequest(pRequest);
+    }
+}
+
+// END OF void vsedit::EncoderFileWriter::releaseQueued()
+//==============================================================================
+
+void vsedit::EncoderFileWriter::stopThread()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    abort();
+    waitForFinished();
+}
+
+// END OF void vsedit::EncoderFileWriter::stopThread()
+//==============================================================================
+
+void vsedit::EncoderFileWriter::setError(const QString &a_message)
+{
+    bool closing;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_errorString = a_message;
+        closing = m_closing;
+        // Nothing more will be written, so refuse new requests.
+        m_aborting = true;
+    }
+
+    // The owner is waiting for the thread after close()
+    // and checks errorString() itself.
+    if (!closing) {
+        emit signalWriteError(a_message);
+    }
+}
+
+// END OF void vsedit::EncoderFileWriter::setError(const QString & a_message)
+//==============================================================================
@@ -0,0 +1,139 @@
+#ifndef ENCODER_FILE_WRITER_H_INCLUDED
+#define ENCODER_FILE_WRITER_H_INCLUDED
+
+#include "../aligned_vector.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "common-src/chrono.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <vapoursynth/VapourSynth.h>
+
+namespace vsedit {
+
+// Writes the encoding stream straight to a file instead of an encoder.
+// Frames are queued with their references and packed by a dedicated thread
+// into large aligned blocks, so the file only sees big sequential writes and
+// the caller never waits for the disk. On Linux the file can be opened with
+// O_DIRECT to keep the output out of the page cache.
+class EncoderFileWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    EncoderFileWriter(const VSAPI *a_cpVSAPI, QObject *a_pParent = nullptr);
+    virtual ~EncoderFileWriter();
+
+    // Creates or truncates the file and starts the writer thread.
+    // Unbuffered output is silently dropped where it is not supported;
+    // isUnbuffered() tells what was actually used.
+    bool open(const QString &a_filePath, bool a_unbuffered);
+
+    bool isOpen() const;
+
+    bool isUnbuffered() const;
+
+    // Queue data for writing. Return the number of bytes queued or -1.
+    qint64 write(const QByteArray &a_data);
+    qint64 writeFrame(const QByteArray &a_prefix,
+                      const VSFrameRef *a_cpFrameRef, const QByteArray &a_postfix);
+
+    // Writes everything queued, then closes the file.
+    // Errors past this point are only reported by errorString().
+    void close();
+
+    // Drops everything queued and closes the file.
+    void abort();
+
+    // True from open() until the writer thread has stopped. After close()
+    // the thread lasts until the last block is on the disk.
+    bool isRunning() const;
+
+    // Blocks until the writer thread has stopped after close() or abort().
+    // Returns at once after signalFinished(). No frame is held afterwards.
+    void waitForFinished();
+
+    QString errorString() const;
+
+    // Seconds the writer thread has spent packing frames into blocks,
+    // not counting the writes of the blocks.
+    double packingTime() const;
+
+signals:
+
+    // Emitted from the writer thread once queued data has been taken
+    // into the write buffer and its frame is released.
+    void signalBytesWritten(qint64 a_bytes);
+    void signalWriteError(const QString &a_message);
+    void signalFinished();
+
+private:
+
+    struct WriteRequest {
+        QByteArray prefix;
+        const VSFrameRef *cpFrameRef = nullptr;
+        QByteArray postfix;
+        size_t bytes = 0;
+    };
+
+    // O_DIRECT needs buffers, offsets and sizes aligned to the
+    // logical block size of the device. A page covers all common ones.
+    static const size_t BLOCK_ALIGNMENT = 4096;
+
+    typedef std::vector<char, aligned_allocator<char, BLOCK_ALIGNMENT>>
+        Block;
+
+    qint64 enqueue(WriteRequest *a_pRequest);
+
+    void writerLoop();
+
+    bool packRequest(const WriteRequest *a_pRequest);
+
+    bool append(const void *a_cpData, size_t a_size);
+
+    bool writeBlock(const char *a_cpData, size_t a_size, bool a_last);
+
+    void releaseRequest(WriteRequest *a_pRequest);
+
+    void releaseQueued();
+
+    void stopThread();
+
+    void setError(const QString &a_message);
+
+    const VSAPI *m_cpVSAPI;
+
+    QFile m_file;
+    bool m_unbuffered;
+
+    Block m_block;
+    size_t m_blockFill;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_requestQueued;
+    std::deque<WriteRequest *> m_queue;
+    bool m_closing;
+    std::atomic<bool> m_aborting;
+    std::atomic<bool> m_running;
+
+    // Nanoseconds, updated by the writer thread.
+    std::atomic<long long> m_packingTime;
+
+    QString m_errorString;
+};
+
+}
+
+#endif // ENCODER_FILE_WRITER_H_INCLUDED
@@ -0,0 +1,365 @@
+#include "encoder_output_log.h"
+
+#include "common-src/log/vs_editor_log_definitions.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QStringList>
+
+//==============================================================================
+
+// Milliseconds between two batches of lines sent to the log.
+static const int FLUSH_INTERVAL = 1000;
+
+// Most lines sent to the log in one batch.
+static const size_t MAX_LINES_PER_FLUSH = 20;
+
+// Lines waiting for the log. Older ones are dropped beyond that.
+static const size_t MAX_PENDING_LINES = 500;
+
+// Seconds between two progress lines sent to the log.
+static const double PROGRESS_LOG_INTERVAL = 30.0;
+
+// Output without line breaks is cut into lines of this length.
+static const int MAX_LINE_BYTES = 4096;
+
+// Seconds a kept spool file is left unchanged before it is removed.
+// Files of running encoders are written to all the time.
+static const qint64 STALE_SPOOL_FILE_AGE = 24 * 60 * 60;
+
+//==============================================================================
+
+static void removeStaleSpoolFiles(const QString &a_dirPath)
+{
+    QDateTime staleTime =
+        QDateTime::currentDateTimeUtc().addSecs(-STALE_SPOOL_FILE_AGE);
+    QFileInfoList files = QDir(a_dirPath).entryInfoList({"*.log"},
+                          QDir::Files);
+
+    for (const QFileInfo &fileInfo : files) {
+        if (fileInfo.lastModified().toUTC() < staleTime) {
+            QFile::remove(fileInfo.absoluteFilePath());
+        }
+    }
+}
+
+//==============================================================================
+
+vsedit::EncoderOutputLog::EncoderOutputLog(QObject *a_pParent):
+    QObject(a_pParent)
+    , m_lastLineRepeats(0)
+    , m_droppedLines(0)
+    , m_linesSkipped(false)
+    , m_progressLogged(false)
+    , m_fps(0.0)
+    , m_bitrate(0.0)
+{
+    m_flushTimer.setInterval(FLUSH_INTERVAL);
+    connect(&m_flushTimer, SIGNAL(timeout()), this, SLOT(slotFlush()));
+}
+
+// END OF vsedit::EncoderOutputLog::EncoderOutputLog(QObject *a_pParent)
+//==============================================================================
+
+vsedit::EncoderOutputLog::~EncoderOutputLog()
+{
+    m_spoolFile.close();
+}
+
+// END OF vsedit::EncoderOutputLog::~EncoderOutputLog()
+//==============================================================================
+
+bool vsedit::EncoderOutputLog::start(const QString &a_spoolPath)
+{
+    finish();
+
+    m_errorString.clear();
+    m_partialLine.clear();
+    m_lastLine.clear();
+    m_lastLineRepeats = 0;
+    m_pendingLines.clear();
+    m_droppedLines = 0;
+    m_linesSkipped = false;
+    m_lastProgressLine.clear();
+    m_progressLogged = false;
+    m_fps = 0.0;
+    m_bitrate = 0.0;
+
+    QString spoolDirPath = QFileInfo(a_spoolPath).absolutePath();
+    static bool staleFilesRemoved = false;
+
+    if (!staleFilesRemoved) {
+        staleFilesRemoved = true;
+        removeStaleSpoolFiles(spoolDirPath);
+    }
+
+    m_spoolFile.setFileName(a_spoolPath);
+    QDir().mkpath(spoolDirPath);
+
+    if (!m_spoolFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_errorString = tr("Could not open encoder log file \"%1\": %2")
+                        .arg(a_spoolPath).arg(m_spoolFile.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::EncoderOutputLog::start(const QString &a_spoolPath)
+//==============================================================================
+
+void vsedit::EncoderOutputLog::append(const QByteArray &a_data)
+{
+    if (a_data.isEmpty()) {
+        return;
+    }
+
+    if (m_spoolFile.isOpen() &&
+            (m_spoolFile.write(a_data) != a_data.size())) {
+        m_errorString = tr("Could not write encoder log file \"%1\": %2")
+                        .arg(m_spoolFile.fileName())
+                        .arg(m_spoolFile.errorString());
+        m_spoolFile.close();
+        emit signalLogMessage(m_errorString, LOG_STYLE_WARNING);
+    }
+
+    // Progress is usually rewritten in place with carriage returns.
+    const char *cpData = a_data.constData();
+    int lineStart = 0;
+
+    for (int i = 0; i < a_data.size(); ++i) {
+        if ((cpData[i] != '\n') && (cpData[i] != '\r')) {
+            continue;
+        }
+
+        m_partialLine.append(cpData + lineStart, i - lineStart);
+        processLine(m_partialLine);
+        m_partialLine.clear();
+        lineStart = i + 1;
+    }
+
+    m_partialLine.append(cpData + lineStart, a_data.size() - lineStart);
+
+    if (m_partialLine.size() >= MAX_LINE_BYTES) {
+        processLine(m_partialLine);
+        m_partialLine.clear();
+    }
+}
+
+// END OF void vsedit::EncoderOutputLog::append(const QByteArray &a_data)
+//==============================================================================
+
+void vsedit::EncoderOutputLog::finish()
+{
+    if (!m_partialLine.isEmpty()) {
+        processLine(m_partialLine);
+        m_partialLine.clear();
+    }
+
+    pushRepeats();
+
+    // The final statistics of the encoder are worth keeping.
+    if (!m_lastProgressLine.isEmpty()) {
+        m_pendingLines.push_back(m_lastProgressLine);
+        m_lastProgressLine.clear();
+    }
+
+    while (!m_pendingLines.empty() || (m_droppedLines > 0)) {
+        slotFlush();
+    }
+
+    m_flushTimer.stop();
+    m_spoolFile.close();
+
+    // Everything has reached the log.
+    if (!m_linesSkipped && !m_spoolFile.fileName().isEmpty()) {
+        m_spoolFile.remove();
+        m_spoolFile.setFileName(QString());
+    }
+}
+
+// END OF void vsedit::EncoderOutputLog::finish()
+//==============================================================================
+
+QString vsedit::EncoderOutputLog::spoolPath() const
+{
+    return m_spoolFile.fileName();
+}
+
+// END OF QString vsedit::EncoderOutputLog::spoolPath() const
+//==============================================================================
+
+QString vsedit::EncoderOutputLog::errorString() const
+{
+    return m_errorString;
+}
+
+// END OF QString vsedit::EncoderOutputLog::errorString() const
+//==============================================================================
+
+double vsedit::EncoderOutputLog::fps() const
+{
+    return m_fps;
+}
+
+// END OF double vsedit::EncoderOutputLog::fps() const
+//==============================================================================
+
+double vsedit::EncoderOutputLog::bitrate() const
+{
+    return m_bitrate;
+}
+
+// END OF double vsedit::EncoderOutputLog::bitrate() const
+//==============================================================================
+
+void vsedit::EncoderOutputLog::slotFlush()
+{
+    pushRepeats();
+
+    if (m_pendingLines.empty() && (m_droppedLines == 0)) {
+        m_flushTimer.stop();
+        return;
+    }
+
+    QStringList lines;
+
+    if (m_droppedLines > 0) {
+        if (m_spoolFile.fileName().isEmpty()) {
+            lines << tr("(%1 lines of encoder output skipped)")
+                  .arg(m_droppedLines);
+        } else {
+            lines << tr("(%1 lines of encoder output skipped, see \"%2\")")
+                  .arg(m_droppedLines).arg(m_spoolFile.fileName());
+        }
+
+        m_droppedLines = 0;
+        m_linesSkipped = true;
+    }
+
+    while (!m_pendingLines.empty() &&
+            ((size_t)lines.size() < MAX_LINES_PER_FLUSH)) {
+        lines << m_pendingLines.front();
+        m_pendingLines.pop_front();
+    }
+
+    emit signalLogMessage(lines.join('\n'));
+}
+
+// END OF void vsedit::EncoderOutputLog::slotFlush()
+//==============================================================================
+
+void vsedit::EncoderOutputLog::processLine(const QByteArray &a_line)
+{
+    QString line = QString::fromUtf8(a_line).trimmed();
+
+    if (line.isEmpty()) {
+        return;
+    }
+
+    if (parseProgress(line)) {
+        double sinceLogged =
+            duration_to_double(hr_clock::now() - m_progressLogTime);
+
+        if (m_progressLogged && (sinceLogged < PROGRESS_LOG_INTERVAL)) {
+            m_lastProgressLine = line;
+            return;
+        }
+
+        m_lastProgressLine.clear();
+        m_progressLogged = true;
+        m_progressLogTime = hr_clock::now();
+        pushLine(line);
+        return;
+    }
+
+    if (line == m_lastLine) {
+        m_lastLineRepeats++;
+        return;
+    }
+
+    pushRepeats();
+    m_lastLine = line;
+    pushLine(line);
+}
+
+// END OF void vsedit::EncoderOutputLog::processLine(const QByteArray &a_line)
+//==============================================================================
+
+bool vsedit::EncoderOutputLog::parseProgress(const QString &a_line)
+{
+    // x264 and x265:
+    // [12.3%] 123/1000 frames, 45.67 fps, 1234.56 kb/s, eta 0:01:02
+    static const QRegularExpression x264Progress(
+        "(\\d+)(?:/\\d+)?\\s+frames[:,]\\s+([\\d.]+)\\s+fps,"
+        "\\s+([\\d.]+)\\s+kb/s");
+    // ffmpeg:
+    // frame=  123 fps= 45 q=28.0 size=  1234kB time=... bitrate=1974.3kbits/s
+    static const QRegularExpression ffmpegProgress(
+        "frame=\\s*(\\d+)\\s+fps=\\s*([\\d.]+)"
+        "(?:.*bitrate=\\s*([\\d.]+)\\s*kbits/s)?");
+
+    QRegularExpressionMatch match = x264Progress.match(a_line);
+
+    if (!match.hasMatch()) {
+        match = ffmpegProgress.match(a_line);
+    }
+
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    double fps = match.captured(2).toDouble();
+    double bitrate = m_bitrate;
+
+    if (!match.captured(3).isEmpty()) {
+        bitrate = match.captured(3).toDouble();
+    }
+
+    if ((fps != m_fps) || (bitrate != m_bitrate)) {
+        m_fps = fps;
+        m_bitrate = bitrate;
+        emit signalStatsChanged();
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::EncoderOutputLog::parseProgress(const QString &a_line)
+//==============================================================================
+
+void vsedit::EncoderOutputLog::pushLine(const QString &a_line)
+{
+    m_pendingLines.push_back(a_line);
+
+    if (m_pendingLines.size() > MAX_PENDING_LINES) {
+        m_pendingLines.pop_front();
+        m_droppedLines++;
+    }
+
+    // The first line after a quiet period is logged right away,
+    // the following ones wait for the timer.
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+        slotFlush();
+    }
+}
+
+// END OF void vsedit::EncoderOutputLog::pushLine(const QString &a_line)
+//==============================================================================
+
+void vsedit::EncoderOutputLog::pushRepeats()
+{
+    if (m_lastLineRepeats == 0) {
+        return;
+    }
+
+    int repeats = m_lastLineRepeats;
+    m_lastLineRepeats = 0;
+    pushLine(tr("(last line repeated %1 more times)").arg(repeats));
+}
+
+// END OF void vsedit::EncoderOutputLog::pushRepeats()
+//==============================================================================
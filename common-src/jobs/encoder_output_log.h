@@ -0,0 +1,97 @@
+#ifndef ENCODER_OUTPUT_LOG_H_INCLUDED
+#define ENCODER_OUTPUT_LOG_H_INCLUDED
+
+#include "common-src/log/styled_log_view_core.h"
+#include "common-src/chrono.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QTimer>
+
+#include <deque>
+
+namespace vsedit {
+
+// Collects what an encoder prints to its standard error. All of it is
+// spooled unchanged to a file. Progress lines are parsed into statistics and
+// only logged now and then, repeated lines are counted instead of logged, and
+// the rest reaches the log in batches at a bounded rate. Lines the log can
+// not keep up with are dropped from a ring buffer and stay in the spool file.
+// A spool file is only kept if lines were dropped, and kept files are
+// removed once they have not been written to for a day.
+class EncoderOutputLog : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    EncoderOutputLog(QObject *a_pParent = nullptr);
+    virtual ~EncoderOutputLog();
+
+    // Starts a new capture and truncates the spool file. Without a spool
+    // file the output is still logged; errorString() tells why it failed.
+    // Stale spool files next to it are removed on the first start.
+    bool start(const QString &a_spoolPath);
+
+    void append(const QByteArray &a_data);
+
+    // Takes the unterminated last line, logs everything pending
+    // and closes the spool file. The file is removed unless lines
+    // were dropped from the log.
+    void finish();
+
+    // Empty once the spool file is removed.
+    QString spoolPath() const;
+    QString errorString() const;
+
+    // Last values the encoder has reported, 0 if unknown.
+    double fps() const;
+    double bitrate() const;
+
+signals:
+
+    void signalLogMessage(const QString &a_message,
+                          const QString &a_style = LOG_STYLE_DEFAULT);
+
+    void signalStatsChanged();
+
+private slots:
+
+    void slotFlush();
+
+private:
+
+    void processLine(const QByteArray &a_line);
+
+    bool parseProgress(const QString &a_line);
+
+    void pushLine(const QString &a_line);
+
+    void pushRepeats();
+
+    QFile m_spoolFile;
+    QString m_errorString;
+
+    QByteArray m_partialLine;
+
+    QString m_lastLine;
+    int m_lastLineRepeats;
+
+    std::deque<QString> m_pendingLines;
+    size_t m_droppedLines;
+    bool m_linesSkipped;
+    QTimer m_flushTimer;
+
+    QString m_lastProgressLine;
+    bool m_progressLogged;
+    hr_time_point m_progressLogTime;
+
+    double m_fps;
+    double m_bitrate;
+};
+
+}
+
+#endif // ENCODER_OUTPUT_LOG_H_INCLUDED
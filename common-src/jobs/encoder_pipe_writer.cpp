@@ -0,0 +1,688 @@
+#include "encoder_pipe_writer.h"
+
+#include <QProcess>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+
+#ifdef Q_OS_LINUX
+// Bigger pipe means fewer wake-ups of both the writer and the encoder.
+// The kernel may refuse it, then the default size is used.
+const int ENCODER_PIPE_SIZE = 1 << 20;
+
+// How often the writer checks whether the encoder has read spliced frames
+// when there is nothing new to write.
+const int PINNED_FRAMES_POLL_MS = 5;
+#endif
+
+//==============================================================================
+
+vsedit::EncoderPipeWriter::EncoderPipeWriter(const VSAPI *a_cpVSAPI,
+                                             QObject *a_pParent) :
+    QObject(a_pParent)
+    , m_cpVSAPI(a_cpVSAPI)
+    , m_pProcess(nullptr)
+    , m_attached(false)
+    , m_pipeReadFd(-1)
+    , m_pipeWriteFd(-1)
+    , m_wakeReadFd(-1)
+    , m_wakeWriteFd(-1)
+    , m_useSplice(true)
+    , m_closing(false)
+    , m_aborting(false)
+    , m_running(false)
+    , m_bytesToWrite(0)
+    , m_streamOffset(0)
+{
+    Q_ASSERT(m_cpVSAPI);
+}
+
+// END OF vsedit::EncoderPipeWriter::EncoderPipeWriter(const VSAPI * a_cpVSAPI,
+//		QObject * a_pParent)
+//==============================================================================
+
+vsedit::EncoderPipeWriter::~EncoderPipeWriter()
+{
+    stopThread();
+    closeFds();
+}
+
+// END OF vsedit::EncoderPipeWriter::~EncoderPipeWriter()
+//==============================================================================
+
+bool vsedit::EncoderPipeWriter::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+// END OF bool vsedit::EncoderPipeWriter::isSupported()
+//==============================================================================
+
+bool vsedit::EncoderPipeWriter::attach(QProcess *a_pProcess)
+{
+    Q_ASSERT(a_pProcess);
+
+#ifdef Q_OS_LINUX
+    stopThread();
+    closeFds();
+
+    m_errorString.clear();
+    m_closing = false;
+    m_aborting = false;
+    m_bytesToWrite = 0;
+    m_streamOffset = 0;
+    m_useSplice = true;
+
+    int pipeFds[2];
+    int wakeFds[2];
+
+    if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+        m_errorString = tr("Could not create pipe: %1")
+                        .arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+
+    if (pipe2(wakeFds, O_CLOEXEC | O_NONBLOCK) != 0) {
+        m_errorString = tr("Could not create pipe: %1")
+                        .arg(QString::fromLocal8Bit(strerror(errno)));
+        ::close(pipeFds[0]);
+        ::close(pipeFds[1]);
+        return false;
+    }
+
+    m_pipeReadFd = pipeFds[0];
+    m_pipeWriteFd = pipeFds[1];
+    m_wakeReadFd = wakeFds[0];
+    m_wakeWriteFd = wakeFds[1];
+
+    // The writer thread never blocks inside a write call,
+    // so abort() can always wake it up.
+    fcntl(m_pipeWriteFd, F_SETFL, fcntl(m_pipeWriteFd, F_GETFL) | O_NONBLOCK);
+    fcntl(m_pipeWriteFd, F_SETPIPE_SZ, ENCODER_PIPE_SIZE);
+
+    // QProcess opens the redirection file itself and hands it to the
+    // child as standard input. The write end is close-on-exec, so the
+    // encoder gets end of file once we close it.
+    m_pProcess = a_pProcess;
+    m_pProcess->setStandardInputFile(
+        QString("/proc/self/fd/%1").arg(m_pipeReadFd));
+    m_attached = true;
+    return true;
+#else
+    (void)a_pProcess;
+    m_errorString = tr("Direct encoder output is not supported "
+                       "on this platform.");
+    return false;
+#endif
+}
+
+// END OF bool vsedit::EncoderPipeWriter::attach(QProcess * a_pProcess)
+//==============================================================================
+
+bool vsedit::EncoderPipeWriter::start()
+{
+#ifdef Q_OS_LINUX
+    if (!m_attached || m_thread.joinable()) {
+        return false;
+    }
+
+    // Keeping the read end open here would stop the pipe from
+    // reporting that the encoder has gone away.
+    if (m_pipeReadFd >= 0) {
+        ::close(m_pipeReadFd);
+        m_pipeReadFd = -1;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&EncoderPipeWriter::writerLoop, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// END OF bool vsedit::EncoderPipeWriter::start()
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::detach()
+{
+    if (m_pProcess) {
+        m_pProcess->setStandardInputFile(QString());
+    }
+
+    m_attached = false;
+}
+
+// END OF void vsedit::EncoderPipeWriter::detach()
+//==============================================================================
+
+bool vsedit::EncoderPipeWriter::isAttached() const
+{
+    return m_attached;
+}
+
+// END OF bool vsedit::EncoderPipeWriter::isAttached() const
+//==============================================================================
+
+qint64 vsedit::EncoderPipeWriter::write(const QByteArray &a_data)
+{
+    if (a_data.isEmpty()) {
+        return 0;
+    }
+
+    WriteRequest *pRequest = new WriteRequest;
+    pRequest->prefix = a_data;
+    pRequest->chunks.push_back({pRequest->prefix.constData(),
+                                (size_t)pRequest->prefix.size()});
+    pRequest->bytes = (size_t)pRequest->prefix.size();
+    return enqueue(pRequest);
+}
+
+// END OF qint64 vsedit::EncoderPipeWriter::write(const QByteArray & a_data)
+//==============================================================================
+
+qint64 vsedit::EncoderPipeWriter::writeFrame(const QByteArray &a_prefix,
+                                             const VSFrameRef *a_cpFrameRef, const QByteArray &a_postfix)
+{
+    Q_ASSERT(a_cpFrameRef);
+
+    WriteRequest *pRequest = new WriteRequest;
+    pRequest->prefix = a_prefix;
+    pRequest->postfix = a_postfix;
+    pRequest->cpFrameRef = m_cpVSAPI->cloneFrameRef(a_cpFrameRef);
+
+    if (!pRequest->prefix.isEmpty()) {
+        pRequest->chunks.push_back({pRequest->prefix.constData(),
+                                    (size_t)pRequest->prefix.size()});
+    }
+
+    const VSFormat *cpFormat = m_cpVSAPI->getFrameFormat(a_cpFrameRef);
+
+    for (int i = 0; i < cpFormat->numPlanes; ++i) {
+        const uint8_t *cpPlane = m_cpVSAPI->getReadPtr(a_cpFrameRef, i);
+        size_t stride = (size_t)m_cpVSAPI->getStride(a_cpFrameRef, i);
+        int height = m_cpVSAPI->getFrameHeight(a_cpFrameRef, i);
+        size_t rowSize = (size_t)m_cpVSAPI->getFrameWidth(a_cpFrameRef, i) *
+                         cpFormat->bytesPerSample;
+
+        // Planes without padding go out in one piece,
+        // others line by line skipping the padding.
+        if (stride == rowSize) {
+            pRequest->chunks.push_back({cpPlane, rowSize * height});
+        } else {
+            for (int y = 0; y < height; ++y) {
+                pRequest->chunks.push_back({cpPlane + stride * y, rowSize});
+            }
+        }
+
+        pRequest->bytes += rowSize * height;
+    }
+
+    if (!pRequest->postfix.isEmpty()) {
+        pRequest->chunks.push_back({pRequest->postfix.constData(),
+                                    (size_t)pRequest->postfix.size()});
+    }
+
+    pRequest->bytes += pRequest->prefix.size() + pRequest->postfix.size();
+    return enqueue(pRequest);
+}
+
+// END OF qint64 vsedit::EncoderPipeWriter::writeFrame(
+//		const QByteArray & a_prefix, const VSFrameRef * a_cpFrameRef,
+//		const QByteArray & a_postfix)
+//==============================================================================
+
+qint64 vsedit::EncoderPipeWriter::bytesToWrite() const
+{
+    return m_bytesToWrite;
+}
+
+// END OF qint64 vsedit::EncoderPipeWriter::bytesToWrite() const
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_requestQueued.notify_one();
+    detach();
+}
+
+// END OF void vsedit::EncoderPipeWriter::close()
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::abort()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_aborting = true;
+    }
+    m_requestQueued.notify_one();
+
+#ifdef Q_OS_LINUX
+    if (m_wakeWriteFd >= 0) {
+        char byte = 0;
+        ssize_t result = ::write(m_wakeWriteFd, &byte, 1);
+        (void)result;
+    }
+#endif
+
+    detach();
+}
+
+// END OF void vsedit::EncoderPipeWriter::abort()
+//==============================================================================
+
+bool vsedit::EncoderPipeWriter::isRunning() const
+{
+    return m_running;
+}
+
+// END OF bool vsedit::EncoderPipeWriter::isRunning() const
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::waitForFinished()
+{
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    releaseQueued();
+}
+
+// END OF void vsedit::EncoderPipeWriter::waitForFinished()
+//==============================================================================
+
+QString vsedit::EncoderPipeWriter::errorString() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_errorString;
+}
+
+// END OF QString vsedit::EncoderPipeWriter::errorString() const
+//==============================================================================
+
+qint64 vsedit::EncoderPipeWriter::enqueue(WriteRequest *a_pRequest)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (!m_thread.joinable() || m_closing || m_aborting) {
+        lock.unlock();
+        releaseRequest(a_pRequest);
+        return -1;
+    }
+
+    qint64 bytes = (qint64)a_pRequest->bytes;
+    m_bytesToWrite += bytes;
+    m_queue.push_back(a_pRequest);
+    lock.unlock();
+    m_requestQueued.notify_one();
+    return bytes;
+}
+
+// END OF qint64 vsedit::EncoderPipeWriter::enqueue(WriteRequest * a_pRequest)
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::writerLoop()
+{
+#ifdef Q_OS_LINUX
+    // A write to the pipe after the encoder has exited must fail
+    // with EPIPE instead of killing the whole application.
+    sigset_t sigpipeSet;
+    sigemptyset(&sigpipeSet);
+    sigaddset(&sigpipeSet, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipeSet, nullptr);
+
+    for (;;) {
+        WriteRequest *pRequest = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto ready = [this]() {
+                return m_aborting || m_closing || !m_queue.empty();
+            };
+
+            if (m_pinned.empty()) {
+                m_requestQueued.wait(lock, ready);
+            } else {
+                m_requestQueued.wait_for(lock,
+                                         std::chrono::milliseconds(PINNED_FRAMES_POLL_MS), ready);
+            }
+
+            if (m_aborting) {
+                break;
+            }
+
+            if (m_queue.empty()) {
+                if (m_closing) {
+                    break;
+                }
+
+                lock.unlock();
+                releaseConsumed(false);
+                continue;
+            }
+
+            pRequest = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        bool written = writeRequest(pRequest);
+
+        if (written && pRequest->spliced) {
+            m_pinned.push_back(pRequest);
+        } else {
+            releaseRequest(pRequest);
+        }
+
+        if (!written) {
+            break;
+        }
+
+        releaseConsumed(false);
+    }
+
+    if (!m_aborting) {
+        waitDrained();
+    }
+
+    releaseConsumed(true);
+    releaseQueued();
+
+    // Closing the write end signals the end of stream to the encoder.
+    ::close(m_pipeWriteFd);
+    m_pipeWriteFd = -1;
+#endif
+
+    m_running = false;
+    emit signalFinished();
+}
+
+// END OF void vsedit::EncoderPipeWriter::writerLoop()
+//==============================================================================
+
+bool vsedit::EncoderPipeWriter::writeRequest(WriteRequest *a_pRequest)
+{
+#ifdef Q_OS_LINUX
+    std::vector<iovec> iov;
+    size_t chunk = 0;
+    size_t chunkOffset = 0;
+
+    while (chunk < a_pRequest->chunks.size()) {
+        if (m_aborting) {
+            return false;
+        }
+
+        iov.clear();
+
+        for (size_t i = chunk; (i < a_pRequest->chunks.size()) &&
+                (iov.size() < IOV_MAX); ++i) {
+            const WriteChunk &c = a_pRequest->chunks[i];
+            size_t skip = (i == chunk) ? chunkOffset : 0;
+            iov.push_back({(void *)((const char *)c.cpData + skip),
+                           c.size - skip});
+        }
+
+        ssize_t result;
+
+        if (m_useSplice) {
+            result = vmsplice(m_pipeWriteFd, iov.data(), iov.size(),
+                              SPLICE_F_NONBLOCK);
+        } else {
+            result = writev(m_pipeWriteFd, iov.data(), (int)iov.size());
+        }
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EAGAIN) {
+                if (!waitWritable()) {
+                    return false;
+                }
+
+                continue;
+            }
+
+            if (m_useSplice && ((errno == EINVAL) || (errno == ENOSYS))) {
+                m_useSplice = false;
+                continue;
+            }
+
+            setError(tr("Error on writing data to encoder: %1")
+                     .arg(QString::fromLocal8Bit(strerror(errno))));
+            return false;
+        }
+
+        if (m_useSplice) {
+            a_pRequest->spliced = true;
+        }
+
+        size_t advance = (size_t)result;
+
+        while (advance > 0) {
+            size_t left = a_pRequest->chunks[chunk].size - chunkOffset;
+
+            if (advance < left) {
+                chunkOffset += advance;
+                break;
+            }
+
+            advance -= left;
+            chunk++;
+            chunkOffset = 0;
+        }
+
+        m_streamOffset += (unsigned long long)result;
+        m_bytesToWrite -= (long long)result;
+        emit signalBytesWritten((qint64)result);
+    }
+
+    a_pRequest->streamEnd = m_streamOffset;
+    return true;
+#else
+    (void)a_pRequest;
+    return false;
+#endif
+}
+
+// END OF bool vsedit::EncoderPipeWriter::writeRequest(
+//		WriteRequest * a_pRequest)
+//==============================================================================
+
+bool vsedit::EncoderPipeWriter::waitWritable()
+{
+#ifdef Q_OS_LINUX
+    for (;;) {
+        pollfd fds[2] = {
+            {m_pipeWriteFd, POLLOUT, 0},
+            {m_wakeReadFd, POLLIN, 0},
+        };
+
+        int result = poll(fds, 2, -1);
+
+        if ((result < 0) && (errno != EINTR)) {
+            setError(tr("Error waiting for encoder: %1")
+                     .arg(QString::fromLocal8Bit(strerror(errno))));
+            return false;
+        }
+
+        if (m_aborting) {
+            return false;
+        }
+
+        if (fds[0].revents & POLLERR) {
+            setError(tr("Encoder has closed its input."));
+            return false;
+        }
+
+        if (fds[0].revents & POLLOUT) {
+            return true;
+        }
+    }
+#else
+    return false;
+#endif
+}
+
+// END OF bool vsedit::EncoderPipeWriter::waitWritable()
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::releaseConsumed(bool a_all)
+{
+#ifdef Q_OS_LINUX
+    if (m_pinned.empty()) {
+        return;
+    }
+
+    // Spliced pages are shared with the pipe, so a frame may only be
+    // released once the encoder has read past its end.
+    unsigned long long consumed = m_streamOffset;
+
+    if (!a_all) {
+        int unread = 0;
+
+        if (ioctl(m_pipeWriteFd, FIONREAD, &unread) != 0) {
+            return;
+        }
+
+        consumed -= (unsigned long long)unread;
+    }
+
+    while (!m_pinned.empty() && (a_all ||
+                                 (m_pinned.front()->streamEnd <= consumed))) {
+        releaseRequest(m_pinned.front());
+        m_pinned.pop_front();
+    }
+#else
+    (void)a_all;
+#endif
+}
+
+// END OF void vsedit::EncoderPipeWriter::releaseConsumed(bool a_all)
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::releaseRequest(WriteRequest *a_pRequest)
+{
+    if (a_pRequest->cpFrameRef) {
+        m_cpVSAPI->freeFrame(a_pRequest->cpFrameRef);
+    }
+
+    delete a_pRequest;
+}
+
+// END OF void vsedit::EncoderPipeWriter::releaseRequest(
+//		WriteRequest * a_pRequest)
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::releaseQueued()
+{
+    std::deque<WriteRequest *> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        dropped.swap(m_queue);
+    }
+
+    for (WriteRequest *pRequest : dropped) {
+        m_bytesToWrite -= (long long)pRequest->bytes;
+        releaseRequest(pRequest);
+    }
+}
+
+// END OF void vsedit::EncoderPipeWriter::releaseQueued()
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::waitDrained()
+{
+#ifdef Q_OS_LINUX
+    while (!m_pinned.empty() && !m_aborting) {
+        releaseConsumed(false);
+
+        if (m_pinned.empty()) {
+            break;
+        }
+
+        // No events requested: only errors are reported,
+        // which means the encoder has closed its end.
+        pollfd fds[2] = {
+            {m_pipeWriteFd, 0, 0},
+            {m_wakeReadFd, POLLIN, 0},
+        };
+
+        int result = poll(fds, 2, PINNED_FRAMES_POLL_MS);
+
+        if ((result > 0) && (fds[0].revents & POLLERR)) {
+            break;
+        }
+    }
+#endif
+}
+
+// END OF void vsedit::EncoderPipeWriter::waitDrained()
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::stopThread()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    abort();
+    waitForFinished();
+}
+
+// END OF void vsedit::EncoderPipeWriter::stopThread()
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::closeFds()
+{
+#ifdef Q_OS_LINUX
+    int *fds[] = {&m_pipeReadFd, &m_pipeWriteFd, &m_wakeReadFd,
+                  &m_wakeWriteFd
+                 };
+
+    for (int *pFd : fds) {
+        if (*pFd >= 0) {
+            ::close(*pFd);
+            *pFd = -1;
+        }
+    }
+#endif
+}
+
+// END OF void vsedit::EncoderPipeWriter::closeFds()
+//==============================================================================
+
+void vsedit::EncoderPipeWriter::setError(const QString &a_message)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_errorString = a_message;
+        // Nothing more will be written, so refuse new requests.
+        m_aborting = true;
+    }
+
+    emit signalWriteError(a_message);
+}
+
+// END OF void vsedit::EncoderPipeWriter::setError(const QString & a_message)
+//==============================================================================
@@ -0,0 +1,155 @@
+#ifndef ENCODER_PIPE_WRITER_H_INCLUDED
+#define ENCODER_PIPE_WRITER_H_INCLUDED
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <vapoursynth/VapourSynth.h>
+
+class QProcess;
+
+namespace vsedit {
+
+// Feeds the encoder standard input from a pipe owned by a dedicated thread.
+// Frame planes are written straight from VapourSynth frames with
+// vmsplice() or writev() instead of being copied into an intermediate buffer
+// and then into QProcess. Every written frame keeps its reference until the
+// encoder has read it.
+// Only available on Linux; isSupported() returns false elsewhere.
+class EncoderPipeWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    EncoderPipeWriter(const VSAPI *a_cpVSAPI, QObject *a_pParent = nullptr);
+    virtual ~EncoderPipeWriter();
+
+    static bool isSupported();
+
+    // Creates the pipe and redirects the process standard input to it.
+    // Must be called before the process is started.
+    bool attach(QProcess *a_pProcess);
+
+    // Starts the writer thread once the process is running.
+    bool start();
+
+    // Restores the normal standard input channel of the process.
+    void detach();
+
+    bool isAttached() const;
+
+    // Queue data for writing. Return the number of bytes queued or -1.
+    qint64 write(const QByteArray &a_data);
+    qint64 writeFrame(const QByteArray &a_prefix,
+                      const VSFrameRef *a_cpFrameRef, const QByteArray &a_postfix);
+
+    // Bytes queued and not yet accepted by the pipe.
+    qint64 bytesToWrite() const;
+
+    // Writes everything queued, then closes the pipe.
+    void close();
+
+    // Drops everything queued and closes the pipe.
+    void abort();
+
+    // True from start() until the writer thread has stopped. After close()
+    // the thread lasts until the encoder has read what is still
+    // referenced by the pipe.
+    bool isRunning() const;
+
+    // Blocks until the writer thread has stopped after close() or abort().
+    // Returns at once after signalFinished(). No frame is held afterwards.
+    void waitForFinished();
+
+    QString errorString() const;
+
+signals:
+
+    // Emitted from the writer thread.
+    void signalBytesWritten(qint64 a_bytes);
+    void signalWriteError(const QString &a_message);
+    void signalFinished();
+
+private:
+
+    struct WriteChunk {
+        const void *cpData;
+        size_t size;
+    };
+
+    struct WriteRequest {
+        QByteArray prefix;
+        const VSFrameRef *cpFrameRef = nullptr;
+        QByteArray postfix;
+        std::vector<WriteChunk> chunks;
+        size_t bytes = 0;
+        bool spliced = false;
+        // Offset in the stream right after this request.
+        unsigned long long streamEnd = 0;
+    };
+
+    qint64 enqueue(WriteRequest *a_pRequest);
+
+    void writerLoop();
+
+    bool writeRequest(WriteRequest *a_pRequest);
+
+    bool waitWritable();
+
+    void releaseConsumed(bool a_all);
+
+    void releaseRequest(WriteRequest *a_pRequest);
+
+    void releaseQueued();
+
+    void waitDrained();
+
+    void stopThread();
+
+    void closeFds();
+
+    void setError(const QString &a_message);
+
+    const VSAPI *m_cpVSAPI;
+
+    QProcess *m_pProcess;
+    bool m_attached;
+
+    int m_pipeReadFd;
+    int m_pipeWriteFd;
+    // Wakes up the writer thread blocked on a full pipe.
+    int m_wakeReadFd;
+    int m_wakeWriteFd;
+
+    bool m_useSplice;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_requestQueued;
+    std::deque<WriteRequest *> m_queue;
+    bool m_closing;
+    std::atomic<bool> m_aborting;
+    std::atomic<bool> m_running;
+    std::atomic<long long> m_bytesToWrite;
+
+    // Requests already spliced into the pipe that the encoder
+    // may still be reading from. Owned by the writer thread.
+    std::deque<WriteRequest *> m_pinned;
+    unsigned long long m_streamOffset;
+
+    QString m_errorString;
+};
+
+}
+
+#endif // ENCODER_PIPE_WRITER_H_INCLUDED
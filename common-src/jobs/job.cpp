@@ -4,13 +4,20 @@
 #include "common-src/settings/settings_manager_core.h"
 #include "common-src/vapoursynth/vs_script_library.h"
 #include "common-src/vapoursynth/vapoursynth_script_processor.h"
+#include "common-src/vapoursynth/vs_checksum.h"
 #include "../frame_header_writers/frame_header_writer_null.h"
 #include "../frame_header_writers/frame_header_writer_y4m.h"
 #include "common-src/jobs/job_variables.h"
+#include "common-src/jobs/encoder_pipe_writer.h"
+#include "common-src/jobs/encoder_file_writer.h"
 
 #include <QFileInfo>
 #include <QFile>
+#include <QDir>
+#include <QStandardPaths>
 #include <QDebug>
+#include <QTimer>
+#include <QThread>
 #include <algorithm>
 #include <vapoursynth/VSHelper.h>
 
@@ -23,6 +30,121 @@
 #include <signal.h>
 #endif
 
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+//==============================================================================
+
+// Number of packed frames that may be handed to the encoder before the
+// first of them is written to its pipe. Packing the next frame overlaps
+// with writing the previous ones.
+const size_t ENCODER_WRITE_AHEAD_FRAMES = 4;
+
+// A segmented job is split into fewer segments rather than encoding
+// segments shorter than this.
+const int MIN_SEGMENT_FRAMES = 240;
+
+// Frames after a nominal segment start searched for a scene change.
+const int SEGMENT_SCENE_CHANGE_SEARCH_FRAMES = 48;
+
+// Frame property set by scene change detection filters
+// on the first frame of a new scene.
+const char SCENE_CHANGE_FRAME_PROPERTY[] = "_SceneChangePrev";
+
+// Seconds between two reads of the encoder CPU time.
+const double ENCODER_CPU_TIME_INTERVAL = 1.0;
+
+// Parts of a resumable job are numbered with three digits.
+const int MAX_CHECKPOINT_PARTS = 999;
+
+// Times a failed segment is encoded before the whole job fails.
+const int MAX_SEGMENT_ATTEMPTS = 3;
+
+// Memory for frames requested by a job and not yet taken by its encoder,
+// or by all of its outputs. Segments of a job share it.
+const size_t FRAMES_MEMORY_BUDGET = 1024u * 1024u * 1024u;
+
+//==============================================================================
+
+// Returns the user and system CPU time of a running process in seconds,
+// or a negative number where it can not be read.
+static double processCpuTime(qint64 a_processId)
+{
+    if (a_processId <= 0) {
+        return -1.0;
+    }
+
+#if defined(Q_OS_LINUX)
+    QFile statFile(QString("/proc/%1/stat").arg(a_processId));
+
+    if (!statFile.open(QIODevice::ReadOnly)) {
+        return -1.0;
+    }
+
+    // The command name in parentheses may contain spaces.
+    QByteArray stat = statFile.readAll();
+    int nameEnd = stat.lastIndexOf(')');
+
+    if (nameEnd < 0) {
+        return -1.0;
+    }
+
+    // Fields after the name start with the state. User and system
+    // times are the 14th and 15th fields of the whole line.
+    QList<QByteArray> fields = stat.mid(nameEnd + 2).split(' ');
+
+    if (fields.size() < 13) {
+        return -1.0;
+    }
+
+    long ticksPerSecond = sysconf(_SC_CLK_TCK);
+
+    if (ticksPerSecond <= 0) {
+        return -1.0;
+    }
+
+    double ticks = (double)(fields[11].toULongLong() +
+                            fields[12].toULongLong());
+    return ticks / (double)ticksPerSecond;
+#elif defined(Q_OS_WIN)
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE,
+                                  (DWORD)a_processId);
+
+    if (!hProcess) {
+        return -1.0;
+    }
+
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    BOOL result = GetProcessTimes(hProcess, &creationTime, &exitTime,
+                                  &kernelTime, &userTime);
+    CloseHandle(hProcess);
+
+    if (!result) {
+        return -1.0;
+    }
+
+    // FILETIME counts 100 ns intervals.
+    auto toSeconds = [](const FILETIME & a_time) {
+        ULARGE_INTEGER value;
+        value.LowPart = a_time.dwLowDateTime;
+        value.HighPart = a_time.dwHighDateTime;
+        return (double)value.QuadPart / 1e7;
+    };
+
+    return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+    return -1.0;
+#endif
+}
+
+//==============================================================================
+
+static QString segmentNumberString(int a_segmentIndex)
+{
+    return QString("%1").arg(a_segmentIndex + 1, 3, 10, QChar('0'));
+}
+
 //==============================================================================
 
 vsedit::Job::Job(const JobProperties &a_properties,
@@ -32,6 +154,11 @@ vsedit::Job::Job(const JobProperties &a_properties,
     QObject(a_pParent)
     , JobVariables()
     , m_properties(a_properties)
+    , m_firstWriteSlot(0)
+    , m_writeSlotsInFlight(0)
+    , m_encoderWait(EncoderWait::None)
+    , m_packingTime(0.0)
+    , m_runningTimeBefore(0.0)
     , m_lastFrameProcessed(-1)
     , m_lastFrameRequested(-1)
     , m_encodingState(EncodingState::Idle)
@@ -43,10 +170,20 @@ vsedit::Job::Job(const JobProperties &a_properties,
     , m_cpVSAPI(nullptr)
     , m_cpVideoInfo(nullptr)
     , m_pFrameHeaderWriter(nullptr)
-    , m_cachedFramesLimit(100)
+    , m_pEncoderPipeWriter(nullptr)
+    , m_pEncoderFileWriter(nullptr)
+    , m_waitingForEncoderWriters(false)
+    , m_framesMemoryBudget(FRAMES_MEMORY_BUDGET)
+    , m_scriptThreads(0)
     , m_framesInQueue(0)
     , m_framesInProcess(0)
     , m_maxThreads(0)
+    , m_segmentIndex(-1)
+    , m_outputIndex(-1)
+    , m_outputFramesWindow(0)
+    , m_sceneChangeProbesPending(0)
+    , m_sceneChangePropFound(false)
+    , m_sceneChangeWindowsRequested(false)
 {
     fillVariables();
 
@@ -66,6 +203,18 @@ vsedit::Job::Job(const JobProperties &a_properties,
             this, SLOT(slotProcessBytesWritten(qint64)));
     connect(&m_process, SIGNAL(readyReadStandardError()),
             this, SLOT(slotProcessReadyReadStandardError()));
+
+    connect(&m_encoderOutputLog,
+            SIGNAL(signalLogMessage(const QString &, const QString &)),
+            this, SIGNAL(signalLogMessage(const QString &, const QString &)));
+    connect(&m_encoderOutputLog, SIGNAL(signalStatsChanged()),
+            this, SLOT(slotEncoderStatsChanged()));
+
+    m_mergeProcess.setProcessChannelMode(QProcess::MergedChannels);
+    connect(&m_mergeProcess, SIGNAL(finished(int, QProcess::ExitStatus)),
+            this, SLOT(slotMergeProcessFinished(int, QProcess::ExitStatus)));
+    connect(&m_mergeProcess, SIGNAL(error(QProcess::ProcessError)),
+            this, SLOT(slotMergeProcessError(QProcess::ProcessError)));
 }
 
 // END OF vsedit::Job::Job(const JobProperties & a_properties,
@@ -166,12 +315,35 @@ bool vsedit::Job::setScriptText(const QString &a_scriptText)
     }
 
     m_properties.scriptText = a_scriptText;
+    m_properties.scriptHash = JobProperties::hashScript(a_scriptText);
     return true;
 }
 
 // END OF bool vsedit::Job::setScriptName(const QString & a_scriptText)
 //==============================================================================
 
+EncodingType vsedit::Job::encodingType() const
+{
+    return m_properties.encodingType;
+}
+
+// END OF EncodingType vsedit::Job::encodingType() const
+//==============================================================================
+
+bool vsedit::Job::setEncodingType(EncodingType a_encodingType)
+{
+    if ((a_encodingType != EncodingType::CLI) &&
+            (a_encodingType != EncodingType::Raw)) {
+        return false;
+    }
+
+    m_properties.encodingType = a_encodingType;
+    return true;
+}
+
+// END OF bool vsedit::Job::setEncodingType(EncodingType a_encodingType)
+//==============================================================================
+
 EncodingHeaderType vsedit::Job::encodingHeaderType() const
 {
     if (m_properties.encodingHeaderType == EncodingHeaderType::Invalid) {
@@ -299,7 +471,14 @@ QString vsedit::Job::subject() const
 {
     QString subjectString;
 
-    if (m_properties.type == JobType::EncodeScriptCLI) {
+    if ((m_properties.type == JobType::EncodeScriptCLI) &&
+            (m_properties.encodingType == EncodingType::Raw)) {
+        subjectString = QString("%sn%:\n> \"%arg%\"");
+        subjectString = subjectString.replace("%sn%",
+                                              resolvePathFromApplication(m_properties.scriptName));
+        subjectString = subjectString.replace("%arg%",
+                                              decodeArguments(m_properties.arguments));
+    } else if (m_properties.type == JobType::EncodeScriptCLI) {
         subjectString = QString("%sn%:\n\"%ep%\" %arg%");
         subjectString = subjectString.replace("%sn%",
                                               resolvePathFromApplication(m_properties.scriptName));
@@ -317,6 +496,19 @@ QString vsedit::Job::subject() const
         subjectString = m_properties.shellCommand.simplified();
     }
 
+    if (m_properties.type == JobType::EncodeScriptCLI) {
+        for (const JobOutput &output : m_properties.extraOutputs) {
+            if (output.encodingType == EncodingType::Raw) {
+                subjectString += QString("\n+ > \"%1\"")
+                                 .arg(decodeArguments(output.arguments));
+            } else {
+                subjectString += QString("\n+ \"%1\" %2")
+                                 .arg(resolvePathFromApplication(output.executablePath))
+                                 .arg(decodeArguments(output.arguments));
+            }
+        }
+    }
+
     return subjectString;
 }
 
@@ -415,6 +607,266 @@ bool vsedit::Job::setLastFrame(int a_frame)
 // END OF bool vsedit::Job::setFirstFrame(int a_frame)
 //==============================================================================
 
+int vsedit::Job::segments() const
+{
+    return m_properties.segments;
+}
+
+// END OF int vsedit::Job::segments() const
+//==============================================================================
+
+bool vsedit::Job::setSegments(int a_segments)
+{
+    if (isActive()) {
+        return false;
+    }
+
+    if ((a_segments < 1) || (a_segments > MAX_JOB_SEGMENTS)) {
+        return false;
+    }
+
+    m_properties.segments = a_segments;
+    return true;
+}
+
+// END OF bool vsedit::Job::setSegments(int a_segments)
+//==============================================================================
+
+QString vsedit::Job::mergeCommand() const
+{
+    return m_properties.mergeCommand;
+}
+
+// END OF QString vsedit::Job::mergeCommand() const
+//==============================================================================
+
+bool vsedit::Job::setMergeCommand(const QString &a_command)
+{
+    if (isActive()) {
+        return false;
+    }
+
+    m_properties.mergeCommand = a_command;
+    return true;
+}
+
+// END OF bool vsedit::Job::setMergeCommand(const QString & a_command)
+//==============================================================================
+
+QVector<JobOutput> vsedit::Job::extraOutputs() const
+{
+    return m_properties.extraOutputs;
+}
+
+// END OF QVector<JobOutput> vsedit::Job::extraOutputs() const
+//==============================================================================
+
+bool vsedit::Job::setExtraOutputs(const QVector<JobOutput> &a_outputs)
+{
+    if (isActive()) {
+        return false;
+    }
+
+    m_properties.extraOutputs = a_outputs;
+    return true;
+}
+
+// END OF bool vsedit::Job::setExtraOutputs(
+//		const QVector<JobOutput> & a_outputs)
+//==============================================================================
+
+int vsedit::Job::checkpointFrames() const
+{
+    return m_properties.checkpointFrames;
+}
+
+// END OF int vsedit::Job::checkpointFrames() const
+//==============================================================================
+
+bool vsedit::Job::setCheckpointFrames(int a_frames)
+{
+    if (isActive()) {
+        return false;
+    }
+
+    if (a_frames < 0) {
+        return false;
+    }
+
+    m_properties.checkpointFrames = a_frames;
+    return true;
+}
+
+// END OF bool vsedit::Job::setCheckpointFrames(int a_frames)
+//==============================================================================
+
+int vsedit::Job::threads() const
+{
+    return m_properties.threads;
+}
+
+// END OF int vsedit::Job::threads() const
+//==============================================================================
+
+bool vsedit::Job::setThreads(int a_threads)
+{
+    if (a_threads < 0) {
+        return false;
+    }
+
+    m_properties.threads = a_threads;
+    return true;
+}
+
+// END OF bool vsedit::Job::setThreads(int a_threads)
+//==============================================================================
+
+JobPriority vsedit::Job::priority() const
+{
+    return m_properties.priority;
+}
+
+// END OF JobPriority vsedit::Job::priority() const
+//==============================================================================
+
+bool vsedit::Job::setPriority(JobPriority a_priority)
+{
+    m_properties.priority = a_priority;
+    return true;
+}
+
+// END OF bool vsedit::Job::setPriority(JobPriority a_priority)
+//==============================================================================
+
+size_t vsedit::Job::framesMemoryBudget() const
+{
+    return m_framesMemoryBudget;
+}
+
+// END OF size_t vsedit::Job::framesMemoryBudget() const
+//==============================================================================
+
+bool vsedit::Job::setFramesMemoryBudget(size_t a_bytes)
+{
+    if (isActive()) {
+        return false;
+    }
+
+    m_framesMemoryBudget = (a_bytes > 0) ? a_bytes : FRAMES_MEMORY_BUDGET;
+    return true;
+}
+
+// END OF bool vsedit::Job::setFramesMemoryBudget(size_t a_bytes)
+//==============================================================================
+
+int vsedit::Job::scriptThreads() const
+{
+    return m_scriptThreads;
+}
+
+// END OF int vsedit::Job::scriptThreads() const
+//==============================================================================
+
+bool vsedit::Job::setScriptThreads(int a_threads)
+{
+    if (a_threads < 0) {
+        return false;
+    }
+
+    m_scriptThreads = a_threads;
+
+    if (m_pVapourSynthScriptProcessor && (!sharesScriptProcessor()) &&
+            m_pVapourSynthScriptProcessor->isInitialized()) {
+        m_pVapourSynthScriptProcessor->setThreadCount(m_scriptThreads);
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::Job::setScriptThreads(int a_threads)
+//==============================================================================
+
+bool vsedit::Job::hasCheckpoint() const
+{
+    if (m_properties.type != JobType::EncodeScriptCLI) {
+        return false;
+    }
+
+    if ((m_properties.segments <= 1) && (m_properties.checkpointFrames <= 0)) {
+        return false;
+    }
+
+    for (const JobSegmentProgress &segment : m_properties.segmentsProgress) {
+        if (segment.isComplete()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// END OF bool vsedit::Job::hasCheckpoint() const
+//==============================================================================
+
+void vsedit::Job::prepareResume()
+{
+    if (isActive() && (m_encodingState != EncodingState::Idle)) {
+        return;
+    }
+
+    // Not through changeStateAndNotify(), which forgets the progress.
+    JobState oldState = m_properties.jobState;
+    m_properties.jobState = JobState::Waiting;
+    m_properties.timeEnded = QDateTime();
+    m_properties.fps = 0.0;
+
+    // Output of an interrupted encoder can not be trusted,
+    // so unfinished parts are encoded anew.
+    for (JobSegmentProgress &segment : m_properties.segmentsProgress) {
+        if (!segment.isComplete()) {
+            segment.framesProcessed = 0;
+            segment.attempts = 0;
+        }
+    }
+
+    if (oldState != m_properties.jobState) {
+        emit signalStateChanged(m_properties.jobState, oldState);
+    }
+}
+
+// END OF void vsedit::Job::prepareResume()
+//==============================================================================
+
+bool vsedit::Job::attachAsSegment(
+    VapourSynthScriptProcessor *a_pScriptProcessor, int a_segmentIndex)
+{
+    if (!attachToScriptProcessor(a_pScriptProcessor)) {
+        return false;
+    }
+
+    m_segmentIndex = a_segmentIndex;
+    return true;
+}
+
+// END OF bool vsedit::Job::attachAsSegment(
+//		VapourSynthScriptProcessor * a_pScriptProcessor, int a_segmentIndex)
+//==============================================================================
+
+bool vsedit::Job::attachAsOutput(
+    VapourSynthScriptProcessor *a_pScriptProcessor, int a_outputIndex)
+{
+    if (!attachToScriptProcessor(a_pScriptProcessor)) {
+        return false;
+    }
+
+    m_outputIndex = a_outputIndex;
+    return true;
+}
+
+// END OF bool vsedit::Job::attachAsOutput(
+//		VapourSynthScriptProcessor * a_pScriptProcessor, int a_outputIndex)
+//==============================================================================
+
 int vsedit::Job::framesProcessed() const
 {
     if (m_properties.type == JobType::EncodeScriptCLI) {
@@ -543,7 +995,10 @@ bool vsedit::Job::initialize()
             return false;
         }
 
+        // Set directly, as setScriptText() refuses an active job.
         m_properties.scriptText = QString::fromUtf8(scriptFile.readAll());
+        m_properties.scriptHash =
+            JobProperties::hashScript(m_properties.scriptText);
         scriptFile.close();
     }
 
@@ -581,6 +1036,14 @@ bool vsedit::Job::initialize()
                 this, SLOT(slotFrameQueueStateChanged(size_t, size_t, size_t)));
     }
 
+    if (sharesScriptProcessor() &&
+            (!m_pVapourSynthScriptProcessor->isInitialized())) {
+        emit signalLogMessage(tr("Script of the segmented job is not "
+                                 "running."), LOG_STYLE_ERROR);
+        changeStateAndNotify(JobState::Failed);
+        return false;
+    }
+
     if ((!m_pVapourSynthScriptProcessor->isInitialized()) ||
             (m_pVapourSynthScriptProcessor->scriptName() !=
              m_properties.scriptName) || (m_pVapourSynthScriptProcessor->script() !=
@@ -597,10 +1060,41 @@ bool vsedit::Job::initialize()
         }
     }
 
+    // Jobs sharing the processor get the packing and the checksums
+    // of the job owning it.
+    if ((!sharesScriptProcessor()) &&
+            ((!m_pVapourSynthScriptProcessor->setOutputPacking(
+                  m_properties.encodingPacking)) ||
+             (!m_pVapourSynthScriptProcessor->setOutputChecksums(
+                  !m_properties.checksumFile.isEmpty())))) {
+        changeStateAndNotify(JobState::Failed);
+        return false;
+    }
+
+    if (!sharesScriptProcessor()) {
+        m_pVapourSynthScriptProcessor->setThreadCount(m_scriptThreads);
+    }
+
+    // Fails if the script output does not fit the packing.
     m_cpVideoInfo = m_pVapourSynthScriptProcessor->videoInfo();
-    Q_ASSERT(m_cpVideoInfo);
 
-    m_properties.framesProcessed = 0;
+    if (!m_cpVideoInfo) {
+        emit signalLogMessage(tr("Failed to prepare the script output."),
+                              LOG_STYLE_ERROR);
+        changeStateAndNotify(JobState::Failed);
+        return false;
+    }
+
+    m_properties.framesProcessed = 0;
+    m_properties.scriptWaitTime = 0.0;
+    m_properties.pipeStallTime = 0.0;
+    m_properties.packingTime = 0.0;
+    m_properties.encoderCpuTime = -1.0;
+    m_properties.runningTime = 0.0;
+    m_packingTime = 0.0;
+    m_runningTimeBefore = 0.0;
+    m_runningSince = hr_clock::now();
+    m_lastCpuTimeSample = hr_time_point();
     m_fpsBuffer.reset();
     m_properties.firstFrameReal = m_properties.firstFrame;
     vsedit::clamp(m_properties.firstFrameReal, 0, m_cpVideoInfo->numFrames - 1);
@@ -613,10 +1107,27 @@ bool vsedit::Job::initialize()
 
     m_lastFrameRequested = m_properties.firstFrameReal - 1;
     m_lastFrameProcessed = m_lastFrameRequested;
+    clearFramesCache();
+
+    // Start with enough frames to keep every script thread busy
+    // and let the window adapt to the encoder from there.
+    size_t initialWindow = (size_t)std::max(QThread::idealThreadCount(), 1);
+    initialWindow = std::max(initialWindow, m_maxThreads) +
+                    ENCODER_WRITE_AHEAD_FRAMES;
+    m_requestWindow.reset(ENCODER_WRITE_AHEAD_FRAMES + 2, initialWindow,
+                          frameBytes(), m_framesMemoryBudget);
+    m_properties.requestWindow = (int)m_requestWindow.frames();
+    m_properties.requestWindowLimit = (int)m_requestWindow.limit();
+    m_framesCache.reset(m_properties.firstFrameReal, m_requestWindow.limit());
     m_encodingState = EncodingState::Idle;
     m_bytesToWrite = 0u;
     m_bytesWritten = 0u;
 
+    m_writeSlots.resize(ENCODER_WRITE_AHEAD_FRAMES);
+    m_firstWriteSlot = 0;
+    m_writeSlotsInFlight = 0;
+    m_encoderWait = EncoderWait::None;
+
     return true;
 }
 
@@ -625,24 +1136,107 @@ bool vsedit::Job::initialize()
 
 void vsedit::Job::cleanUpEncoding()
 {
+    if (!m_subJobs.empty()) {
+        stopSubJobs();
+    }
+
     if (m_process.state() == QProcess::Running) {
         if (m_encodingState != EncodingState::Aborting) {
             m_encodingState = EncodingState::Finishing;
         }
 
-        m_process.closeWriteChannel();
+        if (encoderPipeAttached()) {
+            if (m_encodingState == EncodingState::Aborting) {
+                m_pEncoderPipeWriter->abort();
+            } else {
+                m_pEncoderPipeWriter->close();
+            }
+        } else {
+            m_process.closeWriteChannel();
+        }
+    }
+
+    if (fileOutputOpen()) {
+        if (m_encodingState == EncodingState::Aborting) {
+            m_pEncoderFileWriter->abort();
+        } else {
+            m_pEncoderFileWriter->close();
+        }
+    }
+
+    if (m_pEncoderPipeWriter && m_pEncoderPipeWriter->isAttached()) {
+        m_pEncoderPipeWriter->abort();
+    }
+
+    // The pipe writer keeps its frames until the encoder has read them
+    // and the file writer flushes its last block, either of which
+    // may take a while.
+    if (encoderWritersRunning()) {
+        m_waitingForEncoderWriters = true;
+        return;
+    }
+
+    finishCleanUpEncoding();
+}
+
+// END OF void vsedit::Job::cleanUpEncoding()
+//==============================================================================
+
+void vsedit::Job::finishCleanUpEncoding()
+{
+    m_waitingForEncoderWriters = false;
+
+    if (fileOutputOpen()) {
+        // The thread has stopped. This releases queued frames.
+        m_pEncoderFileWriter->waitForFinished();
+
+        QString error = m_pEncoderFileWriter->errorString();
+
+        if ((m_encodingState != EncodingState::Aborting) &&
+                !error.isEmpty()) {
+            emit signalLogMessage(error, LOG_STYLE_ERROR);
+            m_encodingState = EncodingState::Aborting;
+            changeStateAndNotify(JobState::FailedCleanUp);
+        }
+    }
+
+    // Frames still referenced by the writer must be released
+    // before the script processor is finalized.
+    if (m_pEncoderPipeWriter) {
+        m_pEncoderPipeWriter->waitForFinished();
     }
 
-    if (m_pVapourSynthScriptProcessor) {
+    if (m_pVapourSynthScriptProcessor && !sharesScriptProcessor()) {
         m_pVapourSynthScriptProcessor->finalize();
     }
 
+    closeChecksumFile();
+    setEncoderWait(EncoderWait::None);
     clearFramesCache();
+    m_writeSlots.clear();
     m_framebuffer.clear();
+    m_framebuffer.shrink_to_fit();
+    m_firstWriteSlot = 0;
+    m_writeSlotsInFlight = 0;
     m_cpVideoInfo = nullptr;
+
+    // The shared script processor is not finalized here,
+    // so nothing else would finish the job.
+    if (sharesScriptProcessor()) {
+        finishEncodingCLI();
+    }
 }
 
-// END OF void vsedit::Job::cleanUpEncoding()
+// END OF void vsedit::Job::finishCleanUpEncoding()
+//==============================================================================
+
+bool vsedit::Job::encoderWritersRunning() const
+{
+    return ((m_pEncoderPipeWriter && m_pEncoderPipeWriter->isRunning()) ||
+            (m_pEncoderFileWriter && m_pEncoderFileWriter->isRunning()));
+}
+
+// END OF bool vsedit::Job::encoderWritersRunning() const
 //==============================================================================
 
 void vsedit::Job::start()
@@ -650,7 +1244,20 @@ void vsedit::Job::start()
     if (m_properties.jobState == JobState::Paused) {
         changeStateAndNotify(JobState::Running);
 
-        if (m_properties.type == JobType::EncodeScriptCLI) {
+        if ((m_properties.type == JobType::EncodeScriptCLI) &&
+                (m_encodingState == EncodingState::RunningSubJobs)) {
+            for (Job *pSubJob : m_subJobs) {
+                JobState subJobState = pSubJob->state();
+
+                if ((subJobState == JobState::Paused) ||
+                        (subJobState == JobState::Pausing)) {
+                    pSubJob->start();
+                }
+            }
+
+            requestOutputFrames();
+        } else if (m_properties.type == JobType::EncodeScriptCLI) {
+            m_requestWindow.restartPeriod();
             processFramesQueue();
         } else if (m_properties.type == JobType::RunProcess) {
 #ifdef Q_OS_WIN
@@ -676,6 +1283,15 @@ void vsedit::Job::start()
         return;
     }
 
+    // Resumed before the queued frames have settled.
+    if ((m_properties.jobState == JobState::Pausing) &&
+            (m_properties.type == JobType::EncodeScriptCLI)) {
+        changeStateAndNotify(JobState::Running);
+        m_requestWindow.restartPeriod();
+        processFramesQueue();
+        return;
+    }
+
     if (isActive()) {
         return;
     }
@@ -705,13 +1321,22 @@ void vsedit::Job::pause()
     if (m_properties.type == JobType::EncodeScriptCLI) {
         EncodingState invalidEncodingStates[] = {EncodingState::Idle,
                                                  EncodingState::EncoderCrashed, EncodingState::Finishing,
-                                                 EncodingState::Aborting
+                                                 EncodingState::Aborting, EncodingState::ProbingSceneChanges
                                                 };
 
         if (vsedit::contains(invalidEncodingStates, m_encodingState)) {
             return;
         }
 
+        if (m_encodingState == EncodingState::RunningSubJobs) {
+            for (Job *pSubJob : m_subJobs) {
+                pSubJob->pause();
+            }
+
+            changeStateAndNotify(JobState::Paused);
+            return;
+        }
+
         changeStateAndNotify(JobState::Pausing);
     } else if (m_properties.type == JobType::RunProcess) {
 #ifdef Q_OS_WIN
@@ -773,7 +1398,9 @@ void vsedit::Job::slotProcessStarted()
     if (m_properties.type == JobType::EncodeScriptCLI) {
         emit signalLogMessage(tr("Encoder started. Beginning encoding."));
 
-        if (!m_process.isWritable()) {
+        if (encoderPipeAttached()) {
+            m_pEncoderPipeWriter->start();
+        } else if (!m_process.isWritable()) {
             m_encodingState = EncodingState::Aborting;
             m_properties.jobState = JobState::Aborting;
             emit signalLogMessage(tr("Can not write to encoder. Aborting."),
@@ -782,41 +1409,7 @@ void vsedit::Job::slotProcessStarted()
             return;
         }
 
-        Q_ASSERT(m_pFrameHeaderWriter);
-
-        if (m_pFrameHeaderWriter->needVideoHeader()) {
-            QByteArray videoHeader =
-                m_pFrameHeaderWriter->videoHeader(framesTotal());
-
-            if (m_properties.encodingHeaderType == EncodingHeaderType::Y4M)
-                emit signalLogMessage(tr("Y4M header: ") +
-                                      QString::fromLatin1(videoHeader), LOG_STYLE_DEBUG);
-
-            m_bytesToWrite = videoHeader.size();
-
-            if (m_bytesToWrite > 0) {
-                m_bytesWritten = 0;
-                m_encodingState = EncodingState::WritingHeader;
-                qint64 bytesWritten = m_process.write(videoHeader);
-
-                if (bytesWritten < 0) {
-                    m_encodingState = EncodingState::Aborting;
-                    changeStateAndNotify(JobState::FailedCleanUp);
-                    emit signalLogMessage(
-                        tr("Error on writing header to encoder. Aborting."),
-                        LOG_STYLE_ERROR);
-                    cleanUpEncoding();
-                    return;
-                }
-
-                return;
-            }
-        }
-
-        m_fpsBuffer.reset();
-
-        m_encodingState = EncodingState::WaitingForFrames;
-        processFramesQueue();
+        startWritingStream();
     }
 }
 
@@ -826,6 +1419,11 @@ void vsedit::Job::slotProcessStarted()
 void vsedit::Job::slotProcessFinished(int a_exitCode,
                                       QProcess::ExitStatus a_exitStatus)
 {
+    // The sanity check shares the capture with the encoder run after it.
+    if (m_encodingState != EncodingState::CheckingEncoderSanity) {
+        finishEncoderOutputLog();
+    }
+
     if (m_properties.type == JobType::EncodeScriptCLI) {
         EncodingState workingStates[] = {EncodingState::WaitingForFrames,
                                          EncodingState::WritingFrame, EncodingState::WritingHeader
@@ -1029,7 +1627,10 @@ void vsedit::Job::slotProcessBytesWritten(qint64 a_bytes)
 
     m_bytesWritten += a_bytes;
 
-    if ((m_bytesWritten + m_process.bytesToWrite()) < m_bytesToWrite) {
+    // The pipe and file writers report written bytes from their own
+    // threads, so their queues can not be compared against our counters.
+    if (!encoderPipeAttached() && !fileOutputOpen() &&
+            ((m_bytesWritten + m_process.bytesToWrite()) < m_bytesToWrite)) {
         emit signalLogMessage(tr("Encoder has lost written "
                                  "data. Aborting."), LOG_STYLE_ERROR);
         m_encodingState = EncodingState::Aborting;
@@ -1038,33 +1639,63 @@ void vsedit::Job::slotProcessBytesWritten(qint64 a_bytes)
         return;
     }
 
-    if (m_bytesWritten < m_bytesToWrite) {
-        return;
-    }
-
-    Q_ASSERT(m_cpVSAPI);
-
     if (m_encodingState == EncodingState::WritingHeader) {
+        if (m_bytesWritten < m_bytesToWrite) {
+            return;
+        }
+
+        m_bytesToWrite = 0;
+        m_bytesWritten = 0;
         m_fpsBuffer.reset();
     } else if (m_encodingState == EncodingState::WritingFrame) {
-        Frame referenceFrame(m_lastFrameProcessed + 1, 0, nullptr);
-        QList<Frame>::iterator it =
-            std::find(m_framesCache.begin(), m_framesCache.end(),
-                      referenceFrame);
-        Q_ASSERT(it != m_framesCache.end());
-
-        m_cpVSAPI->freeFrame(it->cpOutputFrameRef);
-        m_framesCache.erase(it);
-        m_lastFrameProcessed++;
-        m_properties.framesProcessed++;
-        updateFPS();
+        // Several frames may be queued. Retire every frame
+        // written to the pipe completely.
+        size_t framesRetired = 0;
+
+        while (m_writeSlotsInFlight > 0) {
+            size_t &slotBytes = m_writeSlots[m_firstWriteSlot];
+
+            if (m_bytesWritten < slotBytes) {
+                break;
+            }
+
+            m_bytesWritten -= slotBytes;
+            m_bytesToWrite -= slotBytes;
+            slotBytes = 0;
+            m_firstWriteSlot = (m_firstWriteSlot + 1) % m_writeSlots.size();
+            m_writeSlotsInFlight--;
+
+            m_lastFrameProcessed++;
+            m_properties.framesProcessed++;
+            framesRetired++;
+        }
+
+        if (framesRetired == 0) {
+            return;
+        }
 
+        m_requestWindow.framesConsumed(framesRetired, m_framesCache.size(),
+                                       m_properties.scriptWaitTime);
+        m_properties.requestWindow = (int)m_requestWindow.frames();
+
+        if (m_encoderWait == EncoderWait::Pipe) {
+            setEncoderWait(EncoderWait::None);
+        }
+
+        updateStageTimes();
+        updateFPS();
         emit signalProgressChanged();
+
+        if (m_writeSlotsInFlight > 0) {
+            processFramesQueue();
+            return;
+        }
     }
 
     m_encodingState = EncodingState::WaitingForFrames;
 
     if ((m_properties.jobState == JobState::Pausing) && (m_framesInProcess == 0)) {
+        setEncoderWait(EncoderWait::None);
         changeStateAndNotify(JobState::Paused);
         return;
     }
@@ -1077,18 +1708,21 @@ void vsedit::Job::slotProcessBytesWritten(qint64 a_bytes)
 
 void vsedit::Job::slotProcessReadyReadStandardError()
 {
-    QByteArray standardError = m_process.readAllStandardError();
-    QString standardErrorText = QString::fromUtf8(standardError);
-    standardErrorText = standardErrorText.trimmed();
-
-    if (!standardErrorText.isEmpty()) {
-        emit signalLogMessage(standardErrorText);
-    }
+    m_encoderOutputLog.append(m_process.readAllStandardError());
 }
 
 // END OF void vsedit::Job::slotProcessReadyReadStandardError()
 //==============================================================================
 
+void vsedit::Job::slotEncoderStatsChanged()
+{
+    m_properties.encoderFps = m_encoderOutputLog.fps();
+    m_properties.encoderBitrate = m_encoderOutputLog.bitrate();
+}
+
+// END OF void vsedit::Job::slotEncoderStatsChanged()
+//==============================================================================
+
 void vsedit::Job::slotWriteLogMessage(int a_messageType,
                                       const QString &a_message)
 {
@@ -1127,6 +1761,11 @@ void vsedit::Job::slotReceiveFrame(int a_frameNumber, int a_outputIndex,
 {
     (void)a_cpPreviewFrameRef;
 
+    if (m_encodingState == EncodingState::ProbingSceneChanges) {
+        receiveSceneChangeProbe(a_frameNumber, a_cpOutputFrameRef);
+        return;
+    }
+
     EncodingState validStates[] = {EncodingState::WaitingForFrames,
                                    EncodingState::WritingHeader, EncodingState::WritingFrame
                                   };
@@ -1144,9 +1783,16 @@ void vsedit::Job::slotReceiveFrame(int a_frameNumber, int a_outputIndex,
     const VSFrameRef *cpFrameRef =
         m_cpVSAPI->cloneFrameRef(a_cpOutputFrameRef);
     Frame newFrame(a_frameNumber, a_outputIndex, cpFrameRef);
-    m_framesCache.push_back(newFrame);
 
-    if (m_encodingState == EncodingState::WaitingForFrames) {
+    if (!m_framesCache.insert(newFrame)) {
+        m_cpVSAPI->freeFrame(cpFrameRef);
+        return;
+    }
+
+    m_requestWindow.frameProduced();
+
+    if ((m_encodingState == EncodingState::WaitingForFrames) ||
+            (m_encodingState == EncodingState::WritingFrame)) {
         processFramesQueue();
     }
 }
@@ -1159,10 +1805,14 @@ void vsedit::Job::slotReceiveFrame(int a_frameNumber, int a_outputIndex,
 void vsedit::Job::slotFrameRequestDiscarded(int a_frameNumber,
         int a_outputIndex, const QString &a_reason)
 {
-    (void)a_frameNumber;
     (void)a_outputIndex;
     (void)a_reason;
 
+    if (m_encodingState == EncodingState::ProbingSceneChanges) {
+        receiveSceneChangeProbe(a_frameNumber, nullptr);
+        return;
+    }
+
     EncodingState validStates[] = {EncodingState::WaitingForFrames,
                                    EncodingState::WritingHeader, EncodingState::WritingFrame
                                   };
@@ -1171,6 +1821,13 @@ void vsedit::Job::slotFrameRequestDiscarded(int a_frameNumber,
         return;
     }
 
+    // Segments of one job share the script, so they see the frames
+    // discarded for each other.
+    if ((a_frameNumber < m_properties.firstFrameReal) ||
+            (a_frameNumber > m_properties.lastFrameReal)) {
+        return;
+    }
+
     m_encodingState = EncodingState::Aborting;
     changeStateAndNotify(JobState::FailedCleanUp);
     cleanUpEncoding();
@@ -1180,126 +1837,404 @@ void vsedit::Job::slotFrameRequestDiscarded(int a_frameNumber,
 //		int a_outputIndex, const QString & a_reason)
 //==============================================================================
 
-void vsedit::Job::fillVariables()
+void vsedit::Job::slotEncoderWriteError(const QString &a_message)
 {
-    JobVariables::fillVariables();
+    if ((m_encodingState != EncodingState::WritingFrame) &&
+            (m_encodingState != EncodingState::WritingHeader)) {
+        emit signalLogMessage(a_message, LOG_STYLE_WARNING);
+        return;
+    }
 
-    struct JobVariableEvaluator {
-        QString token;
-        std::function<QString()> evaluate;
-    };
+    emit signalLogMessage(tr("%1\nAborting.").arg(a_message),
+                          LOG_STYLE_ERROR);
+    m_encodingState = EncodingState::Aborting;
+    changeStateAndNotify(JobState::FailedCleanUp);
+    cleanUpEncoding();
+}
 
-    JobVariableEvaluator evaluators[] = {
-        {
-            TOKEN_WIDTH,
-            [&]() -> QString
-            {
-                if (!m_cpVideoInfo)
-                {
-                    return TOKEN_WIDTH;
-                }
+// END OF void vsedit::Job::slotEncoderWriteError(
+//		const QString & a_message)
+//==============================================================================
 
-                return QString::number(m_cpVideoInfo->width);
-            }
-        },
+void vsedit::Job::slotEncoderWriterFinished()
+{
+    if (m_waitingForEncoderWriters && (!encoderWritersRunning())) {
+        finishCleanUpEncoding();
+    }
+}
 
-        {
-            TOKEN_HEIGHT,
-            [&]() -> QString
-            {
-                if (!m_cpVideoInfo)
-                {
-                    return TOKEN_HEIGHT;
-                }
+// END OF void vsedit::Job::slotEncoderWriterFinished()
+//==============================================================================
 
-                return QString::number(m_cpVideoInfo->height);
-            }
-        },
+void vsedit::Job::slotSubJobStateChanged(JobState a_newState,
+        JobState a_oldState)
+{
+    (void)a_oldState;
 
-        {
-            TOKEN_FPS_NUMERATOR,
-            [&]() -> QString
-            {
-                if (!m_cpVideoInfo)
-                {
-                    return TOKEN_FPS_NUMERATOR;
-                }
+    int index = subJobIndexOf(sender());
 
-                return QString::number(m_cpVideoInfo->fpsNum);
-            }
-        },
+    if ((index < 0) ||
+            (m_encodingState != EncodingState::RunningSubJobs)) {
+        return;
+    }
 
-        {
-            TOKEN_FPS_DENOMINATOR,
-            [&]() -> QString
-            {
-                if (!m_cpVideoInfo)
-                {
-                    return TOKEN_FPS_DENOMINATOR;
-                }
+    Job *pSubJob = m_subJobs[index];
 
-                return QString::number(m_cpVideoInfo->fpsDen);
-            }
-        },
+    // A failed attempt of a segment is compared again on retry.
+    if (a_newState == JobState::Completed) {
+        m_checksumResults.add(pSubJob->m_checksumResults);
+    }
 
-        {
-            TOKEN_FPS,
-            [&]() -> QString
-            {
-                if (!m_cpVideoInfo)
-                {
-                    return TOKEN_FPS;
-                }
+    if (a_newState == JobState::Paused) {
+        // Paused while the job was already resumed.
+        if (m_properties.jobState == JobState::Running) {
+            QTimer::singleShot(0, pSubJob, SLOT(start()));
+        }
 
-                double fps = (double)m_cpVideoInfo->fpsNum /
-                (double)m_cpVideoInfo->fpsDen;
-                return QString::number(fps, 'f', 10);
-            }
-        },
+        return;
+    }
 
-        {
-            TOKEN_BITDEPTH,
-            [&]() -> QString
-            {
-                if (!m_cpVideoInfo)
-                {
-                    return TOKEN_BITDEPTH;
-                }
+    if (!m_properties.extraOutputs.isEmpty()) {
+        if (a_newState == JobState::Completed) {
+            emit signalLogMessage(tr("Output %1 is complete.")
+                                  .arg(index + 1), LOG_STYLE_POSITIVE);
+        } else if (a_newState == JobState::Failed) {
+            emit signalLogMessage(tr("Output %1 has failed.")
+                                  .arg(index + 1), LOG_STYLE_ERROR);
+        } else {
+            return;
+        }
 
-                return QString::number(m_cpVideoInfo->format->bitsPerSample);
-            }
-        },
+        // The output job may still be unwinding inside a signal
+        // of the shared script processor.
+        QTimer::singleShot(0, this, [this]() {
+            checkOutputsFinished();
+        });
+        return;
+    }
 
-        {
-            TOKEN_SCRIPT_DIRECTORY,
-            [&]() -> QString
-            {
-                QFileInfo scriptFile(m_properties.scriptName);
-                return scriptFile.canonicalPath();
-            }
-        },
+    int segmentIndex = index;
 
-        {
-            TOKEN_SCRIPT_NAME,
-            [&]() -> QString
-            {
-                QFileInfo scriptFile(m_properties.scriptName);
-                return scriptFile.completeBaseName();
-            }
-        },
+    if (a_newState == JobState::Completed) {
+        emit signalLogMessage(tr("Segment %1 is complete.")
+                              .arg(segmentIndex + 1), LOG_STYLE_POSITIVE);
 
-        {
-            TOKEN_FRAMES_NUMBER,
-            [&]() -> QString
-            {
-                return QString::number(framesTotal());
+        JobSegmentProgress &segment =
+            m_properties.segmentsProgress[segmentIndex];
+        segment.framesProcessed = segment.framesTotal();
+
+        // The completed segment is a checkpoint to resume from.
+        emit signalPropertiesChanged();
+
+        int nextSegmentIndex = -1;
+
+        for (int i = 0; i < m_properties.segmentsProgress.size(); ++i) {
+            if (!m_properties.segmentsProgress[i].isComplete()) {
+                nextSegmentIndex = i;
+                break;
             }
-        },
+        }
 
-        {
-            TOKEN_SUBSAMPLING,
-            [&]() -> QString
-            {
+        if (nextSegmentIndex < 0) {
+            finishSegments();
+            return;
+        }
+
+        if (encodesPartsInSequence()) {
+            // The finished part may still be unwinding inside a signal
+            // of the shared script processor.
+            QTimer::singleShot(0, this, [this, nextSegmentIndex]() {
+                if (m_encodingState == EncodingState::RunningSubJobs) {
+                    startSegment(nextSegmentIndex);
+                }
+            });
+        }
+    } else if (a_newState == JobState::Failed) {
+        // The segment job may still be unwinding from its failure
+        // inside a signal of the shared script processor.
+        QTimer::singleShot(0, this, [this, segmentIndex]() {
+            retrySegment(segmentIndex);
+        });
+    }
+}
+
+// END OF void vsedit::Job::slotSubJobStateChanged(JobState a_newState,
+//		JobState a_oldState)
+//==============================================================================
+
+void vsedit::Job::slotSubJobProgressChanged()
+{
+    int index = subJobIndexOf(sender());
+
+    if (index < 0) {
+        return;
+    }
+
+    JobProperties subJobProperties = m_subJobs[index]->properties();
+    m_properties.segmentsProgress[index].framesProcessed =
+        subJobProperties.framesProcessed;
+
+    bool outputs = !m_properties.extraOutputs.isEmpty();
+    m_properties.framesProcessed = outputs ? -1 : 0;
+    m_properties.scriptWaitTime = 0.0;
+    m_properties.pipeStallTime = 0.0;
+    m_properties.packingTime = 0.0;
+    m_properties.encoderCpuTime = -1.0;
+    m_properties.runningTime = 0.0;
+
+    if (!outputs) {
+        m_properties.requestWindow = 0;
+        m_properties.requestWindowLimit = 0;
+    }
+
+    for (Job *pSubJob : m_subJobs) {
+        subJobProperties = pSubJob->properties();
+        m_properties.scriptWaitTime += subJobProperties.scriptWaitTime;
+        m_properties.pipeStallTime += subJobProperties.pipeStallTime;
+        m_properties.packingTime += subJobProperties.packingTime;
+        m_properties.runningTime += subJobProperties.runningTime;
+
+        if (subJobProperties.encoderCpuTime >= 0.0) {
+            m_properties.encoderCpuTime =
+                std::max(m_properties.encoderCpuTime, 0.0) +
+                subJobProperties.encoderCpuTime;
+        }
+
+        if (!outputs) {
+            if (pSubJob->isActive()) {
+                m_properties.requestWindow += subJobProperties.requestWindow;
+                m_properties.requestWindowLimit +=
+                    subJobProperties.requestWindowLimit;
+            }
+
+            continue;
+        }
+
+        // Outputs progress together as fast as the slowest one
+        // still working.
+        if (pSubJob->state() == JobState::Failed) {
+            continue;
+        }
+
+        if ((m_properties.framesProcessed < 0) ||
+                (subJobProperties.framesProcessed <
+                 m_properties.framesProcessed)) {
+            m_properties.framesProcessed = subJobProperties.framesProcessed;
+        }
+    }
+
+    // Segments completed before the job was resumed have no running job.
+    if (!outputs) {
+        for (const JobSegmentProgress &segment :
+                m_properties.segmentsProgress) {
+            m_properties.framesProcessed += segment.framesProcessed;
+        }
+    }
+
+    m_properties.framesProcessed = std::max(m_properties.framesProcessed, 0);
+
+    updateFPS();
+    emit signalProgressChanged();
+
+    if (outputs) {
+        requestOutputFrames();
+    }
+}
+
+// END OF void vsedit::Job::slotSubJobProgressChanged()
+//==============================================================================
+
+void vsedit::Job::slotSubJobLogMessage(const QString &a_message,
+                                        const QString &a_style)
+{
+    int index = subJobIndexOf(sender());
+
+    if (index < 0) {
+        return;
+    }
+
+    QString prefix = m_properties.extraOutputs.isEmpty() ?
+                     tr("Segment %1: ") : tr("Output %1: ");
+    emit signalLogMessage(prefix.arg(index + 1) + a_message, a_style);
+}
+
+// END OF void vsedit::Job::slotSubJobLogMessage(const QString & a_message,
+//		const QString & a_style)
+//==============================================================================
+
+void vsedit::Job::slotMergeProcessFinished(int a_exitCode,
+        QProcess::ExitStatus a_exitStatus)
+{
+    QString output =
+        QString::fromUtf8(m_mergeProcess.readAll()).trimmed();
+
+    if (!output.isEmpty()) {
+        emit signalLogMessage(output);
+    }
+
+    if (m_encodingState == EncodingState::Aborting) {
+        finishEncodingCLI();
+        return;
+    }
+
+    if ((a_exitStatus == QProcess::CrashExit) || (a_exitCode != 0)) {
+        emit signalLogMessage(tr("Merge command has failed. Exit code: %1")
+                              .arg(a_exitCode), LOG_STYLE_ERROR);
+        m_encodingState = EncodingState::Aborting;
+        changeStateAndNotify(JobState::FailedCleanUp);
+    } else {
+        emit signalLogMessage(tr("Segments are merged."));
+    }
+
+    finishEncodingCLI();
+}
+
+// END OF void vsedit::Job::slotMergeProcessFinished(int a_exitCode,
+//		QProcess::ExitStatus a_exitStatus)
+//==============================================================================
+
+void vsedit::Job::slotMergeProcessError(QProcess::ProcessError a_error)
+{
+    // Every other error ends with the finished signal.
+    if (a_error != QProcess::FailedToStart) {
+        return;
+    }
+
+    emit signalLogMessage(tr("Merge command has failed to start."),
+                          LOG_STYLE_ERROR);
+
+    if (m_encodingState != EncodingState::Aborting) {
+        m_encodingState = EncodingState::Aborting;
+        changeStateAndNotify(JobState::FailedCleanUp);
+    }
+
+    finishEncodingCLI();
+}
+
+// END OF void vsedit::Job::slotMergeProcessError(
+//		QProcess::ProcessError a_error)
+//==============================================================================
+
+void vsedit::Job::fillVariables()
+{
+    JobVariables::fillVariables();
+
+    struct JobVariableEvaluator {
+        QString token;
+        std::function<QString()> evaluate;
+    };
+
+    JobVariableEvaluator evaluators[] = {
+        {
+            TOKEN_WIDTH,
+            [&]() -> QString
+            {
+                if (!m_cpVideoInfo)
+                {
+                    return TOKEN_WIDTH;
+                }
+
+                return QString::number(m_cpVideoInfo->width);
+            }
+        },
+
+        {
+            TOKEN_HEIGHT,
+            [&]() -> QString
+            {
+                if (!m_cpVideoInfo)
+                {
+                    return TOKEN_HEIGHT;
+                }
+
+                return QString::number(m_cpVideoInfo->height);
+            }
+        },
+
+        {
+            TOKEN_FPS_NUMERATOR,
+            [&]() -> QString
+            {
+                if (!m_cpVideoInfo)
+                {
+                    return TOKEN_FPS_NUMERATOR;
+                }
+
+                return QString::number(m_cpVideoInfo->fpsNum);
+            }
+        },
+
+        {
+            TOKEN_FPS_DENOMINATOR,
+            [&]() -> QString
+            {
+                if (!m_cpVideoInfo)
+                {
+                    return TOKEN_FPS_DENOMINATOR;
+                }
+
+                return QString::number(m_cpVideoInfo->fpsDen);
+            }
+        },
+
+        {
+            TOKEN_FPS,
+            [&]() -> QString
+            {
+                if (!m_cpVideoInfo)
+                {
+                    return TOKEN_FPS;
+                }
+
+                double fps = (double)m_cpVideoInfo->fpsNum /
+                (double)m_cpVideoInfo->fpsDen;
+                return QString::number(fps, 'f', 10);
+            }
+        },
+
+        {
+            TOKEN_BITDEPTH,
+            [&]() -> QString
+            {
+                if (!m_cpVideoInfo)
+                {
+                    return TOKEN_BITDEPTH;
+                }
+
+                return QString::number(m_cpVideoInfo->format->bitsPerSample);
+            }
+        },
+
+        {
+            TOKEN_SCRIPT_DIRECTORY,
+            [&]() -> QString
+            {
+                QFileInfo scriptFile(m_properties.scriptName);
+                return scriptFile.canonicalPath();
+            }
+        },
+
+        {
+            TOKEN_SCRIPT_NAME,
+            [&]() -> QString
+            {
+                QFileInfo scriptFile(m_properties.scriptName);
+                return scriptFile.completeBaseName();
+            }
+        },
+
+        {
+            TOKEN_FRAMES_NUMBER,
+            [&]() -> QString
+            {
+                return QString::number(framesTotal());
+            }
+        },
+
+        {
+            TOKEN_SUBSAMPLING,
+            [&]() -> QString
+            {
                 if (!m_cpVideoInfo)
                 {
                     return TOKEN_SUBSAMPLING;
@@ -1316,6 +2251,19 @@ void vsedit::Job::fillVariables()
                                                  cpFormat->subSamplingH);
             }
         },
+
+        {
+            TOKEN_SEGMENT,
+            [&]() -> QString
+            {
+                if (m_segmentIndex < 0)
+                {
+                    return TOKEN_SEGMENT;
+                }
+
+                return segmentNumberString(m_segmentIndex);
+            }
+        },
     };
 
     for (JobVariableEvaluator &evaluator : evaluators) {
@@ -1358,11 +2306,26 @@ void vsedit::Job::changeStateAndNotify(JobState a_state)
         m_fpsBuffer.reset();
     }
 
+    if ((a_state == JobState::Running) && (oldState != JobState::Running)) {
+        m_runningSince = hr_clock::now();
+    } else if ((oldState == JobState::Running) &&
+               (a_state != JobState::Running)) {
+        m_runningTimeBefore += duration_to_double(hr_clock::now() -
+                               m_runningSince);
+    }
+
     if (a_state == JobState::Waiting) {
         m_properties.timeStarted = QDateTime();
         m_properties.timeEnded = QDateTime();
         m_properties.fps = 0.0;
         m_properties.framesProcessed = 0;
+        m_properties.scriptWaitTime = 0.0;
+        m_properties.pipeStallTime = 0.0;
+        m_properties.packingTime = 0.0;
+        m_properties.encoderCpuTime = -1.0;
+        m_properties.runningTime = 0.0;
+        m_runningTimeBefore = 0.0;
+        m_properties.segmentsProgress.clear();
     }
 
     emit signalStateChanged(m_properties.jobState, oldState);
@@ -1390,6 +2353,16 @@ void vsedit::Job::startEncodeScriptCLI()
         m_pFrameHeaderWriter =
             new FrameHeaderWriterNull(m_cpVSAPI, m_cpVideoInfo, this);
 
+    // Packed frames look like plain grayscale to the header writers.
+    if ((m_properties.encodingPacking != EncodingPacking::Planar) &&
+            (m_properties.encodingHeaderType != EncodingHeaderType::NoHeader)) {
+        emit signalLogMessage(tr("Packed frames can only be encoded "
+                                 "without a header."), LOG_STYLE_ERROR);
+        changeStateAndNotify(JobState::FailedCleanUp);
+        cleanUpEncoding();
+        return;
+    }
+
     bool compatibleHeader = m_pFrameHeaderWriter->isCompatible();
 
     if (!compatibleHeader) {
@@ -1400,54 +2373,862 @@ void vsedit::Job::startEncodeScriptCLI()
         return;
     }
 
-    QString executable = vsedit::findExecutable(m_properties.executablePath);
-    const QString decodedArguments =
-        decodeArguments(m_properties.arguments);
-    const QString commandLine = QString("\"%1\" %2").arg(executable)
-                          .arg(decodedArguments);
+    for (Job *pSubJob : m_subJobs) {
+        delete pSubJob;
+    }
+
+    m_subJobs.clear();
+
+    if (!openChecksumFile()) {
+        changeStateAndNotify(JobState::FailedCleanUp);
+        cleanUpEncoding();
+        return;
+    }
+
+    bool segmented = (m_properties.segments > 1) ||
+                     (m_properties.checkpointFrames > 0);
+
+    if (segmented && !m_properties.extraOutputs.isEmpty()) {
+        emit signalLogMessage(tr("A segmented or resumable job can not have "
+                                 "extra outputs."), LOG_STYLE_ERROR);
+        changeStateAndNotify(JobState::FailedCleanUp);
+        cleanUpEncoding();
+        return;
+    }
+
+    // Sub-jobs write their frames into the file the job has just created
+    // and report the comparison themselves.
+    if (segmented || (!m_properties.extraOutputs.isEmpty())) {
+        m_checksumFile.close();
+    }
+
+    if (segmented) {
+        startSegmentedEncoding();
+        return;
+    }
+
+    if (!m_properties.extraOutputs.isEmpty()) {
+        startOutputs();
+        return;
+    }
+
+    if (m_properties.encodingType == EncodingType::Raw) {
+        startEncodeScriptToFile();
+        return;
+    }
+
+    QString executable = vsedit::findExecutable(m_properties.executablePath);
+    const QString decodedArguments =
+        decodeArguments(m_properties.arguments);
+    const QString commandLine = QString("\"%1\" %2").arg(executable)
+                          .arg(decodedArguments);
+
+    emit signalLogMessage(tr("Command line:"));
+    emit signalLogMessage(commandLine);
+
+    startEncoderOutputLog();
+
+    emit signalLogMessage(tr("Checking the encoder sanity."));
+    m_encodingState = EncodingState::CheckingEncoderSanity;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5,15,0)
+    m_process.start(executable, QProcess::splitCommand(decodedArguments));
+#else
+    m_process.start(commandLine);
+#endif
+
+    if (!m_process.waitForStarted(3000)) {
+        emit signalLogMessage(tr("Encoder wouldn't start."),
+                              LOG_STYLE_ERROR);
+        changeStateAndNotify(JobState::FailedCleanUp);
+        cleanUpEncoding();
+        return;
+    }
+
+    m_process.closeWriteChannel();
+
+    if (!m_process.waitForFinished(3000)) {
+        emit signalLogMessage(tr("Program is not behaving "
+                                 "like a CLI encoder. Terminating."), LOG_STYLE_ERROR);
+        m_process.kill();
+        m_process.waitForFinished(-1);
+        changeStateAndNotify(JobState::FailedCleanUp);
+        cleanUpEncoding();
+        return;
+    }
+
+    emit signalLogMessage(tr("Encoder seems sane. Starting."));
+
+    if (EncoderPipeWriter::isSupported()) {
+        if (!m_pEncoderPipeWriter) {
+            m_pEncoderPipeWriter = new EncoderPipeWriter(m_cpVSAPI, this);
+            connect(m_pEncoderPipeWriter, SIGNAL(signalBytesWritten(qint64)),
+                    this, SLOT(slotProcessBytesWritten(qint64)));
+            connect(m_pEncoderPipeWriter,
+                    SIGNAL(signalWriteError(const QString &)),
+                    this, SLOT(slotEncoderWriteError(const QString &)));
+            connect(m_pEncoderPipeWriter, SIGNAL(signalFinished()),
+                    this, SLOT(slotEncoderWriterFinished()));
+        }
+
+        if (!m_pEncoderPipeWriter->attach(&m_process)) {
+            emit signalLogMessage(tr("Falling back to buffered encoder "
+                                     "input: %1").arg(m_pEncoderPipeWriter->errorString()),
+                                  LOG_STYLE_WARNING);
+        }
+    }
+
+    m_encodingState = EncodingState::StartingEncoder;
+#if QT_VERSION >= QT_VERSION_CHECK(5,15,0)
+    m_process.start(executable, QProcess::splitCommand(decodedArguments));
+#else
+    m_process.start(commandLine);
+#endif
+}
+
+// END OF void vsedit::Job::startEncodeScriptCLI()
+//==============================================================================
+
+void vsedit::Job::startEncodeScriptToFile()
+{
+    // Arguments hold the output file path for this encoding type.
+    const QString filePath = decodeArguments(m_properties.arguments).trimmed();
+
+    if (filePath.isEmpty()) {
+        emit signalLogMessage(tr("Output file path is empty."),
+                              LOG_STYLE_ERROR);
+        changeStateAndNotify(JobState::FailedCleanUp);
+        cleanUpEncoding();
+        return;
+    }
+
+    emit signalLogMessage(tr("Output file:"));
+    emit signalLogMessage(filePath);
+
+    if (!m_pEncoderFileWriter) {
+        m_pEncoderFileWriter = new EncoderFileWriter(m_cpVSAPI, this);
+        connect(m_pEncoderFileWriter, SIGNAL(signalBytesWritten(qint64)),
+                this, SLOT(slotProcessBytesWritten(qint64)));
+        connect(m_pEncoderFileWriter,
+                SIGNAL(signalWriteError(const QString &)),
+                this, SLOT(slotEncoderWriteError(const QString &)));
+        connect(m_pEncoderFileWriter, SIGNAL(signalFinished()),
+                this, SLOT(slotEncoderWriterFinished()));
+    }
+
+    bool unbuffered = m_pSettingsManager->getUnbufferedFileOutput();
+
+    if (!m_pEncoderFileWriter->open(filePath, unbuffered)) {
+        emit signalLogMessage(m_pEncoderFileWriter->errorString(),
+                              LOG_STYLE_ERROR);
+        changeStateAndNotify(JobState::FailedCleanUp);
+        cleanUpEncoding();
+        return;
+    }
+
+    if (unbuffered && !m_pEncoderFileWriter->isUnbuffered()) {
+        emit signalLogMessage(tr("Unbuffered output is not supported "
+                                 "for this file. Writing through the system cache."),
+                              LOG_STYLE_WARNING);
+    }
+
+    emit signalLogMessage(tr("Writing to file."));
+    startWritingStream();
+}
+
+// END OF void vsedit::Job::startEncodeScriptToFile()
+//==============================================================================
+
+void vsedit::Job::startWritingStream()
+{
+    Q_ASSERT(m_pFrameHeaderWriter);
+
+    if (m_pFrameHeaderWriter->needVideoHeader()) {
+        QByteArray videoHeader =
+            m_pFrameHeaderWriter->videoHeader(framesTotal());
+
+        if (m_properties.encodingHeaderType == EncodingHeaderType::Y4M)
+            emit signalLogMessage(tr("Y4M header: ") +
+                                  QString::fromLatin1(videoHeader), LOG_STYLE_DEBUG);
+
+        m_bytesToWrite = videoHeader.size();
+
+        if (m_bytesToWrite > 0) {
+            m_bytesWritten = 0;
+            m_encodingState = EncodingState::WritingHeader;
+            qint64 bytesWritten = writeToEncoder(videoHeader);
+
+            if (bytesWritten < 0) {
+                m_encodingState = EncodingState::Aborting;
+                changeStateAndNotify(JobState::FailedCleanUp);
+                emit signalLogMessage(
+                    tr("Error on writing header to encoder. Aborting."),
+                    LOG_STYLE_ERROR);
+                cleanUpEncoding();
+                return;
+            }
+
+            return;
+        }
+    }
+
+    m_fpsBuffer.reset();
+
+    m_encodingState = EncodingState::WaitingForFrames;
+    processFramesQueue();
+}
+
+// END OF void vsedit::Job::startWritingStream()
+//==============================================================================
+
+bool vsedit::Job::attachToScriptProcessor(
+    VapourSynthScriptProcessor *a_pScriptProcessor)
+{
+    if (isActive() || m_pVapourSynthScriptProcessor) {
+        return false;
+    }
+
+    Q_ASSERT(a_pScriptProcessor);
+    m_pVapourSynthScriptProcessor = a_pScriptProcessor;
+
+    // Log messages of the script go to the job owning the processor only.
+    connect(m_pVapourSynthScriptProcessor,
+            SIGNAL(signalFrameQueueStateChanged(size_t, size_t, size_t)),
+            this, SLOT(slotFrameQueueStateChanged(size_t, size_t, size_t)));
+    connect(m_pVapourSynthScriptProcessor,
+            SIGNAL(signalDistributeFrame(int, int, const VSFrameRef *,
+                                         const VSFrameRef *)),
+            this, SLOT(slotReceiveFrame(int, int, const VSFrameRef *,
+                                        const VSFrameRef *)));
+    connect(m_pVapourSynthScriptProcessor,
+            SIGNAL(signalFrameRequestDiscarded(int, int, const QString &)),
+            this, SLOT(slotFrameRequestDiscarded(int, int, const QString &)));
+
+    return true;
+}
+
+// END OF bool vsedit::Job::attachToScriptProcessor(
+//		VapourSynthScriptProcessor * a_pScriptProcessor)
+//==============================================================================
+
+bool vsedit::Job::sharesScriptProcessor() const
+{
+    return ((m_segmentIndex >= 0) || (m_outputIndex >= 0));
+}
+
+// END OF bool vsedit::Job::sharesScriptProcessor() const
+//==============================================================================
+
+vsedit::Job *vsedit::Job::createSubJob(const JobProperties &a_properties)
+{
+    JobProperties properties = a_properties;
+    properties.id = QUuid::createUuid();
+    properties.jobState = JobState::Waiting;
+    properties.dependsOnJobIds.clear();
+    properties.segments = 1;
+    properties.checkpointFrames = 0;
+    properties.mergeCommand.clear();
+    properties.segmentsProgress.clear();
+    properties.extraOutputs.clear();
+
+    Job *pSubJob = new Job(properties, m_pSettingsManager,
+                           m_pVSScriptLibrary, this);
+
+    connect(pSubJob, SIGNAL(signalStateChanged(JobState, JobState)),
+            this, SLOT(slotSubJobStateChanged(JobState, JobState)));
+    connect(pSubJob, SIGNAL(signalProgressChanged()),
+            this, SLOT(slotSubJobProgressChanged()));
+    connect(pSubJob,
+            SIGNAL(signalLogMessage(const QString &, const QString &)),
+            this, SLOT(slotSubJobLogMessage(const QString &,
+                                            const QString &)));
+
+    return pSubJob;
+}
+
+// END OF vsedit::Job * vsedit::Job::createSubJob(
+//		const JobProperties & a_properties)
+//==============================================================================
+
+void vsedit::Job::startSegmentedEncoding()
+{
+    if (!m_properties.arguments.contains(TOKEN_SEGMENT)) {
+        emit signalLogMessage(tr("Arguments of a segmented or resumable job "
+                                 "must contain %1, so the segments do not overwrite "
+                                 "each other.").arg(TOKEN_SEGMENT), LOG_STYLE_ERROR);
+        changeStateAndNotify(JobState::FailedCleanUp);
+        cleanUpEncoding();
+        return;
+    }
+
+    int framesCount = framesTotal();
+
+    if (canResumeSegments()) {
+        int resumeFrame = m_properties.lastFrameReal + 1;
+
+        for (const JobSegmentProgress &segment :
+                m_properties.segmentsProgress) {
+            if (!segment.isComplete()) {
+                resumeFrame = std::min(resumeFrame, segment.firstFrame);
+            }
+        }
+
+        emit signalLogMessage(tr("Resuming from frame %1. Completed "
+                                 "segments are kept.").arg(resumeFrame), LOG_STYLE_POSITIVE);
+        startSegments();
+        return;
+    }
+
+    if (encodesPartsInSequence()) {
+        // Parts are cut at any frame. They are encoded one after another
+        // by the same encoder settings, so the cuts do not cost quality
+        // the way keyframes of parallel segments would.
+        int partFrames = std::max(m_properties.checkpointFrames,
+                                  MIN_SEGMENT_FRAMES);
+        partFrames = std::max(partFrames, (framesCount +
+                                           MAX_CHECKPOINT_PARTS - 1) / MAX_CHECKPOINT_PARTS);
+
+        m_properties.segmentsProgress.clear();
+
+        for (int first = m_properties.firstFrameReal;
+                first <= m_properties.lastFrameReal; first += partFrames) {
+            JobSegmentProgress part;
+            part.firstFrame = first;
+            part.lastFrame = std::min(first + partFrames - 1,
+                                      m_properties.lastFrameReal);
+            m_properties.segmentsProgress.push_back(part);
+        }
+
+        startSegments();
+        return;
+    }
+    int segmentsCount = std::min(m_properties.segments,
+                                 framesCount / MIN_SEGMENT_FRAMES);
+    segmentsCount = std::max(segmentsCount, 1);
+
+    if (segmentsCount < m_properties.segments) {
+        emit signalLogMessage(tr("Too few frames for %1 segments. "
+                                 "Encoding %2 segments.").arg(m_properties.segments)
+                              .arg(segmentsCount), LOG_STYLE_WARNING);
+    }
+
+    m_properties.segmentsProgress.clear();
+
+    for (int i = 0; i < segmentsCount; ++i) {
+        JobSegmentProgress segment;
+        segment.firstFrame = m_properties.firstFrameReal +
+                             (int)((qint64)framesCount * i / segmentsCount);
+        segment.lastFrame = m_properties.firstFrameReal +
+                            (int)((qint64)framesCount * (i + 1) / segmentsCount) - 1;
+        m_properties.segmentsProgress.push_back(segment);
+    }
+
+    // Each segment but the first may start a bit later, at the first
+    // scene change the script marks. First only the nominal starts are
+    // requested, to see if the script marks scene changes at all.
+    m_sceneChangeSearches.clear();
+    m_sceneChangeProbesPending = 0;
+    m_sceneChangePropFound = false;
+    m_sceneChangeWindowsRequested = false;
+
+    for (int i = 1; i < segmentsCount; ++i) {
+        const JobSegmentProgress &segment = m_properties.segmentsProgress[i];
+        SceneChangeSearch search;
+        search.segmentIndex = i;
+        search.firstFrame = segment.firstFrame;
+        search.lastFrame = std::min(segment.firstFrame +
+                                    SEGMENT_SCENE_CHANGE_SEARCH_FRAMES - 1, segment.lastFrame);
+        search.cut = -1;
+        m_sceneChangeSearches.push_back(search);
+    }
+
+    m_encodingState = EncodingState::ProbingSceneChanges;
+
+    for (const SceneChangeSearch &search : m_sceneChangeSearches) {
+        if (m_pVapourSynthScriptProcessor->requestFrameAsync(
+                    search.firstFrame)) {
+            m_sceneChangeProbesPending++;
+        }
+    }
+
+    if (m_sceneChangeProbesPending == 0) {
+        startSegments();
+    }
+}
+
+// END OF void vsedit::Job::startSegmentedEncoding()
+//==============================================================================
+
+bool vsedit::Job::canResumeSegments() const
+{
+    // The saved segments must cover exactly the frames to encode now.
+    // Anything else means the job was changed since it was interrupted.
+    int nextFrame = m_properties.firstFrameReal;
+    bool anyComplete = false;
+
+    for (const JobSegmentProgress &segment : m_properties.segmentsProgress) {
+        if (segment.firstFrame != nextFrame) {
+            return false;
+        }
+
+        nextFrame = segment.lastFrame + 1;
+        anyComplete = anyComplete || segment.isComplete();
+    }
+
+    return anyComplete && (nextFrame == m_properties.lastFrameReal + 1);
+}
+
+// END OF bool vsedit::Job::canResumeSegments() const
+//==============================================================================
+
+bool vsedit::Job::encodesPartsInSequence() const
+{
+    return (m_properties.segments <= 1) && (m_properties.checkpointFrames > 0);
+}
+
+// END OF bool vsedit::Job::encodesPartsInSequence() const
+//==============================================================================
+
+void vsedit::Job::receiveSceneChangeProbe(int a_frameNumber,
+        const VSFrameRef *a_cpFrameRef)
+{
+    bool sceneChange = false;
+
+    if (a_cpFrameRef) {
+        Q_ASSERT(m_cpVSAPI);
+        const VSMap *cpProps = m_cpVSAPI->getFramePropsRO(a_cpFrameRef);
+        int error = 0;
+        int64_t value = m_cpVSAPI->propGetInt(cpProps,
+                                              SCENE_CHANGE_FRAME_PROPERTY, 0, &error);
+
+        if (!error) {
+            m_sceneChangePropFound = true;
+            sceneChange = (value != 0);
+        }
+    }
+
+    for (SceneChangeSearch &search : m_sceneChangeSearches) {
+        if ((a_frameNumber < search.firstFrame) ||
+                (a_frameNumber > search.lastFrame)) {
+            continue;
+        }
+
+        if (sceneChange && ((search.cut < 0) || (a_frameNumber < search.cut))) {
+            search.cut = a_frameNumber;
+        }
+
+        m_sceneChangeProbesPending--;
+        break;
+    }
+
+    if (m_sceneChangeProbesPending > 0) {
+        return;
+    }
+
+    if (m_sceneChangePropFound && !m_sceneChangeWindowsRequested) {
+        m_sceneChangeWindowsRequested = true;
+
+        for (const SceneChangeSearch &search : m_sceneChangeSearches) {
+            if (search.cut == search.firstFrame) {
+                continue;
+            }
+
+            for (int frame = search.firstFrame + 1; frame <= search.lastFrame;
+                    ++frame) {
+                if (m_pVapourSynthScriptProcessor->requestFrameAsync(frame)) {
+                    m_sceneChangeProbesPending++;
+                }
+            }
+        }
+
+        if (m_sceneChangeProbesPending > 0) {
+            return;
+        }
+    }
+
+    if (!m_sceneChangePropFound) {
+        emit signalLogMessage(tr("The script does not mark scene changes "
+                                 "with %1. Splitting evenly.").arg(SCENE_CHANGE_FRAME_PROPERTY));
+    }
+
+    for (const SceneChangeSearch &search : m_sceneChangeSearches) {
+        if (search.cut < 0) {
+            continue;
+        }
+
+        m_properties.segmentsProgress[search.segmentIndex].firstFrame =
+            search.cut;
+        m_properties.segmentsProgress[search.segmentIndex - 1].lastFrame =
+            search.cut - 1;
+    }
+
+    startSegments();
+}
+
+// END OF void vsedit::Job::receiveSceneChangeProbe(int a_frameNumber,
+//		const VSFrameRef * a_cpFrameRef)
+//==============================================================================
+
+void vsedit::Job::startSegments()
+{
+    m_encodingState = EncodingState::RunningSubJobs;
+    m_fpsBuffer.reset();
+
+    for (int i = 0; i < m_properties.segmentsProgress.size(); ++i) {
+        const JobSegmentProgress &segment = m_properties.segmentsProgress[i];
+
+        JobProperties properties = m_properties;
+        properties.firstFrame = segment.firstFrame;
+        properties.lastFrame = segment.lastFrame;
+
+        Job *pSubJob = createSubJob(properties);
+        pSubJob->m_framesMemoryBudget = m_framesMemoryBudget;
+
+        // Parts in sequence have the budget to themselves.
+        if (!encodesPartsInSequence()) {
+            pSubJob->m_framesMemoryBudget /=
+                m_properties.segmentsProgress.size();
+        }
+
+        pSubJob->attachAsSegment(m_pVapourSynthScriptProcessor, i);
+        m_subJobs.push_back(pSubJob);
+    }
+
+    m_properties.framesProcessed = 0;
+
+    for (const JobSegmentProgress &segment : m_properties.segmentsProgress) {
+        m_properties.framesProcessed += segment.framesProcessed;
+    }
+
+    emit signalProgressChanged();
+
+    for (int i = 0; i < (int)m_subJobs.size(); ++i) {
+        // Aborted from a segment while the others were starting.
+        if (m_encodingState != EncodingState::RunningSubJobs) {
+            return;
+        }
+
+        // Completed before the job was interrupted.
+        if (m_properties.segmentsProgress[i].isComplete()) {
+            continue;
+        }
+
+        startSegment(i);
+
+        if (encodesPartsInSequence()) {
+            return;
+        }
+    }
+}
+
+// END OF void vsedit::Job::startSegments()
+//==============================================================================
+
+void vsedit::Job::startSegment(int a_segmentIndex)
+{
+    JobSegmentProgress &segment =
+        m_properties.segmentsProgress[a_segmentIndex];
+    segment.framesProcessed = 0;
+    segment.attempts++;
+
+    emit signalLogMessage(tr("Starting segment %1: frames %2 to %3.")
+                          .arg(a_segmentIndex + 1).arg(segment.firstFrame)
+                          .arg(segment.lastFrame));
+    m_subJobs[a_segmentIndex]->start();
+}
+
+// END OF void vsedit::Job::startSegment(int a_segmentIndex)
+//==============================================================================
+
+void vsedit::Job::retrySegment(int a_segmentIndex)
+{
+    if (m_encodingState != EncodingState::RunningSubJobs) {
+        return;
+    }
+
+    int attempts = m_properties.segmentsProgress[a_segmentIndex].attempts;
+
+    if (attempts < MAX_SEGMENT_ATTEMPTS) {
+        emit signalLogMessage(tr("Segment %1 has failed. Retrying.")
+                              .arg(a_segmentIndex + 1), LOG_STYLE_WARNING);
+        startSegment(a_segmentIndex);
+        return;
+    }
+
+    emit signalLogMessage(tr("Segment %1 has failed %2 times. Aborting.")
+                          .arg(a_segmentIndex + 1).arg(attempts), LOG_STYLE_ERROR);
+    m_encodingState = EncodingState::Aborting;
+    changeStateAndNotify(JobState::FailedCleanUp);
+    cleanUpEncoding();
+}
+
+// END OF void vsedit::Job::retrySegment(int a_segmentIndex)
+//==============================================================================
+
+void vsedit::Job::finishSegments()
+{
+    emit signalLogMessage(tr("All segments are encoded."));
+
+    // Finished once both the merge command and the script are done.
+    m_encodingState = EncodingState::Finishing;
+
+    if (m_properties.mergeCommand.trimmed().isEmpty()) {
+        emit signalLogMessage(tr("No merge command. "
+                                 "Segments are left as they are."), LOG_STYLE_WARNING);
+        cleanUpEncoding();
+        return;
+    }
+
+    // Decoded before the script is finalized and its variables are gone.
+    QString command =
+        decodeArguments(expandSegmentWords(m_properties.mergeCommand));
+
+    emit signalLogMessage(tr("Merge command:"));
+    emit signalLogMessage(command);
+
+#ifdef Q_OS_WIN
+    m_mergeProcess.setNativeArguments(QString("/c %1").arg(command));
+    m_mergeProcess.start("cmd.exe", QStringList());
+#else
+    m_mergeProcess.start("/bin/sh", QStringList() << "-c" << command);
+#endif
+
+    cleanUpEncoding();
+}
+
+// END OF void vsedit::Job::finishSegments()
+//==============================================================================
+
+void vsedit::Job::stopSubJobs()
+{
+    for (Job *pSubJob : m_subJobs) {
+        pSubJob->abort();
+    }
+
+    if ((m_encodingState == EncodingState::Aborting) &&
+            (m_mergeProcess.state() != QProcess::NotRunning)) {
+        m_mergeProcess.kill();
+        m_mergeProcess.waitForFinished(-1);
+    }
+}
+
+// END OF void vsedit::Job::stopSubJobs()
+//==============================================================================
+
+int vsedit::Job::subJobIndexOf(QObject *a_pSubJob) const
+{
+    std::vector<Job *>::const_iterator it = std::find(m_subJobs.begin(),
+                                            m_subJobs.end(), a_pSubJob);
+
+    if (it == m_subJobs.end()) {
+        return -1;
+    }
+
+    return (int)(it - m_subJobs.begin());
+}
+
+// END OF int vsedit::Job::subJobIndexOf(QObject * a_pSubJob) const
+//==============================================================================
+
+QString vsedit::Job::expandSegmentWords(const QString &a_command) const
+{
+    // Words are separated by spaces outside of double quotes.
+    QStringList words;
+    QString word;
+    bool quoted = false;
+
+    for (const QChar &character : a_command) {
+        if (character == '"') {
+            quoted = !quoted;
+        }
+
+        if (character.isSpace() && !quoted) {
+            if (!word.isEmpty()) {
+                words.push_back(word);
+            }
+
+            word.clear();
+            continue;
+        }
+
+        word += character;
+    }
+
+    if (!word.isEmpty()) {
+        words.push_back(word);
+    }
+
+    QStringList expandedWords;
+
+    for (const QString &commandWord : words) {
+        if (!commandWord.contains(TOKEN_SEGMENT)) {
+            expandedWords.push_back(commandWord);
+            continue;
+        }
+
+        for (int i = 0; i < (int)m_subJobs.size(); ++i) {
+            QString segmentWord = commandWord;
+            expandedWords.push_back(segmentWord.replace(TOKEN_SEGMENT,
+                                    segmentNumberString(i)));
+        }
+    }
+
+    return expandedWords.join(' ');
+}
+
+// END OF QString vsedit::Job::expandSegmentWords(
+//		const QString & a_command) const
+//==============================================================================
+
+void vsedit::Job::startOutputs()
+{
+    m_encodingState = EncodingState::RunningSubJobs;
+    m_fpsBuffer.reset();
+
+    // Outputs have the same memory budget and frame size, so their
+    // reorder buffers hold the whole window.
+    m_outputFramesWindow = (int)m_requestWindow.limit();
+    m_properties.requestWindow = m_outputFramesWindow;
+
+    QVector<JobOutput> outputs;
+    JobOutput mainOutput;
+    mainOutput.encodingType = m_properties.encodingType;
+    mainOutput.encodingHeaderType = m_properties.encodingHeaderType;
+    mainOutput.executablePath = m_properties.executablePath;
+    mainOutput.arguments = m_properties.arguments;
+    outputs.push_back(mainOutput);
+    outputs += m_properties.extraOutputs;
+
+    m_properties.segmentsProgress.clear();
+
+    if ((!m_properties.checksumFile.trimmed().isEmpty()) &&
+            (outputs.size() > 1)) {
+        emit signalLogMessage(tr("All outputs get the same frames. Checksums "
+                                 "are taken from output 1 only."));
+    }
+
+    for (int i = 0; i < outputs.size(); ++i) {
+        JobProperties properties = m_properties;
+        properties.encodingType = outputs[i].encodingType;
+        properties.encodingHeaderType = outputs[i].encodingHeaderType;
+        properties.executablePath = outputs[i].executablePath;
+        properties.arguments = outputs[i].arguments;
+        properties.firstFrame = m_properties.firstFrameReal;
+        properties.lastFrame = m_properties.lastFrameReal;
+
+        // All outputs get the same frames. One of them is enough.
+        if (i > 0) {
+            properties.checksumFile.clear();
+        }
+
+        Job *pSubJob = createSubJob(properties);
+        pSubJob->m_framesMemoryBudget = m_framesMemoryBudget;
+        pSubJob->attachAsOutput(m_pVapourSynthScriptProcessor, i);
+        m_subJobs.push_back(pSubJob);
+
+        JobSegmentProgress progress;
+        progress.firstFrame = m_properties.firstFrameReal;
+        progress.lastFrame = m_properties.lastFrameReal;
+        progress.attempts = 1;
+        m_properties.segmentsProgress.push_back(progress);
+    }
+
+    emit signalLogMessage(tr("Feeding %1 outputs. Up to %2 frames "
+                             "ahead of the slowest one.").arg(outputs.size())
+                          .arg(m_outputFramesWindow));
+    emit signalProgressChanged();
+
+    for (int i = 0; i < (int)m_subJobs.size(); ++i) {
+        if (m_encodingState != EncodingState::RunningSubJobs) {
+            return;
+        }
+
+        emit signalLogMessage(tr("Starting output %1.").arg(i + 1));
+        m_subJobs[i]->start();
+    }
+
+    requestOutputFrames();
+}
+
+// END OF void vsedit::Job::startOutputs()
+//==============================================================================
+
+void vsedit::Job::requestOutputFrames()
+{
+    if (m_properties.extraOutputs.isEmpty() ||
+            (m_encodingState != EncodingState::RunningSubJobs) ||
+            (m_properties.jobState != JobState::Running)) {
+        return;
+    }
+
+    // Each requested frame stays referenced until the slowest output
+    // takes it. Failed outputs are left behind.
+    int slowestFrame = -1;
 
-    emit signalLogMessage(tr("Command line:"));
-    emit signalLogMessage(commandLine);
+    for (Job *pSubJob : m_subJobs) {
+        JobState state = pSubJob->state();
 
-    emit signalLogMessage(tr("Checking the encoder sanity."));
-    m_encodingState = EncodingState::CheckingEncoderSanity;
+        if ((state != JobState::Running) && (state != JobState::Pausing) &&
+                (state != JobState::Paused)) {
+            continue;
+        }
 
-#if QT_VERSION >= QT_VERSION_CHECK(5,15,0)
-    m_process.start(executable, QProcess::splitCommand(decodedArguments));
-#else
-    m_process.start(commandLine);
-#endif
+        int nextFrame = pSubJob->m_framesCache.baseFrame();
 
-    if (!m_process.waitForStarted(3000)) {
-        emit signalLogMessage(tr("Encoder wouldn't start."),
-                              LOG_STYLE_ERROR);
-        changeStateAndNotify(JobState::FailedCleanUp);
-        cleanUpEncoding();
+        if ((slowestFrame < 0) || (nextFrame < slowestFrame)) {
+            slowestFrame = nextFrame;
+        }
+    }
+
+    if (slowestFrame < 0) {
         return;
     }
 
-    m_process.closeWriteChannel();
+    while ((m_lastFrameRequested < m_properties.lastFrameReal) &&
+            (m_lastFrameRequested + 1 < slowestFrame + m_outputFramesWindow)) {
+        m_pVapourSynthScriptProcessor->requestFrameAsync(
+            m_lastFrameRequested + 1);
+        m_lastFrameRequested++;
+    }
+}
 
-    if (!m_process.waitForFinished(3000)) {
-        emit signalLogMessage(tr("Program is not behaving "
-                                 "like a CLI encoder. Terminating."), LOG_STYLE_ERROR);
-        m_process.kill();
-        m_process.waitForFinished(-1);
-        changeStateAndNotify(JobState::FailedCleanUp);
-        cleanUpEncoding();
+// END OF void vsedit::Job::requestOutputFrames()
+//==============================================================================
+
+void vsedit::Job::checkOutputsFinished()
+{
+    if (m_encodingState != EncodingState::RunningSubJobs) {
         return;
     }
 
-    emit signalLogMessage(tr("Encoder seems sane. Starting."));
-    m_encodingState = EncodingState::StartingEncoder;
-#if QT_VERSION >= QT_VERSION_CHECK(5,15,0)
-    m_process.start(executable, QProcess::splitCommand(decodedArguments));
-#else
-    m_process.start(commandLine);
-#endif
+    bool failed = false;
+
+    for (Job *pSubJob : m_subJobs) {
+        if (pSubJob->isActive()) {
+            // The others may go on without the failed output.
+            requestOutputFrames();
+            return;
+        }
+
+        if (pSubJob->state() != JobState::Completed) {
+            failed = true;
+        }
+    }
+
+    if (failed) {
+        emit signalLogMessage(tr("Not all outputs are complete."),
+                              LOG_STYLE_ERROR);
+        m_encodingState = EncodingState::Aborting;
+        changeStateAndNotify(JobState::FailedCleanUp);
+    } else {
+        emit signalLogMessage(tr("All outputs are complete."));
+        m_encodingState = EncodingState::Finishing;
+    }
+
+    cleanUpEncoding();
 }
 
-// END OF void vsedit::Job::startEncodeScriptCLI()
+// END OF void vsedit::Job::checkOutputsFinished()
 //==============================================================================
 
 void vsedit::Job::startRunProcess()
@@ -1461,6 +3242,8 @@ void vsedit::Job::startRunProcess()
     emit signalLogMessage(tr("Command line:"));
     emit signalLogMessage(commandLine);
 
+    startEncoderOutputLog();
+
 #if QT_VERSION >= QT_VERSION_CHECK(5,15,0)
     m_process.start(executable, QProcess::splitCommand(commandLine));
 #else
@@ -1525,25 +3308,51 @@ void vsedit::Job::clearFramesCache()
 
     Q_ASSERT(m_cpVSAPI);
 
-    for (Frame &frame : m_framesCache) {
+    for (Frame &frame : m_framesCache.takeAll()) {
         m_cpVSAPI->freeFrame(frame.cpOutputFrameRef);
         m_cpVSAPI->freeFrame(frame.cpPreviewFrameRef);
     }
-
-    m_framesCache.clear();
 }
 
 // END OF void vsedit::Job::clearFramesCache()
 //==============================================================================
 
+size_t vsedit::Job::frameBytes() const
+{
+    Q_ASSERT(m_cpVideoInfo);
+    const VSFormat *cpFormat = m_cpVideoInfo->format;
+
+    if (!cpFormat) {
+        return 0;
+    }
+
+    size_t bytes = 0;
+
+    for (int i = 0; i < cpFormat->numPlanes; ++i) {
+        int width = m_cpVideoInfo->width >> ((i == 0) ? 0 :
+                    cpFormat->subSamplingW);
+        int height = m_cpVideoInfo->height >> ((i == 0) ? 0 :
+                     cpFormat->subSamplingH);
+        bytes += (size_t)width * height * cpFormat->bytesPerSample;
+    }
+
+    return bytes;
+}
+
+// END OF size_t vsedit::Job::frameBytes() const
+//==============================================================================
+
 void vsedit::Job::processFramesQueue()
 {
-    if (m_encodingState != EncodingState::WaitingForFrames) {
+    if ((m_encodingState != EncodingState::WaitingForFrames) &&
+            (m_encodingState != EncodingState::WritingFrame)) {
         return;
     }
 
     if (m_properties.framesProcessed == framesTotal()) {
         Q_ASSERT(m_framesCache.empty());
+        Q_ASSERT(m_writeSlotsInFlight == 0);
+        updateStageTimes();
         updateFPS();
         changeStateAndNotify(JobState::CompletedCleanUp);
         m_encodingState = EncodingState::Finishing;
@@ -1551,24 +3360,119 @@ void vsedit::Job::processFramesQueue()
         return;
     }
 
-    while ((m_lastFrameRequested < m_properties.lastFrameReal) &&
-            (m_framesInProcess < m_maxThreads) &&
-            (m_framesCache.size() < m_cachedFramesLimit) &&
+    // Requests beyond the free script threads wait in the queue of the
+    // script processor, so the window alone bounds them. Waiting for
+    // a free thread could starve a fast encoder or stall a segment
+    // of a shared script processor.
+    // Outputs take the frames requested by their job.
+    while ((m_outputIndex < 0) &&
+            (m_lastFrameRequested < m_properties.lastFrameReal) &&
+            ((size_t)(m_lastFrameRequested - m_lastFrameProcessed) <
+             m_requestWindow.frames()) &&
+            m_framesCache.fits(m_lastFrameRequested + 1) &&
             (m_properties.jobState == JobState::Running)) {
         m_pVapourSynthScriptProcessor->requestFrameAsync(
             m_lastFrameRequested + 1);
         m_lastFrameRequested++;
     }
 
-    Frame frame(m_lastFrameProcessed + 1, 0, nullptr);
-    QList<Frame>::iterator it = std::find(m_framesCache.begin(),
-                                    m_framesCache.end(), frame);
-
-    if (it == m_framesCache.end()) {
+    if (m_properties.jobState == JobState::Paused) {
         return;
     }
 
-    frame.cpOutputFrameRef = it->cpOutputFrameRef;
+    // Fill the write-ahead window with every frame that is ready in order.
+    while (m_writeSlotsInFlight < m_writeSlots.size()) {
+        int nextFrame = m_lastFrameProcessed + 1 + (int)m_writeSlotsInFlight;
+
+        if (nextFrame > m_properties.lastFrameReal) {
+            // Only the frames already in the pipe are left.
+            setEncoderWait((m_writeSlotsInFlight > 0) ?
+                           EncoderWait::Pipe : EncoderWait::None);
+            return;
+        }
+
+        Q_ASSERT(m_framesCache.baseFrame() == nextFrame);
+
+        if (!m_framesCache.frontReady()) {
+            setEncoderWait((m_properties.jobState == JobState::Running) ?
+                           EncoderWait::Script : EncoderWait::None);
+            return;
+        }
+
+        Frame frame = m_framesCache.popFront();
+
+        hr_time_point packingStart = hr_clock::now();
+        bool written = writeFrameToEncoder(frame);
+        m_packingTime += duration_to_double(hr_clock::now() - packingStart);
+        m_cpVSAPI->freeFrame(frame.cpOutputFrameRef);
+
+        if (!written) {
+            return;
+        }
+    }
+
+    // The oldest frame is not written to the pipe yet.
+    setEncoderWait(EncoderWait::Pipe);
+}
+
+// END OF void vsedit::Job::processFramesQueue()
+//==============================================================================
+
+bool vsedit::Job::writeFrameToEncoder(const Frame &a_frame)
+{
+    Q_ASSERT(m_writeSlotsInFlight < m_writeSlots.size());
+
+    if (m_checksumFile.isOpen() && (!recordChecksums(a_frame))) {
+        m_encodingState = EncodingState::Aborting;
+        changeStateAndNotify(JobState::FailedCleanUp);
+        emit signalLogMessage(m_checksumFile.errorString(), LOG_STYLE_ERROR);
+        cleanUpEncoding();
+        return false;
+    }
+
+    size_t slotIndex = (m_firstWriteSlot + m_writeSlotsInFlight) %
+                       m_writeSlots.size();
+    size_t &slotBytes = m_writeSlots[slotIndex];
+
+    if (encoderPipeAttached() || fileOutputOpen()) {
+        // The writer takes its own reference to the frame
+        // and reads the planes straight from it.
+        QByteArray framePrefix;
+        QByteArray framePostfix;
+
+        if (m_pFrameHeaderWriter->needFramePrefix()) {
+            framePrefix =
+                m_pFrameHeaderWriter->framePrefix(a_frame.cpOutputFrameRef);
+        }
+
+        if (m_pFrameHeaderWriter->needFramePostfix()) {
+            framePostfix =
+                m_pFrameHeaderWriter->framePostfix(a_frame.cpOutputFrameRef);
+        }
+
+        m_encodingState = EncodingState::WritingFrame;
+        qint64 bytesQueued = fileOutputOpen() ?
+                             m_pEncoderFileWriter->writeFrame(framePrefix,
+                                     a_frame.cpOutputFrameRef, framePostfix) :
+                             m_pEncoderPipeWriter->writeFrame(framePrefix,
+                                     a_frame.cpOutputFrameRef, framePostfix);
+
+        if (bytesQueued < 0) {
+            m_encodingState = EncodingState::Aborting;
+            changeStateAndNotify(JobState::FailedCleanUp);
+            emit signalLogMessage(tr("Error on writing data to encoder. "
+                                     "Aborting."), LOG_STYLE_ERROR);
+            cleanUpEncoding();
+            return false;
+        }
+
+        slotBytes = (size_t)bytesQueued;
+        m_writeSlotsInFlight++;
+        m_bytesToWrite += slotBytes;
+        return true;
+    }
+
+    std::vector<char> &framebuffer = m_framebuffer;
 
     // VapourSynth frames are padded so every line has aligned address.
     // But encoder expects frames tightly packed. We pack frame lines
@@ -1583,37 +3487,37 @@ void vsedit::Job::processFramesQueue()
 
     if (m_pFrameHeaderWriter->needFramePrefix()) {
         QByteArray framePrefix =
-            m_pFrameHeaderWriter->framePrefix(frame.cpOutputFrameRef);
+            m_pFrameHeaderWriter->framePrefix(a_frame.cpOutputFrameRef);
         int prefixSize = framePrefix.size();
 
         if (prefixSize > 0) {
-            if ((size_t)prefixSize > m_framebuffer.size()) {
-                m_framebuffer.resize(prefixSize);
+            if ((size_t)prefixSize > framebuffer.size()) {
+                framebuffer.resize(prefixSize);
             }
 
-            memcpy(m_framebuffer.data(), framePrefix.data(), prefixSize);
+            memcpy(framebuffer.data(), framePrefix.data(), prefixSize);
             currentDataSize += prefixSize;
         }
     }
 
     for (int i = 0; i < cpFormat->numPlanes; ++i) {
         const uint8_t *cpPlane =
-            m_cpVSAPI->getReadPtr(frame.cpOutputFrameRef, i);
-        int stride = m_cpVSAPI->getStride(frame.cpOutputFrameRef, i);
-        int width = m_cpVSAPI->getFrameWidth(frame.cpOutputFrameRef, i);
-        int height = m_cpVSAPI->getFrameHeight(frame.cpOutputFrameRef, i);
+            m_cpVSAPI->getReadPtr(a_frame.cpOutputFrameRef, i);
+        int stride = m_cpVSAPI->getStride(a_frame.cpOutputFrameRef, i);
+        int width = m_cpVSAPI->getFrameWidth(a_frame.cpOutputFrameRef, i);
+        int height = m_cpVSAPI->getFrameHeight(a_frame.cpOutputFrameRef, i);
         int bytes = cpFormat->bytesPerSample;
 
         size_t planeSize = width * bytes * height;
         size_t neededFramebufferSize = currentDataSize + planeSize;
 
-        if (neededFramebufferSize > m_framebuffer.size()) {
-            m_framebuffer.resize(neededFramebufferSize);
+        if (neededFramebufferSize > framebuffer.size()) {
+            framebuffer.resize(neededFramebufferSize);
         }
 
         int framebufferStride = width * bytes;
 
-        vs_bitblt(m_framebuffer.data() + currentDataSize, framebufferStride,
+        vs_bitblt(framebuffer.data() + currentDataSize, framebufferStride,
                   cpPlane, stride, framebufferStride, height);
 
         currentDataSize += planeSize;
@@ -1621,27 +3525,29 @@ void vsedit::Job::processFramesQueue()
 
     if (m_pFrameHeaderWriter->needFramePostfix()) {
         QByteArray framePostfix =
-            m_pFrameHeaderWriter->framePostfix(frame.cpOutputFrameRef);
+            m_pFrameHeaderWriter->framePostfix(a_frame.cpOutputFrameRef);
         int postfixSize = framePostfix.size();
 
         if (postfixSize > 0) {
             size_t neededFramebufferSize = currentDataSize + postfixSize;
 
-            if (neededFramebufferSize > m_framebuffer.size()) {
-                m_framebuffer.resize(neededFramebufferSize);
+            if (neededFramebufferSize > framebuffer.size()) {
+                framebuffer.resize(neededFramebufferSize);
             }
 
-            memcpy(m_framebuffer.data() + currentDataSize,
+            memcpy(framebuffer.data() + currentDataSize,
                    framePostfix.data(), postfixSize);
             currentDataSize += postfixSize;
         }
     }
 
+    slotBytes = currentDataSize;
+    m_writeSlotsInFlight++;
+
     m_encodingState = EncodingState::WritingFrame;
-    m_bytesToWrite = currentDataSize;
-    m_bytesWritten = 0;
+    m_bytesToWrite += currentDataSize;
     qint64 bytesWritten =
-        m_process.write(m_framebuffer.data(), (qint64)m_bytesToWrite);
+        m_process.write(framebuffer.data(), (qint64)currentDataSize);
 
     if (bytesWritten < 0) {
         m_encodingState = EncodingState::Aborting;
@@ -1649,19 +3555,233 @@ void vsedit::Job::processFramesQueue()
         emit signalLogMessage(tr("Error on writing data to encoder. "
                                  "Aborting."), LOG_STYLE_ERROR);
         cleanUpEncoding();
+        return false;
+    }
+
+    // The slot is retired in slotProcessBytesWritten()
+    // once the whole frame is written to the pipe.
+    return true;
+}
+
+// END OF bool vsedit::Job::writeFrameToEncoder(const Frame & a_frame)
+//==============================================================================
+
+bool vsedit::Job::openChecksumFile()
+{
+    m_checksumResults = ChecksumResults();
+    QString filePath = m_properties.checksumFile.trimmed();
+
+    if (filePath.isEmpty()) {
+        return true;
+    }
+
+    Q_ASSERT(m_cpVideoInfo);
+    ChecksumFile::Mode mode = ChecksumFile::Mode::Write;
+
+    // Segments and resumed parts fill in the file of the whole job.
+    if (m_properties.checksumCompare) {
+        mode = ChecksumFile::Mode::Compare;
+    } else if (sharesScriptProcessor() || canResumeSegments()) {
+        mode = ChecksumFile::Mode::Update;
+    }
+
+    bool opened = m_checksumFile.open(filePath, mode,
+                                      m_cpVideoInfo->format->numPlanes, m_properties.firstFrameReal);
+
+    if (!opened) {
+        emit signalLogMessage(m_checksumFile.errorString(), LOG_STYLE_ERROR);
+        return false;
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::Job::openChecksumFile()
+//==============================================================================
+
+bool vsedit::Job::recordChecksums(const Frame &a_frame)
+{
+    Q_ASSERT(m_cpVSAPI);
+
+    const VSMap *cpProps =
+        m_cpVSAPI->getFramePropsRO(a_frame.cpOutputFrameRef);
+    int planes = m_cpVideoInfo->format->numPlanes;
+    uint32_t checksums[3] = {};
+
+    for (int i = 0; i < planes; ++i) {
+        int error = 0;
+        checksums[i] = (uint32_t)m_cpVSAPI->propGetInt(cpProps,
+                       CHECKSUM_FRAME_PROPERTY, i, &error);
+        Q_ASSERT(!error);
+    }
+
+    int firstDifferingFrame = m_checksumFile.firstDifferingFrame();
+
+    if (!m_checksumFile.addFrame(a_frame.number, checksums)) {
+        return false;
+    }
+
+    if ((firstDifferingFrame < 0) &&
+            (m_checksumFile.firstDifferingFrame() >= 0) &&
+            (!sharesScriptProcessor())) {
+        emit signalLogMessage(tr("Frame %1 differs from the checksum file "
+                                 "in plane %2.").arg(m_checksumFile.firstDifferingFrame())
+                              .arg(m_checksumFile.firstDifferingPlane()), LOG_STYLE_ERROR);
+    }
+
+    return true;
+}
+
+// END OF bool vsedit::Job::recordChecksums(const Frame & a_frame)
+//==============================================================================
+
+void vsedit::Job::closeChecksumFile()
+{
+    if (m_checksumFile.isOpen()) {
+        bool compared =
+            (m_checksumFile.mode() == ChecksumFile::Mode::Compare);
+        m_checksumFile.close();
+
+        if (compared) {
+            m_checksumResults.add(m_checksumFile.results());
+        }
+    }
+
+    if (sharesScriptProcessor() ||
+            (m_encodingState == EncodingState::Aborting) ||
+            (m_checksumResults.framesCompared +
+             m_checksumResults.framesMissing == 0)) {
         return;
     }
 
-    // Wait until encoder reads the frame.
-    // Then this function will be called again.
+    // Reported once per run.
+    ChecksumResults results = m_checksumResults;
+    m_checksumResults = ChecksumResults();
+
+    if (results.framesMissing > 0) {
+        emit signalLogMessage(tr("%1 frames are not in the checksum file.")
+                              .arg(results.framesMissing), LOG_STYLE_WARNING);
+    }
+
+    if (results.framesDiffering > 0) {
+        emit signalLogMessage(tr("%1 of %2 frames differ from the checksum "
+                                 "file. The first one is frame %3, plane %4.")
+                              .arg(results.framesDiffering)
+                              .arg(results.framesCompared)
+                              .arg(results.firstDifferingFrame)
+                              .arg(results.firstDifferingPlane),
+                              LOG_STYLE_ERROR);
+    } else {
+        emit signalLogMessage(tr("All %1 compared frames match the checksum "
+                                 "file.").arg(results.framesCompared),
+                              LOG_STYLE_POSITIVE);
+    }
 }
 
-// END OF void vsedit::Job::processFramesQueue()
+// END OF void vsedit::Job::closeChecksumFile()
+//==============================================================================
+
+void vsedit::Job::startEncoderOutputLog()
+{
+    QDir spoolDir(QStandardPaths::writableLocation(
+                      QStandardPaths::TempLocation));
+    QString spoolPath = spoolDir.filePath(QString("vsedit-encoder-logs/%1.log")
+                                          .arg(QString(m_properties.id.toRfc4122().toHex())));
+
+    if (!m_encoderOutputLog.start(spoolPath)) {
+        emit signalLogMessage(m_encoderOutputLog.errorString(),
+                              LOG_STYLE_WARNING);
+        spoolPath.clear();
+    }
+
+    m_properties.encoderLogFile = spoolPath;
+    m_properties.encoderFps = 0.0;
+    m_properties.encoderBitrate = 0.0;
+    emit signalPropertiesChanged();
+}
+
+// END OF void vsedit::Job::startEncoderOutputLog()
+//==============================================================================
+
+void vsedit::Job::finishEncoderOutputLog()
+{
+    m_encoderOutputLog.append(m_process.readAllStandardError());
+    m_encoderOutputLog.finish();
+
+    // The spool file is gone unless the log has skipped lines of it.
+    if (m_properties.encoderLogFile != m_encoderOutputLog.spoolPath()) {
+        m_properties.encoderLogFile = m_encoderOutputLog.spoolPath();
+        emit signalPropertiesChanged();
+    }
+}
+
+// END OF void vsedit::Job::finishEncoderOutputLog()
+//==============================================================================
+
+qint64 vsedit::Job::writeToEncoder(const QByteArray &a_data)
+{
+    if (fileOutputOpen()) {
+        return m_pEncoderFileWriter->write(a_data);
+    }
+
+    if (encoderPipeAttached()) {
+        return m_pEncoderPipeWriter->write(a_data);
+    }
+
+    return m_process.write(a_data);
+}
+
+// END OF qint64 vsedit::Job::writeToEncoder(const QByteArray & a_data)
+//==============================================================================
+
+bool vsedit::Job::encoderPipeAttached() const
+{
+    return (m_pEncoderPipeWriter && m_pEncoderPipeWriter->isAttached());
+}
+
+// END OF bool vsedit::Job::encoderPipeAttached() const
+//==============================================================================
+
+bool vsedit::Job::fileOutputOpen() const
+{
+    return (m_pEncoderFileWriter && m_pEncoderFileWriter->isOpen());
+}
+
+// END OF bool vsedit::Job::fileOutputOpen() const
+//==============================================================================
+
+void vsedit::Job::setEncoderWait(EncoderWait a_wait)
+{
+    if (a_wait == m_encoderWait) {
+        return;
+    }
+
+    hr_time_point now = hr_clock::now();
+
+    if (m_encoderWait == EncoderWait::Script) {
+        m_properties.scriptWaitTime +=
+            duration_to_double(now - m_encoderWaitStart);
+    } else if (m_encoderWait == EncoderWait::Pipe) {
+        m_properties.pipeStallTime +=
+            duration_to_double(now - m_encoderWaitStart);
+    }
+
+    m_encoderWait = a_wait;
+    m_encoderWaitStart = now;
+}
+
+// END OF void vsedit::Job::setEncoderWait(EncoderWait a_wait)
 //==============================================================================
 
 void vsedit::Job::finishEncodingCLI()
 {
     if ((m_process.state() == QProcess::Running) ||
+            (m_mergeProcess.state() != QProcess::NotRunning) ||
+            m_waitingForEncoderWriters) {
+        return;
+    }
+
+    if (!sharesScriptProcessor() &&
             m_pVapourSynthScriptProcessor->isInitialized()) {
         return;
     }
@@ -1702,3 +3822,49 @@ void vsedit::Job::updateFPS()
 
 // END OF void vsedit::Job::updateFPS()
 //==============================================================================
+
+void vsedit::Job::updateStageTimes()
+{
+    m_properties.runningTime = runningTime();
+    m_properties.packingTime = m_packingTime;
+
+    if (m_pEncoderFileWriter) {
+        m_properties.packingTime += m_pEncoderFileWriter->packingTime();
+    }
+
+    if (m_process.state() != QProcess::Running) {
+        return;
+    }
+
+    // Reading the CPU time is a system call and a file parse.
+    hr_time_point now = hr_clock::now();
+
+    if (duration_to_double(now - m_lastCpuTimeSample) <
+            ENCODER_CPU_TIME_INTERVAL) {
+        return;
+    }
+
+    m_lastCpuTimeSample = now;
+    double cpuTime = processCpuTime(m_process.processId());
+
+    if (cpuTime >= 0.0) {
+        m_properties.encoderCpuTime = cpuTime;
+    }
+}
+
+// END OF void vsedit::Job::updateStageTimes()
+//==============================================================================
+
+double vsedit::Job::runningTime() const
+{
+    double time = m_runningTimeBefore;
+
+    if (m_properties.jobState == JobState::Running) {
+        time += duration_to_double(hr_clock::now() - m_runningSince);
+    }
+
+    return time;
+}
+
+// END OF double vsedit::Job::runningTime() const
+//==============================================================================
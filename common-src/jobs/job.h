@@ -2,12 +2,16 @@
 #define JOB_H_INCLUDED
 
 #include "fps_buffer.h"
+#include "request_window.h"
+#include "checksum_file.h"
+#include "encoder_output_log.h"
 #include "common-src/settings/settings_definitions_core.h"
 #include "common-src/chrono.h"
 #include "common-src/helpers.h"
 #include "common-src/log/styled_log_view_core.h"
 #include "common-src/log/vs_editor_log_definitions.h"
 #include "common-src/vapoursynth/vs_script_processor_structures.h"
+#include "common-src/vapoursynth/frame_reorder_buffer.h"
 #include "common-src/jobs/job_variables.h"
 
 #include <QObject>
@@ -22,6 +26,8 @@ class FrameHeaderWriter;
 
 namespace vsedit {
 
+class EncoderPipeWriter;
+class EncoderFileWriter;
 
 class Job : public QObject, public JobVariables
 {
@@ -44,6 +50,9 @@ public:
         EncoderCrashed,
         Finishing,
         Aborting,
+        // States of a job split into segments or outputs.
+        ProbingSceneChanges,
+        RunningSubJobs,
     };
 
     virtual bool isActive() const;
@@ -60,6 +69,9 @@ public:
     virtual QString scriptText() const;
     virtual bool setScriptText(const QString &a_scriptText);
 
+    virtual EncodingType encodingType() const;
+    virtual bool setEncodingType(EncodingType a_encodingType);
+
     virtual EncodingHeaderType encodingHeaderType() const;
     virtual bool setEncodingHeaderType(EncodingHeaderType a_headerType);
 
@@ -86,6 +98,52 @@ public:
     virtual int lastFrame() const;
     virtual bool setLastFrame(int a_frame);
 
+    virtual int segments() const;
+    virtual bool setSegments(int a_segments);
+
+    virtual QString mergeCommand() const;
+    virtual bool setMergeCommand(const QString &a_command);
+
+    virtual QVector<JobOutput> extraOutputs() const;
+    virtual bool setExtraOutputs(const QVector<JobOutput> &a_outputs);
+
+    virtual int checkpointFrames() const;
+    virtual bool setCheckpointFrames(int a_frames);
+
+    virtual int threads() const;
+    virtual bool setThreads(int a_threads);
+
+    virtual JobPriority priority() const;
+    virtual bool setPriority(JobPriority a_priority);
+
+    // Memory for frames requested from the script and not yet taken
+    // by the encoder. 0 restores the default.
+    virtual size_t framesMemoryBudget() const;
+    virtual bool setFramesMemoryBudget(size_t a_bytes);
+
+    // Threads of the script core granted to the job, applied at once
+    // to a running job. 0 leaves one per logical CPU.
+    virtual int scriptThreads() const;
+    virtual bool setScriptThreads(int a_threads);
+
+    // True if the job was interrupted after some of its segments
+    // or parts had been encoded completely.
+    virtual bool hasCheckpoint() const;
+
+    // Makes an interrupted job wait to be started again, keeping
+    // the segments or parts it has completed.
+    virtual void prepareResume();
+
+    // Makes the job encode one segment of a segmented job, taking frames
+    // from the script processor of that job instead of its own.
+    virtual bool attachAsSegment(
+        VapourSynthScriptProcessor *a_pScriptProcessor, int a_segmentIndex);
+
+    // Makes the job one of the outputs of a job with extra outputs.
+    // It does not request frames, but takes the ones that job requests.
+    virtual bool attachAsOutput(
+        VapourSynthScriptProcessor *a_pScriptProcessor, int a_outputIndex);
+
     virtual int framesProcessed() const;
     virtual int framesTotal() const;
     virtual double fps() const;
@@ -130,6 +188,7 @@ protected slots:
     virtual void slotProcessReadChannelFinished();
     virtual void slotProcessBytesWritten(qint64 a_bytes);
     virtual void slotProcessReadyReadStandardError();
+    virtual void slotEncoderStatsChanged();
 
     virtual void slotWriteLogMessage(int a_messageType,
                                      const QString &a_message);
@@ -141,6 +200,17 @@ protected slots:
                                   const VSFrameRef *a_cpPreviewFrameRef);
     virtual void slotFrameRequestDiscarded(int a_frameNumber,
                                            int a_outputIndex, const QString &a_reason);
+    virtual void slotEncoderWriteError(const QString &a_message);
+    virtual void slotEncoderWriterFinished();
+
+    virtual void slotSubJobStateChanged(JobState a_newState,
+                                         JobState a_oldState);
+    virtual void slotSubJobProgressChanged();
+    virtual void slotSubJobLogMessage(const QString &a_message,
+                                       const QString &a_style);
+    virtual void slotMergeProcessFinished(int a_exitCode,
+                                          QProcess::ExitStatus a_exitStatus);
+    virtual void slotMergeProcessError(QProcess::ProcessError a_error);
 
 protected:
 
@@ -149,6 +219,27 @@ protected:
     virtual void changeStateAndNotify(JobState a_state);
 
     virtual void startEncodeScriptCLI();
+    virtual void startEncodeScriptToFile();
+    virtual void startWritingStream();
+    virtual bool attachToScriptProcessor(
+        VapourSynthScriptProcessor *a_pScriptProcessor);
+    virtual bool sharesScriptProcessor() const;
+    virtual Job *createSubJob(const JobProperties &a_properties);
+    virtual void startSegmentedEncoding();
+    virtual bool canResumeSegments() const;
+    virtual bool encodesPartsInSequence() const;
+    virtual void receiveSceneChangeProbe(int a_frameNumber,
+                                         const VSFrameRef *a_cpFrameRef);
+    virtual void startSegments();
+    virtual void startSegment(int a_segmentIndex);
+    virtual void retrySegment(int a_segmentIndex);
+    virtual void finishSegments();
+    virtual void stopSubJobs();
+    virtual int subJobIndexOf(QObject *a_pSubJob) const;
+    virtual void startOutputs();
+    virtual void requestOutputFrames();
+    virtual void checkOutputsFinished();
+    virtual QString expandSegmentWords(const QString &a_command) const;
     virtual void startRunProcess();
     virtual void startRunShellCommand();
 
@@ -156,18 +247,77 @@ protected:
 
     virtual void clearFramesCache();
 
+    // Bytes of one frame of the script output as packed for the encoder.
+    virtual size_t frameBytes() const;
+
     virtual void processFramesQueue();
 
+    virtual bool writeFrameToEncoder(const Frame &a_frame);
+
+    virtual bool openChecksumFile();
+    virtual bool recordChecksums(const Frame &a_frame);
+    virtual void closeChecksumFile();
+
+    virtual void startEncoderOutputLog();
+    virtual void finishEncoderOutputLog();
+
+    virtual qint64 writeToEncoder(const QByteArray &a_data);
+
+    virtual bool encoderPipeAttached() const;
+
+    virtual bool fileOutputOpen() const;
+
+    // What the encoding loop is blocked on. Time spent in each state
+    // is accumulated into the job properties.
+    enum class EncoderWait {
+        None,
+        Script,
+        Pipe,
+    };
+
+    virtual void setEncoderWait(EncoderWait a_wait);
+
+    // Second half of cleanUpEncoding(), once the encoder writers
+    // have stopped on their own threads.
+    virtual void finishCleanUpEncoding();
+
+    virtual bool encoderWritersRunning() const;
+
     virtual void finishEncodingCLI();
 
     virtual void updateFPS();
 
+    // Updates the time each encoding stage has taken so far.
+    virtual void updateStageTimes();
+
+    virtual double runningTime() const;
+
     JobProperties m_properties;
 
     QProcess m_process;
 
+    // Packing buffer of the QProcess path. QProcess copies what is
+    // written, so one buffer serves every frame.
     std::vector<char> m_framebuffer;
 
+    // Sizes of the frames handed to the encoder whose bytes have not all
+    // been written to the pipe yet, in ring order.
+    std::vector<size_t> m_writeSlots;
+    size_t m_firstWriteSlot;
+    size_t m_writeSlotsInFlight;
+
+    EncoderWait m_encoderWait;
+    hr_time_point m_encoderWaitStart;
+
+    // Packing time of this thread. The file writer packs on its own.
+    double m_packingTime;
+
+    // Running time before the last pause and the start of the current run.
+    double m_runningTimeBefore;
+    hr_time_point m_runningSince;
+
+    hr_time_point m_lastCpuTimeSample;
+
     int m_lastFrameProcessed;
     int m_lastFrameRequested;
 
@@ -188,14 +338,75 @@ protected:
 
     FrameHeaderWriter *m_pFrameHeaderWriter;
 
-    QList<Frame> m_framesCache;
-    int m_cachedFramesLimit;
+    // Writes to the encoder directly from frame memory when the
+    // platform allows it. Otherwise frames go through m_process.
+    EncoderPipeWriter *m_pEncoderPipeWriter;
+
+    // Takes the place of the encoder when the output is a file.
+    EncoderFileWriter *m_pEncoderFileWriter;
+
+    // Set while the clean up waits for the encoder writers to stop.
+    bool m_waitingForEncoderWriters;
+
+    // Frames received from the script and not yet handed to the encoder.
+    // Its base is the next frame to be written.
+    FrameReorderBuffer m_framesCache;
+
+    // Frames requested from the script and not yet taken by the encoder.
+    RequestWindow m_requestWindow;
+
+    ChecksumFile m_checksumFile;
+
+    // Comparison of this job, or of all its completed sub-jobs.
+    // Sub-jobs leave the report to the job they belong to.
+    ChecksumResults m_checksumResults;
+
+    // Standard error of the encoder or the process of the job.
+    EncoderOutputLog m_encoderOutputLog;
+
+    // Memory frames held ahead of the encoder may take.
+    size_t m_framesMemoryBudget;
+
+    int m_scriptThreads;
 
     size_t m_framesInQueue;
     size_t m_framesInProcess;
     size_t m_maxThreads;
 
     FpsBuffer m_fpsBuffer;
+
+    // Index of the segment this job encodes for a segmented job, or -1.
+    // Such a job shares the script processor of the segmented job and
+    // never finalizes it.
+    int m_segmentIndex;
+
+    // Index of the output this job encodes for a job with extra
+    // outputs, or -1. Such a job shares the script processor too.
+    int m_outputIndex;
+
+    // Jobs encoding the segments of this job in frame order,
+    // or its outputs with the main one first.
+    std::vector<Job *> m_subJobs;
+
+    // How far ahead of the slowest output frames are requested.
+    // Every output holds the frames it has not taken yet.
+    int m_outputFramesWindow;
+
+    // Window after a nominal segment start where the first frame marked
+    // as a scene change moves the start to.
+    struct SceneChangeSearch {
+        int segmentIndex;
+        int firstFrame;
+        int lastFrame;
+        int cut;
+    };
+
+    std::vector<SceneChangeSearch> m_sceneChangeSearches;
+    int m_sceneChangeProbesPending;
+    bool m_sceneChangePropFound;
+    bool m_sceneChangeWindowsRequested;
+
+    QProcess m_mergeProcess;
 };
 
 }
@@ -14,6 +14,7 @@ const QString JobVariables::TOKEN_SCRIPT_DIRECTORY = "{sd}";
 const QString JobVariables::TOKEN_SCRIPT_NAME = "{sn}";
 const QString JobVariables::TOKEN_FRAMES_NUMBER = "{f}";
 const QString JobVariables::TOKEN_SUBSAMPLING = "{ss}";
+const QString JobVariables::TOKEN_SEGMENT = "{seg}";
 
 //==============================================================================
 
@@ -84,6 +85,11 @@ void JobVariables::fillVariables()
             TOKEN_SUBSAMPLING, QObject::tr("subsampling string (like 420)"),
             std::function<QString()>()
         },
+        {
+            TOKEN_SEGMENT, QObject::tr("segment or part number in segmented "
+                                       "or resumable encoding (like 003)"),
+            std::function<QString()>()
+        },
     };
 
     std::sort(m_variables.begin(), m_variables.end(),
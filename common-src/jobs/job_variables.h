@@ -26,6 +26,7 @@ protected:
     static const QString TOKEN_SCRIPT_NAME;
     static const QString TOKEN_FRAMES_NUMBER;
     static const QString TOKEN_SUBSAMPLING;
+    static const QString TOKEN_SEGMENT;
 
     virtual void fillVariables();
 
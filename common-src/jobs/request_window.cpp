@@ -0,0 +1,216 @@
+#include "request_window.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//==============================================================================
+
+// Seconds of encoding between two window adjustments.
+static const double CONTROL_PERIOD = 0.5;
+
+// Share of a period the encoder may wait for the script
+// before the window grows.
+static const double STARVED_FRACTION = 0.02;
+
+// Ready frames kept on top of what the encoder takes in a period
+// to absorb uneven frame times of the script.
+static const size_t SPARE_READY_FRAMES = 2;
+
+// Least relative gain in script throughput that makes a larger window
+// worth its memory.
+static const double MIN_GROWTH_GAIN = 1.05;
+
+// Weight of the last period in the measured rates.
+static const double RATE_SMOOTHING = 0.5;
+
+//==============================================================================
+
+vsedit::RequestWindow::RequestWindow():
+    m_minFrames(1)
+    , m_limit(1)
+    , m_frames(1)
+    , m_periodProduced(0)
+    , m_periodConsumed(0)
+    , m_periodMinReady(std::numeric_limits<size_t>::max())
+    , m_periodScriptWaitStart(0.0)
+    , m_lastScriptWaitTime(0.0)
+    , m_produceRate(0.0)
+    , m_consumeRate(0.0)
+    , m_framesBeforeGrowth(0)
+    , m_rateBeforeGrowth(0.0)
+    , m_growthCeiling(0)
+{
+}
+
+// END OF vsedit::RequestWindow::RequestWindow()
+//==============================================================================
+
+void vsedit::RequestWindow::reset(size_t a_minFrames,
+                                  size_t a_initialFrames, size_t a_frameBytes, size_t a_bytesBudget)
+{
+    m_minFrames = std::max(a_minFrames, (size_t)1);
+    m_limit = MAX_FRAMES;
+
+    if (a_frameBytes > 0) {
+        m_limit = std::min(m_limit, a_bytesBudget / a_frameBytes);
+    }
+
+    m_limit = std::max(m_limit, m_minFrames);
+    m_frames = std::min(std::max(a_initialFrames, m_minFrames), m_limit);
+
+    m_produceRate = 0.0;
+    m_consumeRate = 0.0;
+    m_lastScriptWaitTime = 0.0;
+    m_framesBeforeGrowth = 0;
+    m_rateBeforeGrowth = 0.0;
+    m_growthCeiling = 0;
+    restartPeriod();
+}
+
+// END OF void vsedit::RequestWindow::reset(size_t a_minFrames,
+//		size_t a_initialFrames, size_t a_frameBytes, size_t a_bytesBudget)
+//==============================================================================
+
+void vsedit::RequestWindow::restartPeriod()
+{
+    m_periodStart = hr_clock::now();
+    m_periodProduced = 0;
+    m_periodConsumed = 0;
+    m_periodMinReady = std::numeric_limits<size_t>::max();
+    m_periodScriptWaitStart = m_lastScriptWaitTime;
+}
+
+// END OF void vsedit::RequestWindow::restartPeriod()
+//==============================================================================
+
+size_t vsedit::RequestWindow::frames() const
+{
+    return m_frames;
+}
+
+// END OF size_t vsedit::RequestWindow::frames() const
+//==============================================================================
+
+size_t vsedit::RequestWindow::limit() const
+{
+    return m_limit;
+}
+
+// END OF size_t vsedit::RequestWindow::limit() const
+//==============================================================================
+
+double vsedit::RequestWindow::produceRate() const
+{
+    return m_produceRate;
+}
+
+// END OF double vsedit::RequestWindow::produceRate() const
+//==============================================================================
+
+double vsedit::RequestWindow::consumeRate() const
+{
+    return m_consumeRate;
+}
+
+// END OF double vsedit::RequestWindow::consumeRate() const
+//==============================================================================
+
+void vsedit::RequestWindow::frameProduced()
+{
+    m_periodProduced++;
+}
+
+// END OF void vsedit::RequestWindow::frameProduced()
+//==============================================================================
+
+void vsedit::RequestWindow::framesConsumed(size_t a_frames,
+        size_t a_readyFrames, double a_scriptWaitTime)
+{
+    m_periodConsumed += a_frames;
+    m_periodMinReady = std::min(m_periodMinReady, a_readyFrames);
+    m_lastScriptWaitTime = a_scriptWaitTime;
+
+    double periodTime = duration_to_double(hr_clock::now() - m_periodStart);
+
+    if (periodTime < CONTROL_PERIOD) {
+        return;
+    }
+
+    adjust(periodTime, a_scriptWaitTime - m_periodScriptWaitStart);
+    restartPeriod();
+}
+
+// END OF void vsedit::RequestWindow::framesConsumed(size_t a_frames,
+//		size_t a_readyFrames, double a_scriptWaitTime)
+//==============================================================================
+
+void vsedit::RequestWindow::adjust(double a_periodTime, double a_starvedTime)
+{
+    double produceRate = (double)m_periodProduced / a_periodTime;
+    double consumeRate = (double)m_periodConsumed / a_periodTime;
+
+    if (m_consumeRate > 0.0) {
+        produceRate = RATE_SMOOTHING * produceRate +
+                      (1.0 - RATE_SMOOTHING) * m_produceRate;
+        consumeRate = RATE_SMOOTHING * consumeRate +
+                      (1.0 - RATE_SMOOTHING) * m_consumeRate;
+    }
+
+    m_produceRate = produceRate;
+    m_consumeRate = consumeRate;
+
+    bool starved = (a_starvedTime > a_periodTime * STARVED_FRACTION);
+
+    if (m_framesBeforeGrowth > 0) {
+        // The last growth did not make the script faster. All its threads
+        // are busy already, so the extra frames only take memory.
+        if (m_produceRate < m_rateBeforeGrowth * MIN_GROWTH_GAIN) {
+            m_frames = m_framesBeforeGrowth;
+            m_growthCeiling = m_frames;
+            m_framesBeforeGrowth = 0;
+            return;
+        }
+
+        m_framesBeforeGrowth = 0;
+    }
+
+    if (starved) {
+        size_t ceiling = (m_growthCeiling > 0) ? m_growthCeiling : m_limit;
+
+        if (m_frames >= ceiling) {
+            return;
+        }
+
+        // Throughput of a script that is not saturated grows with the
+        // frames in flight. Grow by the rate the encoder could take
+        // over the rate the script delivered, at most twice a period.
+        double busyTime = std::max(a_periodTime - a_starvedTime,
+                                   a_periodTime * STARVED_FRACTION);
+        double demandRate = (double)m_periodConsumed / busyTime;
+        double deliveredRate = std::max((double)m_periodProduced / a_periodTime,
+                                        1.0 / a_periodTime);
+        double scale = std::min(demandRate / deliveredRate, 2.0);
+        size_t frames = (size_t)std::ceil((double)m_frames * scale);
+        frames = std::max(frames, m_frames + 1);
+
+        m_framesBeforeGrowth = m_frames;
+        m_rateBeforeGrowth = m_produceRate;
+        m_frames = std::min(frames, ceiling);
+        return;
+    }
+
+    // The encoder is the slower side. Frames that stayed ready through
+    // the whole period were requested earlier than needed.
+    if ((m_periodMinReady != std::numeric_limits<size_t>::max()) &&
+            (m_periodMinReady > SPARE_READY_FRAMES)) {
+        size_t surplus = (m_periodMinReady - SPARE_READY_FRAMES + 1) / 2;
+        m_frames -= std::min(surplus, m_frames - m_minFrames);
+        // The script may have got lighter since it saturated.
+        m_growthCeiling = 0;
+    }
+}
+
+// END OF void vsedit::RequestWindow::adjust(double a_periodTime,
+//		double a_starvedTime)
+//==============================================================================
@@ -0,0 +1,75 @@
+#ifndef REQUEST_WINDOW_H_INCLUDED
+#define REQUEST_WINDOW_H_INCLUDED
+
+#include "common-src/chrono.h"
+
+#include <cstddef>
+
+namespace vsedit {
+
+// Decides how many frames an encoding job keeps requested ahead of the
+// encoder. The window grows while the encoder waits for the script and
+// shrinks while finished frames sit unused because the encoder is slower.
+// It never holds more frames than fit into the memory budget.
+class RequestWindow
+{
+public:
+
+    // Hard cap on the window no matter how small the frames are.
+    static const size_t MAX_FRAMES = 1024;
+
+    RequestWindow();
+
+    // Starts over with the initial window. The window stays between
+    // a_minFrames and the number of a_frameBytes frames in a_bytesBudget.
+    void reset(size_t a_minFrames, size_t a_initialFrames,
+               size_t a_frameBytes, size_t a_bytesBudget);
+
+    // Forgets the current measurement period, after a pause for example.
+    void restartPeriod();
+
+    size_t frames() const;
+    size_t limit() const;
+
+    // Frames per second measured over the recent periods.
+    double produceRate() const;
+    double consumeRate() const;
+
+    void frameProduced();
+
+    // a_readyFrames - frames received from the script and still held.
+    // a_scriptWaitTime - total seconds the encoder has waited for
+    // the script so far.
+    void framesConsumed(size_t a_frames, size_t a_readyFrames,
+                        double a_scriptWaitTime);
+
+private:
+
+    void adjust(double a_periodTime, double a_starvedTime);
+
+    size_t m_minFrames;
+    size_t m_limit;
+    size_t m_frames;
+
+    hr_time_point m_periodStart;
+    size_t m_periodProduced;
+    size_t m_periodConsumed;
+    size_t m_periodMinReady;
+    double m_periodScriptWaitStart;
+    double m_lastScriptWaitTime;
+
+    double m_produceRate;
+    double m_consumeRate;
+
+    // Window before the last growth, kept until the growth is
+    // known to pay off. Zero otherwise.
+    size_t m_framesBeforeGrowth;
+    double m_rateBeforeGrowth;
+
+    // Window the script was found saturated at. Zero if unknown.
+    size_t m_growthCeiling;
+};
+
+}
+
+#endif // REQUEST_WINDOW_H_INCLUDED
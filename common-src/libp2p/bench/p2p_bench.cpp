@@ -0,0 +1,617 @@
+// Correctness and throughput harness for libp2p.
+//
+// Every packing is run through its line pack and unpack functions. Each SIMD
+// kernel the CPU supports, and the function the C API dispatches to, is
+// compared bit for bit with the scalar template instantiation, both on short
+// rows with odd widths and offsets and on whole frames at several resolutions
+// and strides. Throughput is reported per ISA level in GB/s and in TSC cycles
+// per pixel.
+//
+// Usage: p2p_bench [--json FILE] [--filter NAME] [--min-time SECONDS] [--check-only]
+//
+// The exit code is non-zero if any output differs from the reference.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../p2p.h"
+#include "../p2p_api.h"
+#include "p2p_bench.h"
+
+#ifdef P2P_SIMD
+#include "../simd/cpuinfo_x86.h"
+#include "../simd/p2p_simd.h"
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define P2P_BENCH_HAVE_TSC
+#endif
+
+using p2p_bench::format_info;
+using p2p_bench::reference_format;
+
+namespace {
+
+struct kernel {
+    const char *isa;
+    p2p_unpack_func unpack;
+    p2p_pack_func pack;
+    p2p_pack_func pack_one_fill;
+};
+
+struct simd_kernel {
+    enum p2p_packing packing;
+    kernel funcs;
+    bool (*supported)();
+};
+
+struct resolution {
+    unsigned width;
+    unsigned height;
+};
+
+// Extra bytes added to the tight row size. A zero pad keeps rows 64-byte
+// aligned; the odd pad keeps them only sample aligned.
+struct stride_mode {
+    const char *name;
+    unsigned pad;
+};
+
+struct options {
+    const char *json_path = nullptr;
+    const char *filter = nullptr;
+    double min_seconds = 0.05;
+    bool check_only = false;
+};
+
+struct bench_result {
+    std::string packing;
+    std::string isa;
+    const char *op;
+    unsigned width;
+    unsigned height;
+    const char *stride;
+    double seconds;
+    double gbps;
+    double mpix_per_s;
+    double cycles_per_pixel;
+};
+
+const resolution resolutions[] = {
+    { 720, 480 },
+    { 1920, 1080 },
+    { 3840, 2160 },
+};
+
+const stride_mode stride_modes[] = {
+    { "aligned", 0 },
+    { "unaligned", 8 },
+};
+
+// Bytes of slack after every buffer. Kernels that read or write past the
+// end of a row show up as a mismatch in this area.
+const size_t guard_bytes = 128;
+const uint8_t guard_value = 0xA5;
+
+bool little_endian_native()
+{
+    return std::is_same<p2p::native_endian_t, p2p::little_endian_t>::value;
+}
+
+#ifdef P2P_SIMD
+bool has_sse41()
+{
+    return p2p::simd::query_x86_capabilities().sse41;
+}
+
+bool has_avx2()
+{
+    return p2p::simd::query_x86_capabilities().avx2;
+}
+
+bool has_avx512()
+{
+    p2p::simd::X86Capabilities caps = p2p::simd::query_x86_capabilities();
+    return caps.avx512f && caps.avx512bw;
+}
+
+#define KERNEL(format, cpu) \
+	{ p2p_##format, { #cpu, p2p::simd::unpack_##format##_##cpu, p2p::simd::pack_##format##_0_##cpu, p2p::simd::pack_##format##_1_##cpu }, has_##cpu }
+// The native packing resolves to the _le or _be kernel of the host.
+#define KERNEL_NATIVE(format, cpu) \
+	{ p2p_##format, { #cpu, \
+	  little_endian_native() ? p2p::simd::unpack_##format##_le_##cpu : p2p::simd::unpack_##format##_be_##cpu, \
+	  little_endian_native() ? p2p::simd::pack_##format##_le_0_##cpu : p2p::simd::pack_##format##_be_0_##cpu, \
+	  little_endian_native() ? p2p::simd::pack_##format##_le_1_##cpu : p2p::simd::pack_##format##_be_1_##cpu }, has_##cpu }
+#define KERNEL3(format, cpu) KERNEL(format##_be, cpu), KERNEL(format##_le, cpu), KERNEL_NATIVE(format, cpu)
+const simd_kernel simd_kernels[] = {
+    KERNEL3(argb32, sse41),
+    KERNEL3(rgba32, sse41),
+    KERNEL3(rgb30, sse41),
+    KERNEL3(y410, sse41),
+    KERNEL3(nv12, sse41),
+    KERNEL3(p010, sse41),
+    KERNEL3(argb32, avx2),
+    KERNEL3(rgba32, avx2),
+    KERNEL3(rgb30, avx2),
+    KERNEL3(y410, avx2),
+    KERNEL3(nv12, avx2),
+    KERNEL3(p010, avx2),
+    KERNEL3(argb32, avx512),
+    KERNEL3(rgba32, avx512),
+};
+#undef KERNEL3
+#undef KERNEL_NATIVE
+#undef KERNEL
+#endif // P2P_SIMD
+
+// Kernels to compare with the reference: the function the C API dispatches
+// to, followed by every ISA-specific kernel the CPU can run.
+std::vector<kernel> candidate_kernels(const format_info &fmt)
+{
+    std::vector<kernel> kernels;
+    kernels.push_back({ "dispatch", p2p_select_unpack_func(fmt.packing),
+                        p2p_select_pack_func_ex(fmt.packing, 0),
+                        p2p_select_pack_func_ex(fmt.packing, 1) });
+
+#ifdef P2P_SIMD
+    for (const simd_kernel &k : simd_kernels) {
+        if (k.packing == fmt.packing && k.supported()) {
+            kernels.push_back(k.funcs);
+        }
+    }
+#endif
+
+    return kernels;
+}
+
+// Kernels to time: scalar reference and each supported ISA level.
+std::vector<kernel> timed_kernels(const format_info &fmt)
+{
+    std::vector<kernel> kernels;
+    kernels.push_back({ "scalar", fmt.unpack, fmt.pack, fmt.pack_one_fill });
+
+    std::vector<kernel> candidates = candidate_kernels(fmt);
+    kernels.insert(kernels.end(), candidates.begin() + 1, candidates.end());
+    return kernels;
+}
+
+unsigned plane_width(const format_info &fmt, unsigned plane, unsigned width)
+{
+    return (plane == 1 || plane == 2) ? (width + (1U << fmt.subsample_w) - 1) >> fmt.subsample_w : width;
+}
+
+size_t packed_row_bytes(const format_info &fmt, unsigned width)
+{
+    return (width + fmt.pel_per_pack - 1) / fmt.pel_per_pack * fmt.pack_bytes;
+}
+
+// Rows processed by the line functions. For NV formats only the
+// interleaved chroma plane goes through them.
+unsigned kernel_rows(const format_info &fmt, unsigned height)
+{
+    return height >> fmt.subsample_h;
+}
+
+// Alignment unit for row offsets and widths of partial rows.
+unsigned pixel_step(const format_info &fmt)
+{
+    return fmt.subsample_w ? 2 : 1;
+}
+
+struct buffer {
+    std::vector<uint8_t> data;
+    ptrdiff_t stride = 0;
+
+    uint8_t *row(unsigned i)
+    {
+        return data.data() + i * stride;
+    }
+};
+
+struct frame {
+    buffer planes[4];
+    buffer packed;
+};
+
+buffer make_buffer(size_t row_bytes, unsigned rows, unsigned pad)
+{
+    buffer buf;
+    buf.stride = ((row_bytes + 63) & ~static_cast<size_t>(63)) + pad;
+    buf.data.assign(buf.stride * rows + guard_bytes, guard_value);
+    return buf;
+}
+
+// Random samples kept within the depth of each plane, so that every
+// kernel sees valid input and must produce identical output.
+void fill_planar(const format_info &fmt, buffer &buf, unsigned plane, unsigned width, unsigned rows, std::mt19937 &rng)
+{
+    uint32_t mask = (fmt.depth[plane] >= 32) ? ~0U : (1U << fmt.depth[plane]) - 1;
+
+    for (unsigned y = 0; y < rows; ++y) {
+        uint8_t *row = buf.row(y);
+
+        for (unsigned x = 0; x < width; ++x) {
+            uint32_t value = rng() & mask;
+
+            if (fmt.planar_bytes == 1) {
+                row[x] = static_cast<uint8_t>(value);
+            } else {
+                uint16_t sample = static_cast<uint16_t>(value);
+                std::memcpy(row + x * 2, &sample, 2);
+            }
+        }
+    }
+}
+
+void fill_random(buffer &buf, size_t row_bytes, unsigned rows, std::mt19937 &rng)
+{
+    for (unsigned y = 0; y < rows; ++y) {
+        uint8_t *row = buf.row(y);
+
+        for (size_t x = 0; x < row_bytes; x += 4) {
+            uint32_t value = rng();
+            std::memcpy(row + x, &value, std::min<size_t>(4, row_bytes - x));
+        }
+    }
+}
+
+frame make_frame(const format_info &fmt, unsigned width, unsigned height, unsigned pad, bool alpha)
+{
+    frame f;
+    unsigned rows = kernel_rows(fmt, height);
+
+    for (unsigned p = 0; p < 4; ++p) {
+        if (fmt.depth[p] && (p != 3 || alpha)) {
+            f.planes[p] = make_buffer(plane_width(fmt, p, width) * fmt.planar_bytes, rows, pad);
+        }
+    }
+
+    f.packed = make_buffer(packed_row_bytes(fmt, width), rows, pad);
+    return f;
+}
+
+void fill_frame(const format_info &fmt, frame &f, unsigned width, unsigned height, std::mt19937 &rng)
+{
+    unsigned rows = kernel_rows(fmt, height);
+
+    for (unsigned p = 0; p < 4; ++p) {
+        if (!f.planes[p].data.empty()) {
+            fill_planar(fmt, f.planes[p], p, plane_width(fmt, p, width), rows, rng);
+        }
+    }
+
+    fill_random(f.packed, packed_row_bytes(fmt, width), rows, rng);
+}
+
+void pack_rows(p2p_pack_func func, frame &f, unsigned first_row, unsigned rows, unsigned left, unsigned right)
+{
+    for (unsigned y = first_row; y < first_row + rows; ++y) {
+        const void *src[4] = {};
+
+        for (unsigned p = 0; p < 4; ++p) {
+            src[p] = f.planes[p].data.empty() ? nullptr : f.planes[p].row(y);
+        }
+
+        func(src, f.packed.row(y), left, right);
+    }
+}
+
+void unpack_rows(p2p_unpack_func func, frame &f, unsigned first_row, unsigned rows, unsigned left, unsigned right)
+{
+    for (unsigned y = first_row; y < first_row + rows; ++y) {
+        void *dst[4] = {};
+
+        for (unsigned p = 0; p < 4; ++p) {
+            dst[p] = f.planes[p].data.empty() ? nullptr : f.planes[p].row(y);
+        }
+
+        func(f.packed.row(y), dst, left, right);
+    }
+}
+
+bool same_planes(const frame &a, const frame &b)
+{
+    for (unsigned p = 0; p < 4; ++p) {
+        if (a.planes[p].data != b.planes[p].data) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+class checker
+{
+public:
+
+    // Runs pack and unpack of every candidate on the given geometry and
+    // compares every byte of the output buffers, guard area included.
+    void check(const format_info &fmt, const std::vector<kernel> &kernels, unsigned width,
+               unsigned height, unsigned left, unsigned pad, std::mt19937 &rng)
+    {
+        unsigned rows = kernel_rows(fmt, height);
+
+        for (int alpha = 0; alpha < (fmt.depth[3] ? 2 : 1); ++alpha) {
+            frame input = make_frame(fmt, width, height, pad, alpha != 0);
+            fill_frame(fmt, input, width, height, rng);
+
+            for (int fill = 0; fill < 2; ++fill) {
+                frame expected = input;
+                pack_rows(fill ? fmt.pack_one_fill : fmt.pack, expected, 0, rows, left, width);
+
+                for (const kernel &k : kernels) {
+                    frame actual = input;
+                    pack_rows(fill ? k.pack_one_fill : k.pack, actual, 0, rows, left, width);
+                    record(expected.packed.data == actual.packed.data, fmt, k,
+                           fill ? "pack_one_fill" : "pack", width, height, left, pad, alpha != 0);
+                }
+            }
+
+            frame expected = input;
+            unpack_rows(fmt.unpack, expected, 0, rows, left, width);
+
+            for (const kernel &k : kernels) {
+                frame actual = input;
+                unpack_rows(k.unpack, actual, 0, rows, left, width);
+                record(same_planes(expected, actual), fmt, k, "unpack", width, height, left, pad, alpha != 0);
+            }
+        }
+    }
+
+    unsigned checked() const
+    {
+        return m_checked;
+    }
+
+    const std::vector<std::string> &failures() const
+    {
+        return m_failures;
+    }
+
+private:
+
+    void record(bool ok, const format_info &fmt, const kernel &k, const char *op,
+                unsigned width, unsigned height, unsigned left, unsigned pad, bool alpha)
+    {
+        ++m_checked;
+
+        if (ok) {
+            return;
+        }
+
+        char text[256];
+        std::snprintf(text, sizeof(text), "%s %s %s %ux%u left=%u pad=%u alpha=%d",
+                      fmt.name, k.isa, op, width, height, left, pad, alpha ? 1 : 0);
+        std::fprintf(stderr, "MISMATCH: %s\n", text);
+        m_failures.push_back(text);
+    }
+
+    unsigned m_checked = 0;
+    std::vector<std::string> m_failures;
+};
+
+// Short rows catch head and tail handling around the vector width.
+void check_rows(const format_info &fmt, checker &chk, std::mt19937 &rng)
+{
+    const unsigned lefts[] = { 0, 1, 2, 3, 5, 17 };
+    std::vector<kernel> kernels = candidate_kernels(fmt);
+    unsigned step = pixel_step(fmt);
+
+    for (unsigned width = step; width <= 160; width += step) {
+        for (unsigned left : lefts) {
+            if (left % step == 0 && left < width) {
+                chk.check(fmt, kernels, width, 2, left, 8, rng);
+            }
+        }
+    }
+}
+
+template <class F>
+double run(F func, double min_seconds, uint64_t *ticks)
+{
+    typedef std::chrono::steady_clock clock;
+
+    func();
+
+    unsigned iterations = 0;
+    clock::time_point start = clock::now();
+#ifdef P2P_BENCH_HAVE_TSC
+    uint64_t start_ticks = __rdtsc();
+#endif
+    double elapsed = 0.0;
+
+    do {
+        func();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < min_seconds || iterations < 3);
+
+#ifdef P2P_BENCH_HAVE_TSC
+    *ticks = (__rdtsc() - start_ticks) / iterations;
+#else
+    *ticks = 0;
+#endif
+    return elapsed / iterations;
+}
+
+// Bytes read and written by one pass of the line functions over a frame.
+double frame_bytes(const format_info &fmt, unsigned width, unsigned height)
+{
+    double bytes_per_row = static_cast<double>(packed_row_bytes(fmt, width));
+
+    for (unsigned p = 0; p < 3; ++p) {
+        if (fmt.depth[p]) {
+            bytes_per_row += plane_width(fmt, p, width) * fmt.planar_bytes;
+        }
+    }
+
+    return bytes_per_row * kernel_rows(fmt, height);
+}
+
+void bench_format(const format_info &fmt, const options &opt, checker &chk,
+                  std::vector<bench_result> &results, std::mt19937 &rng)
+{
+    std::vector<kernel> candidates = candidate_kernels(fmt);
+    std::vector<kernel> kernels = timed_kernels(fmt);
+
+    for (const resolution &res : resolutions) {
+        for (const stride_mode &stride : stride_modes) {
+            chk.check(fmt, candidates, res.width, res.height, 0, stride.pad, rng);
+
+            if (opt.check_only) {
+                continue;
+            }
+
+            // The preview and encoders pack without an alpha plane.
+            frame input = make_frame(fmt, res.width, res.height, stride.pad, false);
+            fill_frame(fmt, input, res.width, res.height, rng);
+
+            for (const kernel &k : kernels) {
+                frame work = input;
+                unsigned rows = kernel_rows(fmt, res.height);
+                double pixels = static_cast<double>(res.width) * res.height;
+                double bytes = frame_bytes(fmt, res.width, res.height);
+
+                uint64_t ticks = 0;
+                double pack_time = run([&]() {
+                    pack_rows(k.pack_one_fill, work, 0, rows, 0, res.width);
+                }, opt.min_seconds, &ticks);
+                results.push_back({ fmt.name, k.isa, "pack", res.width, res.height, stride.name,
+                                    pack_time, bytes / pack_time * 1e-9, pixels / pack_time * 1e-6,
+                                    ticks / pixels });
+
+                double unpack_time = run([&]() {
+                    unpack_rows(k.unpack, work, 0, rows, 0, res.width);
+                }, opt.min_seconds, &ticks);
+                results.push_back({ fmt.name, k.isa, "unpack", res.width, res.height, stride.name,
+                                    unpack_time, bytes / unpack_time * 1e-9, pixels / unpack_time * 1e-6,
+                                    ticks / pixels });
+
+                for (size_t i = results.size() - 2; i < results.size(); ++i) {
+                    const bench_result &r = results[i];
+                    std::printf("%-10s %-8s %-6s %4ux%-4u %-9s %9.1f Mpix/s %7.2f GB/s %7.2f cyc/px\n",
+                                r.packing.c_str(), r.isa.c_str(), r.op, r.width, r.height, r.stride,
+                                r.mpix_per_s, r.gbps, r.cycles_per_pixel);
+                }
+            }
+        }
+    }
+}
+
+void write_json(const char *path, const std::vector<bench_result> &results, const checker &chk)
+{
+    FILE *file = std::strcmp(path, "-") ? std::fopen(path, "w") : stdout;
+
+    if (!file) {
+        std::fprintf(stderr, "Can not open %s for writing.\n", path);
+        return;
+    }
+
+    std::fprintf(file, "{\n  \"version\": 1,\n");
+    std::fprintf(file, "  \"timestamp\": %lld,\n", static_cast<long long>(
+                     std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::system_clock::now().time_since_epoch()).count()));
+
+#ifdef P2P_SIMD
+    p2p::simd::X86Capabilities caps = p2p::simd::query_x86_capabilities();
+    std::fprintf(file, "  \"cpu\": { \"sse41\": %s, \"avx2\": %s, \"avx512f\": %s, \"avx512bw\": %s },\n",
+                 caps.sse41 ? "true" : "false", caps.avx2 ? "true" : "false",
+                 caps.avx512f ? "true" : "false", caps.avx512bw ? "true" : "false");
+#endif
+
+    std::fprintf(file, "  \"checks\": %u,\n  \"mismatches\": [", chk.checked());
+
+    for (size_t i = 0; i < chk.failures().size(); ++i) {
+        std::fprintf(file, "%s\n    \"%s\"", i ? "," : "", chk.failures()[i].c_str());
+    }
+
+    std::fprintf(file, "%s],\n  \"results\": [", chk.failures().empty() ? "" : "\n  ");
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const bench_result &r = results[i];
+        std::fprintf(file, "%s\n    { \"packing\": \"%s\", \"isa\": \"%s\", \"op\": \"%s\", "
+                     "\"width\": %u, \"height\": %u, \"stride\": \"%s\", \"seconds\": %.9f, "
+                     "\"gbps\": %.4f, \"mpix_per_s\": %.2f, \"cycles_per_pixel\": %.4f }",
+                     i ? "," : "", r.packing.c_str(), r.isa.c_str(), r.op, r.width, r.height,
+                     r.stride, r.seconds, r.gbps, r.mpix_per_s, r.cycles_per_pixel);
+    }
+
+    std::fprintf(file, "%s]\n}\n", results.empty() ? "" : "\n  ");
+
+    if (file != stdout) {
+        std::fclose(file);
+    }
+}
+
+bool parse_options(int argc, char **argv, options &opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--json" && has_value) {
+            opt.json_path = argv[++i];
+        } else if (arg == "--filter" && has_value) {
+            opt.filter = argv[++i];
+        } else if (arg == "--min-time" && has_value) {
+            opt.min_seconds = std::atof(argv[++i]);
+        } else if (arg == "--check-only") {
+            opt.check_only = true;
+        } else {
+            std::fprintf(stderr, "Usage: %s [--json FILE] [--filter NAME] "
+                         "[--min-time SECONDS] [--check-only]\n", argv[0]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+int main(int argc, char **argv)
+{
+    options opt;
+
+    if (!parse_options(argc, argv, opt)) {
+        return 2;
+    }
+
+    std::mt19937 rng(0x70327032);
+    checker chk;
+    std::vector<bench_result> results;
+
+    for (int i = 0; i < p2p_packing_max; ++i) {
+        const format_info &fmt = reference_format(static_cast<p2p_packing>(i));
+
+        if (opt.filter && !std::strstr(fmt.name, opt.filter)) {
+            continue;
+        }
+
+        check_rows(fmt, chk, rng);
+        bench_format(fmt, opt, chk, results, rng);
+    }
+
+    std::printf("%u checks, %u mismatches\n", chk.checked(),
+                static_cast<unsigned>(chk.failures().size()));
+
+    if (opt.json_path) {
+        write_json(opt.json_path, results, chk);
+    }
+
+    return chk.failures().empty() ? 0 : 1;
+}
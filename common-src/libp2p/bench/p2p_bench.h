@@ -0,0 +1,29 @@
+#ifndef P2P_BENCH_H_
+#define P2P_BENCH_H_
+
+#include "../p2p_api.h"
+
+namespace p2p_bench {
+
+// Layout of a packing and its scalar reference line functions. The
+// reference is built from the templates without runtime SIMD dispatch.
+struct format_info {
+    enum p2p_packing packing;
+    const char *name;
+    p2p_unpack_func unpack;
+    p2p_pack_func pack;
+    p2p_pack_func pack_one_fill;
+    unsigned planar_bytes;  // Bytes per planar sample.
+    unsigned pack_bytes;    // Bytes per packed word.
+    unsigned pel_per_pack;  // Pixels per packed word.
+    unsigned subsample_w;
+    unsigned subsample_h;
+    bool is_nv;
+    unsigned depth[4];      // Significant bits per planar plane, 0 if unused.
+};
+
+const format_info &reference_format(enum p2p_packing packing);
+
+} // namespace p2p_bench
+
+#endif // P2P_BENCH_H_
@@ -0,0 +1,108 @@
+// Scalar reference instantiation of libp2p for the benchmark. It lives in its
+// own namespace so that it can be linked next to the dispatching library.
+
+#undef P2P_SIMD
+#define P2P_USER_NAMESPACE p2p_ref
+
+#include <cassert>
+#include "../p2p.h"
+// The v210 specializations are not templates, so build a private copy.
+#include "../v210.cpp"
+#include "p2p_bench.h"
+
+namespace p2p_bench {
+
+namespace {
+
+template <class Traits>
+format_info make_format(enum p2p_packing packing, const char *name,
+                        unsigned subsample_h = 0, bool is_nv = false)
+{
+    format_info info = {};
+    info.packing = packing;
+    info.name = name;
+    info.unpack = &p2p_ref::packed_to_planar<Traits>::unpack;
+    info.pack = &p2p_ref::planar_to_packed<Traits, false>::pack;
+    info.pack_one_fill = &p2p_ref::planar_to_packed<Traits, true>::pack;
+    info.planar_bytes = sizeof(typename Traits::planar_type);
+    info.pack_bytes = sizeof(typename Traits::packed_type);
+    info.pel_per_pack = Traits::pel_per_pack;
+    info.subsample_w = Traits::subsampling;
+    info.subsample_h = subsample_h;
+    info.is_nv = is_nv;
+
+    for (unsigned i = 0; i < 4; ++i) {
+        unsigned plane = Traits::component_mask[i];
+
+        if (plane < 4 && info.depth[plane] == 0) {
+            info.depth[plane] = Traits::depth_mask[i];
+        }
+    }
+
+    return info;
+}
+
+// v210 packs 6 pixels of 4:2:2 10-bit video in 4 DWORDs.
+template <class Traits>
+format_info make_v210_format(enum p2p_packing packing, const char *name)
+{
+    format_info info = {};
+    info.packing = packing;
+    info.name = name;
+    info.unpack = &p2p_ref::packed_to_planar<Traits>::unpack;
+    info.pack = &p2p_ref::planar_to_packed<Traits, false>::pack;
+    info.pack_one_fill = &p2p_ref::planar_to_packed<Traits, true>::pack;
+    info.planar_bytes = 2;
+    info.pack_bytes = 16;
+    info.pel_per_pack = 6;
+    info.subsample_w = 1;
+    info.depth[0] = info.depth[1] = info.depth[2] = 10;
+    return info;
+}
+
+#define FORMAT(x, ...) make_format<p2p_ref::packed_##x>(p2p_##x, #x, ##__VA_ARGS__)
+#define FORMAT3(x, ...) FORMAT(x##_be, ##__VA_ARGS__), FORMAT(x##_le, ##__VA_ARGS__), FORMAT(x, ##__VA_ARGS__)
+#define V210(x) make_v210_format<p2p_ref::packed_##x>(p2p_##x, #x)
+const format_info formats[] = {
+    FORMAT3(rgb24),
+    FORMAT3(argb32),
+    FORMAT3(ayuv),
+    FORMAT3(rgb48),
+    FORMAT3(argb64),
+    FORMAT3(rgb30),
+    FORMAT3(y410),
+    FORMAT3(y416),
+    FORMAT(yuy2),
+    FORMAT(uyvy),
+    FORMAT3(y210),
+    FORMAT3(y216),
+    V210(v210_be), V210(v210_le), V210(v210),
+    FORMAT3(v216),
+    FORMAT3(nv12, 1, true),
+    FORMAT3(p010, 1, true),
+    FORMAT3(p016, 1, true),
+    FORMAT3(p210, 0, true),
+    FORMAT3(p216, 0, true),
+    FORMAT3(rgba32),
+    FORMAT3(rgba64),
+    FORMAT3(abgr64),
+    FORMAT3(bgr48),
+    FORMAT3(bgra64),
+};
+#undef V210
+#undef FORMAT3
+#undef FORMAT
+
+static_assert(sizeof(formats) / sizeof(formats[0]) == p2p_packing_max, "every packing must be listed");
+
+} // namespace
+
+
+const format_info &reference_format(enum p2p_packing packing)
+{
+    const format_info &info = formats[packing];
+    assert(info.packing == packing);
+    return info;
+}
+
+} // namespace p2p_bench
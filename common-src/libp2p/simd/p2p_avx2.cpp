@@ -0,0 +1,469 @@
+#ifdef P2P_SIMD
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)
+
+#include <cstdint>
+#include <immintrin.h>
+#include "../p2p.h"
+#include "p2p_simd.h"
+
+namespace P2P_NAMESPACE {
+namespace simd {
+
+namespace {
+
+// 4x4 transpose of DWORDs within each 128-bit lane.
+inline void transpose4_epi32(__m256i &x0, __m256i &x1, __m256i &x2, __m256i &x3)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(x0, x1);
+    __m256i t1 = _mm256_unpacklo_epi32(x2, x3);
+    __m256i t2 = _mm256_unpackhi_epi32(x0, x1);
+    __m256i t3 = _mm256_unpackhi_epi32(x2, x3);
+
+    x0 = _mm256_unpacklo_epi64(t0, t1);
+    x1 = _mm256_unpackhi_epi64(t0, t1);
+    x2 = _mm256_unpacklo_epi64(t2, t3);
+    x3 = _mm256_unpackhi_epi64(t2, t3);
+}
+
+template <unsigned IdxR, unsigned IdxG, unsigned IdxB, unsigned IdxA>
+void unpack_rgb32_avx2(const void *src, void *const *dst, unsigned left, unsigned right, detail::unpack_func tail)
+{
+    const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_set_epi8(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0));
+    const __m256i permute = _mm256_set_epi32(7, 3, 6, 2, 5, 1, 4, 0);
+
+    const uint32_t *src_p = static_cast<const uint32_t *>(src);
+    uint8_t *dst_r = static_cast<uint8_t *>(dst[0]);
+    uint8_t *dst_g = static_cast<uint8_t *>(dst[1]);
+    uint8_t *dst_b = static_cast<uint8_t *>(dst[2]);
+    uint8_t *dst_a = static_cast<uint8_t *>(dst[3]);
+
+    if (!dst_a) {
+        dst_a = dst_r;    // Write alpha to some other channel if disabled.
+    }
+
+    size_t vec32_left = (left + 31) & ~31U;
+    size_t vec32_right = right & ~31U;
+
+    if (vec32_left >= vec32_right) {
+        tail(src, dst, left, right);
+        return;
+    }
+
+    if (left < vec32_left) {
+        tail(src, dst, left, static_cast<unsigned>(vec32_left));
+    }
+
+    for (size_t i = vec32_left; i < vec32_right; i += 32) {
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)(src_p + i + 0));
+        __m256i x1 = _mm256_loadu_si256((const __m256i *)(src_p + i + 8));
+        __m256i x2 = _mm256_loadu_si256((const __m256i *)(src_p + i + 16));
+        __m256i x3 = _mm256_loadu_si256((const __m256i *)(src_p + i + 24));
+
+        x0 = _mm256_shuffle_epi8(x0, shuffle);
+        x1 = _mm256_shuffle_epi8(x1, shuffle);
+        x2 = _mm256_shuffle_epi8(x2, shuffle);
+        x3 = _mm256_shuffle_epi8(x3, shuffle);
+
+        transpose4_epi32(x0, x1, x2, x3);
+
+        __m256i regs[4] = {
+            _mm256_permutevar8x32_epi32(x0, permute),
+            _mm256_permutevar8x32_epi32(x1, permute),
+            _mm256_permutevar8x32_epi32(x2, permute),
+            _mm256_permutevar8x32_epi32(x3, permute),
+        };
+
+        // Must always write alpha component first!
+        _mm256_storeu_si256((__m256i *)(dst_a + i), regs[IdxA]);
+        _mm256_storeu_si256((__m256i *)(dst_r + i), regs[IdxR]);
+        _mm256_storeu_si256((__m256i *)(dst_g + i), regs[IdxG]);
+        _mm256_storeu_si256((__m256i *)(dst_b + i), regs[IdxB]);
+    }
+
+    if (vec32_right < right) {
+        tail(src, dst, static_cast<unsigned>(vec32_right), right);
+    }
+}
+
+template <unsigned IdxR, unsigned IdxG, unsigned IdxB, unsigned IdxA, bool AlphaOneFill>
+void pack_rgb32_avx2(const void *const *src, void *dst, unsigned left, unsigned right, detail::pack_func tail)
+{
+    const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_set_epi8(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0));
+    const __m256i permute = _mm256_set_epi32(7, 5, 3, 1, 6, 4, 2, 0);
+    const __m256i alpha_fill = _mm256_set1_epi8(AlphaOneFill ? static_cast<char>(0xFF) : 0);
+
+    const uint8_t *src_r = static_cast<const uint8_t *>(src[0]);
+    const uint8_t *src_g = static_cast<const uint8_t *>(src[1]);
+    const uint8_t *src_b = static_cast<const uint8_t *>(src[2]);
+    const uint8_t *src_a = static_cast<const uint8_t *>(src[3]);
+    uint32_t *dst_p = static_cast<uint32_t *>(dst);
+
+    size_t vec32_left = (left + 31) & ~31U;
+    size_t vec32_right = right & ~31U;
+
+    if (vec32_left >= vec32_right) {
+        tail(src, dst, left, right);
+        return;
+    }
+
+    if (left < vec32_left) {
+        tail(src, dst, left, static_cast<unsigned>(vec32_left));
+    }
+
+    for (size_t i = vec32_left; i < vec32_right; i += 32) {
+        __m256i regs[4];
+        regs[IdxR] = _mm256_loadu_si256((const __m256i *)(src_r + i));
+        regs[IdxG] = _mm256_loadu_si256((const __m256i *)(src_g + i));
+        regs[IdxB] = _mm256_loadu_si256((const __m256i *)(src_b + i));
+        regs[IdxA] = src_a ? _mm256_loadu_si256((const __m256i *)(src_a + i)) : alpha_fill;
+
+        __m256i x0 = _mm256_permutevar8x32_epi32(regs[0], permute);
+        __m256i x1 = _mm256_permutevar8x32_epi32(regs[1], permute);
+        __m256i x2 = _mm256_permutevar8x32_epi32(regs[2], permute);
+        __m256i x3 = _mm256_permutevar8x32_epi32(regs[3], permute);
+
+        transpose4_epi32(x0, x1, x2, x3);
+
+        x0 = _mm256_shuffle_epi8(x0, shuffle);
+        x1 = _mm256_shuffle_epi8(x1, shuffle);
+        x2 = _mm256_shuffle_epi8(x2, shuffle);
+        x3 = _mm256_shuffle_epi8(x3, shuffle);
+
+        _mm256_storeu_si256((__m256i *)(dst_p + i + 0), x0);
+        _mm256_storeu_si256((__m256i *)(dst_p + i + 8), x1);
+        _mm256_storeu_si256((__m256i *)(dst_p + i + 16), x2);
+        _mm256_storeu_si256((__m256i *)(dst_p + i + 24), x3);
+    }
+
+    if (vec32_right < right) {
+        tail(src, dst, static_cast<unsigned>(vec32_right), right);
+    }
+}
+
+template <unsigned C20, unsigned C10, unsigned C0, bool ByteSwap>
+void unpack_rgb30_avx2(const void *src, void *const *dst, unsigned left, unsigned right, detail::unpack_func tail)
+{
+    const __m256i bswap = _mm256_broadcastsi128_si256(_mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+    const __m256i mask_10b = _mm256_set1_epi32(0x3FF);
+
+    const uint32_t *src_p = static_cast<const uint32_t *>(src);
+    uint16_t *dst_p[4] = {
+        static_cast<uint16_t *>(dst[0]), static_cast<uint16_t *>(dst[1]),
+        static_cast<uint16_t *>(dst[2]), static_cast<uint16_t *>(dst[3]),
+    };
+    uint16_t *dst_a = dst_p[3];
+
+    size_t vec16_left = (left + 15) & ~15U;
+    size_t vec16_right = right & ~15U;
+
+    if (vec16_left >= vec16_right) {
+        tail(src, dst, left, right);
+        return;
+    }
+
+    if (left < vec16_left) {
+        tail(src, dst, left, static_cast<unsigned>(vec16_left));
+    }
+
+    // _mm256_packus_epi32 interleaves the 128-bit lanes of its operands.
+    auto pack_u16 = [](__m256i lo, __m256i hi) {
+        return _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+    };
+
+    for (size_t i = vec16_left; i < vec16_right; i += 16) {
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)(src_p + i + 0));
+        __m256i x1 = _mm256_loadu_si256((const __m256i *)(src_p + i + 8));
+
+        if (ByteSwap) {
+            x0 = _mm256_shuffle_epi8(x0, bswap);
+            x1 = _mm256_shuffle_epi8(x1, bswap);
+        }
+
+        if (dst_a) {
+            __m256i a = pack_u16(_mm256_srli_epi32(x0, 30), _mm256_srli_epi32(x1, 30));
+            _mm256_storeu_si256((__m256i *)(dst_a + i), a);
+        }
+
+        __m256i c20 = pack_u16(_mm256_and_si256(_mm256_srli_epi32(x0, 20), mask_10b), _mm256_and_si256(_mm256_srli_epi32(x1, 20), mask_10b));
+        __m256i c10 = pack_u16(_mm256_and_si256(_mm256_srli_epi32(x0, 10), mask_10b), _mm256_and_si256(_mm256_srli_epi32(x1, 10), mask_10b));
+        __m256i c0 = pack_u16(_mm256_and_si256(x0, mask_10b), _mm256_and_si256(x1, mask_10b));
+
+        _mm256_storeu_si256((__m256i *)(dst_p[C20] + i), c20);
+        _mm256_storeu_si256((__m256i *)(dst_p[C10] + i), c10);
+        _mm256_storeu_si256((__m256i *)(dst_p[C0] + i), c0);
+    }
+
+    if (vec16_right < right) {
+        tail(src, dst, static_cast<unsigned>(vec16_right), right);
+    }
+}
+
+template <unsigned C20, unsigned C10, unsigned C0, bool ByteSwap, bool AlphaOneFill>
+void pack_rgb30_avx2(const void *const *src, void *dst, unsigned left, unsigned right, detail::pack_func tail)
+{
+    const __m256i bswap = _mm256_broadcastsi128_si256(_mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+    const __m128i mask_10b = _mm_set1_epi16(0x3FF);
+    const __m128i mask_2b = _mm_set1_epi16(0x3);
+    const __m256i alpha_fill = _mm256_set1_epi32(AlphaOneFill ? static_cast<int>(0xC0000000U) : 0);
+
+    const uint16_t *src_p[4] = {
+        static_cast<const uint16_t *>(src[0]), static_cast<const uint16_t *>(src[1]),
+        static_cast<const uint16_t *>(src[2]), static_cast<const uint16_t *>(src[3]),
+    };
+    const uint16_t *src_a = src_p[3];
+    uint32_t *dst_p = static_cast<uint32_t *>(dst);
+
+    size_t vec16_left = (left + 15) & ~15U;
+    size_t vec16_right = right & ~15U;
+
+    if (vec16_left >= vec16_right) {
+        tail(src, dst, left, right);
+        return;
+    }
+
+    if (left < vec16_left) {
+        tail(src, dst, left, static_cast<unsigned>(vec16_left));
+    }
+
+    for (size_t i = vec16_left; i < vec16_right; i += 16) {
+        __m256i lo = alpha_fill;
+        __m256i hi = alpha_fill;
+
+        auto add_component = [&](const uint16_t *ptr, __m128i mask, int shift) {
+            __m128i c_lo = _mm_and_si128(_mm_loadu_si128((const __m128i *)(ptr + i + 0)), mask);
+            __m128i c_hi = _mm_and_si128(_mm_loadu_si128((const __m128i *)(ptr + i + 8)), mask);
+            lo = _mm256_or_si256(lo, _mm256_sll_epi32(_mm256_cvtepu16_epi32(c_lo), _mm_cvtsi32_si128(shift)));
+            hi = _mm256_or_si256(hi, _mm256_sll_epi32(_mm256_cvtepu16_epi32(c_hi), _mm_cvtsi32_si128(shift)));
+        };
+
+        if (src_a) {
+            lo = _mm256_setzero_si256();
+            hi = _mm256_setzero_si256();
+            add_component(src_a, mask_2b, 30);
+        }
+
+        add_component(src_p[C20], mask_10b, 20);
+        add_component(src_p[C10], mask_10b, 10);
+        add_component(src_p[C0], mask_10b, 0);
+
+        if (ByteSwap) {
+            lo = _mm256_shuffle_epi8(lo, bswap);
+            hi = _mm256_shuffle_epi8(hi, bswap);
+        }
+
+        _mm256_storeu_si256((__m256i *)(dst_p + i + 0), lo);
+        _mm256_storeu_si256((__m256i *)(dst_p + i + 8), hi);
+    }
+
+    if (vec16_right < right) {
+        tail(src, dst, static_cast<unsigned>(vec16_right), right);
+    }
+}
+
+// Chroma-interleaved halves of NV12 and P010. Only whole vectors are done
+// here; the rest goes to the SSE4.1 kernel, called with even luma positions
+// so both agree on the UV pairs covered.
+template <bool BigEndian>
+void unpack_nv8_avx2(const void *src, void *const *dst, unsigned left, unsigned right, detail::unpack_func tail)
+{
+    const __m256i mask_lo = _mm256_set1_epi16(0x00FF);
+
+    const uint8_t *src_p = static_cast<const uint8_t *>(src);
+    uint8_t *dst_first = static_cast<uint8_t *>(BigEndian ? dst[2] : dst[1]);
+    uint8_t *dst_second = static_cast<uint8_t *>(BigEndian ? dst[1] : dst[2]);
+
+    size_t c_left = left >> 1;
+    size_t c_right = c_left + (right - left + 1) / 2;
+    size_t i = c_left;
+
+    for (; i + 32 <= c_right; i += 32) {
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)(src_p + i * 2 + 0));
+        __m256i x1 = _mm256_loadu_si256((const __m256i *)(src_p + i * 2 + 32));
+
+        // Packing works within lanes, so the quadwords come out of order.
+        __m256i first = _mm256_packus_epi16(_mm256_and_si256(x0, mask_lo), _mm256_and_si256(x1, mask_lo));
+        __m256i second = _mm256_packus_epi16(_mm256_srli_epi16(x0, 8), _mm256_srli_epi16(x1, 8));
+
+        _mm256_storeu_si256((__m256i *)(dst_first + i), _mm256_permute4x64_epi64(first, 0xD8));
+        _mm256_storeu_si256((__m256i *)(dst_second + i), _mm256_permute4x64_epi64(second, 0xD8));
+    }
+
+    if (i == c_left) {
+        tail(src, dst, left, right);
+    } else if (i < c_right) {
+        tail(src, dst, static_cast<unsigned>(i * 2), static_cast<unsigned>(c_right * 2));
+    }
+}
+
+template <bool BigEndian>
+void pack_nv8_avx2(const void *const *src, void *dst, unsigned left, unsigned right, detail::pack_func tail)
+{
+    const uint8_t *src_first = static_cast<const uint8_t *>(BigEndian ? src[2] : src[1]);
+    const uint8_t *src_second = static_cast<const uint8_t *>(BigEndian ? src[1] : src[2]);
+    uint8_t *dst_p = static_cast<uint8_t *>(dst);
+
+    size_t c_left = left >> 1;
+    size_t c_right = c_left + (right - left + 1) / 2;
+    size_t i = c_left;
+
+    for (; i + 32 <= c_right; i += 32) {
+        __m256i first = _mm256_loadu_si256((const __m256i *)(src_first + i));
+        __m256i second = _mm256_loadu_si256((const __m256i *)(src_second + i));
+
+        __m256i lo = _mm256_unpacklo_epi8(first, second);
+        __m256i hi = _mm256_unpackhi_epi8(first, second);
+
+        _mm256_storeu_si256((__m256i *)(dst_p + i * 2 + 0), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst_p + i * 2 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+
+    if (i == c_left) {
+        tail(src, dst, left, right);
+    } else if (i < c_right) {
+        tail(src, dst, static_cast<unsigned>(i * 2), static_cast<unsigned>(c_right * 2));
+    }
+}
+
+template <unsigned Shift, bool BigEndian>
+void unpack_nv16_avx2(const void *src, void *const *dst, unsigned left, unsigned right, detail::unpack_func tail)
+{
+    const __m256i bswap = _mm256_broadcastsi128_si256(_mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+    const __m256i mask_lo = _mm256_set1_epi32(0xFFFF);
+
+    const uint16_t *src_p = static_cast<const uint16_t *>(src);
+    uint16_t *dst_first = static_cast<uint16_t *>(BigEndian ? dst[2] : dst[1]);
+    uint16_t *dst_second = static_cast<uint16_t *>(BigEndian ? dst[1] : dst[2]);
+
+    size_t c_left = left >> 1;
+    size_t c_right = c_left + (right - left + 1) / 2;
+    size_t i = c_left;
+
+    for (; i + 16 <= c_right; i += 16) {
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)(src_p + i * 2 + 0));
+        __m256i x1 = _mm256_loadu_si256((const __m256i *)(src_p + i * 2 + 16));
+
+        if (BigEndian) {
+            x0 = _mm256_shuffle_epi8(x0, bswap);
+            x1 = _mm256_shuffle_epi8(x1, bswap);
+        }
+
+        __m256i first = _mm256_packus_epi32(_mm256_and_si256(x0, mask_lo), _mm256_and_si256(x1, mask_lo));
+        __m256i second = _mm256_packus_epi32(_mm256_srli_epi32(x0, 16), _mm256_srli_epi32(x1, 16));
+
+        first = _mm256_srli_epi16(_mm256_permute4x64_epi64(first, 0xD8), Shift);
+        second = _mm256_srli_epi16(_mm256_permute4x64_epi64(second, 0xD8), Shift);
+
+        _mm256_storeu_si256((__m256i *)(dst_first + i), first);
+        _mm256_storeu_si256((__m256i *)(dst_second + i), second);
+    }
+
+    if (i == c_left) {
+        tail(src, dst, left, right);
+    } else if (i < c_right) {
+        tail(src, dst, static_cast<unsigned>(i * 2), static_cast<unsigned>(c_right * 2));
+    }
+}
+
+template <unsigned Shift, bool BigEndian>
+void pack_nv16_avx2(const void *const *src, void *dst, unsigned left, unsigned right, detail::pack_func tail)
+{
+    const __m256i bswap = _mm256_broadcastsi128_si256(_mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+    const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xFFFFU >> Shift));
+
+    const uint16_t *src_first = static_cast<const uint16_t *>(BigEndian ? src[2] : src[1]);
+    const uint16_t *src_second = static_cast<const uint16_t *>(BigEndian ? src[1] : src[2]);
+    uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+    size_t c_left = left >> 1;
+    size_t c_right = c_left + (right - left + 1) / 2;
+    size_t i = c_left;
+
+    for (; i + 16 <= c_right; i += 16) {
+        __m256i first = _mm256_slli_epi16(_mm256_and_si256(_mm256_loadu_si256((const __m256i *)(src_first + i)), mask), Shift);
+        __m256i second = _mm256_slli_epi16(_mm256_and_si256(_mm256_loadu_si256((const __m256i *)(src_second + i)), mask), Shift);
+
+        __m256i lo = _mm256_unpacklo_epi16(first, second);
+        __m256i hi = _mm256_unpackhi_epi16(first, second);
+
+        if (BigEndian) {
+            lo = _mm256_shuffle_epi8(lo, bswap);
+            hi = _mm256_shuffle_epi8(hi, bswap);
+        }
+
+        _mm256_storeu_si256((__m256i *)(dst_p + i * 2 + 0), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst_p + i * 2 + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+
+    if (i == c_left) {
+        tail(src, dst, left, right);
+    } else if (i < c_right) {
+        tail(src, dst, static_cast<unsigned>(i * 2), static_cast<unsigned>(c_right * 2));
+    }
+}
+
+} // namespace
+
+
+// Unaligned head and tail pixels are delegated to the SSE4.1 kernels.
+#define RGB32_AVX2(format, a, b, c, d) \
+  void unpack_##format##_avx2(const void *src, void * const * dst, unsigned left, unsigned right) \
+  { \
+    unpack_rgb32_avx2<a, b, c, d>(src, dst, left, right, unpack_##format##_sse41); \
+  } \
+  void pack_##format##_0_avx2(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_rgb32_avx2<a, b, c, d, 0>(src, dst, left, right, pack_##format##_0_sse41); \
+  } \
+  void pack_##format##_1_avx2(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_rgb32_avx2<a, b, c, d, 1>(src, dst, left, right, pack_##format##_1_sse41); \
+  }
+
+RGB32_AVX2(argb32_be, 1, 2, 3, 0)
+RGB32_AVX2(argb32_le, 2, 1, 0, 3)
+RGB32_AVX2(rgba32_be, 0, 1, 2, 3)
+RGB32_AVX2(rgba32_le, 3, 2, 1, 0)
+
+#define RGB30_AVX2(format, a, b, c, d) \
+  void unpack_##format##_avx2(const void *src, void * const * dst, unsigned left, unsigned right) \
+  { \
+    unpack_rgb30_avx2<a, b, c, d>(src, dst, left, right, unpack_##format##_sse41); \
+  } \
+  void pack_##format##_0_avx2(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_rgb30_avx2<a, b, c, d, 0>(src, dst, left, right, pack_##format##_0_sse41); \
+  } \
+  void pack_##format##_1_avx2(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_rgb30_avx2<a, b, c, d, 1>(src, dst, left, right, pack_##format##_1_sse41); \
+  }
+
+RGB30_AVX2(rgb30_be, C_R, C_G, C_B, true)
+RGB30_AVX2(rgb30_le, C_R, C_G, C_B, false)
+RGB30_AVX2(y410_be, C_V, C_Y, C_U, true)
+RGB30_AVX2(y410_le, C_V, C_Y, C_U, false)
+
+#define NV_AVX2(format, unpack_impl, pack_impl) \
+  void unpack_##format##_avx2(const void *src, void * const * dst, unsigned left, unsigned right) \
+  { \
+    unpack_impl(src, dst, left, right, unpack_##format##_sse41); \
+  } \
+  void pack_##format##_0_avx2(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_impl(src, dst, left, right, pack_##format##_0_sse41); \
+  } \
+  void pack_##format##_1_avx2(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_impl(src, dst, left, right, pack_##format##_1_sse41); \
+  }
+
+NV_AVX2(nv12_be, unpack_nv8_avx2<true>, pack_nv8_avx2<true>)
+NV_AVX2(nv12_le, unpack_nv8_avx2<false>, pack_nv8_avx2<false>)
+NV_AVX2(p010_be, (unpack_nv16_avx2<6, true>), (pack_nv16_avx2<6, true>))
+NV_AVX2(p010_le, (unpack_nv16_avx2<6, false>), (pack_nv16_avx2<6, false>))
+
+} // namespace simd
+} // namespace p2p
+
+#endif // x86
+#endif // P2P_SIMD
@@ -0,0 +1,170 @@
+#ifdef P2P_SIMD
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)
+
+#include <cstdint>
+#include <immintrin.h>
+#include "../p2p.h"
+#include "p2p_simd.h"
+
+namespace P2P_NAMESPACE {
+namespace simd {
+
+namespace {
+
+// 4x4 transpose of DWORDs within each 128-bit lane.
+inline void transpose4_epi32(__m512i &x0, __m512i &x1, __m512i &x2, __m512i &x3)
+{
+    __m512i t0 = _mm512_unpacklo_epi32(x0, x1);
+    __m512i t1 = _mm512_unpacklo_epi32(x2, x3);
+    __m512i t2 = _mm512_unpackhi_epi32(x0, x1);
+    __m512i t3 = _mm512_unpackhi_epi32(x2, x3);
+
+    x0 = _mm512_unpacklo_epi64(t0, t1);
+    x1 = _mm512_unpackhi_epi64(t0, t1);
+    x2 = _mm512_unpacklo_epi64(t2, t3);
+    x3 = _mm512_unpackhi_epi64(t2, t3);
+}
+
+template <unsigned IdxR, unsigned IdxG, unsigned IdxB, unsigned IdxA>
+void unpack_rgb32_avx512(const void *src, void *const *dst, unsigned left, unsigned right, detail::unpack_func tail)
+{
+    const __m512i shuffle = _mm512_broadcast_i32x4(_mm_set_epi8(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0));
+    const __m512i permute = _mm512_set_epi32(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0);
+
+    const uint32_t *src_p = static_cast<const uint32_t *>(src);
+    uint8_t *dst_r = static_cast<uint8_t *>(dst[0]);
+    uint8_t *dst_g = static_cast<uint8_t *>(dst[1]);
+    uint8_t *dst_b = static_cast<uint8_t *>(dst[2]);
+    uint8_t *dst_a = static_cast<uint8_t *>(dst[3]);
+
+    if (!dst_a) {
+        dst_a = dst_r;    // Write alpha to some other channel if disabled.
+    }
+
+    size_t vec64_left = (left + 63) & ~63U;
+    size_t vec64_right = right & ~63U;
+
+    if (vec64_left >= vec64_right) {
+        tail(src, dst, left, right);
+        return;
+    }
+
+    if (left < vec64_left) {
+        tail(src, dst, left, static_cast<unsigned>(vec64_left));
+    }
+
+    for (size_t i = vec64_left; i < vec64_right; i += 64) {
+        __m512i x0 = _mm512_loadu_si512((const __m512i *)(src_p + i + 0));
+        __m512i x1 = _mm512_loadu_si512((const __m512i *)(src_p + i + 16));
+        __m512i x2 = _mm512_loadu_si512((const __m512i *)(src_p + i + 32));
+        __m512i x3 = _mm512_loadu_si512((const __m512i *)(src_p + i + 48));
+
+        x0 = _mm512_shuffle_epi8(x0, shuffle);
+        x1 = _mm512_shuffle_epi8(x1, shuffle);
+        x2 = _mm512_shuffle_epi8(x2, shuffle);
+        x3 = _mm512_shuffle_epi8(x3, shuffle);
+
+        transpose4_epi32(x0, x1, x2, x3);
+
+        __m512i regs[4] = {
+            _mm512_permutexvar_epi32(permute, x0),
+            _mm512_permutexvar_epi32(permute, x1),
+            _mm512_permutexvar_epi32(permute, x2),
+            _mm512_permutexvar_epi32(permute, x3),
+        };
+
+        // Must always write alpha component first!
+        _mm512_storeu_si512((__m512i *)(dst_a + i), regs[IdxA]);
+        _mm512_storeu_si512((__m512i *)(dst_r + i), regs[IdxR]);
+        _mm512_storeu_si512((__m512i *)(dst_g + i), regs[IdxG]);
+        _mm512_storeu_si512((__m512i *)(dst_b + i), regs[IdxB]);
+    }
+
+    if (vec64_right < right) {
+        tail(src, dst, static_cast<unsigned>(vec64_right), right);
+    }
+}
+
+template <unsigned IdxR, unsigned IdxG, unsigned IdxB, unsigned IdxA, bool AlphaOneFill>
+void pack_rgb32_avx512(const void *const *src, void *dst, unsigned left, unsigned right, detail::pack_func tail)
+{
+    const __m512i shuffle = _mm512_broadcast_i32x4(_mm_set_epi8(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0));
+    const __m512i permute = _mm512_set_epi32(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0);
+    const __m512i alpha_fill = _mm512_set1_epi8(AlphaOneFill ? static_cast<char>(0xFF) : 0);
+
+    const uint8_t *src_r = static_cast<const uint8_t *>(src[0]);
+    const uint8_t *src_g = static_cast<const uint8_t *>(src[1]);
+    const uint8_t *src_b = static_cast<const uint8_t *>(src[2]);
+    const uint8_t *src_a = static_cast<const uint8_t *>(src[3]);
+    uint32_t *dst_p = static_cast<uint32_t *>(dst);
+
+    size_t vec64_left = (left + 63) & ~63U;
+    size_t vec64_right = right & ~63U;
+
+    if (vec64_left >= vec64_right) {
+        tail(src, dst, left, right);
+        return;
+    }
+
+    if (left < vec64_left) {
+        tail(src, dst, left, static_cast<unsigned>(vec64_left));
+    }
+
+    for (size_t i = vec64_left; i < vec64_right; i += 64) {
+        __m512i regs[4];
+        regs[IdxR] = _mm512_loadu_si512((const __m512i *)(src_r + i));
+        regs[IdxG] = _mm512_loadu_si512((const __m512i *)(src_g + i));
+        regs[IdxB] = _mm512_loadu_si512((const __m512i *)(src_b + i));
+        regs[IdxA] = src_a ? _mm512_loadu_si512((const __m512i *)(src_a + i)) : alpha_fill;
+
+        __m512i x0 = _mm512_permutexvar_epi32(permute, regs[0]);
+        __m512i x1 = _mm512_permutexvar_epi32(permute, regs[1]);
+        __m512i x2 = _mm512_permutexvar_epi32(permute, regs[2]);
+        __m512i x3 = _mm512_permutexvar_epi32(permute, regs[3]);
+
+        transpose4_epi32(x0, x1, x2, x3);
+
+        x0 = _mm512_shuffle_epi8(x0, shuffle);
+        x1 = _mm512_shuffle_epi8(x1, shuffle);
+        x2 = _mm512_shuffle_epi8(x2, shuffle);
+        x3 = _mm512_shuffle_epi8(x3, shuffle);
+
+        _mm512_storeu_si512((__m512i *)(dst_p + i + 0), x0);
+        _mm512_storeu_si512((__m512i *)(dst_p + i + 16), x1);
+        _mm512_storeu_si512((__m512i *)(dst_p + i + 32), x2);
+        _mm512_storeu_si512((__m512i *)(dst_p + i + 48), x3);
+    }
+
+    if (vec64_right < right) {
+        tail(src, dst, static_cast<unsigned>(vec64_right), right);
+    }
+}
+
+} // namespace
+
+
+// Unaligned head and tail pixels are delegated to the AVX2 kernels.
+#define RGB32_AVX512(format, a, b, c, d) \
+  void unpack_##format##_avx512(const void *src, void * const * dst, unsigned left, unsigned right) \
+  { \
+    unpack_rgb32_avx512<a, b, c, d>(src, dst, left, right, unpack_##format##_avx2); \
+  } \
+  void pack_##format##_0_avx512(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_rgb32_avx512<a, b, c, d, 0>(src, dst, left, right, pack_##format##_0_avx2); \
+  } \
+  void pack_##format##_1_avx512(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_rgb32_avx512<a, b, c, d, 1>(src, dst, left, right, pack_##format##_1_avx2); \
+  }
+
+RGB32_AVX512(argb32_be, 1, 2, 3, 0)
+RGB32_AVX512(argb32_le, 2, 1, 0, 3)
+RGB32_AVX512(rgba32_be, 0, 1, 2, 3)
+RGB32_AVX512(rgba32_le, 3, 2, 1, 0)
+
+} // namespace simd
+} // namespace p2p
+
+#endif // x86
+#endif // P2P_SIMD
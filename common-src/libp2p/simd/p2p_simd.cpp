@@ -24,14 +24,45 @@ auto populate_unpack_table()
 #if defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)
     simd::X86Capabilities x86 = simd::query_x86_capabilities();
 
-    if (x86.sse41) {
+    // The first matching entry is used, so wider ISAs must come first.
 #define ENTRY(format, cpu) table[idx++] = unpack_table_entry{ &typeid(packed_##format), simd::unpack_##format##_##cpu }
+    if (x86.avx512f && x86.avx512bw) {
+        ENTRY(argb32_be, avx512);
+        ENTRY(argb32_le, avx512);
+        ENTRY(rgba32_be, avx512);
+        ENTRY(rgba32_le, avx512);
+    }
+
+    if (x86.avx2) {
+        ENTRY(argb32_be, avx2);
+        ENTRY(argb32_le, avx2);
+        ENTRY(rgba32_be, avx2);
+        ENTRY(rgba32_le, avx2);
+        ENTRY(rgb30_be, avx2);
+        ENTRY(rgb30_le, avx2);
+        ENTRY(y410_be, avx2);
+        ENTRY(y410_le, avx2);
+        ENTRY(nv12_be, avx2);
+        ENTRY(nv12_le, avx2);
+        ENTRY(p010_be, avx2);
+        ENTRY(p010_le, avx2);
+    }
+
+    if (x86.sse41) {
         ENTRY(argb32_be, sse41);
         ENTRY(argb32_le, sse41);
         ENTRY(rgba32_be, sse41);
         ENTRY(rgba32_le, sse41);
-#undef ENTRY
+        ENTRY(rgb30_be, sse41);
+        ENTRY(rgb30_le, sse41);
+        ENTRY(y410_be, sse41);
+        ENTRY(y410_le, sse41);
+        ENTRY(nv12_be, sse41);
+        ENTRY(nv12_le, sse41);
+        ENTRY(p010_be, sse41);
+        ENTRY(p010_le, sse41);
     }
+#undef ENTRY
 
 #endif
 
@@ -46,14 +77,45 @@ auto populate_pack_table()
 #if defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)
     simd::X86Capabilities x86 = simd::query_x86_capabilities();
 
-    if (x86.sse41) {
+    // The first matching entry is used, so wider ISAs must come first.
 #define ENTRY(format, cpu) table[idx++] = pack_table_entry{ &typeid(packed_##format), simd::pack_##format##_0_##cpu, simd::pack_##format##_1_##cpu }
+    if (x86.avx512f && x86.avx512bw) {
+        ENTRY(argb32_be, avx512);
+        ENTRY(argb32_le, avx512);
+        ENTRY(rgba32_be, avx512);
+        ENTRY(rgba32_le, avx512);
+    }
+
+    if (x86.avx2) {
+        ENTRY(argb32_be, avx2);
+        ENTRY(argb32_le, avx2);
+        ENTRY(rgba32_be, avx2);
+        ENTRY(rgba32_le, avx2);
+        ENTRY(rgb30_be, avx2);
+        ENTRY(rgb30_le, avx2);
+        ENTRY(y410_be, avx2);
+        ENTRY(y410_le, avx2);
+        ENTRY(nv12_be, avx2);
+        ENTRY(nv12_le, avx2);
+        ENTRY(p010_be, avx2);
+        ENTRY(p010_le, avx2);
+    }
+
+    if (x86.sse41) {
         ENTRY(argb32_be, sse41);
         ENTRY(argb32_le, sse41);
         ENTRY(rgba32_be, sse41);
         ENTRY(rgba32_le, sse41);
-#undef ENTRY
+        ENTRY(rgb30_be, sse41);
+        ENTRY(rgb30_le, sse41);
+        ENTRY(y410_be, sse41);
+        ENTRY(y410_le, sse41);
+        ENTRY(nv12_be, sse41);
+        ENTRY(nv12_le, sse41);
+        ENTRY(p010_be, sse41);
+        ENTRY(p010_le, sse41);
     }
+#undef ENTRY
 
 #endif
 
@@ -21,10 +21,70 @@ UNPACK(argb32_le, sse41)
 UNPACK(rgba32_be, sse41)
 UNPACK(rgba32_le, sse41)
 
+UNPACK(rgb30_be, sse41)
+UNPACK(rgb30_le, sse41)
+UNPACK(y410_be, sse41)
+UNPACK(y410_le, sse41)
+
+PACK(rgb30_be, sse41)
+PACK(rgb30_le, sse41)
+PACK(y410_be, sse41)
+PACK(y410_le, sse41)
+
 PACK(argb32_be, sse41)
 PACK(argb32_le, sse41)
 PACK(rgba32_be, sse41)
 PACK(rgba32_le, sse41)
+
+UNPACK(nv12_be, sse41)
+UNPACK(nv12_le, sse41)
+UNPACK(p010_be, sse41)
+UNPACK(p010_le, sse41)
+
+PACK(nv12_be, sse41)
+PACK(nv12_le, sse41)
+PACK(p010_be, sse41)
+PACK(p010_le, sse41)
+
+UNPACK(argb32_be, avx2)
+UNPACK(argb32_le, avx2)
+UNPACK(rgba32_be, avx2)
+UNPACK(rgba32_le, avx2)
+
+UNPACK(rgb30_be, avx2)
+UNPACK(rgb30_le, avx2)
+UNPACK(y410_be, avx2)
+UNPACK(y410_le, avx2)
+
+PACK(rgb30_be, avx2)
+PACK(rgb30_le, avx2)
+PACK(y410_be, avx2)
+PACK(y410_le, avx2)
+
+PACK(argb32_be, avx2)
+PACK(argb32_le, avx2)
+PACK(rgba32_be, avx2)
+PACK(rgba32_le, avx2)
+
+UNPACK(nv12_be, avx2)
+UNPACK(nv12_le, avx2)
+UNPACK(p010_be, avx2)
+UNPACK(p010_le, avx2)
+
+PACK(nv12_be, avx2)
+PACK(nv12_le, avx2)
+PACK(p010_be, avx2)
+PACK(p010_le, avx2)
+
+UNPACK(argb32_be, avx512)
+UNPACK(argb32_le, avx512)
+UNPACK(rgba32_be, avx512)
+UNPACK(rgba32_le, avx512)
+
+PACK(argb32_be, avx512)
+PACK(argb32_le, avx512)
+PACK(rgba32_be, avx512)
+PACK(rgba32_le, avx512)
 #endif // x86
 
 #undef PACK
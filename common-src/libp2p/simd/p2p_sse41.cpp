@@ -78,6 +78,15 @@ void unpack_rgb32_sse41(const void *src, void *const *dst, unsigned left, unsign
         _mm_storeu_si128((__m128i *)(dst_b + i), regs[IdxB]);
     };
 
+    // Spans shorter than one vector would make the loop bounds overlap.
+    if (right - left < 16) {
+        for (size_t i = left; i < right; ++i) {
+            scalar_iter(i);
+        }
+
+        return;
+    }
+
     for (size_t i = left; i < vec4_left; ++i) {
         scalar_iter(i);
     }
@@ -180,6 +189,15 @@ void pack_rgb32_sse41(const void *const *src, void *dst, unsigned left, unsigned
         _mm_storeu_si128((__m128i *)(dst_p + i + 12), x3);
     };
 
+    // Spans shorter than one vector would make the loop bounds overlap.
+    if (right - left < 16) {
+        for (size_t i = left; i < right; ++i) {
+            scalar_iter(i);
+        }
+
+        return;
+    }
+
     for (size_t i = left; i < vec4_left; ++i) {
         scalar_iter(i);
     }
@@ -201,6 +219,327 @@ void pack_rgb32_sse41(const void *const *src, void *dst, unsigned left, unsigned
     }
 }
 
+// 2:10:10:10 packings. C20, C10 and C0 are the planar indices of the
+// components stored at bit 20, 10 and 0 of the DWORD; alpha is at bit 30.
+template <unsigned C20, unsigned C10, unsigned C0, bool ByteSwap>
+void unpack_rgb30_sse41(const void *src, void *const *dst, unsigned left, unsigned right)
+{
+    const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    const __m128i mask_10b = _mm_set1_epi32(0x3FF);
+
+    const uint32_t *src_p = static_cast<const uint32_t *>(src);
+    uint16_t *dst_p[4] = {
+        static_cast<uint16_t *>(dst[0]), static_cast<uint16_t *>(dst[1]),
+        static_cast<uint16_t *>(dst[2]), static_cast<uint16_t *>(dst[3]),
+    };
+    uint16_t *dst_a = dst_p[3];
+
+    size_t vec8_left = (left + 7) & ~7U;
+    size_t vec8_right = right & ~7U;
+
+    auto scalar_iter = [&](size_t i) {
+        uint32_t x = src_p[i];
+        x = ByteSwap ? ((x >> 24) | ((x >> 8) & 0xFF00U) | ((x << 8) & 0xFF0000U) | (x << 24)) : x;
+
+        if (dst_a) {
+            dst_a[i] = static_cast<uint16_t>(x >> 30);
+        }
+
+        dst_p[C20][i] = static_cast<uint16_t>((x >> 20) & 0x3FFU);
+        dst_p[C10][i] = static_cast<uint16_t>((x >> 10) & 0x3FFU);
+        dst_p[C0][i] = static_cast<uint16_t>(x & 0x3FFU);
+    };
+    auto vec8_iter = [&](size_t i) {
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(src_p + i + 0));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(src_p + i + 4));
+
+        if (ByteSwap) {
+            x0 = _mm_shuffle_epi8(x0, bswap);
+            x1 = _mm_shuffle_epi8(x1, bswap);
+        }
+
+        if (dst_a) {
+            __m128i a = _mm_packus_epi32(_mm_srli_epi32(x0, 30), _mm_srli_epi32(x1, 30));
+            _mm_storeu_si128((__m128i *)(dst_a + i), a);
+        }
+
+        __m128i c20 = _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(x0, 20), mask_10b), _mm_and_si128(_mm_srli_epi32(x1, 20), mask_10b));
+        __m128i c10 = _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(x0, 10), mask_10b), _mm_and_si128(_mm_srli_epi32(x1, 10), mask_10b));
+        __m128i c0 = _mm_packus_epi32(_mm_and_si128(x0, mask_10b), _mm_and_si128(x1, mask_10b));
+
+        _mm_storeu_si128((__m128i *)(dst_p[C20] + i), c20);
+        _mm_storeu_si128((__m128i *)(dst_p[C10] + i), c10);
+        _mm_storeu_si128((__m128i *)(dst_p[C0] + i), c0);
+    };
+
+    if (right - left < 8) {
+        for (size_t i = left; i < right; ++i) {
+            scalar_iter(i);
+        }
+
+        return;
+    }
+
+    for (size_t i = left; i < vec8_left; ++i) {
+        scalar_iter(i);
+    }
+
+    for (size_t i = vec8_left; i < vec8_right; i += 8) {
+        vec8_iter(i);
+    }
+
+    for (size_t i = vec8_right; i < right; ++i) {
+        scalar_iter(i);
+    }
+}
+
+template <unsigned C20, unsigned C10, unsigned C0, bool ByteSwap, bool AlphaOneFill>
+void pack_rgb30_sse41(const void *const *src, void *dst, unsigned left, unsigned right)
+{
+    const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    const __m128i mask_10b = _mm_set1_epi16(0x3FF);
+    const __m128i mask_2b = _mm_set1_epi16(0x3);
+    const __m128i alpha_fill = _mm_set1_epi32(AlphaOneFill ? static_cast<int>(0xC0000000U) : 0);
+
+    const uint16_t *src_p[4] = {
+        static_cast<const uint16_t *>(src[0]), static_cast<const uint16_t *>(src[1]),
+        static_cast<const uint16_t *>(src[2]), static_cast<const uint16_t *>(src[3]),
+    };
+    const uint16_t *src_a = src_p[3];
+    uint32_t *dst_p = static_cast<uint32_t *>(dst);
+
+    size_t vec8_left = (left + 7) & ~7U;
+    size_t vec8_right = right & ~7U;
+
+    auto scalar_iter = [&](size_t i) {
+        uint32_t x = src_a ? (static_cast<uint32_t>(src_a[i] & 0x3U) << 30) : (AlphaOneFill ? 0xC0000000U : 0);
+        x |= static_cast<uint32_t>(src_p[C20][i] & 0x3FFU) << 20;
+        x |= static_cast<uint32_t>(src_p[C10][i] & 0x3FFU) << 10;
+        x |= static_cast<uint32_t>(src_p[C0][i] & 0x3FFU);
+        dst_p[i] = ByteSwap ? ((x >> 24) | ((x >> 8) & 0xFF00U) | ((x << 8) & 0xFF0000U) | (x << 24)) : x;
+    };
+    auto vec8_iter = [&](size_t i) {
+        __m128i c20 = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src_p[C20] + i)), mask_10b);
+        __m128i c10 = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src_p[C10] + i)), mask_10b);
+        __m128i c0 = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src_p[C0] + i)), mask_10b);
+
+        __m128i lo = _mm_or_si128(_mm_slli_epi32(_mm_cvtepu16_epi32(c20), 20), _mm_slli_epi32(_mm_cvtepu16_epi32(c10), 10));
+        __m128i hi = _mm_or_si128(_mm_slli_epi32(_mm_unpackhi_epi16(c20, _mm_setzero_si128()), 20), _mm_slli_epi32(_mm_unpackhi_epi16(c10, _mm_setzero_si128()), 10));
+        lo = _mm_or_si128(lo, _mm_cvtepu16_epi32(c0));
+        hi = _mm_or_si128(hi, _mm_unpackhi_epi16(c0, _mm_setzero_si128()));
+
+        if (src_a) {
+            __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src_a + i)), mask_2b);
+            lo = _mm_or_si128(lo, _mm_slli_epi32(_mm_cvtepu16_epi32(a), 30));
+            hi = _mm_or_si128(hi, _mm_slli_epi32(_mm_unpackhi_epi16(a, _mm_setzero_si128()), 30));
+        } else {
+            lo = _mm_or_si128(lo, alpha_fill);
+            hi = _mm_or_si128(hi, alpha_fill);
+        }
+
+        if (ByteSwap) {
+            lo = _mm_shuffle_epi8(lo, bswap);
+            hi = _mm_shuffle_epi8(hi, bswap);
+        }
+
+        _mm_storeu_si128((__m128i *)(dst_p + i + 0), lo);
+        _mm_storeu_si128((__m128i *)(dst_p + i + 4), hi);
+    };
+
+    if (right - left < 8) {
+        for (size_t i = left; i < right; ++i) {
+            scalar_iter(i);
+        }
+
+        return;
+    }
+
+    for (size_t i = left; i < vec8_left; ++i) {
+        scalar_iter(i);
+    }
+
+    for (size_t i = vec8_left; i < vec8_right; i += 8) {
+        vec8_iter(i);
+    }
+
+    for (size_t i = vec8_right; i < right; ++i) {
+        scalar_iter(i);
+    }
+}
+
+// Chroma-interleaved halves of NV12 (8-bit) and P010/P016 (16-bit) with the
+// samples stored Shift bits up. The line functions take luma positions,
+// every iteration of the generic template handles one UV pair.
+inline void nv_chroma_range(unsigned left, unsigned right, size_t &c_left, size_t &c_right)
+{
+    c_left = left >> 1;
+    c_right = c_left + (right - left + 1) / 2;
+}
+
+template <bool BigEndian>
+void unpack_nv8_sse41(const void *src, void *const *dst, unsigned left, unsigned right)
+{
+    const __m128i mask_lo = _mm_set1_epi16(0x00FF);
+
+    const uint8_t *src_p = static_cast<const uint8_t *>(src);
+    uint8_t *dst_u = static_cast<uint8_t *>(dst[1]);
+    uint8_t *dst_v = static_cast<uint8_t *>(dst[2]);
+
+    // Big endian pairs store V first.
+    uint8_t *dst_first = BigEndian ? dst_v : dst_u;
+    uint8_t *dst_second = BigEndian ? dst_u : dst_v;
+
+    size_t c_left;
+    size_t c_right;
+    nv_chroma_range(left, right, c_left, c_right);
+
+    size_t i = c_left;
+
+    for (; i + 16 <= c_right; i += 16) {
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(src_p + i * 2 + 0));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(src_p + i * 2 + 16));
+
+        __m128i first = _mm_packus_epi16(_mm_and_si128(x0, mask_lo), _mm_and_si128(x1, mask_lo));
+        __m128i second = _mm_packus_epi16(_mm_srli_epi16(x0, 8), _mm_srli_epi16(x1, 8));
+
+        _mm_storeu_si128((__m128i *)(dst_first + i), first);
+        _mm_storeu_si128((__m128i *)(dst_second + i), second);
+    }
+
+    for (; i < c_right; ++i) {
+        dst_first[i] = src_p[i * 2 + 0];
+        dst_second[i] = src_p[i * 2 + 1];
+    }
+}
+
+template <bool BigEndian>
+void pack_nv8_sse41(const void *const *src, void *dst, unsigned left, unsigned right)
+{
+    const uint8_t *src_u = static_cast<const uint8_t *>(src[1]);
+    const uint8_t *src_v = static_cast<const uint8_t *>(src[2]);
+    uint8_t *dst_p = static_cast<uint8_t *>(dst);
+
+    const uint8_t *src_first = BigEndian ? src_v : src_u;
+    const uint8_t *src_second = BigEndian ? src_u : src_v;
+
+    size_t c_left;
+    size_t c_right;
+    nv_chroma_range(left, right, c_left, c_right);
+
+    size_t i = c_left;
+
+    for (; i + 16 <= c_right; i += 16) {
+        __m128i first = _mm_loadu_si128((const __m128i *)(src_first + i));
+        __m128i second = _mm_loadu_si128((const __m128i *)(src_second + i));
+
+        _mm_storeu_si128((__m128i *)(dst_p + i * 2 + 0), _mm_unpacklo_epi8(first, second));
+        _mm_storeu_si128((__m128i *)(dst_p + i * 2 + 16), _mm_unpackhi_epi8(first, second));
+    }
+
+    for (; i < c_right; ++i) {
+        dst_p[i * 2 + 0] = src_first[i];
+        dst_p[i * 2 + 1] = src_second[i];
+    }
+}
+
+template <unsigned Shift, bool BigEndian>
+void unpack_nv16_sse41(const void *src, void *const *dst, unsigned left, unsigned right)
+{
+    const __m128i bswap = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    const __m128i mask_lo = _mm_set1_epi32(0xFFFF);
+
+    const uint16_t *src_p = static_cast<const uint16_t *>(src);
+    uint16_t *dst_u = static_cast<uint16_t *>(dst[1]);
+    uint16_t *dst_v = static_cast<uint16_t *>(dst[2]);
+
+    uint16_t *dst_first = BigEndian ? dst_v : dst_u;
+    uint16_t *dst_second = BigEndian ? dst_u : dst_v;
+
+    size_t c_left;
+    size_t c_right;
+    nv_chroma_range(left, right, c_left, c_right);
+
+    size_t i = c_left;
+
+    for (; i + 8 <= c_right; i += 8) {
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(src_p + i * 2 + 0));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(src_p + i * 2 + 8));
+
+        if (BigEndian) {
+            x0 = _mm_shuffle_epi8(x0, bswap);
+            x1 = _mm_shuffle_epi8(x1, bswap);
+        }
+
+        __m128i first = _mm_packus_epi32(_mm_and_si128(x0, mask_lo), _mm_and_si128(x1, mask_lo));
+        __m128i second = _mm_packus_epi32(_mm_srli_epi32(x0, 16), _mm_srli_epi32(x1, 16));
+
+        _mm_storeu_si128((__m128i *)(dst_first + i), _mm_srli_epi16(first, Shift));
+        _mm_storeu_si128((__m128i *)(dst_second + i), _mm_srli_epi16(second, Shift));
+    }
+
+    for (; i < c_right; ++i) {
+        uint16_t first = src_p[i * 2 + 0];
+        uint16_t second = src_p[i * 2 + 1];
+
+        if (BigEndian) {
+            first = static_cast<uint16_t>((first >> 8) | (first << 8));
+            second = static_cast<uint16_t>((second >> 8) | (second << 8));
+        }
+
+        dst_first[i] = static_cast<uint16_t>(first >> Shift);
+        dst_second[i] = static_cast<uint16_t>(second >> Shift);
+    }
+}
+
+template <unsigned Shift, bool BigEndian>
+void pack_nv16_sse41(const void *const *src, void *dst, unsigned left, unsigned right)
+{
+    const __m128i bswap = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    const __m128i mask = _mm_set1_epi16(static_cast<short>(0xFFFFU >> Shift));
+
+    const uint16_t *src_u = static_cast<const uint16_t *>(src[1]);
+    const uint16_t *src_v = static_cast<const uint16_t *>(src[2]);
+    uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+    const uint16_t *src_first = BigEndian ? src_v : src_u;
+    const uint16_t *src_second = BigEndian ? src_u : src_v;
+
+    size_t c_left;
+    size_t c_right;
+    nv_chroma_range(left, right, c_left, c_right);
+
+    size_t i = c_left;
+
+    for (; i + 8 <= c_right; i += 8) {
+        __m128i first = _mm_slli_epi16(_mm_and_si128(_mm_loadu_si128((const __m128i *)(src_first + i)), mask), Shift);
+        __m128i second = _mm_slli_epi16(_mm_and_si128(_mm_loadu_si128((const __m128i *)(src_second + i)), mask), Shift);
+
+        __m128i lo = _mm_unpacklo_epi16(first, second);
+        __m128i hi = _mm_unpackhi_epi16(first, second);
+
+        if (BigEndian) {
+            lo = _mm_shuffle_epi8(lo, bswap);
+            hi = _mm_shuffle_epi8(hi, bswap);
+        }
+
+        _mm_storeu_si128((__m128i *)(dst_p + i * 2 + 0), lo);
+        _mm_storeu_si128((__m128i *)(dst_p + i * 2 + 8), hi);
+    }
+
+    for (; i < c_right; ++i) {
+        uint16_t first = static_cast<uint16_t>((src_first[i] & (0xFFFFU >> Shift)) << Shift);
+        uint16_t second = static_cast<uint16_t>((src_second[i] & (0xFFFFU >> Shift)) << Shift);
+
+        if (BigEndian) {
+            first = static_cast<uint16_t>((first >> 8) | (first << 8));
+            second = static_cast<uint16_t>((second >> 8) | (second << 8));
+        }
+
+        dst_p[i * 2 + 0] = first;
+        dst_p[i * 2 + 1] = second;
+    }
+}
+
 } // namespace
 
 
@@ -223,6 +562,45 @@ RGB32_SSE41(argb32_le, 2, 1, 0, 3)
 RGB32_SSE41(rgba32_be, 0, 1, 2, 3)
 RGB32_SSE41(rgba32_le, 3, 2, 1, 0)
 
+#define RGB30_SSE41(format, a, b, c, d) \
+  void unpack_##format##_sse41(const void *src, void * const * dst, unsigned left, unsigned right) \
+  { \
+    unpack_rgb30_sse41<a, b, c, d>(src, dst, left, right); \
+  } \
+  void pack_##format##_0_sse41(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_rgb30_sse41<a, b, c, d, 0>(src, dst, left, right); \
+  } \
+  void pack_##format##_1_sse41(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_rgb30_sse41<a, b, c, d, 1>(src, dst, left, right); \
+  }
+
+RGB30_SSE41(rgb30_be, C_R, C_G, C_B, true)
+RGB30_SSE41(rgb30_le, C_R, C_G, C_B, false)
+RGB30_SSE41(y410_be, C_V, C_Y, C_U, true)
+RGB30_SSE41(y410_le, C_V, C_Y, C_U, false)
+
+// NV packings have no alpha, so both pack variants are the same.
+#define NV_SSE41(format, unpack_impl, pack_impl) \
+  void unpack_##format##_sse41(const void *src, void * const * dst, unsigned left, unsigned right) \
+  { \
+    unpack_impl(src, dst, left, right); \
+  } \
+  void pack_##format##_0_sse41(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_impl(src, dst, left, right); \
+  } \
+  void pack_##format##_1_sse41(const void * const *src, void *dst, unsigned left, unsigned right) \
+  { \
+    pack_impl(src, dst, left, right); \
+  }
+
+NV_SSE41(nv12_be, unpack_nv8_sse41<true>, pack_nv8_sse41<true>)
+NV_SSE41(nv12_le, unpack_nv8_sse41<false>, pack_nv8_sse41<false>)
+NV_SSE41(p010_be, (unpack_nv16_sse41<6, true>), (pack_nv16_sse41<6, true>))
+NV_SSE41(p010_le, (unpack_nv16_sse41<6, false>), (pack_nv16_sse41<6, false>))
+
 } // namespace simd
 } // namespace p2p
 
@@ -3,6 +3,7 @@
 #include "common-src/helpers.h"
 
 #include <QObject>
+#include <QCryptographicHash>
 #include <QJsonArray>
 #include <QVariant>
 #include <map>
@@ -17,15 +18,25 @@ const ChromaPlacement DEFAULT_CHROMA_PLACEMENT = ChromaPlacement::MPEG2;
 const double DEFAULT_BICUBIC_FILTER_PARAMETER_B = 1.0 / 3.0;
 const double DEFAULT_BICUBIC_FILTER_PARAMETER_C = 1.0 / 3.0;
 const int DEFAULT_LANCZOS_FILTER_TAPS = 3;
+const bool DEFAULT_UNBUFFERED_FILE_OUTPUT = false;
 const EncodingType DEFAULT_ENCODING_TYPE = EncodingType::CLI;
 const EncodingHeaderType DEFAULT_ENCODING_HEADER_TYPE =
     EncodingHeaderType::Y4M;
+const EncodingPacking DEFAULT_ENCODING_PACKING = EncodingPacking::Planar;
 const JobType DEFAULT_JOB_TYPE = JobType::EncodeScriptCLI;
 const JobState DEFAULT_JOB_STATE = JobState::Waiting;
 const int DEFAULT_JOB_FIRST_FRAME = -1;
 const int DEFAULT_JOB_LAST_FRAME = -1;
 const int DEFAULT_JOB_FRAMES_PROCESSED = 0;
 const double DEFAULT_JOB_FPS = 0.0;
+const int DEFAULT_JOB_SEGMENTS = 1;
+const int MAX_JOB_SEGMENTS = 64;
+const int DEFAULT_JOB_CHECKPOINT_FRAMES = 0;
+const int DEFAULT_JOB_THREADS = 0;
+const JobPriority DEFAULT_JOB_PRIORITY = JobPriority::Normal;
+const int DEFAULT_JOBS_THREADS_BUDGET = 0;
+const int DEFAULT_JOBS_MEMORY_BUDGET = 0;
+const bool DEFAULT_JOBS_RUN_IN_WORKERS = false;
 const int DEFAULT_RECENT_JOB_SERVERS_NUMBER = 10;
 const int DEFAULT_WINDOW_GEOMETRY_SAVE_DELAY = 2000;
 const char DEFAULT_ENCODING_ARGUMENTS[] =
@@ -52,12 +63,27 @@ JobProperties::JobProperties():
     , jobState(JobState::Waiting)
     , encodingType(EncodingType::CLI)
     , encodingHeaderType(EncodingHeaderType::Invalid)
+    , encodingPacking(DEFAULT_ENCODING_PACKING)
     , firstFrame(-1)
     , firstFrameReal(-1)
     , lastFrame(-1)
     , lastFrameReal(-1)
     , framesProcessed(0)
     , fps(0.0)
+    , scriptWaitTime(0.0)
+    , pipeStallTime(0.0)
+    , packingTime(0.0)
+    , encoderCpuTime(-1.0)
+    , runningTime(0.0)
+    , requestWindow(0)
+    , requestWindowLimit(0)
+    , segments(DEFAULT_JOB_SEGMENTS)
+    , checkpointFrames(DEFAULT_JOB_CHECKPOINT_FRAMES)
+    , checksumCompare(false)
+    , encoderFps(0.0)
+    , encoderBitrate(0.0)
+    , threads(DEFAULT_JOB_THREADS)
+    , priority(DEFAULT_JOB_PRIORITY)
 {
 }
 
@@ -91,6 +117,16 @@ QString JobProperties::stateName(JobState a_state)
     return stateNameMap[a_state];
 }
 
+QString JobProperties::hashScript(const QString &a_scriptText)
+{
+    if (a_scriptText.isEmpty()) {
+        return QString();
+    }
+
+    return QString::fromLatin1(QCryptographicHash::hash(
+                                   a_scriptText.toUtf8(), QCryptographicHash::Sha256).toHex());
+}
+
 QString JobProperties::subject() const
 {
     QString subjectString;
@@ -100,6 +136,11 @@ QString JobProperties::subject() const
         subjectString = subjectString.replace("%sn%", scriptName);
         subjectString = subjectString.replace("%ep%", executablePath);
         subjectString = subjectString.replace("%arg%", arguments);
+
+        for (const JobOutput &output : extraOutputs) {
+            subjectString += QString("\n+ \"%1\" %2")
+                             .arg(output.executablePath).arg(output.arguments);
+        }
     } else if (type == JobType::RunProcess) {
         subjectString = QString("\"%ep%\" %arg%");
         subjectString = subjectString.replace("%ep%", executablePath);
@@ -118,6 +159,90 @@ int JobProperties::framesTotal() const
     return lastFrameReal - firstFrameReal + 1;
 }
 
+QString JobProperties::bottleneck() const
+{
+    // Seconds of running before the shares of the stages mean anything.
+    const double MIN_RUNNING_TIME = 2.0;
+    // Share of the running time a stage has to be waited for
+    // to be called the bottleneck.
+    const double BOTTLENECK_SHARE = 0.25;
+
+    if ((type != JobType::EncodeScriptCLI) ||
+            (runningTime < MIN_RUNNING_TIME)) {
+        return QString();
+    }
+
+    double scriptShare = scriptWaitTime / runningTime;
+    double encoderShare = pipeStallTime / runningTime;
+    double packingShare = packingTime / runningTime;
+
+    QString encoderName = (encodingType == EncodingType::Raw) ?
+                          QObject::tr("output file") : QObject::tr("encoder");
+    QString encoderLoad;
+
+    if ((encodingType != EncodingType::Raw) && (encoderCpuTime >= 0.0)) {
+        encoderLoad = QObject::tr("; encoder used %1 CPU cores")
+                      .arg(encoderCpuTime / runningTime, 0, 'f', 1);
+    }
+
+    if ((scriptShare >= BOTTLENECK_SHARE) && (scriptShare >= encoderShare)) {
+        return QObject::tr("Bottleneck: script (%1 waited for frames "
+                           "%2% of the time%3)").arg(encoderName)
+               .arg((int)(scriptShare * 100.0)).arg(encoderLoad);
+    }
+
+    if (encoderShare >= BOTTLENECK_SHARE) {
+        return QObject::tr("Bottleneck: %1 (frames waited for it "
+                           "%2% of the time%3)").arg(encoderName)
+               .arg((int)(encoderShare * 100.0)).arg(encoderLoad);
+    }
+
+    if (packingShare >= BOTTLENECK_SHARE) {
+        return QObject::tr("Bottleneck: frame packing (%1% of the time%2)")
+               .arg((int)(packingShare * 100.0)).arg(encoderLoad);
+    }
+
+    return QObject::tr("No bottleneck: script and %1 keep up with "
+                       "each other%2").arg(encoderName).arg(encoderLoad);
+}
+
+int JobSegmentProgress::framesTotal() const
+{
+    return lastFrame - firstFrame + 1;
+}
+
+bool JobSegmentProgress::isComplete() const
+{
+    return (framesProcessed == framesTotal());
+}
+
+QJsonObject JobOutput::toJson() const
+{
+    QJsonObject jsOutput;
+    jsOutput[JP_ENCODING_TYPE] = (int)encodingType;
+    jsOutput[JP_ENCODING_HEADER_TYPE] = (int)encodingHeaderType;
+    jsOutput[JP_EXECUTABLE_PATH] = executablePath;
+    jsOutput[JP_ARGUMENTS] = arguments;
+    return jsOutput;
+}
+
+JobOutput JobOutput::fromJson(const QJsonObject &a_object)
+{
+    JobOutput output;
+
+    if (a_object.contains(JP_ENCODING_TYPE))
+        output.encodingType =
+            (EncodingType)a_object[JP_ENCODING_TYPE].toInt();
+
+    if (a_object.contains(JP_ENCODING_HEADER_TYPE))
+        output.encodingHeaderType =
+            (EncodingHeaderType)a_object[JP_ENCODING_HEADER_TYPE].toInt();
+
+    output.executablePath = a_object[JP_EXECUTABLE_PATH].toString();
+    output.arguments = a_object[JP_ARGUMENTS].toString();
+    return output;
+}
+
 const char JP_ID[] = "id";
 const char JP_TYPE[] = "type";
 const char JP_JOB_STATE[] = "jobState";
@@ -126,8 +251,10 @@ const char JP_TIME_STARTED[] = "timeStarted";
 const char JP_TIME_ENDED[] = "timeEnded";
 const char JP_SCRIPT_NAME[] = "scriptName";
 const char JP_SCRIPT_TEXT[] = "scriptText";
+const char JP_SCRIPT_HASH[] = "scriptHash";
 const char JP_ENCODING_TYPE[] = "encodingType";
 const char JP_ENCODING_HEADER_TYPE[] = "encodingHeaderType";
+const char JP_ENCODING_PACKING[] = "encodingPacking";
 const char JP_EXECUTABLE_PATH[] = "executablePath";
 const char JP_ARGUMENTS[] = "arguments";
 const char JP_SHELL_COMMAND[] = "shellCommand";
@@ -137,6 +264,78 @@ const char JP_LAST_FRAME[] = "lastFrame";
 const char JP_LAST_FRAME_REAL[] = "lastFrameReal";
 const char JP_FRAMES_PROCESSED[] = "framesProcessed";
 const char JP_FPS[] = "fps";
+const char JP_SCRIPT_WAIT_TIME[] = "scriptWaitTime";
+const char JP_PIPE_STALL_TIME[] = "pipeStallTime";
+const char JP_PACKING_TIME[] = "packingTime";
+const char JP_ENCODER_CPU_TIME[] = "encoderCpuTime";
+const char JP_RUNNING_TIME[] = "runningTime";
+const char JP_REQUEST_WINDOW[] = "requestWindow";
+const char JP_REQUEST_WINDOW_LIMIT[] = "requestWindowLimit";
+const char JP_SEGMENTS[] = "segments";
+const char JP_MERGE_COMMAND[] = "mergeCommand";
+const char JP_SEGMENTS_PROGRESS[] = "segmentsProgress";
+const char JP_EXTRA_OUTPUTS[] = "extraOutputs";
+const char JP_CHECKPOINT_FRAMES[] = "checkpointFrames";
+const char JP_CHECKSUM_FILE[] = "checksumFile";
+const char JP_CHECKSUM_COMPARE[] = "checksumCompare";
+const char JP_ENCODER_LOG_FILE[] = "encoderLogFile";
+const char JP_ENCODER_FPS[] = "encoderFps";
+const char JP_ENCODER_BITRATE[] = "encoderBitrate";
+const char JP_THREADS[] = "threads";
+const char JP_PRIORITY[] = "priority";
+
+static const char JP_SEGMENT_FIRST_FRAME[] = "firstFrame";
+static const char JP_SEGMENT_LAST_FRAME[] = "lastFrame";
+static const char JP_SEGMENT_FRAMES_PROCESSED[] = "framesProcessed";
+static const char JP_SEGMENT_ATTEMPTS[] = "attempts";
+
+QJsonObject JobSegmentProgress::toJson() const
+{
+    QJsonObject jsSegment;
+    jsSegment[JP_SEGMENT_FIRST_FRAME] = firstFrame;
+    jsSegment[JP_SEGMENT_LAST_FRAME] = lastFrame;
+    jsSegment[JP_SEGMENT_FRAMES_PROCESSED] = framesProcessed;
+    jsSegment[JP_SEGMENT_ATTEMPTS] = attempts;
+    return jsSegment;
+}
+
+JobSegmentProgress JobSegmentProgress::fromJson(const QJsonObject &a_object)
+{
+    JobSegmentProgress segment;
+    segment.firstFrame = a_object[JP_SEGMENT_FIRST_FRAME].toInt(-1);
+    segment.lastFrame = a_object[JP_SEGMENT_LAST_FRAME].toInt(-1);
+    segment.framesProcessed = a_object[JP_SEGMENT_FRAMES_PROCESSED].toInt();
+    segment.attempts = a_object[JP_SEGMENT_ATTEMPTS].toInt();
+    return segment;
+}
+
+static QJsonArray segmentsProgressToJson(
+    const QVector<JobSegmentProgress> &a_segments)
+{
+    QJsonArray jsSegments;
+
+    for (const JobSegmentProgress &segment : a_segments) {
+        jsSegments.push_back(segment.toJson());
+    }
+
+    return jsSegments;
+}
+
+static QVector<JobSegmentProgress> segmentsProgressFromJson(
+    const QJsonValue &a_value)
+{
+    QVector<JobSegmentProgress> segments;
+
+    if (!a_value.isArray()) {
+        return segments;
+    }
+
+    for (const QJsonValue &value : a_value.toArray()) {
+        segments.push_back(JobSegmentProgress::fromJson(value.toObject()));
+    }
+
+    return segments;
+}
 
 QJsonObject JobProperties::toJson() const
 {
@@ -157,8 +356,10 @@ QJsonObject JobProperties::toJson() const
     jsJob[JP_TIME_ENDED] = timeEnded.toMSecsSinceEpoch();
     jsJob[JP_SCRIPT_NAME] = scriptName;
     jsJob[JP_SCRIPT_TEXT] = scriptText;
+    jsJob[JP_SCRIPT_HASH] = scriptHash;
     jsJob[JP_ENCODING_TYPE] = (int)encodingType;
     jsJob[JP_ENCODING_HEADER_TYPE] = (int)encodingHeaderType;
+    jsJob[JP_ENCODING_PACKING] = (int)encodingPacking;
     jsJob[JP_EXECUTABLE_PATH] = executablePath;
     jsJob[JP_ARGUMENTS] = arguments;
     jsJob[JP_SHELL_COMMAND] = shellCommand;
@@ -168,9 +369,106 @@ QJsonObject JobProperties::toJson() const
     jsJob[JP_LAST_FRAME_REAL] = lastFrameReal;
     jsJob[JP_FRAMES_PROCESSED] = framesProcessed;
     jsJob[JP_FPS] = fps;
+    jsJob[JP_SCRIPT_WAIT_TIME] = scriptWaitTime;
+    jsJob[JP_PIPE_STALL_TIME] = pipeStallTime;
+    jsJob[JP_SEGMENTS] = segments;
+    jsJob[JP_MERGE_COMMAND] = mergeCommand;
+    jsJob[JP_CHECKPOINT_FRAMES] = checkpointFrames;
+    jsJob[JP_CHECKSUM_FILE] = checksumFile;
+    jsJob[JP_CHECKSUM_COMPARE] = checksumCompare;
+    jsJob[JP_ENCODER_LOG_FILE] = encoderLogFile;
+    jsJob[JP_ENCODER_FPS] = encoderFps;
+    jsJob[JP_ENCODER_BITRATE] = encoderBitrate;
+    jsJob[JP_THREADS] = threads;
+    jsJob[JP_PRIORITY] = (int)priority;
+    jsJob[JP_SEGMENTS_PROGRESS] = segmentsProgressToJson(segmentsProgress);
+
+    QJsonArray jsExtraOutputs;
+
+    for (const JobOutput &output : extraOutputs) {
+        jsExtraOutputs.push_back(output.toJson());
+    }
+
+    jsJob[JP_EXTRA_OUTPUTS] = jsExtraOutputs;
+    return jsJob;
+}
+
+QJsonObject JobProperties::progressToJson() const
+{
+    QJsonObject jsJob;
+    jsJob[JP_ID] = id.toString();
+    jsJob[JP_FRAMES_PROCESSED] = framesProcessed;
+    jsJob[JP_FPS] = fps;
+    jsJob[JP_SCRIPT_WAIT_TIME] = scriptWaitTime;
+    jsJob[JP_PIPE_STALL_TIME] = pipeStallTime;
+    jsJob[JP_PACKING_TIME] = packingTime;
+    jsJob[JP_ENCODER_CPU_TIME] = encoderCpuTime;
+    jsJob[JP_RUNNING_TIME] = runningTime;
+    jsJob[JP_REQUEST_WINDOW] = requestWindow;
+    jsJob[JP_REQUEST_WINDOW_LIMIT] = requestWindowLimit;
+    jsJob[JP_ENCODER_FPS] = encoderFps;
+    jsJob[JP_ENCODER_BITRATE] = encoderBitrate;
+
+    if (!segmentsProgress.isEmpty()) {
+        jsJob[JP_SEGMENTS_PROGRESS] =
+            segmentsProgressToJson(segmentsProgress);
+    }
+
     return jsJob;
 }
 
+void JobProperties::progressFromJson(const QJsonObject &a_object)
+{
+    if (a_object.contains(JP_FRAMES_PROCESSED)) {
+        framesProcessed = a_object[JP_FRAMES_PROCESSED].toInt();
+    }
+
+    if (a_object.contains(JP_FPS)) {
+        fps = a_object[JP_FPS].toDouble();
+    }
+
+    if (a_object.contains(JP_SCRIPT_WAIT_TIME)) {
+        scriptWaitTime = a_object[JP_SCRIPT_WAIT_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_PIPE_STALL_TIME)) {
+        pipeStallTime = a_object[JP_PIPE_STALL_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_PACKING_TIME)) {
+        packingTime = a_object[JP_PACKING_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_ENCODER_CPU_TIME)) {
+        encoderCpuTime = a_object[JP_ENCODER_CPU_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_RUNNING_TIME)) {
+        runningTime = a_object[JP_RUNNING_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_REQUEST_WINDOW)) {
+        requestWindow = a_object[JP_REQUEST_WINDOW].toInt();
+    }
+
+    if (a_object.contains(JP_REQUEST_WINDOW_LIMIT)) {
+        requestWindowLimit = a_object[JP_REQUEST_WINDOW_LIMIT].toInt();
+    }
+
+    if (a_object.contains(JP_ENCODER_FPS)) {
+        encoderFps = a_object[JP_ENCODER_FPS].toDouble();
+    }
+
+    if (a_object.contains(JP_ENCODER_BITRATE)) {
+        encoderBitrate = a_object[JP_ENCODER_BITRATE].toDouble();
+    }
+
+    if (a_object.contains(JP_SEGMENTS_PROGRESS)) {
+        segmentsProgress =
+            segmentsProgressFromJson(a_object[JP_SEGMENTS_PROGRESS]);
+    }
+}
+
 JobProperties JobProperties::fromJson(const QJsonObject &a_object)
 {
     JobProperties properties;
@@ -212,6 +510,10 @@ JobProperties JobProperties::fromJson(const QJsonObject &a_object)
         properties.scriptText = a_object[JP_SCRIPT_TEXT].toString();
     }
 
+    if (a_object.contains(JP_SCRIPT_HASH)) {
+        properties.scriptHash = a_object[JP_SCRIPT_HASH].toString();
+    }
+
     if (a_object.contains(JP_ENCODING_TYPE))
         properties.encodingType =
             (EncodingType)a_object[JP_ENCODING_TYPE].toInt();
@@ -220,6 +522,10 @@ JobProperties JobProperties::fromJson(const QJsonObject &a_object)
         properties.encodingHeaderType =
             (EncodingHeaderType)a_object[JP_ENCODING_HEADER_TYPE].toInt();
 
+    if (a_object.contains(JP_ENCODING_PACKING))
+        properties.encodingPacking =
+            (EncodingPacking)a_object[JP_ENCODING_PACKING].toInt();
+
     if (a_object.contains(JP_EXECUTABLE_PATH)) {
         properties.executablePath = a_object[JP_EXECUTABLE_PATH].toString();
     }
@@ -256,6 +562,87 @@ JobProperties JobProperties::fromJson(const QJsonObject &a_object)
         properties.fps = a_object[JP_FPS].toDouble();
     }
 
+    if (a_object.contains(JP_SCRIPT_WAIT_TIME)) {
+        properties.scriptWaitTime = a_object[JP_SCRIPT_WAIT_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_PIPE_STALL_TIME)) {
+        properties.pipeStallTime = a_object[JP_PIPE_STALL_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_PACKING_TIME)) {
+        properties.packingTime = a_object[JP_PACKING_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_ENCODER_CPU_TIME)) {
+        properties.encoderCpuTime = a_object[JP_ENCODER_CPU_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_RUNNING_TIME)) {
+        properties.runningTime = a_object[JP_RUNNING_TIME].toDouble();
+    }
+
+    if (a_object.contains(JP_REQUEST_WINDOW)) {
+        properties.requestWindow = a_object[JP_REQUEST_WINDOW].toInt();
+    }
+
+    if (a_object.contains(JP_REQUEST_WINDOW_LIMIT)) {
+        properties.requestWindowLimit =
+            a_object[JP_REQUEST_WINDOW_LIMIT].toInt();
+    }
+
+    if (a_object.contains(JP_SEGMENTS)) {
+        properties.segments = a_object[JP_SEGMENTS].toInt();
+    }
+
+    if (a_object.contains(JP_MERGE_COMMAND)) {
+        properties.mergeCommand = a_object[JP_MERGE_COMMAND].toString();
+    }
+
+    if (a_object.contains(JP_CHECKPOINT_FRAMES)) {
+        properties.checkpointFrames = a_object[JP_CHECKPOINT_FRAMES].toInt();
+    }
+
+    if (a_object.contains(JP_CHECKSUM_FILE)) {
+        properties.checksumFile = a_object[JP_CHECKSUM_FILE].toString();
+    }
+
+    if (a_object.contains(JP_CHECKSUM_COMPARE)) {
+        properties.checksumCompare = a_object[JP_CHECKSUM_COMPARE].toBool();
+    }
+
+    if (a_object.contains(JP_ENCODER_LOG_FILE)) {
+        properties.encoderLogFile = a_object[JP_ENCODER_LOG_FILE].toString();
+    }
+
+    if (a_object.contains(JP_ENCODER_FPS)) {
+        properties.encoderFps = a_object[JP_ENCODER_FPS].toDouble();
+    }
+
+    if (a_object.contains(JP_ENCODER_BITRATE)) {
+        properties.encoderBitrate = a_object[JP_ENCODER_BITRATE].toDouble();
+    }
+
+    if (a_object.contains(JP_THREADS)) {
+        properties.threads = a_object[JP_THREADS].toInt();
+    }
+
+    if (a_object.contains(JP_PRIORITY)) {
+        properties.priority = (JobPriority)a_object[JP_PRIORITY].toInt();
+    }
+
+    if (a_object.contains(JP_SEGMENTS_PROGRESS)) {
+        properties.segmentsProgress =
+            segmentsProgressFromJson(a_object[JP_SEGMENTS_PROGRESS]);
+    }
+
+    if (a_object[JP_EXTRA_OUTPUTS].isArray()) {
+        for (const QJsonValue &value : a_object[JP_EXTRA_OUTPUTS].toArray()) {
+            properties.extraOutputs.push_back(
+                JobOutput::fromJson(value.toObject()));
+        }
+    }
+
     return properties;
 }
 
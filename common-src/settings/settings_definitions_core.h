@@ -44,6 +44,25 @@ enum class EncodingHeaderType {
     Y4M,
 };
 
+// Layout of the frames fed to the encoder. Packed layouts need
+// a matching planar YUV script output and no header.
+enum class EncodingPacking {
+    Planar,
+    NV12,
+    P010,
+    V210,
+    Y410,
+};
+
+// Ready jobs of a higher priority start first. When the budget of the job
+// server is used up, they pause running jobs of a lower priority and
+// those resume once there are threads for them again.
+enum class JobPriority {
+    Low,
+    Normal,
+    High,
+};
+
 enum class JobType {
     EncodeScriptCLI,
     RunProcess,
@@ -75,8 +94,11 @@ extern const char JP_DEPENDS_ON_JOB_IDS[];
 extern const char JP_TIME_STARTED[];
 extern const char JP_TIME_ENDED[];
 extern const char JP_SCRIPT_NAME[];
+extern const char JP_SCRIPT_TEXT[];
+extern const char JP_SCRIPT_HASH[];
 extern const char JP_ENCODING_TYPE[];
 extern const char JP_ENCODING_HEADER_TYPE[];
+extern const char JP_ENCODING_PACKING[];
 extern const char JP_EXECUTABLE_PATH[];
 extern const char JP_ARGUMENTS[];
 extern const char JP_SHELL_COMMAND[];
@@ -86,6 +108,50 @@ extern const char JP_LAST_FRAME[];
 extern const char JP_LAST_FRAME_REAL[];
 extern const char JP_FRAMES_PROCESSED[];
 extern const char JP_FPS[];
+extern const char JP_SCRIPT_WAIT_TIME[];
+extern const char JP_PIPE_STALL_TIME[];
+extern const char JP_PACKING_TIME[];
+extern const char JP_ENCODER_CPU_TIME[];
+extern const char JP_RUNNING_TIME[];
+extern const char JP_REQUEST_WINDOW[];
+extern const char JP_REQUEST_WINDOW_LIMIT[];
+extern const char JP_SEGMENTS[];
+extern const char JP_MERGE_COMMAND[];
+extern const char JP_SEGMENTS_PROGRESS[];
+extern const char JP_CHECKPOINT_FRAMES[];
+extern const char JP_CHECKSUM_FILE[];
+extern const char JP_CHECKSUM_COMPARE[];
+extern const char JP_ENCODER_LOG_FILE[];
+extern const char JP_ENCODER_FPS[];
+extern const char JP_ENCODER_BITRATE[];
+extern const char JP_THREADS[];
+extern const char JP_PRIORITY[];
+extern const char JP_EXTRA_OUTPUTS[];
+
+// Frame range and progress of one part of a segmented encoding job.
+struct JobSegmentProgress {
+    int firstFrame = -1;
+    int lastFrame = -1;
+    int framesProcessed = 0;
+    int attempts = 0;
+
+    int framesTotal() const;
+    bool isComplete() const;
+
+    QJsonObject toJson() const;
+    static JobSegmentProgress fromJson(const QJsonObject &a_object);
+};
+
+// Encoder fed with the same frames as the main encoder of a job.
+struct JobOutput {
+    EncodingType encodingType = EncodingType::CLI;
+    EncodingHeaderType encodingHeaderType = EncodingHeaderType::Y4M;
+    QString executablePath;
+    QString arguments;
+
+    QJsonObject toJson() const;
+    static JobOutput fromJson(const QJsonObject &a_object);
+};
 
 struct JobProperties {
     QUuid id;
@@ -96,8 +162,12 @@ struct JobProperties {
     QDateTime timeEnded;
     QString scriptName;
     QString scriptText;
+    // Hash of the script text the job server keeps the text by. Jobs with
+    // the same script share it, and clients get the text only on request.
+    QString scriptHash;
     EncodingType encodingType;
     EncodingHeaderType encodingHeaderType = EncodingHeaderType::Invalid;
+    EncodingPacking encodingPacking;
     QString executablePath;
     QString arguments;
     QString shellCommand;
@@ -107,6 +177,47 @@ struct JobProperties {
     int lastFrameReal;
     int framesProcessed;
     double fps;
+    // Seconds an encoding job has spent waiting for the script to produce
+    // frames and for the encoder to read them.
+    double scriptWaitTime;
+    double pipeStallTime;
+    // Seconds spent packing frames for the encoder, encoder process CPU
+    // time (negative if unknown) and seconds the job has been running.
+    double packingTime;
+    double encoderCpuTime;
+    double runningTime;
+    // Frames an encoding job currently lets the script run ahead of the
+    // encoder, and the most the memory budget allows.
+    int requestWindow;
+    int requestWindowLimit;
+    // Number of parts the frame range is split into, each encoded by its
+    // own encoder process. The merge command joins the parts afterwards.
+    int segments;
+    QString mergeCommand;
+    // Frames encoded by one encoder process of a job that is not
+    // segmented, or 0. Every completed part is a checkpoint the job
+    // resumes from after the job server has died. Segments of
+    // a segmented job are checkpoints on their own.
+    int checkpointFrames;
+    // Progress of every segment or part, or of every output when the job has
+    // extra outputs.
+    QVector<JobSegmentProgress> segmentsProgress;
+    // Encoders fed with the same frames in addition to the main one.
+    QVector<JobOutput> extraOutputs;
+    // Sidecar file with checksums of the frames fed to the encoder, or
+    // empty. In compare mode the frames are checked against it instead.
+    QString checksumFile;
+    bool checksumCompare;
+    // File the whole standard error of the encoder is spooled to, and the
+    // speed and bitrate (kb/s) the encoder reports, 0 while unknown.
+    QString encoderLogFile;
+    double encoderFps;
+    double encoderBitrate;
+    // CPU threads the job is expected to keep busy, script and encoder
+    // together. The job server runs jobs side by side while their threads
+    // fit into its budget. 0 - all of the budget.
+    int threads;
+    JobPriority priority;
 
     JobProperties();
     JobProperties(const JobProperties &) = default;
@@ -117,10 +228,21 @@ struct JobProperties {
     static QString typeName(JobType a_type);
     static QString stateName(JobState a_state);
 
+    static QString hashScript(const QString &a_scriptText);
+
     QString subject() const;
     int framesTotal() const;
 
+    // Which stage of an encoding job limits its speed, judged by
+    // the time the stages spent waiting. Empty until it is known.
+    QString bottleneck() const;
+
     QJsonObject toJson() const;
+    // Subset of properties sent on every progress update.
+    QJsonObject progressToJson() const;
+    // Applies the progress keys present in a_object, leaving the other
+    // properties as they are.
+    void progressFromJson(const QJsonObject &a_object);
     static JobProperties fromJson(const QJsonObject &a_object);
 };
 
@@ -145,14 +267,24 @@ extern const ChromaPlacement DEFAULT_CHROMA_PLACEMENT;
 extern const double DEFAULT_BICUBIC_FILTER_PARAMETER_B;
 extern const double DEFAULT_BICUBIC_FILTER_PARAMETER_C;
 extern const int DEFAULT_LANCZOS_FILTER_TAPS;
+extern const bool DEFAULT_UNBUFFERED_FILE_OUTPUT;
 extern const EncodingType DEFAULT_ENCODING_TYPE;
 extern const EncodingHeaderType DEFAULT_ENCODING_HEADER_TYPE;
+extern const EncodingPacking DEFAULT_ENCODING_PACKING;
 extern const JobType DEFAULT_JOB_TYPE;
 extern const JobState DEFAULT_JOB_STATE;
 extern const int DEFAULT_JOB_FIRST_FRAME;
 extern const int DEFAULT_JOB_LAST_FRAME;
 extern const int DEFAULT_JOB_FRAMES_PROCESSED;
 extern const double DEFAULT_JOB_FPS;
+extern const int DEFAULT_JOB_SEGMENTS;
+extern const int MAX_JOB_SEGMENTS;
+extern const int DEFAULT_JOB_CHECKPOINT_FRAMES;
+extern const int DEFAULT_JOB_THREADS;
+extern const JobPriority DEFAULT_JOB_PRIORITY;
+extern const int DEFAULT_JOBS_THREADS_BUDGET;
+extern const int DEFAULT_JOBS_MEMORY_BUDGET;
+extern const bool DEFAULT_JOBS_RUN_IN_WORKERS;
 extern const int DEFAULT_RECENT_JOB_SERVERS_NUMBER;
 extern const int DEFAULT_WINDOW_GEOMETRY_SAVE_DELAY;
 
@@ -5,10 +5,13 @@
 #include <QFileInfo>
 #include <QStandardPaths>
 #include <QSettings>
+#include <QJsonArray>
+#include <QJsonDocument>
 
 //==============================================================================
 
 const char SETTINGS_FILE_NAME[] = "/vsedit.config";
+const char JOBS_JOURNAL_FILE_NAME[] = "/vsedit-jobs.journal";
 
 //==============================================================================
 
@@ -22,6 +25,10 @@ const char CHROMA_PLACEMENT_KEY[] = "chroma_placement";
 const char BICUBIC_FILTER_PARAMETER_B_KEY[] = "bicubic_filter_parameter_b";
 const char BICUBIC_FILTER_PARAMETER_C_KEY[] = "bicubic_filter_parameter_c";
 const char LANCZOS_FILTER_TAPS_KEY[] = "lanczos_filter_taps";
+const char UNBUFFERED_FILE_OUTPUT_KEY[] = "unbuffered_file_output";
+const char JOBS_THREADS_BUDGET_KEY[] = "jobs_threads_budget";
+const char JOBS_MEMORY_BUDGET_KEY[] = "jobs_memory_budget";
+const char JOBS_RUN_IN_WORKERS_KEY[] = "jobs_run_in_workers";
 const char RECENT_JOB_SERVERS_KEY[] = "recent_job_servers";
 const char TRUSTED_CLIENTS_ADDRESSES_KEY[] = "trusted_clients_addresses";
 
@@ -48,6 +55,7 @@ const char JOB_SCRIPT_NAME_KEY[] = "script_name";
 const char JOB_SCRIPT_TEXT_KEY[] = "script_text";
 const char JOB_ENCODING_TYPE_KEY[] = "encoding_type";
 const char JOB_ENCODING_HEADER_TYPE_KEY[] = "encoding_header_type";
+const char JOB_ENCODING_PACKING_KEY[] = "encoding_packing";
 const char JOB_EXECUTABLE_PATH_KEY[] = "executable_path";
 const char JOB_ARGUMENTS_KEY[] = "arguments";
 const char JOB_SHELL_COMMAND_KEY[] = "shell_command";
@@ -57,6 +65,16 @@ const char JOB_LAST_FRAME_KEY[] = "last_frame";
 const char JOB_LAST_FRAME_REAL_KEY[] = "last_frame_real";
 const char JOB_FRAME_PROCESSED_KEY[] = "frames_processed";
 const char JOB_FPS_KEY[] = "fps";
+const char JOB_SEGMENTS_KEY[] = "segments";
+const char JOB_MERGE_COMMAND_KEY[] = "merge_command";
+const char JOB_EXTRA_OUTPUTS_KEY[] = "extra_outputs";
+const char JOB_CHECKPOINT_FRAMES_KEY[] = "checkpoint_frames";
+const char JOB_SEGMENTS_PROGRESS_KEY[] = "segments_progress";
+const char JOB_CHECKSUM_FILE_KEY[] = "checksum_file";
+const char JOB_CHECKSUM_COMPARE_KEY[] = "checksum_compare";
+const char JOB_ENCODER_LOG_FILE_KEY[] = "encoder_log_file";
+const char JOB_THREADS_KEY[] = "threads";
+const char JOB_PRIORITY_KEY[] = "priority";
 
 //==============================================================================
 
@@ -294,6 +312,57 @@ bool SettingsManagerCore::setLanczosFilterTaps(int a_taps)
 
 //==============================================================================
 
+bool SettingsManagerCore::getUnbufferedFileOutput() const
+{
+    return value(UNBUFFERED_FILE_OUTPUT_KEY,
+                 DEFAULT_UNBUFFERED_FILE_OUTPUT).toBool();
+}
+
+bool SettingsManagerCore::setUnbufferedFileOutput(bool a_unbuffered)
+{
+    return setValue(UNBUFFERED_FILE_OUTPUT_KEY, a_unbuffered);
+}
+
+//==============================================================================
+
+int SettingsManagerCore::getJobsThreadsBudget() const
+{
+    return value(JOBS_THREADS_BUDGET_KEY,
+                 DEFAULT_JOBS_THREADS_BUDGET).toInt();
+}
+
+bool SettingsManagerCore::setJobsThreadsBudget(int a_threads)
+{
+    return setValue(JOBS_THREADS_BUDGET_KEY, a_threads);
+}
+
+//==============================================================================
+
+int SettingsManagerCore::getJobsMemoryBudget() const
+{
+    return value(JOBS_MEMORY_BUDGET_KEY, DEFAULT_JOBS_MEMORY_BUDGET).toInt();
+}
+
+bool SettingsManagerCore::setJobsMemoryBudget(int a_megabytes)
+{
+    return setValue(JOBS_MEMORY_BUDGET_KEY, a_megabytes);
+}
+
+//==============================================================================
+
+bool SettingsManagerCore::getJobsRunInWorkers() const
+{
+    return value(JOBS_RUN_IN_WORKERS_KEY,
+                 DEFAULT_JOBS_RUN_IN_WORKERS).toBool();
+}
+
+bool SettingsManagerCore::setJobsRunInWorkers(bool a_inWorkers)
+{
+    return setValue(JOBS_RUN_IN_WORKERS_KEY, a_inWorkers);
+}
+
+//==============================================================================
+
 QVector<EncodingPreset> SettingsManagerCore::getAllEncodingPresets() const
 {
     QSettings settings(m_settingsFilePath, QSettings::IniFormat);
@@ -443,6 +512,9 @@ QVector<JobProperties> SettingsManagerCore::getJobs() const
         job.encodingHeaderType = (EncodingHeaderType)settings.value(
                                      JOB_ENCODING_HEADER_TYPE_KEY,
                                      (int)DEFAULT_ENCODING_HEADER_TYPE).toInt();
+        job.encodingPacking = (EncodingPacking)settings.value(
+                                  JOB_ENCODING_PACKING_KEY,
+                                  (int)DEFAULT_ENCODING_PACKING).toInt();
 
         job.executablePath = settings.value(JOB_EXECUTABLE_PATH_KEY).toString();
         job.arguments = settings.value(JOB_ARGUMENTS_KEY).toString();
@@ -459,6 +531,38 @@ QVector<JobProperties> SettingsManagerCore::getJobs() const
         job.framesProcessed = settings.value(JOB_FRAME_PROCESSED_KEY,
                                              DEFAULT_JOB_FRAMES_PROCESSED).toInt();
         job.fps = settings.value(JOB_FPS_KEY, DEFAULT_JOB_FPS).toDouble();
+        job.segments = settings.value(JOB_SEGMENTS_KEY,
+                                      DEFAULT_JOB_SEGMENTS).toInt();
+        job.mergeCommand = settings.value(JOB_MERGE_COMMAND_KEY,
+                                          QString()).toString();
+
+        QJsonDocument extraOutputsDocument = QJsonDocument::fromJson(
+                settings.value(JOB_EXTRA_OUTPUTS_KEY).toByteArray());
+
+        for (const QJsonValue &value : extraOutputsDocument.array()) {
+            job.extraOutputs.push_back(JobOutput::fromJson(value.toObject()));
+        }
+
+        job.checkpointFrames = settings.value(JOB_CHECKPOINT_FRAMES_KEY,
+                                              DEFAULT_JOB_CHECKPOINT_FRAMES).toInt();
+        job.checksumFile = settings.value(JOB_CHECKSUM_FILE_KEY).toString();
+        job.checksumCompare =
+            settings.value(JOB_CHECKSUM_COMPARE_KEY, false).toBool();
+        job.encoderLogFile =
+            settings.value(JOB_ENCODER_LOG_FILE_KEY).toString();
+        job.threads = settings.value(JOB_THREADS_KEY,
+                                     DEFAULT_JOB_THREADS).toInt();
+        job.priority = (JobPriority)settings.value(JOB_PRIORITY_KEY,
+                       (int)DEFAULT_JOB_PRIORITY).toInt();
+
+        // Completed segments and parts are what a job resumes from.
+        QJsonDocument segmentsProgressDocument = QJsonDocument::fromJson(
+                    settings.value(JOB_SEGMENTS_PROGRESS_KEY).toByteArray());
+
+        for (const QJsonValue &value : segmentsProgressDocument.array()) {
+            job.segmentsProgress.push_back(
+                JobSegmentProgress::fromJson(value.toObject()));
+        }
 
         jobs.push_back(job);
 
@@ -498,6 +602,7 @@ bool SettingsManagerCore::setJobs(const QVector<JobProperties> &a_jobs)
         settings.setValue(JOB_ENCODING_TYPE_KEY, (int)job.encodingType);
         settings.setValue(JOB_ENCODING_HEADER_TYPE_KEY,
                           (int)job.encodingHeaderType);
+        settings.setValue(JOB_ENCODING_PACKING_KEY, (int)job.encodingPacking);
         settings.setValue(JOB_EXECUTABLE_PATH_KEY, job.executablePath);
         settings.setValue(JOB_ARGUMENTS_KEY, job.arguments);
         settings.setValue(JOB_SHELL_COMMAND_KEY, job.shellCommand);
@@ -507,6 +612,33 @@ bool SettingsManagerCore::setJobs(const QVector<JobProperties> &a_jobs)
         settings.setValue(JOB_LAST_FRAME_REAL_KEY, job.lastFrameReal);
         settings.setValue(JOB_FRAME_PROCESSED_KEY, job.framesProcessed);
         settings.setValue(JOB_FPS_KEY, job.fps);
+        settings.setValue(JOB_SEGMENTS_KEY, job.segments);
+        settings.setValue(JOB_MERGE_COMMAND_KEY, job.mergeCommand);
+
+        QJsonArray jsExtraOutputs;
+
+        for (const JobOutput &output : job.extraOutputs) {
+            jsExtraOutputs.push_back(output.toJson());
+        }
+
+        settings.setValue(JOB_EXTRA_OUTPUTS_KEY,
+                          QJsonDocument(jsExtraOutputs).toJson(QJsonDocument::Compact));
+
+        settings.setValue(JOB_CHECKPOINT_FRAMES_KEY, job.checkpointFrames);
+        settings.setValue(JOB_CHECKSUM_FILE_KEY, job.checksumFile);
+        settings.setValue(JOB_CHECKSUM_COMPARE_KEY, job.checksumCompare);
+        settings.setValue(JOB_ENCODER_LOG_FILE_KEY, job.encoderLogFile);
+        settings.setValue(JOB_THREADS_KEY, job.threads);
+        settings.setValue(JOB_PRIORITY_KEY, (int)job.priority);
+
+        QJsonArray jsSegmentsProgress;
+
+        for (const JobSegmentProgress &segment : job.segmentsProgress) {
+            jsSegmentsProgress.push_back(segment.toJson());
+        }
+
+        settings.setValue(JOB_SEGMENTS_PROGRESS_KEY,
+                          QJsonDocument(jsSegmentsProgress).toJson(QJsonDocument::Compact));
 
         settings.endGroup();
     }
@@ -518,6 +650,14 @@ bool SettingsManagerCore::setJobs(const QVector<JobProperties> &a_jobs)
 
 //==============================================================================
 
+QString SettingsManagerCore::getJobsJournalPath() const
+{
+    return QFileInfo(m_settingsFilePath).absolutePath() +
+           JOBS_JOURNAL_FILE_NAME;
+}
+
+//==============================================================================
+
 QStringList SettingsManagerCore::getRecentJobServers() const
 {
     QStringList recentServers = value(RECENT_JOB_SERVERS_KEY).toStringList();
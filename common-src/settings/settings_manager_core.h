@@ -56,6 +56,25 @@ public:
 
     bool setLanczosFilterTaps(int a_taps);
 
+    bool getUnbufferedFileOutput() const;
+
+    bool setUnbufferedFileOutput(bool a_unbuffered);
+
+    // CPU threads the jobs running at once may take. 0 - all logical CPUs.
+    int getJobsThreadsBudget() const;
+
+    bool setJobsThreadsBudget(int a_threads);
+
+    // Megabytes of frames the jobs running at once may hold. 0 - no cap.
+    int getJobsMemoryBudget() const;
+
+    bool setJobsMemoryBudget(int a_megabytes);
+
+    // Run every encoding job in a worker process of its own.
+    bool getJobsRunInWorkers() const;
+
+    bool setJobsRunInWorkers(bool a_inWorkers);
+
     QVector<EncodingPreset> getAllEncodingPresets() const;
 
     EncodingPreset getEncodingPreset(const QString &a_name) const;
@@ -68,6 +87,10 @@ public:
 
     bool setJobs(const QVector<JobProperties> &a_jobs);
 
+    // Journal the job server keeps its jobs in, next to the settings file.
+    // Jobs stored with the settings are only read to be moved there.
+    QString getJobsJournalPath() const;
+
     QStringList getRecentJobServers() const;
 
     bool setRecentJobServers(const QStringList &a_servers);
@@ -0,0 +1,159 @@
+// Micro-benchmark of the frame reorder buffer.
+//
+// Frames are requested in order up to a fixed distance ahead of the consumer
+// and complete in random order, like frames coming from VapourSynth worker
+// threads. The consumer takes frames out in order as soon as they are ready.
+// The same arrival sequence is fed to FrameReorderBuffer and to a plain list
+// searched with std::find, which is what the job and the preview used before.
+//
+// Usage: frame_reorder_bench [FRAMES]
+//
+// The exit code is non-zero if the two containers deliver different orders.
+
+#include "../frame_reorder_buffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Order in which frames complete when no frame is requested further than
+// a_window frames ahead of the next one to be consumed.
+std::vector<int> arrivalOrder(int a_framesCount, int a_window,
+                              unsigned a_seed)
+{
+    std::mt19937 rng(a_seed);
+    std::vector<int> outstanding;
+    std::vector<bool> arrived(a_framesCount, false);
+    std::vector<int> order;
+    order.reserve(a_framesCount);
+    int nextRequest = 0;
+    int nextConsumed = 0;
+
+    while ((int)order.size() < a_framesCount) {
+        while ((nextConsumed < a_framesCount) && arrived[nextConsumed]) {
+            nextConsumed++;
+        }
+
+        while ((nextRequest < nextConsumed + a_window) &&
+                (nextRequest < a_framesCount)) {
+            outstanding.push_back(nextRequest++);
+        }
+
+        size_t index = rng() % outstanding.size();
+        order.push_back(outstanding[index]);
+        arrived[outstanding[index]] = true;
+        outstanding[index] = outstanding.back();
+        outstanding.pop_back();
+    }
+
+    return order;
+}
+
+// Previous approach: unordered list, linear search and erase from the middle.
+long long runList(const std::vector<int> &a_order)
+{
+    std::vector<Frame> cache;
+    int nextFrame = 0;
+    long long checksum = 0;
+
+    for (int number : a_order) {
+        cache.push_back(Frame(number, 0, nullptr));
+
+        for (;;) {
+            std::vector<Frame>::iterator it = std::find(cache.begin(),
+                                              cache.end(), Frame(nextFrame, 0, nullptr));
+
+            if (it == cache.end()) {
+                break;
+            }
+
+            checksum = checksum * 31 + it->number;
+            cache.erase(it);
+            nextFrame++;
+        }
+    }
+
+    return checksum;
+}
+
+long long runReorderBuffer(const std::vector<int> &a_order, int a_window)
+{
+    FrameReorderBuffer cache;
+    cache.reset(0, a_window);
+    long long checksum = 0;
+
+    for (int number : a_order) {
+        cache.insert(Frame(number, 0, nullptr));
+
+        while (cache.frontReady()) {
+            checksum = checksum * 31 + cache.popFront().number;
+        }
+    }
+
+    return checksum;
+}
+
+template<typename Run>
+double nanosecondsPerFrame(int a_framesCount, long long &a_checksum,
+                           Run a_run)
+{
+    typedef std::chrono::steady_clock clock;
+    double best = 0.0;
+
+    for (int i = 0; i < 5; ++i) {
+        clock::time_point start = clock::now();
+        a_checksum = a_run();
+        std::chrono::duration<double, std::nano> passed = clock::now() - start;
+        double perFrame = passed.count() / a_framesCount;
+
+        if ((i == 0) || (perFrame < best)) {
+            best = perFrame;
+        }
+    }
+
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int framesCount = 100000;
+
+    if (argc > 1) {
+        framesCount = std::max(atoi(argv[1]), 1);
+    }
+
+    const int windows[] = {8, 32, 100, 400, 1600};
+    bool mismatch = false;
+
+    printf("%d frames\n", framesCount);
+    printf("%8s %14s %14s %9s\n", "window", "list ns/frame", "ring ns/frame",
+           "speedup");
+
+    for (int window : windows) {
+        std::vector<int> order = arrivalOrder(framesCount, window, 1234u);
+        long long listChecksum = 0;
+        long long ringChecksum = 0;
+
+        double listTime = nanosecondsPerFrame(framesCount, listChecksum,
+        [&]() { return runList(order); });
+        double ringTime = nanosecondsPerFrame(framesCount, ringChecksum,
+        [&]() { return runReorderBuffer(order, window); });
+
+        if (listChecksum != ringChecksum) {
+            mismatch = true;
+        }
+
+        printf("%8d %14.1f %14.1f %8.1fx%s\n", window, listTime, ringTime,
+               listTime / ringTime, (listChecksum != ringChecksum) ?
+               "  MISMATCH" : "");
+    }
+
+    return mismatch ? 1 : 0;
+}
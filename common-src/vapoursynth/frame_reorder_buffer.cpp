@@ -0,0 +1,209 @@
+#include "frame_reorder_buffer.h"
+
+#include <cassert>
+
+//==============================================================================
+
+// Frame numbers are never negative, so this marks an empty slot.
+static const Frame EMPTY_SLOT(-1, -1, nullptr);
+
+//==============================================================================
+
+FrameReorderBuffer::FrameReorderBuffer():
+    m_head(0)
+    , m_size(0)
+    , m_baseFrame(0)
+    , m_framesCount(0)
+{
+}
+
+// END OF FrameReorderBuffer::FrameReorderBuffer()
+//==============================================================================
+
+void FrameReorderBuffer::reset(int a_baseFrame, size_t a_capacity,
+                               int a_framesCount)
+{
+    m_slots.assign(a_capacity, EMPTY_SLOT);
+    m_head = 0;
+    m_size = 0;
+    m_baseFrame = a_baseFrame;
+    m_framesCount = a_framesCount;
+}
+
+// END OF void FrameReorderBuffer::reset(int a_baseFrame, size_t a_capacity,
+//		int a_framesCount)
+//==============================================================================
+
+size_t FrameReorderBuffer::capacity() const
+{
+    return m_slots.size();
+}
+
+// END OF size_t FrameReorderBuffer::capacity() const
+//==============================================================================
+
+size_t FrameReorderBuffer::size() const
+{
+    return m_size;
+}
+
+// END OF size_t FrameReorderBuffer::size() const
+//==============================================================================
+
+bool FrameReorderBuffer::empty() const
+{
+    return (m_size == 0);
+}
+
+// END OF bool FrameReorderBuffer::empty() const
+//==============================================================================
+
+int FrameReorderBuffer::baseFrame() const
+{
+    return m_baseFrame;
+}
+
+// END OF int FrameReorderBuffer::baseFrame() const
+//==============================================================================
+
+bool FrameReorderBuffer::fits(int a_frameNumber) const
+{
+    return (offsetOf(a_frameNumber) < m_slots.size());
+}
+
+// END OF bool FrameReorderBuffer::fits(int a_frameNumber) const
+//==============================================================================
+
+bool FrameReorderBuffer::insert(const Frame &a_frame)
+{
+    size_t offset = offsetOf(a_frame.number);
+
+    if (offset >= m_slots.size()) {
+        return false;
+    }
+
+    Frame &slot = m_slots[slotOf(offset)];
+
+    if (slot.number >= 0) {
+        return false;
+    }
+
+    slot = a_frame;
+    m_size++;
+    return true;
+}
+
+// END OF bool FrameReorderBuffer::insert(const Frame & a_frame)
+//==============================================================================
+
+bool FrameReorderBuffer::contains(int a_frameNumber) const
+{
+    size_t offset = offsetOf(a_frameNumber);
+
+    if (offset >= m_slots.size()) {
+        return false;
+    }
+
+    return (m_slots[slotOf(offset)].number == a_frameNumber);
+}
+
+// END OF bool FrameReorderBuffer::contains(int a_frameNumber) const
+//==============================================================================
+
+bool FrameReorderBuffer::frontReady() const
+{
+    return ((m_size > 0) && (m_slots[m_head].number >= 0));
+}
+
+// END OF bool FrameReorderBuffer::frontReady() const
+//==============================================================================
+
+const Frame &FrameReorderBuffer::front() const
+{
+    assert(frontReady());
+    return m_slots[m_head];
+}
+
+// END OF const Frame & FrameReorderBuffer::front() const
+//==============================================================================
+
+Frame FrameReorderBuffer::popFront()
+{
+    assert(frontReady());
+
+    Frame frame = m_slots[m_head];
+    m_slots[m_head] = EMPTY_SLOT;
+    m_head = slotOf(1);
+    m_size--;
+    m_baseFrame++;
+
+    if ((m_framesCount > 0) && (m_baseFrame >= m_framesCount)) {
+        m_baseFrame = 0;
+    }
+
+    return frame;
+}
+
+// END OF Frame FrameReorderBuffer::popFront()
+//==============================================================================
+
+std::vector<Frame> FrameReorderBuffer::takeAll()
+{
+    std::vector<Frame> frames;
+    frames.reserve(m_size);
+
+    for (Frame &slot : m_slots) {
+        if (slot.number >= 0) {
+            frames.push_back(slot);
+            slot = EMPTY_SLOT;
+        }
+    }
+
+    m_size = 0;
+    return frames;
+}
+
+// END OF std::vector<Frame> FrameReorderBuffer::takeAll()
+//==============================================================================
+
+size_t FrameReorderBuffer::offsetOf(int a_frameNumber) const
+{
+    if (a_frameNumber < 0) {
+        return m_slots.size();
+    }
+
+    int offset = a_frameNumber - m_baseFrame;
+
+    if (m_framesCount > 0) {
+        if (a_frameNumber >= m_framesCount) {
+            return m_slots.size();
+        }
+
+        if (offset < 0) {
+            offset += m_framesCount;
+        }
+    }
+
+    if (offset < 0) {
+        return m_slots.size();
+    }
+
+    return (size_t)offset;
+}
+
+// END OF size_t FrameReorderBuffer::offsetOf(int a_frameNumber) const
+//==============================================================================
+
+size_t FrameReorderBuffer::slotOf(size_t a_offset) const
+{
+    size_t slot = m_head + a_offset;
+
+    if (slot >= m_slots.size()) {
+        slot -= m_slots.size();
+    }
+
+    return slot;
+}
+
+// END OF size_t FrameReorderBuffer::slotOf(size_t a_offset) const
+//==============================================================================
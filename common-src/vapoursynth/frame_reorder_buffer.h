@@ -0,0 +1,65 @@
+#ifndef FRAME_REORDER_BUFFER_H_INCLUDED
+#define FRAME_REORDER_BUFFER_H_INCLUDED
+
+#include "vs_script_processor_structures.h"
+
+#include <cstddef>
+#include <vector>
+
+//==============================================================================
+
+// Holds frames that arrive out of order until they can be consumed in order.
+// Frames are stored in a ring indexed by their distance from the base frame,
+// which is the next frame to be taken out. Insertion, lookup and taking the
+// base frame out are O(1).
+// When framesCount is set, frame numbers wrap around after the last frame,
+// as they do in looped playback.
+class FrameReorderBuffer
+{
+public:
+
+    FrameReorderBuffer();
+
+    // Drops the content without freeing frame references.
+    void reset(int a_baseFrame, size_t a_capacity, int a_framesCount = 0);
+
+    size_t capacity() const;
+    size_t size() const;
+    bool empty() const;
+
+    int baseFrame() const;
+
+    // Whether a frame number falls into the window that can be stored.
+    bool fits(int a_frameNumber) const;
+
+    // Returns false if the frame does not fit or is already stored.
+    // The caller keeps ownership of the frame references then.
+    bool insert(const Frame &a_frame);
+
+    bool contains(int a_frameNumber) const;
+
+    bool frontReady() const;
+    const Frame &front() const;
+
+    // Takes the base frame out and moves the base to the next frame.
+    Frame popFront();
+
+    // Takes every stored frame out, leaving the base where it is.
+    std::vector<Frame> takeAll();
+
+private:
+
+    // Distance from the base frame, or capacity if out of window.
+    size_t offsetOf(int a_frameNumber) const;
+    size_t slotOf(size_t a_offset) const;
+
+    std::vector<Frame> m_slots;
+    size_t m_head;
+    size_t m_size;
+    int m_baseFrame;
+    int m_framesCount;
+};
+
+//==============================================================================
+
+#endif // FRAME_REORDER_BUFFER_H_INCLUDED
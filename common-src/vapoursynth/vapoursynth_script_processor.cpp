@@ -3,8 +3,11 @@
 #include "../helpers.h"
 #include "vs_script_library.h"
 #include "vs_pack_rgb.h"
+#include "vs_pack_yuv.h"
+#include "vs_checksum.h"
 
 #include <vector>
+#include <algorithm>
 #include <cmath>
 #include <utility>
 #include <memory>
@@ -174,18 +177,7 @@ bool VapourSynthScriptProcessor::finalize()
         return false;
     }
 
-    for (NodePair &nodePair : m_nodePairForOutputIndex) {
-
-        if (nodePair.pOutputNode) {
-            m_cpVSAPI->freeNode(nodePair.pOutputNode);
-        }
-
-        if (nodePair.pPreviewNode) {
-            m_cpVSAPI->freeNode(nodePair.pPreviewNode);
-        }
-    }
-
-    m_nodePairForOutputIndex.clear();
+    freeNodePairs();
 
     m_cpVideoInfo = nullptr;
     m_cpCoreInfo = nullptr;
@@ -236,21 +228,17 @@ const VSVideoInfo *VapourSynthScriptProcessor::videoInfo(int a_outputIndex)
     Q_ASSERT(m_cpVSAPI);
     Q_ASSERT(m_pVSScript);
 
-    VSNodeRef *pNode =
-        m_pVSScriptLibrary->getOutput(m_pVSScript, a_outputIndex);
+    // Packed outputs differ from the script ones. The node pair holds
+    // the node the frames actually come from.
+    VSNodeRef *pNode = getNodePair(a_outputIndex, false).pOutputNode;
 
     if (!pNode) {
-        m_error = tr("Couldn't resolve output node number %1.")
-                  .arg(a_outputIndex);
-        emit signalWriteLogMessage(mtCritical, m_error);
         return nullptr;
     }
 
     const VSVideoInfo *cpVideoInfo = m_cpVSAPI->getVideoInfo(pNode);
     Q_ASSERT(cpVideoInfo);
 
-    m_cpVSAPI->freeNode(pNode);
-
     return cpVideoInfo;
 }
 
@@ -834,6 +822,24 @@ NodePair &VapourSynthScriptProcessor::getNodePair(int a_outputIndex,
             emit signalWriteLogMessage(mtCritical, m_error);
             return nodePair;
         }
+
+        if (m_outputPacking != EncodingPacking::Planar) {
+            nodePair.pOutputNode = packOutputNode(nodePair.pOutputNode);
+
+            if (!nodePair.pOutputNode) {
+                return nodePair;
+            }
+        }
+
+        // Hashes the frames exactly as they leave the processor.
+        if (m_outputChecksums) {
+            nodePair.pOutputNode = applyOutputFilter(nodePair.pOutputNode,
+                                   checksumCreate, m_cpVSAPI->createMap());
+
+            if (!nodePair.pOutputNode) {
+                return nodePair;
+            }
+        }
     }
 
     if (a_needPreview && (!nodePair.pPreviewNode)) {
@@ -854,6 +860,169 @@ NodePair &VapourSynthScriptProcessor::getNodePair(int a_outputIndex,
 //		bool a_needPreview)
 //==============================================================================
 
+bool VapourSynthScriptProcessor::setOutputPacking(EncodingPacking a_packing)
+{
+    if (a_packing == m_outputPacking) {
+        return true;
+    }
+
+    if (!resetOutputNodes()) {
+        return false;
+    }
+
+    m_outputPacking = a_packing;
+    return true;
+}
+
+// END OF bool VapourSynthScriptProcessor::setOutputPacking(
+//		EncodingPacking a_packing)
+//==============================================================================
+
+bool VapourSynthScriptProcessor::setOutputChecksums(bool a_enabled)
+{
+    if (a_enabled == m_outputChecksums) {
+        return true;
+    }
+
+    if (!resetOutputNodes()) {
+        return false;
+    }
+
+    m_outputChecksums = a_enabled;
+    return true;
+}
+
+// END OF bool VapourSynthScriptProcessor::setOutputChecksums(bool a_enabled)
+//==============================================================================
+
+bool VapourSynthScriptProcessor::setThreadCount(int a_threads)
+{
+    if (!m_initialized) {
+        return false;
+    }
+
+    Q_ASSERT(m_cpVSAPI);
+
+    VSCore *pCore = m_pVSScriptLibrary->getCore(m_pVSScript);
+    m_cpVSAPI->setThreadCount(std::max(a_threads, 0), pCore);
+    m_cpVSAPI->getCoreInfo2(pCore, m_cpCoreInfo.get());
+    sendFrameQueueChangeSignal();
+    return true;
+}
+
+// END OF bool VapourSynthScriptProcessor::setThreadCount(int a_threads)
+//==============================================================================
+
+VSNodeRef *VapourSynthScriptProcessor::applyOutputFilter(VSNodeRef *a_pNode,
+        FilterCreateFunction a_create, VSMap *a_pArguments)
+{
+    Q_ASSERT(m_cpVSAPI);
+
+    VSCore *pCore = m_pVSScriptLibrary->getCore(m_pVSScript);
+    m_cpVSAPI->propSetNode(a_pArguments, "clip", a_pNode, paReplace);
+    m_cpVSAPI->freeNode(a_pNode);
+
+    VSMap *pResultMap = m_cpVSAPI->createMap();
+    a_create(a_pArguments, pResultMap, pCore, m_cpVSAPI);
+    m_cpVSAPI->freeMap(a_pArguments);
+
+    const char *cpError = m_cpVSAPI->getError(pResultMap);
+
+    if (cpError) {
+        m_error = tr("Failed to prepare the output:\n");
+        m_error += cpError;
+        emit signalWriteLogMessage(mtCritical, m_error);
+        m_cpVSAPI->freeMap(pResultMap);
+        return nullptr;
+    }
+
+    VSNodeRef *pResultNode =
+        m_cpVSAPI->propGetNode(pResultMap, "clip", 0, nullptr);
+    Q_ASSERT(pResultNode);
+    m_cpVSAPI->freeMap(pResultMap);
+
+    return pResultNode;
+}
+
+// END OF VSNodeRef * VapourSynthScriptProcessor::applyOutputFilter(
+//		VSNodeRef * a_pNode, FilterCreateFunction a_create,
+//		VSMap * a_pArguments)
+//==============================================================================
+
+VSNodeRef *VapourSynthScriptProcessor::packOutputNode(VSNodeRef *a_pNode)
+{
+    Q_ASSERT(m_cpVSAPI);
+
+    p2p_packing packing = p2p_packing_max;
+
+    switch (m_outputPacking) {
+    case EncodingPacking::NV12:
+        packing = p2p_nv12_le;
+        break;
+
+    case EncodingPacking::P010:
+        packing = p2p_p010_le;
+        break;
+
+    case EncodingPacking::V210:
+        packing = p2p_v210_le;
+        break;
+
+    case EncodingPacking::Y410:
+        packing = p2p_y410_le;
+        break;
+
+    default:
+        Q_ASSERT(false);
+    }
+
+    VSMap *pArgumentMap = m_cpVSAPI->createMap();
+    m_cpVSAPI->propSetInt(pArgumentMap, "packing", (int64_t)packing,
+                          paReplace);
+
+    return applyOutputFilter(a_pNode, packCreateYUV, pArgumentMap);
+}
+
+// END OF VSNodeRef * VapourSynthScriptProcessor::packOutputNode(
+//		VSNodeRef * a_pNode)
+//==============================================================================
+
+bool VapourSynthScriptProcessor::resetOutputNodes()
+{
+    if ((!m_frameTicketsQueue.empty()) || (!m_frameTicketsInProcess.empty())) {
+        m_error = tr("Can not change the outputs "
+                     "while frames are requested.");
+        emit signalWriteLogMessage(mtCritical, m_error);
+        return false;
+    }
+
+    // Output filters are applied when the nodes are created.
+    freeNodePairs();
+    return true;
+}
+
+// END OF bool VapourSynthScriptProcessor::resetOutputNodes()
+//==============================================================================
+
+void VapourSynthScriptProcessor::freeNodePairs()
+{
+    for (NodePair &nodePair : m_nodePairForOutputIndex) {
+
+        if (nodePair.pOutputNode) {
+            m_cpVSAPI->freeNode(nodePair.pOutputNode);
+        }
+
+        if (nodePair.pPreviewNode) {
+            m_cpVSAPI->freeNode(nodePair.pPreviewNode);
+        }
+    }
+
+    m_nodePairForOutputIndex.clear();
+}
+
+// END OF void VapourSynthScriptProcessor::freeNodePairs()
+//==============================================================================
+
 QString VapourSynthScriptProcessor::framePropsString(
     const VSFrameRef *a_cpFrame) const
 {
@@ -49,6 +49,18 @@ public:
 
     void setColorDepth(const int a_colorDepth) { m_colorDepth = a_colorDepth; }
 
+    // Makes the outputs deliver frames packed for an encoder, as described
+    // in vs_pack_yuv.h. Fails while frames are requested.
+    bool setOutputPacking(EncodingPacking a_packing);
+
+    // Makes output frames carry the checksums of their planes,
+    // as described in vs_checksum.h. Fails while frames are requested.
+    bool setOutputChecksums(bool a_enabled);
+
+    // Threads of the VapourSynth core. 0 restores one per logical CPU.
+    // Fails before the script is initialized.
+    bool setThreadCount(int a_threads);
+
 
 public slots:
 
@@ -91,6 +103,21 @@ private:
 
     NodePair &getNodePair(int a_outputIndex, bool a_needPreview);
 
+    typedef void (VS_CC *FilterCreateFunction)(const VSMap *, VSMap *,
+            VSCore *, const VSAPI *);
+
+    // Takes a_pNode as the "clip" of the filter with other arguments from
+    // a_pArguments. Returns the filtered node or nullptr on error.
+    // a_pNode is freed either way.
+    VSNodeRef *applyOutputFilter(VSNodeRef *a_pNode,
+                                 FilterCreateFunction a_create, VSMap *a_pArguments);
+
+    VSNodeRef *packOutputNode(VSNodeRef *a_pNode);
+
+    bool resetOutputNodes();
+
+    void freeNodePairs();
+
     QString framePropsString(const VSFrameRef *a_cpFrame) const;
 
     void printFrameProps(const VSFrameRef *a_cpFrame);
@@ -107,6 +134,8 @@ private:
 
     bool m_initialized;
     int m_colorDepth = 0;
+    EncodingPacking m_outputPacking = EncodingPacking::Planar;
+    bool m_outputChecksums = false;
 
     const VSAPI *m_cpVSAPI;
 
@@ -0,0 +1,197 @@
+#include "vs_checksum.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CRC32C_X64
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+const char CHECKSUM_FRAME_PROPERTY[] = "VSEditChecksum";
+
+namespace {
+
+// Reflected Castagnoli polynomial.
+const uint32_t CRC32C_POLYNOMIAL = 0x82F63B78u;
+
+// Tables for slicing by 8 bytes.
+struct Crc32cTables
+{
+    uint32_t table[8][256];
+
+    Crc32cTables()
+    {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1u) ? CRC32C_POLYNOMIAL : 0u);
+            }
+
+            table[0][i] = crc;
+        }
+
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int slice = 1; slice < 8; ++slice) {
+                uint32_t previous = table[slice - 1][i];
+                table[slice][i] = (previous >> 8) ^ table[0][previous & 0xFFu];
+            }
+        }
+    }
+};
+
+const Crc32cTables &crc32cTables()
+{
+    static const Crc32cTables tables;
+    return tables;
+}
+
+uint32_t crc32cSoftware(uint32_t a_crc, const uint8_t *a_cpData, size_t a_size)
+{
+    const uint32_t (*t)[256] = crc32cTables().table;
+
+    while (a_size >= 8) {
+        uint32_t low;
+        uint32_t high;
+        memcpy(&low, a_cpData, 4);
+        memcpy(&high, a_cpData + 4, 4);
+        // Tables are built for little-endian loads.
+        low ^= a_crc;
+        a_crc = t[7][low & 0xFFu] ^ t[6][(low >> 8) & 0xFFu] ^
+                t[5][(low >> 16) & 0xFFu] ^ t[4][low >> 24] ^
+                t[3][high & 0xFFu] ^ t[2][(high >> 8) & 0xFFu] ^
+                t[1][(high >> 16) & 0xFFu] ^ t[0][high >> 24];
+        a_cpData += 8;
+        a_size -= 8;
+    }
+
+    while (a_size > 0) {
+        a_crc = (a_crc >> 8) ^ t[0][(a_crc ^ *a_cpData) & 0xFFu];
+        a_cpData++;
+        a_size--;
+    }
+
+    return a_crc;
+}
+
+#ifdef CRC32C_X64
+
+#ifndef _MSC_VER
+__attribute__((target("sse4.2")))
+#endif
+uint32_t crc32cHardware(uint32_t a_crc, const uint8_t *a_cpData, size_t a_size)
+{
+    uint64_t crc = a_crc;
+
+    while (a_size >= 8) {
+        uint64_t word;
+        memcpy(&word, a_cpData, 8);
+        crc = _mm_crc32_u64(crc, word);
+        a_cpData += 8;
+        a_size -= 8;
+    }
+
+    uint32_t crc32 = (uint32_t)crc;
+
+    while (a_size > 0) {
+        crc32 = _mm_crc32_u8(crc32, *a_cpData);
+        a_cpData++;
+        a_size--;
+    }
+
+    return crc32;
+}
+
+bool cpuHasSse42()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+#endif // CRC32C_X64
+
+} // namespace
+
+uint32_t crc32c(uint32_t a_crc, const void *a_cpData, size_t a_size)
+{
+    const uint8_t *cpData = static_cast<const uint8_t *>(a_cpData);
+    a_crc = ~a_crc;
+
+#ifdef CRC32C_X64
+    static const bool hardware = cpuHasSse42();
+
+    if (hardware) {
+        return ~crc32cHardware(a_crc, cpData, a_size);
+    }
+#endif
+
+    return ~crc32cSoftware(a_crc, cpData, a_size);
+}
+
+struct checksumData {
+    VSNodeRef *node = nullptr;
+    const VSVideoInfo *vi = nullptr;
+};
+
+void VS_CC checksumInit(VSMap *in, VSMap *out, void **instanceData, VSNode *node, VSCore *core, const VSAPI *vsapi)
+{
+    checksumData *d = reinterpret_cast<checksumData *>(*instanceData);
+    vsapi->setVideoInfo(d->vi, 1, node);
+}
+
+const VSFrameRef *VS_CC checksumGetFrame(int n, int activationReason, void **instanceData, void **frameData, VSFrameContext *frameCtx, VSCore *core, const VSAPI *vsapi)
+{
+    checksumData *d = reinterpret_cast<checksumData *>(*instanceData);
+
+    if (activationReason == arInitial) {
+        vsapi->requestFrameFilter(n, d->node, frameCtx);
+    } else if (activationReason == arAllFramesReady) {
+        const VSFrameRef *src_frame = vsapi->getFrameFilter(n, d->node, frameCtx);
+        const VSFormat *fmt = vsapi->getFrameFormat(src_frame);
+        VSFrameRef *dst_frame = vsapi->copyFrame(src_frame, core);
+        VSMap *props = vsapi->getFramePropsRW(dst_frame);
+        vsapi->propDeleteKey(props, CHECKSUM_FRAME_PROPERTY);
+
+        for (int plane = 0; plane < fmt->numPlanes; ++plane) {
+            const uint8_t *src = vsapi->getReadPtr(src_frame, plane);
+            int stride = vsapi->getStride(src_frame, plane);
+            size_t row_bytes = (size_t)vsapi->getFrameWidth(src_frame, plane) * fmt->bytesPerSample;
+            int height = vsapi->getFrameHeight(src_frame, plane);
+            uint32_t crc = 0;
+
+            for (int row = 0; row < height; ++row) {
+                crc = crc32c(crc, src + (ptrdiff_t)row * stride, row_bytes);
+            }
+
+            vsapi->propSetInt(props, CHECKSUM_FRAME_PROPERTY, crc, paAppend);
+        }
+
+        vsapi->freeFrame(src_frame);
+        return dst_frame;
+    }
+
+    return nullptr;
+}
+
+void VS_CC checksumFree(void *instanceData, VSCore *core, const VSAPI *vsapi)
+{
+    checksumData *d = reinterpret_cast<checksumData *>(instanceData);
+    vsapi->freeNode(d->node);
+    delete d;
+}
+
+void VS_CC checksumCreate(const VSMap *in, VSMap *out, VSCore *core, const VSAPI *vsapi)
+{
+    checksumData *data = new checksumData;
+    data->node = vsapi->propGetNode(in, "clip", 0, nullptr);
+    data->vi = vsapi->getVideoInfo(data->node);
+    vsapi->createFilter(in, out, "Checksum", checksumInit, checksumGetFrame, checksumFree, fmParallel, 0, data, core);
+}
@@ -0,0 +1,21 @@
+#ifndef VS_CHECKSUM_H_INCLUDED
+#define VS_CHECKSUM_H_INCLUDED
+
+#include <vapoursynth/VapourSynth.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Frame property holding one CRC-32C per plane. Every plane is hashed
+// row after row over the bytes an encoder gets, without stride padding.
+extern const char CHECKSUM_FRAME_PROPERTY[];
+
+// CRC-32C (Castagnoli) of a_size bytes continuing from a_crc.
+// Uses the SSE4.2 CRC32 instruction where the CPU has it.
+uint32_t crc32c(uint32_t a_crc, const void *a_cpData, size_t a_size);
+
+// Passes the "clip" through, attaching CHECKSUM_FRAME_PROPERTY
+// to every frame. Planes are shared with the source frames, not copied.
+void VS_CC checksumCreate(const VSMap *in, VSMap *out, VSCore *core, const VSAPI *vsapi);
+
+#endif
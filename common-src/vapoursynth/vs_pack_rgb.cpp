@@ -1,11 +1,180 @@
 #include "vs_pack_rgb.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Frames smaller than this are always packed in one call.
+const int PARALLEL_PACK_MIN_PIXELS = 1920 * 1080;
+// Bands are never thinner than this, so each task stays worth the hand-off.
+const int PARALLEL_PACK_MIN_BAND_ROWS = 64;
+const unsigned PARALLEL_PACK_MAX_THREADS = 8;
+
+// Small pool of helper threads used to pack row bands of one frame.
+// Bands are claimed from a shared counter by the calling thread and by
+// the helpers alike, so the caller keeps packing its own frame while the
+// helpers are busy with other frames, and only waits for the bands a
+// helper has already started.
+// The pool is never destroyed and its threads are detached, so nothing
+// is joined during static destruction, after VapourSynth may be gone.
+class PackThreadPool
+{
+public:
+
+    PackThreadPool()
+    {
+        unsigned hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        m_workersCount = std::min(hardwareThreads, PARALLEL_PACK_MAX_THREADS) - 1;
+
+        for (unsigned i = 0; i < m_workersCount; ++i) {
+            std::thread(&PackThreadPool::workerLoop, this).detach();
+        }
+    }
+
+    int threadsCount() const
+    {
+        return (int)m_workersCount + 1;
+    }
+
+    // Runs a_task(0) .. a_task(a_tasksCount - 1) and returns when all are done.
+    void run(int a_tasksCount, const std::function<void(int)> &a_task)
+    {
+        std::shared_ptr<Batch> pBatch = std::make_shared<Batch>();
+        pBatch->tasksCount = a_tasksCount;
+        pBatch->pTask = &a_task;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (int i = 1; i < a_tasksCount; ++i) {
+                m_batches.push_back(pBatch);
+            }
+        }
+        m_taskAvailable.notify_all();
+
+        while (runNextTask(*pBatch)) {
+        }
+
+        std::unique_lock<std::mutex> lock(pBatch->mutex);
+        pBatch->allDone.wait(lock, [&]() { return pBatch->running == 0; });
+    }
+
+private:
+
+    struct Batch {
+        std::mutex mutex;
+        std::condition_variable allDone;
+        int tasksCount = 0;
+        int nextTask = 0;
+        int running = 0;
+        // Only dereferenced for a claimed task, and run() does not return
+        // before every claimed task is finished.
+        const std::function<void(int)> *pTask = nullptr;
+    };
+
+    // Claims and runs one task of the batch. Returns false if every task
+    // has already been claimed.
+    static bool runNextTask(Batch &a_batch)
+    {
+        int task;
+
+        {
+            std::lock_guard<std::mutex> lock(a_batch.mutex);
+
+            if (a_batch.nextTask >= a_batch.tasksCount) {
+                return false;
+            }
+
+            task = a_batch.nextTask++;
+            a_batch.running++;
+        }
+
+        (*a_batch.pTask)(task);
+
+        std::lock_guard<std::mutex> lock(a_batch.mutex);
+
+        if (--a_batch.running == 0) {
+            a_batch.allDone.notify_all();
+        }
+
+        return true;
+    }
+
+    void workerLoop()
+    {
+        for (;;) {
+            std::shared_ptr<Batch> pBatch;
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_taskAvailable.wait(lock, [this]() {
+                    return !m_batches.empty();
+                });
+
+                pBatch = std::move(m_batches.front());
+                m_batches.pop_front();
+            }
+
+            // Nothing is left if the caller got to all bands first.
+            runNextTask(*pBatch);
+        }
+    }
+
+    unsigned m_workersCount = 0;
+    // One entry per band a helper may take.
+    std::deque<std::shared_ptr<Batch>> m_batches;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+};
+
+PackThreadPool &packThreadPool()
+{
+    static PackThreadPool *pPool = new PackThreadPool;
+    return *pPool;
+}
+
+} // namespace
+
 struct packData {
     VSNodeRef *node = nullptr;
     const VSVideoInfo *vi = nullptr;
     enum p2p_packing packing_fmt;
+    // Frames of this filter being packed right now.
+    std::atomic<int> framesPacking{0};
 };
 
+// Number of row bands to split a frame into. Only frames big enough to
+// benefit are split, and only by as many bands as the core has threads
+// not packing other frames, so a saturated core falls back to
+// single-threaded packing.
+static int packBandsCount(packData *d, int width, int height, VSCore *core, const VSAPI *vsapi)
+{
+    if (width * height < PARALLEL_PACK_MIN_PIXELS) {
+        return 1;
+    }
+
+    VSCoreInfo coreInfo;
+    vsapi->getCoreInfo2(core, &coreInfo);
+    // This frame is already counted.
+    int freeThreads = coreInfo.numThreads - d->framesPacking.load();
+
+    if (freeThreads <= 0) {
+        return 1;
+    }
+
+    int bands = std::min(freeThreads + 1, packThreadPool().threadsCount());
+    bands = std::min(bands, height / PARALLEL_PACK_MIN_BAND_ROWS);
+    return std::max(bands, 1);
+}
+
 void VS_CC packInit(VSMap *in, VSMap *out, void **instanceData, VSNode *node, VSCore *core, const VSAPI *vsapi)
 {
     packData *d = reinterpret_cast<packData *>(*instanceData);
@@ -41,7 +210,38 @@ const VSFrameRef *VS_CC packGetFrame(int n, int activationReason, void **instanc
 
         p.dst[0] = vsapi->getWritePtr(dst_frame, 0);
         p.dst_stride[0] = vsapi->getStride(dst_frame, 0);
-        p2p_pack_frame(&p, P2P_ALPHA_SET_ONE);
+
+        d->framesPacking++;
+        int bands = packBandsCount(d, width, height, core, vsapi);
+
+        if (bands > 1) {
+            // Packed formats used here are not vertically subsampled,
+            // so bands can start at any row.
+            int bandHeight = (height + bands - 1) / bands;
+
+            packThreadPool().run(bands, [&](int a_band) {
+                int top = a_band * bandHeight;
+                int rows = std::min(bandHeight, height - top);
+
+                if (rows <= 0) {
+                    return;
+                }
+
+                p2p_buffer_param band = p;
+                band.height = rows;
+
+                for (int plane = 0; plane < 3; ++plane) {
+                    band.src[plane] = static_cast<const uint8_t *>(p.src[plane]) + top * p.src_stride[plane];
+                }
+
+                band.dst[0] = static_cast<uint8_t *>(p.dst[0]) + top * p.dst_stride[0];
+                p2p_pack_frame(&band, P2P_ALPHA_SET_ONE);
+            });
+        } else {
+            p2p_pack_frame(&p, P2P_ALPHA_SET_ONE);
+        }
+
+        d->framesPacking--;
 
         VSMap *props = vsapi->getFramePropsRW(dst_frame);
         vsapi->propSetInt(props, "_packingFormat", static_cast<int64_t>(d->packing_fmt), paReplace);
@@ -61,20 +261,18 @@ void VS_CC packFree(void *instanceData, VSCore *core, const VSAPI *vsapi)
 
 void VS_CC packCreateRGB24(const VSMap *in, VSMap *out, VSCore *core, const VSAPI *vsapi)
 {
-    packData d;
-    d.node = vsapi->propGetNode(in, "clip", 0, nullptr);
-    d.vi = vsapi->getVideoInfo(d.node);
-    d.packing_fmt = p2p_argb32;
-    packData *data = new packData(d);
+    packData *data = new packData;
+    data->node = vsapi->propGetNode(in, "clip", 0, nullptr);
+    data->vi = vsapi->getVideoInfo(data->node);
+    data->packing_fmt = p2p_argb32;
     vsapi->createFilter(in, out, "PackRGB24", packInit, packGetFrame, packFree, fmParallel, 0, data, core);
 }
 
 void VS_CC packCreateRGB30(const VSMap *in, VSMap *out, VSCore *core, const VSAPI *vsapi)
 {
-    packData d;
-    d.node = vsapi->propGetNode(in, "clip", 0, nullptr);
-    d.vi = vsapi->getVideoInfo(d.node);
-    d.packing_fmt = p2p_rgb30;
-    packData *data = new packData(d);
+    packData *data = new packData;
+    data->node = vsapi->propGetNode(in, "clip", 0, nullptr);
+    data->vi = vsapi->getVideoInfo(data->node);
+    data->packing_fmt = p2p_rgb30;
     vsapi->createFilter(in, out, "PackRGB30", packInit, packGetFrame, packFree, fmParallel, 0, data, core);
 }
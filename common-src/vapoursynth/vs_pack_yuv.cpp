@@ -0,0 +1,150 @@
+#include "vs_pack_yuv.h"
+
+#include <cstring>
+#include <string>
+
+struct packYUVData {
+    VSNodeRef *node = nullptr;
+    const VSVideoInfo *vi = nullptr;
+    enum p2p_packing packing_fmt;
+    // Bytes of a packed row, padding included.
+    int row_bytes = 0;
+    // Bytes of a row actually written by the packing function.
+    int packed_row_bytes = 0;
+    // Interleaved chroma rows stored below the luma rows. NV12 and P010 only.
+    int chroma_rows = 0;
+};
+
+void VS_CC packYUVInit(VSMap *in, VSMap *out, void **instanceData, VSNode *node, VSCore *core, const VSAPI *vsapi)
+{
+    packYUVData *d = reinterpret_cast<packYUVData *>(*instanceData);
+    VSVideoInfo new_vi = (VSVideoInfo) * (d->vi);
+    new_vi.format = vsapi->registerFormat(cmGray, stInteger, 8, 0, 0, core);
+    new_vi.width = d->row_bytes;
+    new_vi.height = d->vi->height + d->chroma_rows;
+    vsapi->setVideoInfo(&new_vi, 1, node);
+}
+
+const VSFrameRef *VS_CC packYUVGetFrame(int n, int activationReason, void **instanceData, void **frameData, VSFrameContext *frameCtx, VSCore *core, const VSAPI *vsapi)
+{
+    packYUVData *d = reinterpret_cast<packYUVData *>(*instanceData);
+
+    if (activationReason == arInitial) {
+        vsapi->requestFrameFilter(n, d->node, frameCtx);
+    } else if (activationReason == arAllFramesReady) {
+        const VSFrameRef *src_frame = vsapi->getFrameFilter(n, d->node, frameCtx);
+        int width = d->vi->width;
+        int height = d->vi->height;
+        const VSFormat *dstfmt = vsapi->registerFormat(cmGray, stInteger, 8, 0, 0, core);
+        VSFrameRef *dst_frame = vsapi->newVideoFrame(dstfmt, d->row_bytes, height + d->chroma_rows, src_frame, core);
+
+        uint8_t *dst = vsapi->getWritePtr(dst_frame, 0);
+        ptrdiff_t dst_stride = vsapi->getStride(dst_frame, 0);
+
+        p2p_buffer_param p = {};
+        p.width = width;
+        p.height = height;
+        p.packing = d->packing_fmt;
+
+        for (int plane = 0; plane < 3; ++plane) {
+            p.src[plane] = vsapi->getReadPtr(src_frame, plane);
+            p.src_stride[plane] = vsapi->getStride(src_frame, plane);
+        }
+
+        p.dst[0] = dst;
+        p.dst_stride[0] = dst_stride;
+
+        if (d->chroma_rows > 0) {
+            p.dst[1] = dst + height * dst_stride;
+            p.dst_stride[1] = dst_stride;
+        }
+
+        // libp2p has SSE4.1/AVX2 kernels for Y410 and for the NV12/P010
+        // chroma. v210 and the P010 luma shift use its generic code.
+        // Sets the Y410 alpha to opaque. The other layouts have no alpha.
+        p2p_pack_frame(&p, P2P_ALPHA_SET_ONE);
+
+        // v210 rows are padded to 128 bytes. Encoders expect zeros there.
+        if (d->packed_row_bytes < d->row_bytes) {
+            for (int row = 0; row < height; ++row) {
+                memset(dst + row * dst_stride + d->packed_row_bytes, 0, d->row_bytes - d->packed_row_bytes);
+            }
+        }
+
+        vsapi->freeFrame(src_frame);
+        return dst_frame;
+    }
+
+    return nullptr;
+}
+
+void VS_CC packYUVFree(void *instanceData, VSCore *core, const VSAPI *vsapi)
+{
+    packYUVData *d = reinterpret_cast<packYUVData *>(instanceData);
+    vsapi->freeNode(d->node);
+    delete d;
+}
+
+void VS_CC packCreateYUV(const VSMap *in, VSMap *out, VSCore *core, const VSAPI *vsapi)
+{
+    packYUVData *data = new packYUVData;
+    data->node = vsapi->propGetNode(in, "clip", 0, nullptr);
+    data->vi = vsapi->getVideoInfo(data->node);
+    data->packing_fmt = static_cast<enum p2p_packing>(vsapi->propGetInt(in, "packing", 0, nullptr));
+
+    int width = data->vi->width;
+    int height = data->vi->height;
+    int required_format = 0;
+    const char *name = nullptr;
+
+    switch (data->packing_fmt) {
+    case p2p_nv12_le:
+        name = "NV12";
+        required_format = pfYUV420P8;
+        data->row_bytes = width;
+        data->chroma_rows = height / 2;
+        break;
+
+    case p2p_p010_le:
+        name = "P010";
+        required_format = pfYUV420P10;
+        data->row_bytes = width * 2;
+        data->chroma_rows = height / 2;
+        break;
+
+    case p2p_v210_le:
+        name = "v210";
+        required_format = pfYUV422P10;
+        // 6 pixels in 16 bytes, rows aligned to 48 pixels.
+        data->row_bytes = (width + 47) / 48 * 128;
+        data->packed_row_bytes = (width + 5) / 6 * 16;
+        break;
+
+    case p2p_y410_le:
+        name = "Y410";
+        required_format = pfYUV444P10;
+        data->row_bytes = width * 4;
+        break;
+
+    default:
+        vsapi->setError(out, "PackYUV: unsupported packing.");
+        vsapi->freeNode(data->node);
+        delete data;
+        return;
+    }
+
+    if (data->packed_row_bytes == 0) {
+        data->packed_row_bytes = data->row_bytes;
+    }
+
+    if (!isConstantFormat(data->vi) || (data->vi->format->id != required_format)) {
+        const VSFormat *required = vsapi->getFormatPreset(required_format, core);
+        std::string error = std::string("PackYUV: ") + name + " needs a constant " + required->name + " clip.";
+        vsapi->setError(out, error.c_str());
+        vsapi->freeNode(data->node);
+        delete data;
+        return;
+    }
+
+    vsapi->createFilter(in, out, "PackYUV", packYUVInit, packYUVGetFrame, packYUVFree, fmParallel, 0, data, core);
+}
@@ -0,0 +1,16 @@
+#ifndef VS_PACK_YUV_H_INCLUDED
+#define VS_PACK_YUV_H_INCLUDED
+
+#include "../libp2p/p2p_api.h"
+#include <vapoursynth/VapourSynth.h>
+#include <vapoursynth/VSHelper.h>
+
+// Packs a planar YUV clip into a layout encoders take as raw input.
+// The "packing" argument holds one of the p2p_packing values supported here:
+// p2p_nv12_le, p2p_p010_le, p2p_v210_le or p2p_y410_le.
+// Frames come out as GRAY8 holding the packed rows one after another,
+// chroma rows of the semi-planar layouts below the luma rows, so they can
+// be written out as they are. Frame properties are kept.
+void VS_CC packCreateYUV(const VSMap *in, VSMap *out, VSCore *core, const VSAPI *vsapi);
+
+#endif
@@ -113,6 +113,7 @@ FORMS += $${PROJECT_DIRECTORY}/src/main_window.ui
 HEADERS += $${COMMON_DIRECTORY}/common-src/application_instance_file_guard/application_instance_file_guard.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/helpers.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/ipc_defines.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/ipc_messages.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/settings/settings_definitions_core.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/settings/settings_definitions.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/settings/settings_manager_core.h
@@ -137,6 +138,7 @@ HEADERS += $${PROJECT_DIRECTORY}/src/trusted_clients_addresses_dialog.h
 HEADERS += $${PROJECT_DIRECTORY}/src/main_window.h
 
 SOURCES += $${COMMON_DIRECTORY}/common-src/helpers.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/ipc_messages.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/application_instance_file_guard/application_instance_file_guard.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/settings/settings_definitions_core.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/settings/settings_definitions.cpp
@@ -3,6 +3,7 @@ DEFINES += QT_NO_DEPRECATED_WARNINGS
 
 QT -= gui
 QT += websockets
+QT += network
 
 QT_VERSION_WARNING = "WARNING: Linking against Qt version lower than 5.6.1 is likely to cause CLI tools video encoding to crash due to I/O but in Qt."
 
@@ -107,36 +108,58 @@ HEADERS += $${COMMON_DIRECTORY}/common-src/log/styled_log_view_core.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/log/vs_editor_log_definitions.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/vapoursynth/vs_script_library.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/vapoursynth/vs_script_processor_structures.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/vapoursynth/frame_reorder_buffer.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/vapoursynth/vapoursynth_script_processor.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer_null.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer_y4m.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/job.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/encoder_pipe_writer.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/encoder_file_writer.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/request_window.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/checksum_file.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/encoder_output_log.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/job_variables.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/application_instance_file_guard/application_instance_file_guard.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/ipc_defines.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/ipc_messages.h
 
 HEADERS += $${PROJECT_DIRECTORY}/src/jobs/job_definitions.h
 HEADERS += $${PROJECT_DIRECTORY}/src/jobs/jobs_manager.h
+HEADERS += $${PROJECT_DIRECTORY}/src/jobs/jobs_journal.h
+HEADERS += $${PROJECT_DIRECTORY}/src/jobs/worker_channel.h
+HEADERS += $${PROJECT_DIRECTORY}/src/jobs/worker_job.h
 HEADERS += $${PROJECT_DIRECTORY}/src/job_server.h
+HEADERS += $${PROJECT_DIRECTORY}/src/job_worker.h
 
 SOURCES += $${COMMON_DIRECTORY}/common-src/helpers.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/ipc_messages.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/settings/settings_definitions_core.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/settings/settings_manager_core.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/log/styled_log_view_core.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/log/vs_editor_log_definitions.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/vapoursynth/vs_script_library.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/vapoursynth/vs_script_processor_structures.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/vapoursynth/frame_reorder_buffer.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/vapoursynth/vapoursynth_script_processor.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer_null.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer_y4m.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/job.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/encoder_pipe_writer.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/encoder_file_writer.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/request_window.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/checksum_file.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/encoder_output_log.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/job_variables.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/application_instance_file_guard/application_instance_file_guard.cpp
 
 SOURCES += $${PROJECT_DIRECTORY}/src/jobs/jobs_manager.cpp
+SOURCES += $${PROJECT_DIRECTORY}/src/jobs/jobs_journal.cpp
+SOURCES += $${PROJECT_DIRECTORY}/src/jobs/worker_channel.cpp
+SOURCES += $${PROJECT_DIRECTORY}/src/jobs/worker_job.cpp
 SOURCES += $${PROJECT_DIRECTORY}/src/job_server.cpp
+SOURCES += $${PROJECT_DIRECTORY}/src/job_worker.cpp
 SOURCES += $${PROJECT_DIRECTORY}/src/main.cpp
 
 include($${COMMON_DIRECTORY}/pro/local_quirks.pri)
@@ -151,11 +151,17 @@ HEADERS += $${COMMON_DIRECTORY}/common-src/log/vs_editor_log_definitions.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/log/vs_editor_log.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/vapoursynth/vs_script_library.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/vapoursynth/vs_script_processor_structures.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/vapoursynth/frame_reorder_buffer.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/vapoursynth/vapoursynth_script_processor.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer_null.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer_y4m.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/job.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/encoder_pipe_writer.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/encoder_file_writer.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/request_window.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/checksum_file.h
+HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/encoder_output_log.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/jobs/job_variables.h
 HEADERS += $${COMMON_DIRECTORY}/common-src/timeline_slider/timeline_slider.h
 
@@ -166,6 +172,7 @@ HEADERS += $${PROJECT_DIRECTORY}/src/settings/theme_elements_model.h
 HEADERS += $${PROJECT_DIRECTORY}/src/settings/settings_dialog.h
 HEADERS += $${PROJECT_DIRECTORY}/src/script_status_bar_widget/script_status_bar_widget.h
 HEADERS += $${PROJECT_DIRECTORY}/src/preview/scroll_navigator.h
+HEADERS += $${PROJECT_DIRECTORY}/src/preview/preview_canvas.h
 HEADERS += $${PROJECT_DIRECTORY}/src/preview/preview_area.h
 HEADERS += $${PROJECT_DIRECTORY}/src/preview/preview_advanced_settings_dialog.h
 HEADERS += $${PROJECT_DIRECTORY}/src/preview/preview_dialog.h
@@ -203,11 +210,17 @@ SOURCES += $${COMMON_DIRECTORY}/common-src/log/vs_editor_log_definitions.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/log/vs_editor_log.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/vapoursynth/vs_script_library.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/vapoursynth/vs_script_processor_structures.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/vapoursynth/frame_reorder_buffer.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/vapoursynth/vapoursynth_script_processor.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer_null.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/frame_header_writers/frame_header_writer_y4m.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/job.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/encoder_pipe_writer.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/encoder_file_writer.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/request_window.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/checksum_file.cpp
+SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/encoder_output_log.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/jobs/job_variables.cpp
 SOURCES += $${COMMON_DIRECTORY}/common-src/timeline_slider/timeline_slider.cpp
 
@@ -218,6 +231,7 @@ SOURCES += $${PROJECT_DIRECTORY}/src/settings/theme_elements_model.cpp
 SOURCES += $${PROJECT_DIRECTORY}/src/settings/settings_dialog.cpp
 SOURCES += $${PROJECT_DIRECTORY}/src/script_status_bar_widget/script_status_bar_widget.cpp
 SOURCES += $${PROJECT_DIRECTORY}/src/preview/scroll_navigator.cpp
+SOURCES += $${PROJECT_DIRECTORY}/src/preview/preview_canvas.cpp
 SOURCES += $${PROJECT_DIRECTORY}/src/preview/preview_area.cpp
 SOURCES += $${PROJECT_DIRECTORY}/src/preview/preview_advanced_settings_dialog.cpp
 SOURCES += $${PROJECT_DIRECTORY}/src/preview/preview_dialog.cpp
@@ -64,7 +64,13 @@ void JobDependenciesDelegate::setEditorData(QWidget *a_pEditor,
 
     pListWidget->clear();
 
-    for (int i = 0; i < a_index.row(); ++i) {
+    // Any other job can be a dependency as long as no job ends up
+    // depending on itself. The server checks that.
+    for (int i = 0; i < cpModel->rowCount(); ++i) {
+        if (i == a_index.row()) {
+            continue;
+        }
+
         QString name = tr("Job %1").arg(i + 1);
         QListWidgetItem *pItem = new QListWidgetItem(name, pListWidget);
         QUuid id = cpModel->jobProperties(i).id;
@@ -11,6 +11,7 @@
 #include <QScreen>
 #include <map>
 #include <limits>
+#include <algorithm>
 
 //==============================================================================
 
@@ -39,13 +40,35 @@ JobEditDialog::JobEditDialog(SettingsManager *a_pSettingsManager,
     m_ui.jobTypeComboBox->setCurrentIndex(0);
     slotJobTypeChanged(m_ui.jobTypeComboBox->currentIndex());
 
+    m_ui.priorityComboBox->addItem(tr("Low"), (int)JobPriority::Low);
+    m_ui.priorityComboBox->addItem(tr("Normal"), (int)JobPriority::Normal);
+    m_ui.priorityComboBox->addItem(tr("High"), (int)JobPriority::High);
+
+    m_ui.encodingOutputTypeComboBox->addItem(tr("Encoder"),
+            (int)EncodingType::CLI);
+    m_ui.encodingOutputTypeComboBox->addItem(tr("File"),
+            (int)EncodingType::Raw);
+
     m_ui.encodingHeaderTypeComboBox->addItem(tr("No header"),
             (int)EncodingHeaderType::NoHeader);
     m_ui.encodingHeaderTypeComboBox->addItem(tr("Y4M"),
             (int)EncodingHeaderType::Y4M);
 
+    m_ui.encodingPackingComboBox->addItem(tr("Planar"),
+                                          (int)EncodingPacking::Planar);
+    m_ui.encodingPackingComboBox->addItem(tr("NV12 (from YUV420P8)"),
+                                          (int)EncodingPacking::NV12);
+    m_ui.encodingPackingComboBox->addItem(tr("P010 (from YUV420P10)"),
+                                          (int)EncodingPacking::P010);
+    m_ui.encodingPackingComboBox->addItem(tr("v210 (from YUV422P10)"),
+                                          (int)EncodingPacking::V210);
+    m_ui.encodingPackingComboBox->addItem(tr("Y410 (from YUV444P10)"),
+                                          (int)EncodingPacking::Y410);
+
     m_ui.encodingFirstFrameSpinBox->setMaximum(std::numeric_limits<int>::max());
     m_ui.encodingLastFrameSpinBox->setMaximum(std::numeric_limits<int>::max());
+    m_ui.encodingSegmentsSpinBox->setMaximum(MAX_JOB_SEGMENTS);
+    slotEncodingSegmentsChanged(m_ui.encodingSegmentsSpinBox->value());
 
     setUpEncodingPresets();
 
@@ -53,6 +76,8 @@ JobEditDialog::JobEditDialog(SettingsManager *a_pSettingsManager,
             this, SLOT(slotJobTypeChanged(int)));
     connect(m_ui.encodingScriptBrowseButton, SIGNAL(clicked()),
             this, SLOT(slotEncodingScriptBrowseButtonClicked()));
+    connect(m_ui.encodingOutputTypeComboBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(slotEncodingOutputTypeChanged(int)));
     connect(m_ui.encodingPresetComboBox, SIGNAL(activated(const QString &)),
             this, SLOT(slotEncodingPresetComboBoxActivated(const QString &)));
     connect(m_ui.encodingPresetSaveButton, SIGNAL(clicked()),
@@ -65,6 +90,14 @@ JobEditDialog::JobEditDialog(SettingsManager *a_pSettingsManager,
             this, SLOT(slotEncodingArgumentsHelpButtonClicked()));
     connect(m_ui.encodingFramesFromVideoButton, SIGNAL(clicked()),
             this, SLOT(slotEncodingFramesFromVideoButtonClicked()));
+    connect(m_ui.encodingSegmentsSpinBox, SIGNAL(valueChanged(int)),
+            this, SLOT(slotEncodingSegmentsChanged(int)));
+    connect(m_ui.encodingCheckpointFramesSpinBox, SIGNAL(valueChanged(int)),
+            this, SLOT(slotEncodingCheckpointFramesChanged(int)));
+    connect(m_ui.encodingExtraOutputAddButton, SIGNAL(clicked()),
+            this, SLOT(slotEncodingExtraOutputAddButtonClicked()));
+    connect(m_ui.encodingExtraOutputRemoveButton, SIGNAL(clicked()),
+            this, SLOT(slotEncodingExtraOutputRemoveButtonClicked()));
     connect(m_ui.processExecutableBrowseButton, SIGNAL(clicked()),
             this, SLOT(slotProcessExecutableBrowseButtonClicked()));
     connect(m_ui.jobSaveButton, SIGNAL(clicked()), this, SLOT(accept()));
@@ -86,10 +119,17 @@ JobProperties JobEditDialog::jobProperties() const
 {
     JobProperties newProperties;
     newProperties.type = (JobType)m_ui.jobTypeComboBox->currentData().toInt();
+    newProperties.threads = m_ui.threadsSpinBox->value();
+    newProperties.priority =
+        (JobPriority)m_ui.priorityComboBox->currentData().toInt();
     newProperties.scriptName = m_ui.encodingScriptPathEdit->text();
 
+    newProperties.encodingType = (EncodingType)m_ui
+            .encodingOutputTypeComboBox->currentData().toInt();
     newProperties.encodingHeaderType = (EncodingHeaderType)m_ui
             .encodingHeaderTypeComboBox->currentData().toInt();
+    newProperties.encodingPacking = (EncodingPacking)m_ui
+            .encodingPackingComboBox->currentData().toInt();
 
     if (newProperties.type == JobType::EncodeScriptCLI) {
         newProperties.executablePath = m_ui.encodingExecutablePathEdit->text();
@@ -102,6 +142,18 @@ JobProperties JobEditDialog::jobProperties() const
     newProperties.shellCommand = m_ui.shellCommandTextEdit->toPlainText();
     newProperties.firstFrame = m_ui.encodingFirstFrameSpinBox->value();
     newProperties.lastFrame = m_ui.encodingLastFrameSpinBox->value();
+    newProperties.segments = m_ui.encodingSegmentsSpinBox->value();
+    newProperties.checkpointFrames =
+        m_ui.encodingCheckpointFramesSpinBox->value();
+    newProperties.checksumFile = m_ui.encodingChecksumFileEdit->text();
+    newProperties.checksumCompare =
+        m_ui.encodingChecksumCompareCheckBox->isChecked();
+    newProperties.mergeCommand = m_ui.encodingMergeCommandEdit->text();
+
+    if (newProperties.type == JobType::EncodeScriptCLI) {
+        newProperties.extraOutputs = m_extraOutputs;
+    }
+
     return newProperties;
 }
 
@@ -116,15 +168,26 @@ int JobEditDialog::call(const QString &a_title,
 
     int index = m_ui.jobTypeComboBox->findData((int)a_jobProperties.type);
     m_ui.jobTypeComboBox->setCurrentIndex(index);
+    m_ui.threadsSpinBox->setValue(a_jobProperties.threads);
+    index = m_ui.priorityComboBox->findData((int)a_jobProperties.priority);
+    m_ui.priorityComboBox->setCurrentIndex(std::max(index, 0));
     m_ui.encodingScriptPathEdit->setText(a_jobProperties.scriptName);
     m_ui.encodingPresetComboBox->clearEditText();
 
+    index = m_ui.encodingOutputTypeComboBox->findData(
+                (int)a_jobProperties.encodingType);
+    m_ui.encodingOutputTypeComboBox->setCurrentIndex(std::max(index, 0));
+
     if (a_jobProperties.encodingHeaderType != EncodingHeaderType::Invalid) {
         index = m_ui.encodingHeaderTypeComboBox->findData(
                     (int)a_jobProperties.encodingHeaderType);
         m_ui.encodingHeaderTypeComboBox->setCurrentIndex(index);
     }
 
+    index = m_ui.encodingPackingComboBox->findData(
+                (int)a_jobProperties.encodingPacking);
+    m_ui.encodingPackingComboBox->setCurrentIndex(std::max(index, 0));
+
     if (!a_jobProperties.executablePath.isEmpty()) {
         m_ui.encodingExecutablePathEdit->setText(a_jobProperties.executablePath);
         m_ui.processExecutablePathEdit->setText(a_jobProperties.executablePath);
@@ -138,6 +201,15 @@ int JobEditDialog::call(const QString &a_title,
 
     m_ui.encodingFirstFrameSpinBox->setValue(a_jobProperties.firstFrame);
     m_ui.encodingLastFrameSpinBox->setValue(a_jobProperties.lastFrame);
+    m_ui.encodingSegmentsSpinBox->setValue(a_jobProperties.segments);
+    m_ui.encodingCheckpointFramesSpinBox->setValue(
+        a_jobProperties.checkpointFrames);
+    m_ui.encodingChecksumFileEdit->setText(a_jobProperties.checksumFile);
+    m_ui.encodingChecksumCompareCheckBox->setChecked(
+        a_jobProperties.checksumCompare);
+    m_ui.encodingMergeCommandEdit->setText(a_jobProperties.mergeCommand);
+    m_extraOutputs = a_jobProperties.extraOutputs;
+    updateExtraOutputsList();
 
     return exec();
 }
@@ -168,6 +240,76 @@ void JobEditDialog::slotJobTypeChanged(int a_index)
 // END OF void JobEditDialog::slotJobTypeChanged(int a_index)
 //==============================================================================
 
+void JobEditDialog::slotEncodingOutputTypeChanged(int a_index)
+{
+    EncodingType outputType = (EncodingType)m_ui.encodingOutputTypeComboBox
+                              ->itemData(a_index).toInt();
+    bool useEncoder = (outputType == EncodingType::CLI);
+
+    m_ui.encodingExecutablePathEdit->setEnabled(useEncoder);
+    m_ui.encodingExecutableBrowseButton->setEnabled(useEncoder);
+}
+
+// END OF void JobEditDialog::slotEncodingOutputTypeChanged(int a_index)
+//==============================================================================
+
+void JobEditDialog::slotEncodingSegmentsChanged(int a_value)
+{
+    m_ui.encodingMergeCommandEdit->setEnabled((a_value > 1) ||
+            (m_ui.encodingCheckpointFramesSpinBox->value() > 0));
+}
+
+// END OF void JobEditDialog::slotEncodingSegmentsChanged(int a_value)
+//==============================================================================
+
+void JobEditDialog::slotEncodingCheckpointFramesChanged(int a_value)
+{
+    m_ui.encodingMergeCommandEdit->setEnabled((a_value > 0) ||
+            (m_ui.encodingSegmentsSpinBox->value() > 1));
+}
+
+// END OF void JobEditDialog::slotEncodingCheckpointFramesChanged(int a_value)
+//==============================================================================
+
+void JobEditDialog::slotEncodingExtraOutputAddButtonClicked()
+{
+    JobOutput output;
+    output.encodingType = (EncodingType)m_ui
+            .encodingOutputTypeComboBox->currentData().toInt();
+    output.encodingHeaderType = (EncodingHeaderType)m_ui
+            .encodingHeaderTypeComboBox->currentData().toInt();
+    output.executablePath = m_ui.encodingExecutablePathEdit->text();
+    output.arguments = m_ui.encodingArgumentsTextEdit->toPlainText();
+
+    if ((output.encodingType == EncodingType::CLI) &&
+            output.executablePath.isEmpty()) {
+        QMessageBox::warning(this, tr("Extra output"),
+                             tr("Choose the encoder executable first."));
+        return;
+    }
+
+    m_extraOutputs.push_back(output);
+    updateExtraOutputsList();
+}
+
+// END OF void JobEditDialog::slotEncodingExtraOutputAddButtonClicked()
+//==============================================================================
+
+void JobEditDialog::slotEncodingExtraOutputRemoveButtonClicked()
+{
+    int row = m_ui.encodingExtraOutputsListWidget->currentRow();
+
+    if ((row < 0) || (row >= m_extraOutputs.size())) {
+        return;
+    }
+
+    m_extraOutputs.remove(row);
+    updateExtraOutputsList();
+}
+
+// END OF void JobEditDialog::slotEncodingExtraOutputRemoveButtonClicked()
+//==============================================================================
+
 void JobEditDialog::slotEncodingScriptBrowseButtonClicked()
 {
     QFileDialog fileDialog(this);
@@ -216,6 +358,11 @@ void JobEditDialog::slotEncodingPresetComboBoxActivated(const QString &a_text)
     m_ui.encodingExecutablePathEdit->setText(preset.executablePath);
     m_ui.encodingArgumentsTextEdit->setPlainText(preset.arguments);
 
+    int outputTypeIndex =
+        m_ui.encodingOutputTypeComboBox->findData((int)preset.type);
+    m_ui.encodingOutputTypeComboBox->setCurrentIndex(
+        std::max(outputTypeIndex, 0));
+
     int headerTypeIndex =
         m_ui.encodingHeaderTypeComboBox->findData((int)preset.headerType);
 
@@ -240,6 +387,9 @@ void JobEditDialog::slotEncodingPresetSaveButtonClicked()
         return;
     }
 
+    preset.type = (EncodingType)
+                  m_ui.encodingOutputTypeComboBox->currentData().toInt();
+
     if (preset.type == EncodingType::CLI) {
         preset.executablePath = m_ui.encodingExecutablePathEdit->text();
 
@@ -250,6 +400,14 @@ void JobEditDialog::slotEncodingPresetSaveButtonClicked()
         }
 
         preset.arguments = m_ui.encodingArgumentsTextEdit->toPlainText();
+    } else if (preset.type == EncodingType::Raw) {
+        preset.arguments = m_ui.encodingArgumentsTextEdit->toPlainText();
+
+        if (preset.arguments.trimmed().isEmpty()) {
+            QMessageBox::warning(this, tr("Preset save error."),
+                                 tr("Output file path must not be empty."));
+            return;
+        }
     }
 
     preset.headerType = (EncodingHeaderType)
@@ -385,6 +543,9 @@ void JobEditDialog::slotEncodingArgumentsHelpButtonClicked()
                                .arg(variable.token).arg(variable.description);
     }
 
+    argumentsHelpString += QLatin1String("\n\n") +
+                           tr("When the output is a file, arguments are the path of that file.");
+
     QString title = tr("Encoder arguments");
     QMessageBox::information(this, title, argumentsHelpString);
 }
@@ -424,6 +585,27 @@ void JobEditDialog::setUpEncodingPresets()
 // END OF void JobEditDialog::setUpEncodingPresets()
 //==============================================================================
 
+void JobEditDialog::updateExtraOutputsList()
+{
+    m_ui.encodingExtraOutputsListWidget->clear();
+
+    for (const JobOutput &output : m_extraOutputs) {
+        QString text;
+
+        if (output.encodingType == EncodingType::Raw) {
+            text = QString("> \"%1\"").arg(output.arguments.simplified());
+        } else {
+            text = QString("\"%1\" %2").arg(output.executablePath)
+                   .arg(output.arguments.simplified());
+        }
+
+        m_ui.encodingExtraOutputsListWidget->addItem(text);
+    }
+}
+
+// END OF void JobEditDialog::updateExtraOutputsList()
+//==============================================================================
+
 QString JobEditDialog::chooseExecutable(const QString &a_dialogTitle,
                                         const QString &a_initialPath)
 {
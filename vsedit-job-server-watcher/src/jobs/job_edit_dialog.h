@@ -30,6 +30,11 @@ private slots:
 
     void slotJobTypeChanged(int a_index);
     void slotEncodingScriptBrowseButtonClicked();
+    void slotEncodingOutputTypeChanged(int a_index);
+    void slotEncodingSegmentsChanged(int a_value);
+    void slotEncodingCheckpointFramesChanged(int a_value);
+    void slotEncodingExtraOutputAddButtonClicked();
+    void slotEncodingExtraOutputRemoveButtonClicked();
     void slotEncodingPresetComboBoxActivated(const QString &a_text);
     void slotEncodingPresetSaveButtonClicked();
     void slotEncodingPresetDeleteButton();
@@ -42,6 +47,8 @@ private:
 
     void setUpEncodingPresets();
 
+    void updateExtraOutputsList();
+
     QString chooseExecutable(const QString &a_dialogTitle,
                              const QString &a_initialPath = QString());
 
@@ -51,6 +58,8 @@ private:
     VSScriptLibrary *m_pVSScriptLibrary;
 
     QVector<EncodingPreset> m_encodingPresets;
+
+    QVector<JobOutput> m_extraOutputs;
 };
 
 #endif // JOB_EDIT_DIALOG_H_INCLUDED
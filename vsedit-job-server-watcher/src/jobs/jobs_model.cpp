@@ -202,6 +202,66 @@ QVariant JobsModel::data(const QModelIndex &a_index, int a_role) const
                 fps += vsedit::timeToString(secondsToFinish);
             }
 
+            if (a_role == Qt::ToolTipRole) {
+                fps += "\n";
+                fps += tr("Waiting for script: %1\nWaiting for encoder: %2")
+                       .arg(vsedit::timeToString(m_jobs[row].scriptWaitTime))
+                       .arg(vsedit::timeToString(m_jobs[row].pipeStallTime));
+                fps += "\n";
+                fps += tr("Packing frames: %1")
+                       .arg(vsedit::timeToString(m_jobs[row].packingTime));
+
+                if (m_jobs[row].encoderCpuTime >= 0.0) {
+                    fps += "\n";
+                    fps += tr("Encoder CPU time: %1")
+                           .arg(vsedit::timeToString(m_jobs[row].encoderCpuTime));
+                }
+
+                if (m_jobs[row].encoderFps > 0.0) {
+                    fps += "\n";
+                    fps += tr("Encoder reports: %1 fps, %2 kb/s")
+                           .arg(m_jobs[row].encoderFps, 0, 'f', 2)
+                           .arg(m_jobs[row].encoderBitrate, 0, 'f', 2);
+                }
+
+                if (!m_jobs[row].encoderLogFile.isEmpty()) {
+                    fps += "\n";
+                    fps += tr("Encoder output: %1")
+                           .arg(m_jobs[row].encoderLogFile);
+                }
+
+                QString bottleneck = m_jobs[row].bottleneck();
+
+                if (!bottleneck.isEmpty()) {
+                    fps += "\n";
+                    fps += bottleneck;
+                }
+
+                if (m_jobs[row].requestWindowLimit > 0) {
+                    fps += "\n";
+                    fps += tr("Frames ahead: %1 of %2")
+                           .arg(m_jobs[row].requestWindow)
+                           .arg(m_jobs[row].requestWindowLimit);
+                }
+
+                const QVector<JobSegmentProgress> &segments =
+                    m_jobs[row].segmentsProgress;
+
+                QString segmentText = m_jobs[row].extraOutputs.isEmpty() ?
+                                      tr("Segment %1: %2/%3") : tr("Output %1: %2/%3");
+
+                for (int i = 0; i < segments.size(); ++i) {
+                    fps += "\n";
+                    fps += segmentText.arg(i + 1)
+                           .arg(segments[i].framesProcessed)
+                           .arg(segments[i].framesTotal());
+
+                    if (segments[i].attempts > 1) {
+                        fps += tr(" (attempt %1)").arg(segments[i].attempts);
+                    }
+                }
+            }
+
             return fps;
         }
     } else if (a_role == Qt::TextAlignmentRole) {
@@ -434,24 +494,38 @@ void JobsModel::requestJobDependsOnIds(const QUuid &a_id,
 //		const QVector<QUuid> & a_dependencies)
 //==============================================================================
 
-bool JobsModel::setJobProgress(const QUuid &a_id, int a_progress, double a_fps)
+bool JobsModel::setJobProgress(const JobProperties &a_progress)
 {
-    int index = indexOfJob(a_id);
+    int index = indexOfJob(a_progress.id);
 
     if (index < 0) {
         return false;
     }
 
-    m_jobs[index].framesProcessed = a_progress;
-    m_jobs[index].fps = a_fps;
+    m_jobs[index].framesProcessed = a_progress.framesProcessed;
+    m_jobs[index].fps = a_progress.fps;
+    m_jobs[index].scriptWaitTime = a_progress.scriptWaitTime;
+    m_jobs[index].pipeStallTime = a_progress.pipeStallTime;
+    m_jobs[index].packingTime = a_progress.packingTime;
+    m_jobs[index].encoderCpuTime = a_progress.encoderCpuTime;
+    m_jobs[index].runningTime = a_progress.runningTime;
+    m_jobs[index].requestWindow = a_progress.requestWindow;
+    m_jobs[index].requestWindowLimit = a_progress.requestWindowLimit;
+    m_jobs[index].encoderFps = a_progress.encoderFps;
+    m_jobs[index].encoderBitrate = a_progress.encoderBitrate;
+
+    if (!a_progress.segmentsProgress.isEmpty()) {
+        m_jobs[index].segmentsProgress = a_progress.segmentsProgress;
+    }
+
     notifyJobUpdated(index, STATE_COLUMN);
     notifyJobUpdated(index, FPS_COLUMN);
-    emit signalProgressChanged(index, a_progress, m_jobs[index].framesTotal());
+    emit signalProgressChanged(index, a_progress.framesProcessed,
+                               m_jobs[index].framesTotal());
     return true;
 }
 
-// END OF bool JobsModel::setJobProgress(const QUuid & a_id, int a_progress,
-//		double a_fps)
+// END OF bool JobsModel::setJobProgress(const JobProperties & a_progress)
 //==============================================================================
 
 bool JobsModel::setJobState(const QUuid &a_id, JobState a_state)
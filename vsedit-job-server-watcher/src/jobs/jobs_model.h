@@ -70,7 +70,7 @@ public:
                             const QVector<QUuid> &a_dependencies);
     void requestJobDependsOnIds(const QUuid &a_id,
                                 const QVector<QUuid> &a_dependencies);
-    bool setJobProgress(const QUuid &a_id, int a_progress, double a_fps);
+    bool setJobProgress(const JobProperties &a_progress);
     bool setJobState(const QUuid &a_id, JobState a_state);
     bool setJobStartTime(const QUuid &a_id, const QDateTime &a_time);
     bool setJobEndTime(const QUuid &a_id, const QDateTime &a_time);
@@ -9,6 +9,7 @@
 
 #include "../../common-src/helpers.h"
 #include "../../common-src/ipc_defines.h"
+#include "../../common-src/ipc_messages.h"
 #include "../../common-src/settings/settings_definitions.h"
 #include "../../common-src/settings/settings_manager.h"
 #include "../../common-src/vapoursynth/vs_script_library.h"
@@ -74,6 +75,9 @@ MainWindow::MainWindow() : QMainWindow()
     , m_nextServerAddress(QHostAddress::LocalHost)
     , m_pTaskServer(nullptr)
     , m_pGeometrySaveTimer(nullptr)
+    , m_jobsSequence(0)
+    , m_protocolPending(false)
+    , m_jobsSyncPending(false)
 #ifdef Q_OS_WIN
     , m_pWinTaskbarButton(nullptr)
     , m_pWinTaskbarProgress(nullptr)
@@ -789,9 +793,18 @@ void MainWindow::slotServerConnected()
 {
     changeState(WatcherState::Connected);
     m_connectionAttempts = 0;
-    m_pServerSocket->sendBinaryMessage(MSG_GET_JOBS_INFO);
-    m_pServerSocket->sendBinaryMessage(MSG_GET_LOG);
-    m_pServerSocket->sendBinaryMessage(MSG_SUBSCRIBE);
+
+    // Old servers answer that they do not know the command
+    // and keep sending JSON. The jobs are requested with the answer.
+    vsedit::MessageFormat format = vsedit::cborMessagesSupported() ?
+                                   vsedit::MessageFormat::Cbor : vsedit::MessageFormat::Json;
+    QJsonObject jsProtocol;
+    jsProtocol[PROTOCOL_FORMAT] = vsedit::messageFormatName(format);
+    m_pServerSocket->sendBinaryMessage(
+        vsedit::jsonMessage(MSG_SET_PROTOCOL, jsProtocol));
+    m_protocolPending = true;
+    m_jobsSyncPending = false;
+
     processTaskList();
 }
 
@@ -800,7 +813,15 @@ void MainWindow::slotServerConnected()
 
 void MainWindow::slotServerDisconnected()
 {
-    m_pJobsModel->clear();
+    m_protocolPending = false;
+    m_jobsSyncPending = false;
+
+    // Jobs stay while reconnecting to the same server.
+    if ((m_state != WatcherState::Connected) &&
+            (m_state != WatcherState::Connecting)) {
+        forgetJobs();
+    }
+
     m_trustedClientsAddresses.clear();
     m_pActionSetTrustedClientsAddresses->setEnabled(false);
 
@@ -823,6 +844,7 @@ void MainWindow::slotServerDisconnected()
         m_connectionAttempts++;
 
         if (m_connectionAttempts >= m_maxConnectionAttempts) {
+            forgetJobs();
             changeState(WatcherState::NotConnected);
             m_connectionAttempts = 0;
             m_ui.logView->addEntry(tr("Could not connect to server."),
@@ -855,218 +877,52 @@ void MainWindow::slotServerDisconnected()
 
 void MainWindow::slotBinaryMessageReceived(const QByteArray &a_message)
 {
-    slotTextMessageReceived(QString::fromUtf8(a_message));
-}
-
-// END OF void MainWindow::slotBinaryMessageReceived(
-//		const QByteArray & a_message)
-//==============================================================================
-
-void MainWindow::slotTextMessageReceived(const QString &a_message)
-{
-    QString command = a_message;
-    QString arguments;
-    int spaceIndex = a_message.indexOf(' ');
-
-    if (spaceIndex >= 0) {
-        command = a_message.left(spaceIndex);
-        arguments = a_message.mid(spaceIndex + 1);
-    }
-
-    QJsonDocument jsArguments = QJsonDocument::fromJson(arguments.toUtf8());
-
-    if (command == QString(SMSG_JOBS_INFO)) {
-        processSMsgJobInfo(arguments);
-        return;
-    }
-
-    if (command == QString(SMSG_COMPLETE_LOG)) {
-        QJsonArray jsEntries = jsArguments.array();
-
-        for (int i = 0; i < jsEntries.size(); ++i) {
-            LogEntry entry = LogEntry::fromJson(jsEntries[i].toObject());
-            m_ui.logView->addEntry(entry);
-        }
-
-        return;
-    }
-
-    if (command == QString(SMSG_LOG_MESSAGE)) {
-        LogEntry entry = LogEntry::fromJson(jsArguments.object());
-        m_ui.logView->addEntry(entry);
-        return;
-    }
-
-    if (command == QString(SMSG_JOB_CREATED)) {
-        QJsonObject jsJobProperties = jsArguments.object();
-        m_pJobsModel->createJob(JobProperties::fromJson(jsJobProperties));
-        return;
-    }
-
-    if (command == QString(SMSG_JOB_UPDATE)) {
-        QJsonObject jsJobProperties = jsArguments.object();
-        JobProperties properties = JobProperties::fromJson(jsJobProperties);
-        m_pJobsModel->updateJobProperties(properties);
-        return;
-    }
-
-    if (command == QString(SMSG_JOB_STATE_UPDATE)) {
-        QJsonObject jsJob = jsArguments.object();
+    QString command;
+    QJsonValue jsArguments;
+    vsedit::MessageFormat format = vsedit::MessageFormat::Json;
 
-        if (!jsJob.contains(JP_ID)) {
-            return;
-        }
-
-        QUuid id(jsJob[JP_ID].toString());
-
-        if (!jsJob.contains(JP_JOB_STATE)) {
-            return;
-        }
-
-        JobState state = (JobState)jsJob[JP_JOB_STATE].toInt();
-        m_pJobsModel->setJobState(id, state);
-        return;
-    }
-
-    if (command == QString(SMSG_JOB_PROGRESS_UPDATE)) {
-        QJsonObject jsJob = jsArguments.object();
-
-        if (!jsJob.contains(JP_ID)) {
-            return;
-        }
-
-        QUuid id(jsJob[JP_ID].toString());
-
-        if (!jsJob.contains(JP_FRAMES_PROCESSED)) {
-            return;
-        }
-
-        int progress = jsJob[JP_FRAMES_PROCESSED].toInt();
-
-        if (!jsJob.contains(JP_FPS)) {
-            return;
-        }
-
-        double fps = jsJob[JP_FPS].toDouble();
-        m_pJobsModel->setJobProgress(id, progress, fps);
-        return;
-    }
-
-    if (command == QString(SMSG_JOB_START_TIME_UPDATE)) {
-        QJsonObject jsJob = jsArguments.object();
-
-        if (!jsJob.contains(JP_ID)) {
-            return;
-        }
-
-        QUuid id(jsJob[JP_ID].toString());
-
-        if (!jsJob.contains(JP_TIME_STARTED)) {
-            return;
-        }
-
-        QDateTime time = QDateTime::fromMSecsSinceEpoch(
-                             jsJob[JP_TIME_STARTED].toVariant().toLongLong());
-        m_pJobsModel->setJobStartTime(id, time);
-        return;
-    }
-
-    if (command == QString(SMSG_JOB_END_TIME_UPDATE)) {
-        QJsonObject jsJob = jsArguments.object();
-
-        if (!jsJob.contains(JP_ID)) {
-            return;
-        }
-
-        QUuid id(jsJob[JP_ID].toString());
-
-        if (!jsJob.contains(JP_TIME_ENDED)) {
-            return;
-        }
-
-        QDateTime time = QDateTime::fromMSecsSinceEpoch(
-                             jsJob[JP_TIME_ENDED].toVariant().toLongLong());
-        m_pJobsModel->setJobEndTime(id, time);
-        return;
-    }
-
-    if (command == QString(SMSG_JOB_DEPENDENCIES_UPDATE)) {
-        QJsonObject jsJob = jsArguments.object();
-
-        if (!jsJob.contains(JP_ID)) {
-            return;
-        }
-
-        QUuid id(jsJob[JP_ID].toString());
-
-        if (!jsJob.contains(JP_DEPENDS_ON_JOB_IDS)) {
-            return;
-        }
-
-        QJsonArray jsDependencies = jsJob[JP_DEPENDS_ON_JOB_IDS].toArray();
-        QVector<QUuid> dependencies;
-
-        for (int i = 0; i < jsDependencies.count(); ++i) {
-            dependencies.push_back(QUuid(jsDependencies[i].toString()));
-        }
-
-        m_pJobsModel->setJobDependsOnIds(id, dependencies);
-        return;
-    }
-
-    if (command == QString(SMSG_JOBS_SWAPPED)) {
-        QJsonArray jsSwap = jsArguments.array();
-
-        if (jsSwap.size() != 2) {
-            return;
-        }
-
-        QUuid id1(jsSwap[0].toString());
-        QUuid id2(jsSwap[1].toString());
-        m_pJobsModel->swapJobs(id1, id2);
+    if (!vsedit::decodeMessage(a_message, &command, &jsArguments, &format)) {
+        m_ui.logView->addEntry(tr("Received a broken message from the server."),
+                               LOG_STYLE_WARNING);
         return;
     }
 
-    if (command == QString(SMSG_JOBS_DELETED)) {
-        QJsonArray jsIds = jsArguments.array();
-        QVector<QUuid> ids;
-
-        for (int i = 0; i < jsIds.count(); ++i) {
-            ids.push_back(QUuid(jsIds[i].toString()));
-        }
-
-        m_pJobsModel->deleteJobs(ids);
+    if (processMessage(command, jsArguments)) {
         return;
     }
 
-    if (command == QString(SMSG_REFUSE)) {
-        return;
+    // The server answers some requests with plain text.
+    if (format == vsedit::MessageFormat::Json) {
+        m_ui.logView->addEntry(QString::fromUtf8(a_message));
     }
 
-    if (command == QString(SMSG_CLOSING_SERVER)) {
-        m_ui.logView->addEntry(tr("Server is shutting down."));
-        return;
+    // Servers that do not know the protocol request or the synchronization
+    // of jobs get the jobs the old way.
+    if (m_protocolPending) {
+        m_protocolPending = false;
+        m_pServerSocket->sendBinaryMessage(MSG_GET_JOBS_INFO);
+        m_pServerSocket->sendBinaryMessage(MSG_GET_LOG);
+        m_pServerSocket->sendBinaryMessage(MSG_SUBSCRIBE);
+    } else if (m_jobsSyncPending) {
+        m_jobsSyncPending = false;
+        m_pServerSocket->sendBinaryMessage(MSG_GET_JOBS_INFO);
+        m_pServerSocket->sendBinaryMessage(MSG_SUBSCRIBE);
     }
+}
 
-    if (command == QString(SMSG_TRUSTED_CLIENTS_INFO)) {
-        QStringList trustedClientsAddresses;
-        QVariantList values = jsArguments.array().toVariantList();
-
-        for (const QVariant &value : values) {
-            trustedClientsAddresses << value.toString();
-        }
-
-        m_trustedClientsAddresses = trustedClientsAddresses;
-        m_pActionSetTrustedClientsAddresses->setEnabled(true);
-        return;
-    }
+// END OF void MainWindow::slotBinaryMessageReceived(
+//		const QByteArray & a_message)
+//==============================================================================
 
-    m_ui.logView->addEntry(a_message);
+void MainWindow::slotTextMessageReceived(const QString &a_message)
+{
+    slotBinaryMessageReceived(a_message.toUtf8());
 }
 
 // END OF void MainWindow::slotTextMessageReceived(const QString & a_message)
 //==============================================================================
 
+
 void MainWindow::slotServerError(QAbstractSocket::SocketError a_error)
 {
     if (a_error == QAbstractSocket::ConnectionRefusedError) {
@@ -1343,6 +1199,214 @@ void MainWindow::createActionsAndMenus()
 // END OF void MainWindow::createActionsAndMenus()
 //==============================================================================
 
+bool MainWindow::processMessage(const QString &a_command,
+                                const QJsonValue &a_arguments)
+{
+    if (a_command == QString(SMSG_JOBS_INFO)) {
+        processSMsgJobInfo(a_arguments.toArray());
+        return true;
+    }
+
+    if (a_command == QString(SMSG_PROTOCOL)) {
+        m_protocolPending = false;
+        synchronizeJobs();
+        m_pServerSocket->sendBinaryMessage(MSG_GET_LOG);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOBS_SYNC)) {
+        processSMsgJobsSync(a_arguments.toObject());
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOB_CHANGE)) {
+        processSMsgJobChange(a_arguments.toObject());
+        return true;
+    }
+
+    if (a_command == QString(SMSG_COMPLETE_LOG)) {
+        QJsonArray jsEntries = a_arguments.toArray();
+
+        for (int i = 0; i < jsEntries.size(); ++i) {
+            LogEntry entry = LogEntry::fromJson(jsEntries[i].toObject());
+            m_ui.logView->addEntry(entry);
+        }
+
+        return true;
+    }
+
+    if (a_command == QString(SMSG_LOG_MESSAGE)) {
+        LogEntry entry = LogEntry::fromJson(a_arguments.toObject());
+        m_ui.logView->addEntry(entry);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOB_CREATED)) {
+        QJsonObject jsJobProperties = a_arguments.toObject();
+        m_pJobsModel->createJob(JobProperties::fromJson(jsJobProperties));
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOB_UPDATE)) {
+        QJsonObject jsJobProperties = a_arguments.toObject();
+        JobProperties properties = JobProperties::fromJson(jsJobProperties);
+        m_pJobsModel->updateJobProperties(properties);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOB_STATE_UPDATE)) {
+        QJsonObject jsJob = a_arguments.toObject();
+
+        if (!jsJob.contains(JP_ID)) {
+            return true;
+        }
+
+        QUuid id(jsJob[JP_ID].toString());
+
+        if (!jsJob.contains(JP_JOB_STATE)) {
+            return true;
+        }
+
+        JobState state = (JobState)jsJob[JP_JOB_STATE].toInt();
+        m_pJobsModel->setJobState(id, state);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOB_PROGRESS_UPDATE)) {
+        QJsonObject jsJob = a_arguments.toObject();
+
+        if (!jsJob.contains(JP_ID)) {
+            return true;
+        }
+
+        if (!jsJob.contains(JP_FRAMES_PROCESSED)) {
+            return true;
+        }
+
+        if (!jsJob.contains(JP_FPS)) {
+            return true;
+        }
+
+        m_pJobsModel->setJobProgress(JobProperties::fromJson(jsJob));
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOB_START_TIME_UPDATE)) {
+        QJsonObject jsJob = a_arguments.toObject();
+
+        if (!jsJob.contains(JP_ID)) {
+            return true;
+        }
+
+        QUuid id(jsJob[JP_ID].toString());
+
+        if (!jsJob.contains(JP_TIME_STARTED)) {
+            return true;
+        }
+
+        QDateTime time = QDateTime::fromMSecsSinceEpoch(
+                             jsJob[JP_TIME_STARTED].toVariant().toLongLong());
+        m_pJobsModel->setJobStartTime(id, time);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOB_END_TIME_UPDATE)) {
+        QJsonObject jsJob = a_arguments.toObject();
+
+        if (!jsJob.contains(JP_ID)) {
+            return true;
+        }
+
+        QUuid id(jsJob[JP_ID].toString());
+
+        if (!jsJob.contains(JP_TIME_ENDED)) {
+            return true;
+        }
+
+        QDateTime time = QDateTime::fromMSecsSinceEpoch(
+                             jsJob[JP_TIME_ENDED].toVariant().toLongLong());
+        m_pJobsModel->setJobEndTime(id, time);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOB_DEPENDENCIES_UPDATE)) {
+        QJsonObject jsJob = a_arguments.toObject();
+
+        if (!jsJob.contains(JP_ID)) {
+            return true;
+        }
+
+        QUuid id(jsJob[JP_ID].toString());
+
+        if (!jsJob.contains(JP_DEPENDS_ON_JOB_IDS)) {
+            return true;
+        }
+
+        QJsonArray jsDependencies = jsJob[JP_DEPENDS_ON_JOB_IDS].toArray();
+        QVector<QUuid> dependencies;
+
+        for (int i = 0; i < jsDependencies.count(); ++i) {
+            dependencies.push_back(QUuid(jsDependencies[i].toString()));
+        }
+
+        m_pJobsModel->setJobDependsOnIds(id, dependencies);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOBS_SWAPPED)) {
+        QJsonArray jsSwap = a_arguments.toArray();
+
+        if (jsSwap.size() != 2) {
+            return true;
+        }
+
+        QUuid id1(jsSwap[0].toString());
+        QUuid id2(jsSwap[1].toString());
+        m_pJobsModel->swapJobs(id1, id2);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_JOBS_DELETED)) {
+        QJsonArray jsIds = a_arguments.toArray();
+        QVector<QUuid> ids;
+
+        for (int i = 0; i < jsIds.count(); ++i) {
+            ids.push_back(QUuid(jsIds[i].toString()));
+        }
+
+        m_pJobsModel->deleteJobs(ids);
+        return true;
+    }
+
+    if (a_command == QString(SMSG_REFUSE)) {
+        return true;
+    }
+
+    if (a_command == QString(SMSG_CLOSING_SERVER)) {
+        m_ui.logView->addEntry(tr("Server is shutting down."));
+        return true;
+    }
+
+    if (a_command == QString(SMSG_TRUSTED_CLIENTS_INFO)) {
+        QStringList trustedClientsAddresses;
+        QVariantList values = a_arguments.toArray().toVariantList();
+
+        for (const QVariant &value : values) {
+            trustedClientsAddresses << value.toString();
+        }
+
+        m_trustedClientsAddresses = trustedClientsAddresses;
+        m_pActionSetTrustedClientsAddresses->setEnabled(true);
+        return true;
+    }
+
+    return false;
+}
+
+// END OF bool MainWindow::processMessage(const QString & a_command,
+//		const QJsonValue & a_arguments)
+//==============================================================================
+
 void MainWindow::editJob(const QModelIndex &a_index)
 {
     JobProperties properties = m_pJobsModel->jobProperties(a_index.row());
@@ -1357,9 +1421,17 @@ void MainWindow::editJob(const QModelIndex &a_index)
                                         .arg(a_index.row() + 1), properties);
 
     if (result == QDialog::Accepted) {
-        QUuid id = properties.id;
+        JobProperties oldProperties = properties;
         properties = m_pJobEditDialog->jobProperties();
-        properties.id = id;
+        properties.id = oldProperties.id;
+
+        // The job keeps its script unless it is given another one.
+        // The server has the script by its hash.
+        if (properties.scriptName == oldProperties.scriptName) {
+            properties.scriptText.clear();
+            properties.scriptHash = oldProperties.scriptHash;
+        }
+
         m_pServerSocket->sendBinaryMessage(vsedit::jsonMessage(MSG_CHANGE_JOB,
                                            properties.toJson()));
     }
@@ -1370,21 +1442,11 @@ void MainWindow::editJob(const QModelIndex &a_index)
 // END OF void MainWindow::editJob(const QModelIndex & a_index)
 //==============================================================================
 
-void MainWindow::processSMsgJobInfo(const QString &a_message)
+void MainWindow::processSMsgJobInfo(const QJsonArray &a_jobs)
 {
-    if (a_message.isEmpty()) {
-        return;
-    }
-
-    QJsonDocument doc = QJsonDocument::fromJson(a_message.toUtf8());
-
-    if (!doc.isArray()) {
-        return;
-    }
-
     QVector<JobProperties> propertiesVector;
 
-    for (const QJsonValue &value : doc.array()) {
+    for (const QJsonValue &value : a_jobs) {
         if (!value.isObject()) {
             continue;
         }
@@ -1396,7 +1458,76 @@ void MainWindow::processSMsgJobInfo(const QString &a_message)
     m_pJobsModel->setJobs(propertiesVector);
 }
 
-// END OF void MainWindow::processSMsgJobInfo(const QString & a_message)
+// END OF void MainWindow::processSMsgJobInfo(const QJsonArray & a_jobs)
+//==============================================================================
+
+void MainWindow::processSMsgJobsSync(const QJsonObject &a_sync)
+{
+    if (a_sync.contains(SYNC_JOBS)) {
+        processSMsgJobInfo(a_sync[SYNC_JOBS].toArray());
+    } else {
+        for (const QJsonValue &value : a_sync[SYNC_CHANGES].toArray()) {
+            QJsonObject jsChange = value.toObject();
+            processMessage(jsChange[SYNC_COMMAND].toString(),
+                           jsChange[SYNC_ARGUMENTS]);
+        }
+    }
+
+    m_jobsServerID = a_sync[SYNC_SERVER_ID].toString();
+    m_jobsSequence = (qint64)a_sync[SYNC_SEQUENCE].toDouble();
+    m_jobsSyncPending = false;
+}
+
+// END OF void MainWindow::processSMsgJobsSync(const QJsonObject & a_sync)
+//==============================================================================
+
+void MainWindow::processSMsgJobChange(const QJsonObject &a_change)
+{
+    // Changes sent before the synchronization are part of it.
+    if (m_jobsSyncPending) {
+        return;
+    }
+
+    qint64 sequence = (qint64)a_change[SYNC_SEQUENCE].toDouble();
+
+    if (sequence <= m_jobsSequence) {
+        return;
+    }
+
+    if (sequence > m_jobsSequence + 1) {
+        synchronizeJobs();
+        return;
+    }
+
+    processMessage(a_change[SYNC_COMMAND].toString(),
+                   a_change[SYNC_ARGUMENTS]);
+    m_jobsSequence = sequence;
+}
+
+// END OF void MainWindow::processSMsgJobChange(const QJsonObject & a_change)
+//==============================================================================
+
+void MainWindow::synchronizeJobs()
+{
+    QJsonObject jsSync;
+    jsSync[SYNC_SERVER_ID] = m_jobsServerID;
+    jsSync[SYNC_SEQUENCE] = (double)m_jobsSequence;
+    m_pServerSocket->sendBinaryMessage(
+        vsedit::jsonMessage(MSG_SYNC_JOBS, jsSync));
+    m_jobsSyncPending = true;
+}
+
+// END OF void MainWindow::synchronizeJobs()
+//==============================================================================
+
+void MainWindow::forgetJobs()
+{
+    m_pJobsModel->clear();
+    m_jobsServerID.clear();
+    m_jobsSequence = 0;
+}
+
+// END OF void MainWindow::forgetJobs()
 //==============================================================================
 
 QVector<int> MainWindow::selectedIndexes()
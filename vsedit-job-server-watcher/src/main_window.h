@@ -9,6 +9,7 @@
 #include <QSystemTrayIcon>
 #include <QWebSocket>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QHostAddress>
 #include <list>
 
@@ -130,7 +131,21 @@ private:
 
     void editJob(const QModelIndex &a_index);
 
-    void processSMsgJobInfo(const QString &a_message);
+    // False if the message is no command the watcher knows.
+    bool processMessage(const QString &a_command,
+                        const QJsonValue &a_arguments);
+
+    void processSMsgJobInfo(const QJsonArray &a_jobs);
+
+    void processSMsgJobsSync(const QJsonObject &a_sync);
+
+    void processSMsgJobChange(const QJsonObject &a_change);
+
+    // Asks the server for the changes of the jobs since the last one
+    // the watcher has seen.
+    void synchronizeJobs();
+
+    void forgetJobs();
 
     QVector<int> selectedIndexes();
 
@@ -183,6 +198,15 @@ private:
 
     QList<JobProperties> m_taskList;
 
+    // The jobs are kept over a reconnect and brought up to date with the
+    // changes the watcher has missed.
+    QString m_jobsServerID;
+    qint64 m_jobsSequence;
+
+    // Servers that do not know the requests answer them with plain text.
+    bool m_protocolPending;
+    bool m_jobsSyncPending;
+
     QStringList m_trustedClientsAddresses;
 
     QTimer *m_pGeometrySaveTimer;
@@ -1,11 +1,30 @@
 #include "job_server.h"
 
 #include "../../common-src/ipc_defines.h"
+#include "../../common-src/ipc_messages.h"
 #include "../../common-src/helpers.h"
 #include "jobs/jobs_manager.h"
 
 #include <QWebSocketServer>
 #include <QWebSocket>
+#include <iterator>
+
+//==============================================================================
+
+// Changes of the jobs the server remembers for clients that reconnect.
+static const int MAX_JOB_CHANGES = 10000;
+
+// Clients get the script of a job by its hash when they need it.
+static QJsonObject clientJobJson(const JobProperties &a_properties)
+{
+    QJsonObject jsJob = a_properties.toJson();
+
+    if (!a_properties.scriptHash.isEmpty()) {
+        jsJob.remove(JP_SCRIPT_TEXT);
+    }
+
+    return jsJob;
+}
 
 //==============================================================================
 
@@ -13,6 +32,9 @@ JobServer::JobServer(QObject *a_pParent) : QObject(a_pParent)
     , m_pSettingsManager(nullptr)
     , m_pJobsManager(nullptr)
     , m_pWebSocketServer(nullptr)
+    , m_serverID(QUuid::createUuid())
+    , m_jobsSequence(0)
+    , m_trimmedSequence(0)
 {
     m_pSettingsManager = new SettingsManagerCore(this);
 
@@ -61,6 +83,8 @@ JobServer::~JobServer()
 
     m_clients.clear();
     m_subscribers.clear();
+    m_syncedClients.clear();
+    m_clientFormats.clear();
     m_pWebSocketServer->close();
     m_pJobsManager->saveJobs();
 }
@@ -90,9 +114,8 @@ void JobServer::slotNewConnection()
             this, &JobServer::slotSocketDisconnected);
 
     if (trustedClientAddress(pSocket->peerAddress())) {
-        QByteArray message = vsedit::jsonMessage(SMSG_TRUSTED_CLIENTS_INFO,
-                             QJsonArray::fromStringList(m_trustedClientsAddresses));
-        pSocket->sendBinaryMessage(message);
+        sendMessage(pSocket, SMSG_TRUSTED_CLIENTS_INFO,
+                    QJsonArray::fromStringList(m_trustedClientsAddresses));
     }
 }
 
@@ -108,8 +131,7 @@ void JobServer::slotBinaryMessageReceived(
         return;
     }
 
-    QString messageString = tr(a_message);
-    processMessage(pClient, messageString);
+    processMessage(pClient, a_message);
 }
 
 // END OF void JobServer::slotBinaryMessageReceived(
@@ -124,7 +146,7 @@ void JobServer::slotTextMessageReceived(const QString &a_message)
         return;
     }
 
-    processMessage(pClient, a_message);
+    processMessage(pClient, a_message.toUtf8());
 }
 
 // END OF void JobServer::slotTextMessageReceived(const QString & a_message)
@@ -140,6 +162,8 @@ void JobServer::slotSocketDisconnected()
 
     m_clients.removeAll(pClient);
     m_subscribers.removeAll(pClient);
+    m_syncedClients.removeAll(pClient);
+    m_clientFormats.remove(pClient);
     pClient->deleteLater();
 }
 
@@ -151,7 +175,7 @@ void JobServer::slotLogMessage(const QString &a_message,
 {
     LogEntry entry(a_message, a_style);
     m_logEntries.push_back(entry);
-    broadcastMessage(vsedit::jsonMessage(SMSG_LOG_MESSAGE, entry.toJson()));
+    broadcastMessage(SMSG_LOG_MESSAGE, entry.toJson());
 }
 
 // END OF void JobServer::slotLogMessage(const QString & a_message,
@@ -160,8 +184,7 @@ void JobServer::slotLogMessage(const QString &a_message,
 
 void JobServer::slotJobCreated(const JobProperties &a_properties)
 {
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOB_CREATED,
-                                         a_properties.toJson()));
+    broadcastJobChange(SMSG_JOB_CREATED, clientJobJson(a_properties));
 }
 
 // END OF void JobServer::slotJobCreated(const JobProperties & a_properties)
@@ -169,8 +192,7 @@ void JobServer::slotJobCreated(const JobProperties &a_properties)
 
 void JobServer::slotJobChanged(const JobProperties &a_properties)
 {
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOB_UPDATE,
-                                         a_properties.toJson()));
+    broadcastJobChange(SMSG_JOB_UPDATE, clientJobJson(a_properties));
 }
 
 // END OF void JobServer::slotJobChanged(const JobProperties & a_properties)
@@ -181,25 +203,21 @@ void JobServer::slotJobStateChanged(const QUuid &a_jobID, JobState a_state)
     QJsonObject jsJob;
     jsJob[JP_ID] = a_jobID.toString();
     jsJob[JP_JOB_STATE] = (int)a_state;
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOB_STATE_UPDATE, jsJob));
+    broadcastJobChange(SMSG_JOB_STATE_UPDATE, jsJob);
 }
 
 // END OF void JobServer::slotJobStateChanged(const QUuid & a_jobID,
 //		JobState a_state)
 //==============================================================================
 
-void JobServer::slotJobProgressChanged(const QUuid &a_jobID, int a_progress,
-                                       double a_fps)
+void JobServer::slotJobProgressChanged(const JobProperties &a_properties)
 {
-    QJsonObject jsJob;
-    jsJob[JP_ID] = a_jobID.toString();
-    jsJob[JP_FRAMES_PROCESSED] = a_progress;
-    jsJob[JP_FPS] = a_fps;
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOB_PROGRESS_UPDATE, jsJob));
+    broadcastJobChange(SMSG_JOB_PROGRESS_UPDATE, a_properties.progressToJson(),
+                       a_properties.id);
 }
 
-// END OF void JobServer::slotJobProgressChanged(const QUuid & a_jobID,
-//		int a_progress, double a_fps)
+// END OF void JobServer::slotJobProgressChanged(
+//		const JobProperties & a_properties)
 //==============================================================================
 
 void JobServer::slotJobStartTimeChanged(const QUuid &a_jobID,
@@ -208,7 +226,7 @@ void JobServer::slotJobStartTimeChanged(const QUuid &a_jobID,
     QJsonObject jsJob;
     jsJob[JP_ID] = a_jobID.toString();
     jsJob[JP_TIME_STARTED] = a_time.toMSecsSinceEpoch();
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOB_START_TIME_UPDATE, jsJob));
+    broadcastJobChange(SMSG_JOB_START_TIME_UPDATE, jsJob);
 }
 
 // END OF void JobServer::slotJobStartTimeChanged(const QUuid & a_jobID,
@@ -221,7 +239,7 @@ void JobServer::slotJobEndTimeChanged(const QUuid &a_jobID,
     QJsonObject jsJob;
     jsJob[JP_ID] = a_jobID.toString();
     jsJob[JP_TIME_ENDED] = a_time.toMSecsSinceEpoch();
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOB_END_TIME_UPDATE, jsJob));
+    broadcastJobChange(SMSG_JOB_END_TIME_UPDATE, jsJob);
 }
 
 // END OF void JobServer::slotJobEndTimeChanged(const QUuid & a_jobID,
@@ -240,7 +258,7 @@ void JobServer::slotJobDependenciesChanged(const QUuid &a_jobID,
     }
 
     jsJob[JP_DEPENDS_ON_JOB_IDS] = jsDependencies;
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOB_DEPENDENCIES_UPDATE, jsJob));
+    broadcastJobChange(SMSG_JOB_DEPENDENCIES_UPDATE, jsJob);
 }
 
 // END OF void JobServer::slotJobDependenciesChanged(const QUuid & a_jobID,
@@ -252,7 +270,7 @@ void JobServer::slotJobsSwapped(const QUuid &a_jobID1, const QUuid &a_jobID2)
     QJsonArray jsSwap;
     jsSwap << a_jobID1.toString();
     jsSwap << a_jobID2.toString();
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOBS_SWAPPED, jsSwap));
+    broadcastJobChange(SMSG_JOBS_SWAPPED, jsSwap);
 }
 
 // END OF void JobServer::slotJobsSwapped(const QUuid & a_jobID1,
@@ -265,26 +283,27 @@ void JobServer::slotJobsDeleted(const QVector<QUuid> &a_ids)
 
     for (const QUuid &id : a_ids) {
         jsIdsArray.push_back(id.toString());
+        m_progressChanges.remove(id);
     }
 
-    broadcastMessage(vsedit::jsonMessage(SMSG_JOBS_DELETED, jsIdsArray));
+    broadcastJobChange(SMSG_JOBS_DELETED, jsIdsArray);
 }
 
 // END OF void JobServer::slotJobsDeleted(const QVector<QUuid> & a_ids)
 //==============================================================================
 
 void JobServer::processMessage(QWebSocket *a_pClient,
-                               const QString &a_message)
+                               const QByteArray &a_message)
 {
     bool trustedClient = trustedClientAddress(a_pClient->peerAddress());
 
-    QString command = a_message;
-    QString arguments;
-    int spaceIndex = a_message.indexOf(' ');
+    QString command;
+    QJsonValue jsArguments;
 
-    if (spaceIndex >= 0) {
-        command = a_message.left(spaceIndex);
-        arguments = a_message.mid(spaceIndex + 1);
+    if (!vsedit::decodeMessage(a_message, &command, &jsArguments, nullptr,
+                               false)) {
+        a_pClient->sendBinaryMessage("Received a broken message.");
+        return;
     }
 
     QString trustedOnlyCommands[] = {MSG_CLOSE_SERVER, MSG_CREATE_JOB,
@@ -300,15 +319,24 @@ void JobServer::processMessage(QWebSocket *a_pClient,
         return;
     }
 
-    QJsonDocument jsArguments = QJsonDocument::fromJson(arguments.toUtf8());
+    if (command == QString(MSG_SET_PROTOCOL)) {
+        QString formatName = jsArguments.toObject()[PROTOCOL_FORMAT].toString();
+        vsedit::MessageFormat format = vsedit::messageFormatFromName(formatName);
+        QJsonObject jsProtocol;
+        jsProtocol[PROTOCOL_FORMAT] = vsedit::messageFormatName(format);
+        // The answer comes in the format the client has used so far.
+        sendMessage(a_pClient, SMSG_PROTOCOL, jsProtocol);
+        m_clientFormats[a_pClient] = format;
+        return;
+    }
 
     if (command == QString(MSG_GET_JOBS_INFO)) {
-        a_pClient->sendBinaryMessage(jobsInfoMessage());
+        sendMessage(a_pClient, SMSG_JOBS_INFO, jobsInfo());
         return;
     }
 
     if (command == QString(MSG_GET_LOG)) {
-        a_pClient->sendBinaryMessage(completeLogMessage());
+        sendMessage(a_pClient, SMSG_COMPLETE_LOG, completeLog());
         return;
     }
 
@@ -318,29 +346,46 @@ void JobServer::processMessage(QWebSocket *a_pClient,
         return;
     }
 
+    if (command == QString(MSG_SYNC_JOBS)) {
+        QJsonObject jsSync = jsArguments.toObject();
+        sendMessage(a_pClient, SMSG_JOBS_SYNC,
+                    jobsSync(jsSync[SYNC_SERVER_ID].toString(),
+                             (qint64)jsSync[SYNC_SEQUENCE].toDouble(-1)));
+
+        if (!m_subscribers.contains(a_pClient)) {
+            m_subscribers.push_back(a_pClient);
+        }
+
+        if (!m_syncedClients.contains(a_pClient)) {
+            m_syncedClients.push_back(a_pClient);
+        }
+
+        return;
+    }
+
     if (command == QString(MSG_UNSUBSCRIBE)) {
         m_subscribers.removeAll(a_pClient);
+        m_syncedClients.removeAll(a_pClient);
         a_pClient->sendBinaryMessage("Unsubscribed from jobs updates.");
         return;
     }
 
     if (command == QString(MSG_CLOSE_SERVER)) {
-        broadcastMessage(SMSG_CLOSING_SERVER, true);
+        broadcastMessage(SMSG_CLOSING_SERVER, QJsonValue(), true);
         emit finish();
         return;
     }
 
     if (command == QString(MSG_GET_TRUSTED_CLIENTS)) {
-        QByteArray message = vsedit::jsonMessage(SMSG_TRUSTED_CLIENTS_INFO,
-                             QJsonArray::fromStringList(m_trustedClientsAddresses));
-        a_pClient->sendBinaryMessage(message);
+        sendMessage(a_pClient, SMSG_TRUSTED_CLIENTS_INFO,
+                    QJsonArray::fromStringList(m_trustedClientsAddresses));
         return;
     }
 
     if (command == QString(MSG_SET_TRUSTED_CLIENTS)) {
         QStringList trustedClientsAddresses;
 
-        for (QJsonValue value : jsArguments.array()) {
+        for (QJsonValue value : jsArguments.toArray()) {
             QString address = value.toString();
             QHostAddress hostAddress(address);
 
@@ -355,28 +400,27 @@ void JobServer::processMessage(QWebSocket *a_pClient,
         m_trustedClientsAddresses = trustedClientsAddresses;
         m_pSettingsManager->setTrustedClientsAddresses(
             m_trustedClientsAddresses);
-        QByteArray message = vsedit::jsonMessage(SMSG_TRUSTED_CLIENTS_INFO,
-                             QJsonArray::fromStringList(m_trustedClientsAddresses));
-        broadcastMessage(message, true, true);
+        broadcastMessage(SMSG_TRUSTED_CLIENTS_INFO,
+                         QJsonArray::fromStringList(m_trustedClientsAddresses), true, true);
         return;
     }
 
     if (command == QString(MSG_CREATE_JOB)) {
         JobProperties properties =
-            JobProperties::fromJson(jsArguments.object());
+            JobProperties::fromJson(jsArguments.toObject());
         m_pJobsManager->createJob(properties);
         return;
     }
 
     if (command == QString(MSG_CHANGE_JOB)) {
         JobProperties properties =
-            JobProperties::fromJson(jsArguments.object());
+            JobProperties::fromJson(jsArguments.toObject());
         m_pJobsManager->changeJob(properties);
         return;
     }
 
     if (command == QString(MSG_SET_JOB_DEPENDENCIES)) {
-        QJsonObject jsJob = jsArguments.object();
+        QJsonObject jsJob = jsArguments.toObject();
 
         if (!jsJob.contains(JP_ID)) {
             return;
@@ -400,7 +444,7 @@ void JobServer::processMessage(QWebSocket *a_pClient,
     }
 
     if (command == QString(MSG_SWAP_JOBS)) {
-        QJsonArray jsIDs = jsArguments.array();
+        QJsonArray jsIDs = jsArguments.toArray();
 
         if (jsIDs.count() != 2) {
             return;
@@ -412,7 +456,7 @@ void JobServer::processMessage(QWebSocket *a_pClient,
     }
 
     if (command == QString(MSG_RESET_JOBS)) {
-        QJsonArray jsIDs = jsArguments.array();
+        QJsonArray jsIDs = jsArguments.toArray();
         QVector<QUuid> ids;
 
         for (int i = 0; i < jsIDs.count(); ++i) {
@@ -424,7 +468,7 @@ void JobServer::processMessage(QWebSocket *a_pClient,
     }
 
     if (command == QString(MSG_DELETE_JOBS)) {
-        QJsonArray jsIDs = jsArguments.array();
+        QJsonArray jsIDs = jsArguments.toArray();
         QVector<QUuid> ids;
 
         for (int i = 0; i < jsIDs.count(); ++i) {
@@ -456,29 +500,28 @@ void JobServer::processMessage(QWebSocket *a_pClient,
     }
 
     a_pClient->sendBinaryMessage(QString("Received an unknown command: %1")
-                                 .arg(a_message).toUtf8());
+                                 .arg(command).toUtf8());
 }
 
 // END OF void JobServer::processMessage(QWebSocket * a_pClient,
-//		const QString & a_message)
+//		const QByteArray & a_message)
 //==============================================================================
 
-QByteArray JobServer::jobsInfoMessage() const
+QJsonArray JobServer::jobsInfo() const
 {
     QJsonArray jsJobs;
 
     for (const JobProperties &properties : m_pJobsManager->jobsProperties()) {
-        jsJobs.push_back(properties.toJson());
+        jsJobs.push_back(clientJobJson(properties));
     }
 
-    QByteArray message = vsedit::jsonMessage(SMSG_JOBS_INFO, jsJobs);
-    return message;
+    return jsJobs;
 }
 
-// END OF QByteArray JobServer::jobsInfoMessage() const
+// END OF QJsonArray JobServer::jobsInfo() const
 //==============================================================================
 
-QByteArray JobServer::completeLogMessage() const
+QJsonArray JobServer::completeLog() const
 {
     QJsonArray jsEntries;
 
@@ -486,50 +529,141 @@ QByteArray JobServer::completeLogMessage() const
         jsEntries.push_back(entry.toJson());
     }
 
-    QByteArray message = vsedit::jsonMessage(SMSG_COMPLETE_LOG, jsEntries);
-    return message;
+    return jsEntries;
+}
+
+// END OF QJsonArray JobServer::completeLog() const
+//==============================================================================
+
+QJsonObject JobServer::jobsSync(const QString &a_serverID,
+                                qint64 a_sequence) const
+{
+    QJsonObject jsSync;
+    jsSync[SYNC_SERVER_ID] = m_serverID.toString();
+    jsSync[SYNC_SEQUENCE] = (double)m_jobsSequence;
+
+    bool knownSequence = (a_serverID == m_serverID.toString()) &&
+                         (a_sequence >= m_trimmedSequence) && (a_sequence <= m_jobsSequence);
+
+    if (knownSequence) {
+        QMap<qint64, QJsonObject>::const_iterator first =
+            m_jobChanges.upperBound(a_sequence);
+        int changesCount = (int)std::distance(first, m_jobChanges.constEnd());
+
+        if (changesCount <= m_pJobsManager->jobsCount()) {
+            QJsonArray jsChanges;
+
+            for (QMap<qint64, QJsonObject>::const_iterator it = first;
+                    it != m_jobChanges.constEnd(); ++it) {
+                jsChanges.push_back(it.value());
+            }
+
+            jsSync[SYNC_CHANGES] = jsChanges;
+            return jsSync;
+        }
+    }
+
+    jsSync[SYNC_JOBS] = jobsInfo();
+    return jsSync;
 }
 
-// END OF QByteArray JobServer::completeLogMessage() const
+// END OF QJsonObject JobServer::jobsSync(const QString & a_serverID,
+//		qint64 a_sequence) const
 //==============================================================================
 
-void JobServer::broadcastMessage(const QString &a_message,
-                                 bool a_includeNonSubscribers, bool a_trustedOnly)
+void JobServer::sendMessage(QWebSocket *a_pClient, const QString &a_command,
+                            const QJsonValue &a_arguments)
 {
-    broadcastMessage(a_message.toUtf8(), a_includeNonSubscribers,
-                     a_trustedOnly);
+    vsedit::MessageFormat format =
+        m_clientFormats.value(a_pClient, vsedit::MessageFormat::Json);
+    a_pClient->sendBinaryMessage(vsedit::encodeMessage(format, a_command,
+                                 a_arguments));
 }
 
-// END OF void JobServer::broadcastMessage(const QString & a_message,
-//		bool a_includeNonSubscribers, bool a_trustedOnly)
+// END OF void JobServer::sendMessage(QWebSocket * a_pClient,
+//		const QString & a_command, const QJsonValue & a_arguments)
 //==============================================================================
 
-void JobServer::broadcastMessage(const char *a_message,
-                                 bool a_includeNonSubscribers, bool a_trustedOnly)
+void JobServer::broadcastMessage(const QString &a_command,
+                                 const QJsonValue &a_arguments, bool a_includeNonSubscribers,
+                                 bool a_trustedOnly)
 {
-    broadcastMessage(QByteArray(a_message), a_includeNonSubscribers,
-                     a_trustedOnly);
+    sendToClients(a_includeNonSubscribers ? m_clients : m_subscribers,
+                  a_command, a_arguments, a_trustedOnly);
 }
 
-// END OF void JobServer::broadcastMessage(const char * a_message,
-//		bool a_includeNonSubscribers, bool a_trustedOnly)
+// END OF void JobServer::broadcastMessage(const QString & a_command,
+//		const QJsonValue & a_arguments, bool a_includeNonSubscribers,
+//		bool a_trustedOnly)
 //==============================================================================
 
-void JobServer::broadcastMessage(const QByteArray &a_message,
-                                 bool a_includeNonSubscribers, bool a_trustedOnly)
+void JobServer::sendToClients(const QList<QWebSocket *> &a_clients,
+                              const QString &a_command, const QJsonValue &a_arguments,
+                              bool a_trustedOnly)
 {
-    QList<QWebSocket *> &clients =
-        a_includeNonSubscribers ? m_clients : m_subscribers;
+    // Encoded once for all clients of a format.
+    QByteArray jsonMessage;
+    QByteArray cborMessage;
 
-    for (QWebSocket *pClient : clients) {
-        if ((!a_trustedOnly) || trustedClientAddress(pClient->peerAddress())) {
-            pClient->sendBinaryMessage(a_message);
+    for (QWebSocket *pClient : a_clients) {
+        if (a_trustedOnly && !trustedClientAddress(pClient->peerAddress())) {
+            continue;
         }
+
+        vsedit::MessageFormat format =
+            m_clientFormats.value(pClient, vsedit::MessageFormat::Json);
+        QByteArray &message = (format == vsedit::MessageFormat::Cbor) ?
+                              cborMessage : jsonMessage;
+
+        if (message.isEmpty()) {
+            message = vsedit::encodeMessage(format, a_command, a_arguments);
+        }
+
+        pClient->sendBinaryMessage(message);
     }
 }
 
-// END OF void JobServer::broadcastMessage(const QByteArray & a_message,
-//		bool a_includeNonSubscribers, bool a_trustedOnly)
+// END OF void JobServer::sendToClients(
+//		const QList<QWebSocket *> & a_clients, const QString & a_command,
+//		const QJsonValue & a_arguments, bool a_trustedOnly)
+//==============================================================================
+
+void JobServer::broadcastJobChange(const QString &a_command,
+                                   const QJsonValue &a_arguments, const QUuid &a_progressJobID)
+{
+    m_jobsSequence++;
+
+    QJsonObject jsChange;
+    jsChange[SYNC_SEQUENCE] = (double)m_jobsSequence;
+    jsChange[SYNC_COMMAND] = a_command;
+    jsChange[SYNC_ARGUMENTS] = a_arguments;
+    m_jobChanges[m_jobsSequence] = jsChange;
+
+    if (!a_progressJobID.isNull()) {
+        m_jobChanges.remove(m_progressChanges.value(a_progressJobID, 0));
+        m_progressChanges[a_progressJobID] = m_jobsSequence;
+    }
+
+    while (m_jobChanges.size() > MAX_JOB_CHANGES) {
+        QMap<qint64, QJsonObject>::iterator it = m_jobChanges.begin();
+        m_trimmedSequence = it.key();
+        m_jobChanges.erase(it);
+    }
+
+    QList<QWebSocket *> plainSubscribers;
+
+    for (QWebSocket *pClient : m_subscribers) {
+        if (!m_syncedClients.contains(pClient)) {
+            plainSubscribers.push_back(pClient);
+        }
+    }
+
+    sendToClients(plainSubscribers, a_command, a_arguments);
+    sendToClients(m_syncedClients, SMSG_JOB_CHANGE, jsChange);
+}
+
+// END OF void JobServer::broadcastJobChange(const QString & a_command,
+//		const QJsonValue & a_arguments, const QUuid & a_progressJobID)
 //==============================================================================
 
 bool JobServer::trustedClientAddress(const QHostAddress &a_address)
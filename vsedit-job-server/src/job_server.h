@@ -3,11 +3,15 @@
 
 #include "../../common-src/settings/settings_manager_core.h"
 #include "../../common-src/log/styled_log_view_core.h"
+#include "../../common-src/ipc_messages.h"
 
 #include <QObject>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QHash>
+#include <QMap>
+#include <QUuid>
 #include <list>
 #include <vector>
 
@@ -43,8 +47,7 @@ private slots:
     void slotJobCreated(const JobProperties &a_properties);
     void slotJobChanged(const JobProperties &a_properties);
     void slotJobStateChanged(const QUuid &a_jobID, JobState a_state);
-    void slotJobProgressChanged(const QUuid &a_jobID, int a_progress,
-                                double a_fps);
+    void slotJobProgressChanged(const JobProperties &a_properties);
     void slotJobStartTimeChanged(const QUuid &a_jobID,
                                  const QDateTime &a_time);
     void slotJobEndTimeChanged(const QUuid &a_jobID,
@@ -56,16 +59,29 @@ private slots:
 
 private:
 
-    void processMessage(QWebSocket *a_pClient, const QString &a_message);
-    QByteArray jobsInfoMessage() const;
-    QByteArray completeLogMessage() const;
+    void processMessage(QWebSocket *a_pClient, const QByteArray &a_message);
+    QJsonArray jobsInfo() const;
+    QJsonArray completeLog() const;
 
-    void broadcastMessage(const QString &a_message,
-                          bool a_includeNonSubscribers = false, bool a_trustedOnly = false);
-    void broadcastMessage(const char *a_message,
-                          bool a_includeNonSubscribers = false, bool a_trustedOnly = false);
-    void broadcastMessage(const QByteArray &a_message,
+    // Messages go to every client in the format it has asked for.
+    void sendMessage(QWebSocket *a_pClient, const QString &a_command,
+                     const QJsonValue &a_arguments = QJsonValue());
+    void broadcastMessage(const QString &a_command,
+                          const QJsonValue &a_arguments = QJsonValue(),
                           bool a_includeNonSubscribers = false, bool a_trustedOnly = false);
+    void sendToClients(const QList<QWebSocket *> &a_clients,
+                       const QString &a_command, const QJsonValue &a_arguments,
+                       bool a_trustedOnly = false);
+
+    // Numbers the change, keeps it in the log and sends it to the
+    // subscribers. A progress update replaces the previous one of the job
+    // in the log.
+    void broadcastJobChange(const QString &a_command,
+                            const QJsonValue &a_arguments, const QUuid &a_progressJobID = QUuid());
+
+    // Sends the changes since the sequence number the client has seen,
+    // or all jobs when that is cheaper or the log does not reach back.
+    QJsonObject jobsSync(const QString &a_serverID, qint64 a_sequence) const;
 
     bool trustedClientAddress(const QHostAddress &a_address);
 
@@ -77,6 +93,20 @@ private:
 
     QList<QWebSocket *> m_clients;
     QList<QWebSocket *> m_subscribers;
+    QHash<QWebSocket *, vsedit::MessageFormat> m_clientFormats;
+
+    // Subscribers that get the changes of the jobs with their numbers.
+    QList<QWebSocket *> m_syncedClients;
+
+    // Sequence numbers start over with every run of the server.
+    QUuid m_serverID;
+    qint64 m_jobsSequence;
+
+    // Recent changes of the jobs by their sequence numbers and the number
+    // of the last change that no longer fits in.
+    QMap<qint64, QJsonObject> m_jobChanges;
+    QHash<QUuid, qint64> m_progressChanges;
+    qint64 m_trimmedSequence;
 
     QStringList m_trustedClientsAddresses;
 };
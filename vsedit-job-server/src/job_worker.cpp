@@ -0,0 +1,243 @@
+#include "job_worker.h"
+
+#include "jobs/worker_channel.h"
+#include "../../common-src/ipc_defines.h"
+#include "../../common-src/helpers.h"
+#include "../../common-src/jobs/job.h"
+#include "../../common-src/settings/settings_manager_core.h"
+#include "../../common-src/vapoursynth/vs_script_library.h"
+#include "../../common-src/log/vs_editor_log_definitions.h"
+
+#include <QLocalSocket>
+
+//==============================================================================
+
+// Milliseconds to wait for the job server to accept the worker.
+static const int WORKER_CONNECT_TIMEOUT = 10000;
+
+// Milliseconds to wait for the last messages to reach the job server.
+static const int WORKER_FLUSH_TIMEOUT = 3000;
+
+//==============================================================================
+
+JobWorker::JobWorker(const QString &a_serverName, QObject *a_pParent) :
+    QObject(a_pParent)
+    , m_serverName(a_serverName)
+    , m_pSettingsManager(nullptr)
+    , m_pVSScriptLibrary(nullptr)
+    , m_pChannel(nullptr)
+    , m_pJob(nullptr)
+{
+    m_pSettingsManager = new SettingsManagerCore(this);
+    m_pVSScriptLibrary = new VSScriptLibrary(m_pSettingsManager, this);
+
+    connect(m_pVSScriptLibrary,
+            SIGNAL(signalWriteLogMessage(int, const QString &)),
+            this, SLOT(slotLogMessage(int, const QString &)));
+}
+
+// END OF JobWorker::JobWorker(const QString &a_serverName,
+//		QObject *a_pParent)
+//==============================================================================
+
+JobWorker::~JobWorker()
+{
+    delete m_pJob;
+
+    if (m_pChannel) {
+        m_pChannel->flush(WORKER_FLUSH_TIMEOUT);
+    }
+}
+
+// END OF JobWorker::~JobWorker()
+//==============================================================================
+
+bool JobWorker::start()
+{
+    QLocalSocket *pSocket = new QLocalSocket(this);
+    pSocket->connectToServer(m_serverName);
+
+    if (!pSocket->waitForConnected(WORKER_CONNECT_TIMEOUT)) {
+        delete pSocket;
+        return false;
+    }
+
+    m_pChannel = new WorkerChannel(pSocket, this);
+    connect(m_pChannel,
+            SIGNAL(signalMessageReceived(const QString &, const QJsonObject &)),
+            this,
+            SLOT(slotServerMessageReceived(const QString &, const QJsonObject &)));
+    connect(m_pChannel, SIGNAL(signalDisconnected()),
+            this, SLOT(slotServerDisconnected()));
+    return true;
+}
+
+// END OF bool JobWorker::start()
+//==============================================================================
+
+void JobWorker::slotServerMessageReceived(const QString &a_command,
+        const QJsonObject &a_arguments)
+{
+    if (a_command == QString(WKMSG_START_JOB)) {
+        startJob(a_arguments);
+        return;
+    }
+
+    if (!m_pJob) {
+        return;
+    }
+
+    if (a_command == QString(WKMSG_PAUSE_JOB)) {
+        m_pJob->pause();
+    } else if (a_command == QString(WKMSG_RESUME_JOB)) {
+        m_pJob->start();
+    } else if (a_command == QString(WKMSG_ABORT_JOB)) {
+        m_pJob->abort();
+    } else if (a_command == QString(WKMSG_SET_SCRIPT_THREADS)) {
+        m_pJob->setScriptThreads(a_arguments[WK_SCRIPT_THREADS].toInt());
+        return;
+    } else {
+        return;
+    }
+
+    // The server has guessed the outcome, which the job may have refused.
+    sendState();
+}
+
+// END OF void JobWorker::slotServerMessageReceived(const QString &a_command,
+//		const QJsonObject &a_arguments)
+//==============================================================================
+
+void JobWorker::slotServerDisconnected()
+{
+    // Nobody is left to report to. Aborting stops the encoder as well.
+    if (m_pJob) {
+        m_pJob->abort();
+    }
+
+    emit finish();
+}
+
+// END OF void JobWorker::slotServerDisconnected()
+//==============================================================================
+
+void JobWorker::slotLogMessage(const QString &a_message,
+                               const QString &a_style)
+{
+    if (!m_pChannel) {
+        return;
+    }
+
+    LogEntry entry(a_message, a_style);
+    m_pChannel->send(WKSMSG_LOG_MESSAGE, entry.toJson());
+}
+
+// END OF void JobWorker::slotLogMessage(const QString &a_message,
+//		const QString &a_style)
+//==============================================================================
+
+void JobWorker::slotLogMessage(int a_type, const QString &a_message)
+{
+    QString style = vsMessageTypeToStyleName(a_type);
+    slotLogMessage(a_message, style);
+}
+
+// END OF void JobWorker::slotLogMessage(int a_type, const QString &a_message)
+//==============================================================================
+
+void JobWorker::slotJobPropertiesChanged()
+{
+    if (!m_pChannel || !m_pJob) {
+        return;
+    }
+
+    m_pChannel->send(WKSMSG_JOB_UPDATE, m_pJob->properties().toJson());
+}
+
+// END OF void JobWorker::slotJobPropertiesChanged()
+//==============================================================================
+
+void JobWorker::slotJobStateChanged(JobState a_newState, JobState a_oldState)
+{
+    if ((a_newState == a_oldState) || !m_pChannel) {
+        return;
+    }
+
+    sendState();
+
+    if (vsedit::contains(ACTIVE_JOB_STATES, a_newState) ||
+            (a_newState == JobState::Waiting)) {
+        return;
+    }
+
+    // The final statistics and times go along with the end of the job.
+    slotJobPropertiesChanged();
+    m_pChannel->flush(WORKER_FLUSH_TIMEOUT);
+    emit finish();
+}
+
+// END OF void JobWorker::slotJobStateChanged(JobState a_newState,
+//		JobState a_oldState)
+//==============================================================================
+
+void JobWorker::slotJobProgressChanged()
+{
+    if (!m_pChannel || !m_pJob) {
+        return;
+    }
+
+    m_pChannel->send(WKSMSG_JOB_PROGRESS_UPDATE,
+                     m_pJob->properties().progressToJson());
+}
+
+// END OF void JobWorker::slotJobProgressChanged()
+//==============================================================================
+
+void JobWorker::startJob(const QJsonObject &a_arguments)
+{
+    if (m_pJob) {
+        return;
+    }
+
+    JobProperties properties =
+        JobProperties::fromJson(a_arguments[WK_PROPERTIES].toObject());
+
+    m_pJob = new vsedit::Job(properties, m_pSettingsManager,
+                             m_pVSScriptLibrary, this);
+    m_pJob->setFramesMemoryBudget(
+        (size_t)a_arguments[WK_FRAMES_MEMORY_BUDGET].toDouble());
+    m_pJob->setScriptThreads(a_arguments[WK_SCRIPT_THREADS].toInt());
+
+    connect(m_pJob, SIGNAL(signalPropertiesChanged()),
+            this, SLOT(slotJobPropertiesChanged()));
+    connect(m_pJob, SIGNAL(signalStateChanged(JobState, JobState)),
+            this, SLOT(slotJobStateChanged(JobState, JobState)));
+    connect(m_pJob, SIGNAL(signalProgressChanged()),
+            this, SLOT(slotJobProgressChanged()));
+    connect(m_pJob, SIGNAL(signalStartTimeChanged()),
+            this, SLOT(slotJobPropertiesChanged()));
+    connect(m_pJob, SIGNAL(signalEndTimeChanged()),
+            this, SLOT(slotJobPropertiesChanged()));
+    connect(m_pJob, SIGNAL(signalLogMessage(const QString &, const QString &)),
+            this, SLOT(slotLogMessage(const QString &, const QString &)));
+
+    m_pJob->start();
+}
+
+// END OF void JobWorker::startJob(const QJsonObject &a_arguments)
+//==============================================================================
+
+void JobWorker::sendState()
+{
+    if (!m_pChannel || !m_pJob) {
+        return;
+    }
+
+    QJsonObject jsJob;
+    jsJob[JP_ID] = m_pJob->id().toString();
+    jsJob[JP_JOB_STATE] = (int)m_pJob->state();
+    m_pChannel->send(WKSMSG_JOB_STATE_UPDATE, jsJob);
+}
+
+// END OF void JobWorker::sendState()
+//==============================================================================
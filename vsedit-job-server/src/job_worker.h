@@ -0,0 +1,65 @@
+#ifndef JOB_WORKER_H_INCLUDED
+#define JOB_WORKER_H_INCLUDED
+
+#include "../../common-src/settings/settings_definitions_core.h"
+#include "../../common-src/log/styled_log_view_core.h"
+
+#include <QObject>
+#include <QJsonObject>
+
+class SettingsManagerCore;
+class VSScriptLibrary;
+class WorkerChannel;
+
+namespace vsedit {
+class Job;
+}
+
+// Runs a single job for the job server in a process of its own.
+// Connects to the local server the job server has named, runs the job
+// it is given and reports back until the job is over.
+class JobWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    JobWorker(const QString &a_serverName, QObject *a_pParent = nullptr);
+    virtual ~JobWorker();
+
+    bool start();
+
+signals:
+
+    void finish();
+
+private slots:
+
+    void slotServerMessageReceived(const QString &a_command,
+                                   const QJsonObject &a_arguments);
+    void slotServerDisconnected();
+
+    void slotLogMessage(const QString &a_message,
+                        const QString &a_style = LOG_STYLE_DEFAULT);
+    void slotLogMessage(int a_type, const QString &a_message);
+
+    void slotJobPropertiesChanged();
+    void slotJobStateChanged(JobState a_newState, JobState a_oldState);
+    void slotJobProgressChanged();
+
+private:
+
+    void startJob(const QJsonObject &a_arguments);
+
+    void sendState();
+
+    QString m_serverName;
+
+    SettingsManagerCore *m_pSettingsManager;
+    VSScriptLibrary *m_pVSScriptLibrary;
+    WorkerChannel *m_pChannel;
+
+    vsedit::Job *m_pJob;
+};
+
+#endif // JOB_WORKER_H_INCLUDED
@@ -11,6 +11,13 @@ enum class JobWantTo {
 struct JobTicket {
     vsedit::Job *pJob;
     JobWantTo whenDone;
+    // Dependencies that have not completed, and the ones among them
+    // that have failed or are missing.
+    int unmetDependencies;
+    int failedDependencies;
+    // Paused to make room for a job of a higher priority
+    // and to be resumed by the scheduler.
+    bool preempted;
 };
 
 #endif // JOB_DEFINITIONS_H_INCLUDED
@@ -0,0 +1,488 @@
+#include "jobs_journal.h"
+
+#include "../../../common-src/log/vs_editor_log_definitions.h"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <QSaveFile>
+#include <QUuid>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//==============================================================================
+
+// Milliseconds records may wait in the system before they are forced
+// to the disk.
+static const int SYNC_INTERVAL = 1000;
+
+// The journal is compacted when it has grown by as much as it took
+// after the last compaction, but not before it has grown by this much.
+static const qint64 MIN_COMPACTION_BYTES = 4 * 1024 * 1024;
+
+static const char RECORD_OPERATION[] = "op";
+static const char RECORD_JOB[] = "job";
+static const char RECORD_IDS[] = "ids";
+static const char RECORD_HASH[] = "hash";
+static const char RECORD_TEXT[] = "text";
+
+static const char OPERATION_PUT[] = "put";
+static const char OPERATION_UPDATE[] = "update";
+static const char OPERATION_SWAP[] = "swap";
+static const char OPERATION_DELETE[] = "delete";
+static const char OPERATION_SCRIPT[] = "script";
+
+static bool syncFile(QFile &a_file)
+{
+    if (!a_file.flush()) {
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    return (_commit(a_file.handle()) == 0);
+#else
+    return (fsync(a_file.handle()) == 0);
+#endif
+}
+
+// Jobs refer to their scripts by hash, each script is recorded once.
+static QJsonObject jobToJson(const JobProperties &a_properties)
+{
+    QJsonObject jsJob = a_properties.toJson();
+
+    if (!a_properties.scriptHash.isEmpty()) {
+        jsJob.remove(JP_SCRIPT_TEXT);
+    }
+
+    return jsJob;
+}
+
+static QByteArray recordLine(const QJsonObject &a_record)
+{
+    QByteArray line = QJsonDocument(a_record).toJson(QJsonDocument::Compact);
+    line += '\n';
+    return line;
+}
+
+static QJsonObject scriptRecord(const QString &a_hash, const QString &a_text)
+{
+    QJsonObject record;
+    record[RECORD_OPERATION] = OPERATION_SCRIPT;
+    record[RECORD_HASH] = a_hash;
+    record[RECORD_TEXT] = a_text;
+    return record;
+}
+
+//==============================================================================
+
+JobsJournal::JobsJournal(QObject *a_pParent) : QObject(a_pParent)
+    , m_compactedBytes(0)
+    , m_appendedBytes(0)
+    , m_compactionRequested(false)
+{
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(SYNC_INTERVAL);
+    connect(&m_syncTimer, SIGNAL(timeout()), this, SLOT(sync()));
+}
+
+// END OF JobsJournal::JobsJournal(QObject *a_pParent)
+//==============================================================================
+
+JobsJournal::~JobsJournal()
+{
+    sync();
+    m_file.close();
+}
+
+// END OF JobsJournal::~JobsJournal()
+//==============================================================================
+
+QString JobsJournal::filePath() const
+{
+    return m_filePath;
+}
+
+// END OF QString JobsJournal::filePath() const
+//==============================================================================
+
+void JobsJournal::setFilePath(const QString &a_filePath)
+{
+    if (m_filePath == a_filePath) {
+        return;
+    }
+
+    sync();
+    m_file.close();
+    m_filePath = a_filePath;
+    m_writtenScripts.clear();
+}
+
+// END OF void JobsJournal::setFilePath(const QString &a_filePath)
+//==============================================================================
+
+bool JobsJournal::exists() const
+{
+    return QFileInfo::exists(m_filePath);
+}
+
+// END OF bool JobsJournal::exists() const
+//==============================================================================
+
+bool JobsJournal::load(QVector<JobProperties> *a_pJobs)
+{
+    Q_ASSERT(a_pJobs);
+    a_pJobs->clear();
+
+    QFile file(m_filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(tr("Could not open jobs journal \"%1\": %2")
+                 .arg(m_filePath).arg(file.errorString()));
+        return false;
+    }
+
+    // Jobs are kept as JSON while replaying, so an update only
+    // overwrites the values it carries. A deleted job leaves an empty
+    // object behind, so the indexes of the others stay valid and the
+    // gaps are dropped once at the end.
+    QVector<QJsonObject> jobs;
+    QHash<QUuid, int> indexes;
+    QHash<QString, QString> scripts;
+    int brokenRecords = 0;
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+
+        // A record cut short by a crash. Nothing follows it.
+        if (!line.endsWith('\n')) {
+            if (!line.trimmed().isEmpty()) {
+                brokenRecords++;
+            }
+
+            break;
+        }
+
+        QJsonParseError error;
+        QJsonObject record = QJsonDocument::fromJson(line, &error).object();
+
+        if (error.error != QJsonParseError::NoError) {
+            brokenRecords++;
+            continue;
+        }
+
+        QString operation = record[RECORD_OPERATION].toString();
+
+        if (operation == OPERATION_SCRIPT) {
+            scripts[record[RECORD_HASH].toString()] =
+                record[RECORD_TEXT].toString();
+        } else if ((operation == OPERATION_PUT) ||
+                   (operation == OPERATION_UPDATE)) {
+            QJsonObject jsJob = record[RECORD_JOB].toObject();
+            QUuid id(jsJob[JP_ID].toString());
+            int index = indexes.value(id, -1);
+
+            if (index < 0) {
+                if (operation == OPERATION_UPDATE) {
+                    brokenRecords++;
+                    continue;
+                }
+
+                indexes[id] = jobs.size();
+                jobs.push_back(jsJob);
+                continue;
+            }
+
+            if (operation == OPERATION_PUT) {
+                jobs[index] = jsJob;
+                continue;
+            }
+
+            for (QJsonObject::const_iterator it = jsJob.constBegin();
+                    it != jsJob.constEnd(); ++it) {
+                jobs[index][it.key()] = it.value();
+            }
+        } else if (operation == OPERATION_SWAP) {
+            QJsonArray jsIds = record[RECORD_IDS].toArray();
+            QUuid id1(jsIds[0].toString());
+            QUuid id2(jsIds[1].toString());
+            int index1 = indexes.value(id1, -1);
+            int index2 = indexes.value(id2, -1);
+
+            if ((index1 < 0) || (index2 < 0)) {
+                brokenRecords++;
+                continue;
+            }
+
+            std::swap(jobs[index1], jobs[index2]);
+            indexes[id1] = index2;
+            indexes[id2] = index1;
+        } else if (operation == OPERATION_DELETE) {
+            for (const QJsonValue &jsId : record[RECORD_IDS].toArray()) {
+                QUuid id(jsId.toString());
+                int index = indexes.value(id, -1);
+
+                if (index < 0) {
+                    continue;
+                }
+
+                jobs[index] = QJsonObject();
+                indexes.remove(id);
+            }
+        } else {
+            brokenRecords++;
+        }
+    }
+
+    if (brokenRecords > 0) {
+        emit signalLogMessage(tr("%1 broken records of jobs journal \"%2\" "
+                                 "were skipped.").arg(brokenRecords).arg(m_filePath),
+                              LOG_STYLE_WARNING);
+    }
+
+    a_pJobs->reserve(indexes.size());
+
+    for (const QJsonObject &jsJob : jobs) {
+        if (jsJob.isEmpty()) {
+            continue;
+        }
+
+        JobProperties properties = JobProperties::fromJson(jsJob);
+
+        // Records of older versions carry the script themselves.
+        if (properties.scriptText.isEmpty()) {
+            properties.scriptText = scripts.value(properties.scriptHash);
+        }
+
+        a_pJobs->push_back(properties);
+    }
+
+    return true;
+}
+
+// END OF bool JobsJournal::load(QVector<JobProperties> *a_pJobs)
+//==============================================================================
+
+bool JobsJournal::compact(const QVector<JobProperties> &a_jobs)
+{
+    if (m_filePath.isEmpty()) {
+        return false;
+    }
+
+    // The new journal takes the place of the open one.
+    sync();
+    m_file.close();
+
+    QSaveFile file(m_filePath);
+    bool result = file.open(QIODevice::WriteOnly);
+
+    // Scripts go first, so the jobs find them when the journal is replayed.
+    QSet<QString> writtenScripts;
+
+    for (const JobProperties &properties : a_jobs) {
+        if (!result) {
+            break;
+        }
+
+        if (properties.scriptHash.isEmpty() ||
+                writtenScripts.contains(properties.scriptHash)) {
+            continue;
+        }
+
+        QByteArray line = recordLine(scriptRecord(properties.scriptHash,
+                                     properties.scriptText));
+        result = (file.write(line) == line.size());
+        writtenScripts.insert(properties.scriptHash);
+    }
+
+    for (const JobProperties &properties : a_jobs) {
+        if (!result) {
+            break;
+        }
+
+        QJsonObject record;
+        record[RECORD_OPERATION] = OPERATION_PUT;
+        record[RECORD_JOB] = jobToJson(properties);
+        QByteArray line = recordLine(record);
+        result = (file.write(line) == line.size());
+    }
+
+    // Commits through a synced temporary file, so a crash leaves
+    // either the old journal or the new one.
+    if (result) {
+        result = file.commit();
+    }
+
+    if (!result) {
+        setError(tr("Could not compact jobs journal \"%1\": %2")
+                 .arg(m_filePath).arg(file.errorString()));
+        file.cancelWriting();
+    }
+
+    if (!m_file.isOpen()) {
+        m_file.setFileName(m_filePath);
+
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            setError(tr("Could not open jobs journal \"%1\": %2")
+                     .arg(m_filePath).arg(m_file.errorString()));
+            return false;
+        }
+    }
+
+    if (result) {
+        m_writtenScripts = writtenScripts;
+    }
+
+    m_compactedBytes = m_file.size();
+    m_appendedBytes = 0;
+    m_compactionRequested = false;
+    return result;
+}
+
+// END OF bool JobsJournal::compact(const QVector<JobProperties> &a_jobs)
+//==============================================================================
+
+void JobsJournal::putJob(const JobProperties &a_properties)
+{
+    if (!a_properties.scriptHash.isEmpty() &&
+            !m_writtenScripts.contains(a_properties.scriptHash)) {
+        append(scriptRecord(a_properties.scriptHash, a_properties.scriptText));
+        m_writtenScripts.insert(a_properties.scriptHash);
+    }
+
+    QJsonObject record;
+    record[RECORD_OPERATION] = OPERATION_PUT;
+    record[RECORD_JOB] = jobToJson(a_properties);
+    append(record);
+}
+
+// END OF void JobsJournal::putJob(const JobProperties &a_properties)
+//==============================================================================
+
+void JobsJournal::updateJob(const JobProperties &a_properties)
+{
+    if (!a_properties.scriptHash.isEmpty() &&
+            !m_writtenScripts.contains(a_properties.scriptHash)) {
+        append(scriptRecord(a_properties.scriptHash, a_properties.scriptText));
+        m_writtenScripts.insert(a_properties.scriptHash);
+    }
+
+    QJsonObject jsJob = a_properties.toJson();
+    jsJob.remove(JP_SCRIPT_TEXT);
+
+    QJsonObject record;
+    record[RECORD_OPERATION] = OPERATION_UPDATE;
+    record[RECORD_JOB] = jsJob;
+    append(record);
+}
+
+// END OF void JobsJournal::updateJob(const JobProperties &a_properties)
+//==============================================================================
+
+void JobsJournal::swapJobs(const QUuid &a_jobID1, const QUuid &a_jobID2)
+{
+    QJsonArray jsIds;
+    jsIds << a_jobID1.toString();
+    jsIds << a_jobID2.toString();
+
+    QJsonObject record;
+    record[RECORD_OPERATION] = OPERATION_SWAP;
+    record[RECORD_IDS] = jsIds;
+    append(record);
+}
+
+// END OF void JobsJournal::swapJobs(const QUuid &a_jobID1,
+//		const QUuid &a_jobID2)
+//==============================================================================
+
+void JobsJournal::deleteJobs(const QVector<QUuid> &a_ids)
+{
+    if (a_ids.isEmpty()) {
+        return;
+    }
+
+    QJsonArray jsIds;
+
+    for (const QUuid &id : a_ids) {
+        jsIds << id.toString();
+    }
+
+    QJsonObject record;
+    record[RECORD_OPERATION] = OPERATION_DELETE;
+    record[RECORD_IDS] = jsIds;
+    append(record);
+}
+
+// END OF void JobsJournal::deleteJobs(const QVector<QUuid> &a_ids)
+//==============================================================================
+
+QString JobsJournal::errorString() const
+{
+    return m_errorString;
+}
+
+// END OF QString JobsJournal::errorString() const
+//==============================================================================
+
+void JobsJournal::sync()
+{
+    m_syncTimer.stop();
+
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    if (!syncFile(m_file)) {
+        setError(tr("Could not write jobs journal \"%1\" to the disk.")
+                 .arg(m_filePath));
+    }
+}
+
+// END OF void JobsJournal::sync()
+//==============================================================================
+
+void JobsJournal::append(const QJsonObject &a_record)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    QByteArray line = recordLine(a_record);
+
+    // Flushed right away, so only a crash of the system can lose it.
+    if ((m_file.write(line) != line.size()) || !m_file.flush()) {
+        setError(tr("Could not write jobs journal \"%1\": %2")
+                 .arg(m_filePath).arg(m_file.errorString()));
+        return;
+    }
+
+    m_appendedBytes += line.size();
+
+    if (!m_syncTimer.isActive()) {
+        m_syncTimer.start();
+    }
+
+    if (!m_compactionRequested && (m_appendedBytes >
+                                   std::max(m_compactedBytes, MIN_COMPACTION_BYTES))) {
+        m_compactionRequested = true;
+        emit signalCompactionNeeded();
+    }
+}
+
+// END OF void JobsJournal::append(const QJsonObject &a_record)
+//==============================================================================
+
+void JobsJournal::setError(const QString &a_message)
+{
+    m_errorString = a_message;
+    emit signalLogMessage(a_message, LOG_STYLE_ERROR);
+}
+
+// END OF void JobsJournal::setError(const QString &a_message)
+//==============================================================================
@@ -0,0 +1,92 @@
+#ifndef JOBS_JOURNAL_H_INCLUDED
+#define JOBS_JOURNAL_H_INCLUDED
+
+#include "../../../common-src/settings/settings_definitions_core.h"
+#include "../../../common-src/log/styled_log_view_core.h"
+
+#include <QObject>
+#include <QFile>
+#include <QJsonObject>
+#include <QSet>
+#include <QTimer>
+
+// Keeps the jobs of the server on disk as an append-only journal of
+// changes, one JSON record per line. A change only appends its record,
+// so the scripts of unchanged jobs are never written again. Records reach
+// the system at once and the disk in batches, so a crashed server loses
+// nothing and a crashed system at most the last batch. Once the journal
+// has grown by as much as the jobs take, it is compacted into one record
+// per job. Loading replays the journal, ignoring a torn last record.
+// Scripts are recorded once by their hash and jobs refer to them.
+class JobsJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    JobsJournal(QObject *a_pParent = nullptr);
+    virtual ~JobsJournal();
+
+    QString filePath() const;
+    void setFilePath(const QString &a_filePath);
+
+    bool exists() const;
+
+    bool load(QVector<JobProperties> *a_pJobs);
+
+    // Replaces the journal with a record of each job and keeps
+    // appending to it.
+    bool compact(const QVector<JobProperties> &a_jobs);
+
+    // Records the script of the job too, unless the journal has it.
+    void putJob(const JobProperties &a_properties);
+
+    // Records everything but the script, which can not change
+    // while the job is in the queue without a put. A script the journal
+    // does not have yet, like one a job has read from its file on start,
+    // is recorded as well.
+    void updateJob(const JobProperties &a_properties);
+
+    void swapJobs(const QUuid &a_jobID1, const QUuid &a_jobID2);
+
+    void deleteJobs(const QVector<QUuid> &a_ids);
+
+    QString errorString() const;
+
+public slots:
+
+    // Forces the appended records to the disk.
+    void sync();
+
+signals:
+
+    void signalLogMessage(const QString &a_message,
+                          const QString &a_style = LOG_STYLE_DEFAULT);
+
+    // Emitted once the journal has grown enough to be compacted.
+    void signalCompactionNeeded();
+
+private:
+
+    void append(const QJsonObject &a_record);
+
+    void setError(const QString &a_message);
+
+    QString m_filePath;
+    QFile m_file;
+
+    QString m_errorString;
+
+    // Size of the journal right after the last compaction
+    // and what has been appended since.
+    qint64 m_compactedBytes;
+    qint64 m_appendedBytes;
+    bool m_compactionRequested;
+
+    // Hashes of the scripts the journal holds since the last compaction.
+    QSet<QString> m_writtenScripts;
+
+    QTimer m_syncTimer;
+};
+
+#endif // JOBS_JOURNAL_H_INCLUDED
@@ -1,13 +1,39 @@
 #include "jobs_manager.h"
 
+#include "worker_job.h"
 #include "../../../common-src/settings/settings_manager_core.h"
 #include "../../../common-src/vapoursynth/vs_script_library.h"
 
+#include <QThread>
+#include <QSet>
+#include <algorithm>
+
+//==============================================================================
+
+// Least memory for frames a job is started with when others run already.
+static const size_t MIN_JOB_FRAMES_MEMORY = 256u * 1024u * 1024u;
+
+static bool isFailState(JobState a_state)
+{
+    const JobState failStates[] = {JobState::Aborted, JobState::Aborting,
+                                   JobState::DependencyNotMet, JobState::Failed, JobState::FailedCleanUp
+                                  };
+    return vsedit::contains(failStates, a_state);
+}
+
+static int priorityLevel(JobPriority a_priority)
+{
+    return std::min(std::max((int)a_priority, (int)JobPriority::Low),
+                    (int)JobPriority::High);
+}
+
 //==============================================================================
 
 JobsManager::JobsManager(SettingsManagerCore *a_pSettingsManager,
                          QObject *a_pParent) :
     QObject(a_pParent)
+    , m_startingJobs(false)
+    , m_startJobsAgain(false)
     , m_pSettingsManager(a_pSettingsManager)
     , m_pVSScriptLibrary(nullptr)
 {
@@ -18,6 +44,13 @@ JobsManager::JobsManager(SettingsManagerCore *a_pSettingsManager,
     connect(m_pVSScriptLibrary,
             SIGNAL(signalWriteLogMessage(int, const QString &)),
             this, SLOT(slotLogMessage(int, const QString &)));
+
+    connect(&m_journal,
+            SIGNAL(signalLogMessage(const QString &, const QString &)),
+            this, SIGNAL(signalLogMessage(const QString &, const QString &)));
+    // Compacted after the change that has grown the journal is done.
+    connect(&m_journal, SIGNAL(signalCompactionNeeded()),
+            this, SLOT(saveJobs()), Qt::QueuedConnection);
 }
 
 // END OF
@@ -30,6 +63,14 @@ JobsManager::~JobsManager()
 // END OF
 //==============================================================================
 
+int JobsManager::jobsCount() const
+{
+    return m_tickets.size();
+}
+
+// END OF
+//==============================================================================
+
 QVector<JobProperties> JobsManager::jobsProperties() const
 {
     QVector<JobProperties> properties;
@@ -46,14 +87,26 @@ QVector<JobProperties> JobsManager::jobsProperties() const
 
 int JobsManager::createJob(const JobProperties &a_jobProperties)
 {
-    vsedit::Job *pJob = new vsedit::Job(a_jobProperties,  m_pSettingsManager,
-                                        m_pVSScriptLibrary, this);
+    vsedit::Job *pJob = newJob(a_jobProperties);
     connectJob(pJob);
-    JobTicket ticket = {pJob, JobWantTo::Nothing};
+    JobTicket ticket = {pJob, JobWantTo::Nothing, 0, 0, false};
     m_tickets.push_back(ticket);
     int newRow = (int)m_tickets.size();
-    saveJobs();
-    emit signalJobCreated(a_jobProperties);
+    m_jobIndexes[pJob->id()] = newRow - 1;
+    linkDependencies(newRow - 1);
+    updateJobQueues(newRow - 1);
+    m_journal.putJob(pJob->properties());
+    emit signalJobCreated(pJob->properties());
+
+    // While the queue runs a new job may start right away
+    // or take the place of jobs of a lower priority.
+    for (int index : m_activeJobs) {
+        if (m_tickets[index].whenDone == JobWantTo::RunNext) {
+            startReadyJobs();
+            break;
+        }
+    }
+
     return newRow;
 }
 
@@ -62,38 +115,26 @@ int JobsManager::createJob(const JobProperties &a_jobProperties)
 
 bool JobsManager::swapJobs(const QUuid &a_jobID1, const QUuid &a_jobID2)
 {
-    int lowerIndex = indexOfJob(a_jobID1);
+    int index1 = indexOfJob(a_jobID1);
 
-    if (lowerIndex < 0) {
+    if (index1 < 0) {
         return false;
     }
 
-    int higherIndex = indexOfJob(a_jobID2);
+    int index2 = indexOfJob(a_jobID2);
 
-    if (higherIndex < 0) {
+    if (index2 < 0) {
         return false;
     }
 
-    if (higherIndex < lowerIndex) {
-        std::swap(lowerIndex, higherIndex);
-    }
-
-    for (int i = lowerIndex; i < higherIndex; ++i) {
-        if (vsedit::contains(m_tickets[higherIndex].pJob->dependsOnJobIds(),
-                             m_tickets[i].pJob->id())) {
-            return false;
-        }
-    }
-
-    for (int i = lowerIndex + 1; i < higherIndex; ++i) {
-        if (vsedit::contains(m_tickets[i].pJob->dependsOnJobIds(),
-                             m_tickets[lowerIndex].pJob->id())) {
-            return false;
-        }
-    }
-
-    std::swap(m_tickets[lowerIndex], m_tickets[higherIndex]);
-    saveJobs();
+    // Queue order only decides which of the ready jobs goes first,
+    // dependencies are kept by the graph.
+    std::swap(m_tickets[index1], m_tickets[index2]);
+    m_jobIndexes[m_tickets[index1].pJob->id()] = index1;
+    m_jobIndexes[m_tickets[index2].pJob->id()] = index2;
+    updateJobQueues(index1);
+    updateJobQueues(index2);
+    m_journal.swapJobs(a_jobID1, a_jobID2);
     emit signalJobsSwapped(a_jobID1, a_jobID2);
     return true;
 }
@@ -109,13 +150,8 @@ bool JobsManager::setJobState(const QUuid &a_jobID, JobState a_state)
         return false;
     }
 
-    bool result = m_tickets[index].pJob->setState(a_state);
-
-    if (result) {
-        saveJobs();
-    }
-
-    return result;
+    // The state change is recorded by its notification.
+    return m_tickets[index].pJob->setState(a_state);
 }
 
 // END OF
@@ -131,20 +167,27 @@ bool JobsManager::setJobDependsOnIds(const QUuid &a_jobID,
     }
 
     for (const QUuid &id : a_dependencies) {
-        int dependencyIndex = indexOfJob(id);
-
-        if ((dependencyIndex < 0) || (dependencyIndex >= index)) {
+        if (indexOfJob(id) < 0) {
             return false;
         }
     }
 
+    if (createsCycle(a_jobID, a_dependencies)) {
+        emit signalLogMessage(tr("Can not set the dependencies. "
+                                 "The job would depend on itself."), LOG_STYLE_WARNING);
+        return false;
+    }
+
+    unlinkDependencies(index);
     bool result = m_tickets[index].pJob->setDependsOnJobIds(a_dependencies);
+    linkDependencies(index);
+    updateJobQueues(index);
 
     if (!result) {
         return false;
     }
 
-    saveJobs();
+    m_journal.updateJob(m_tickets[index].pJob->properties());
     emit signalJobDependenciesChanged(a_jobID, a_dependencies);
 
     return true;
@@ -161,14 +204,23 @@ bool JobsManager::changeJob(const JobProperties &a_jobProperties)
         return false;
     }
 
+    if (createsCycle(a_jobProperties.id, a_jobProperties.dependsOnJobIds)) {
+        emit signalLogMessage(tr("Can not change the job. "
+                                 "It would depend on itself."), LOG_STYLE_WARNING);
+        return false;
+    }
+
     vsedit::Job *pJob = m_tickets[index].pJob;
-    bool result = pJob->setProperties(a_jobProperties);
+    bool result = pJob->setProperties(storeScript(a_jobProperties));
+    dropUnusedScripts();
 
     if (result) {
         result = pJob->setState(JobState::Waiting);
     }
 
-    saveJobs();
+    // The new properties may bring other dependencies and another state.
+    rebuildJobQueues();
+    m_journal.putJob(pJob->properties());
     emit signalJobChanged(pJob->properties());
     return result;
 }
@@ -192,22 +244,48 @@ bool JobsManager::loadJobs()
 
     clearJobs();
 
-    QVector<JobProperties> jobPropertiesList =
-        m_pSettingsManager->getJobs();
+    m_journal.setFilePath(m_pSettingsManager->getJobsJournalPath());
+    QVector<JobProperties> jobPropertiesList;
+    // Jobs of older versions are kept with the settings.
+    bool fromSettings = !m_journal.exists();
+
+    if (fromSettings) {
+        jobPropertiesList = m_pSettingsManager->getJobs();
+    } else if (!m_journal.load(&jobPropertiesList)) {
+        return false;
+    }
 
     for (const JobProperties &properties : jobPropertiesList) {
-        vsedit::Job *pJob = new vsedit::Job(properties, m_pSettingsManager,
-                                            m_pVSScriptLibrary);
+        vsedit::Job *pJob = newJob(properties);
 
         if (vsedit::contains(ACTIVE_JOB_STATES, pJob->state())) {
-            pJob->setState(JobState::Aborted);
+            if (pJob->hasCheckpoint()) {
+                pJob->prepareResume();
+                emit signalLogMessage(tr("Job \"%1\" was interrupted. "
+                                         "It will resume from its last completed part.")
+                                      .arg(pJob->subject()));
+            } else {
+                pJob->setState(JobState::Aborted);
+            }
         }
 
         connectJob(pJob);
-        JobTicket ticket = {pJob, JobWantTo::Nothing};
+        JobTicket ticket = {pJob, JobWantTo::Nothing, 0, 0, false};
         m_tickets.push_back(ticket);
     }
 
+    rebuildJobQueues();
+
+    // Drops what the journal holds beyond the current jobs
+    // and starts appending to it.
+    if (!saveJobs()) {
+        return false;
+    }
+
+    if (fromSettings) {
+        m_pSettingsManager->setJobs(QVector<JobProperties>());
+    }
+
     return true;
 }
 
@@ -222,13 +300,7 @@ bool JobsManager::saveJobs()
         return false;
     }
 
-    QVector<JobProperties> jobPropertiesList;
-
-    for (const JobTicket &ticket : m_tickets) {
-        jobPropertiesList.push_back(ticket.pJob->properties());
-    }
-
-    bool result = m_pSettingsManager->setJobs(jobPropertiesList);
+    bool result = m_journal.compact(jobsProperties());
 
     if (!result) {
         emit signalLogMessage(tr("Failed to save jobs.", LOG_STYLE_ERROR));
@@ -242,13 +314,7 @@ bool JobsManager::saveJobs()
 
 bool JobsManager::hasActiveJobs()
 {
-    for (const JobTicket &ticket : m_tickets) {
-        if (vsedit::contains(ACTIVE_JOB_STATES, ticket.pJob->state())) {
-            return true;
-        }
-    }
-
-    return false;
+    return !m_activeJobs.empty();
 }
 
 // END OF
@@ -256,7 +322,7 @@ bool JobsManager::hasActiveJobs()
 
 void JobsManager::startWaitingJobs()
 {
-    startFirstReadyJob();
+    startReadyJobs();
 }
 
 // END OF
@@ -270,6 +336,7 @@ void JobsManager::abortActiveJobs()
         }
 
         ticket.whenDone = JobWantTo::Nothing;
+        ticket.preempted = false;
         ticket.pJob->abort();
     }
 }
@@ -298,6 +365,9 @@ void JobsManager::resumePausedJobs()
             continue;
         }
 
+        // Resumed by the user, the job is no longer the scheduler's
+        // to resume and keeps its threads from now on.
+        ticket.preempted = false;
         ticket.pJob->start();
     }
 }
@@ -318,11 +388,14 @@ void JobsManager::resetJobs(const QVector<QUuid> &a_ids)
 void JobsManager::deleteJobs(const QVector<QUuid> &a_ids)
 {
     QVector<QUuid> deletedJobs;
+    QSet<QUuid> deletedIds;
 
+    // Indexes stay valid until the tickets are erased after the loop,
+    // so the queues are rebuilt once for the whole batch.
     for (const QUuid &id : a_ids) {
         int index = indexOfJob(id);
 
-        if (index < 0) {
+        if ((index < 0) || deletedIds.contains(id)) {
             continue;
         }
 
@@ -331,23 +404,45 @@ void JobsManager::deleteJobs(const QVector<QUuid> &a_ids)
         if (vsedit::contains(ACTIVE_JOB_STATES, pJob->state())) {
             emit signalLogMessage(tr("Can not delete an active job."),
                                   LOG_STYLE_WARNING);
-            return;
+            continue;
         }
 
-        for (const JobTicket &ticket : m_tickets) {
-            if (vsedit::contains(ticket.pJob->dependsOnJobIds(), pJob->id())) {
-                emit signalLogMessage(tr("Can not delete a job while "
-                                         "other jobs depend on it."), LOG_STYLE_WARNING);
-                return;
+        // Dependents deleted earlier in the batch no longer count.
+        bool hasDependents = false;
+
+        for (const QUuid &dependentID : m_dependentJobs.value(id)) {
+            if (!deletedIds.contains(dependentID)) {
+                hasDependents = true;
+                break;
             }
         }
 
+        if (hasDependents) {
+            emit signalLogMessage(tr("Can not delete a job while "
+                                     "other jobs depend on it."), LOG_STYLE_WARNING);
+            continue;
+        }
+
         delete pJob;
-        m_tickets.erase(m_tickets.begin() + index);
+        m_tickets[index].pJob = nullptr;
         deletedJobs.push_back(id);
+        deletedIds.insert(id);
+    }
+
+    if (deletedJobs.isEmpty()) {
+        return;
     }
 
-    saveJobs();
+    QVector<JobTicket>::iterator newEnd = std::remove_if(m_tickets.begin(),
+                                          m_tickets.end(), [](const JobTicket &a_ticket) {
+        return (a_ticket.pJob == nullptr);
+    });
+    m_tickets.erase(newEnd, m_tickets.end());
+    rebuildJobQueues();
+
+    // Jobs that could not be deleted do not stop the others.
+    dropUnusedScripts();
+    m_journal.deleteJobs(deletedJobs);
     emit signalJobsDeleted(deletedJobs);
 }
 
@@ -391,7 +486,17 @@ void JobsManager::slotJobPropertiesChanged()
         return;
     }
 
-    emit signalJobChanged(pJob->properties());
+    // A job without a script reads it from its file when it starts.
+    JobProperties properties = pJob->properties();
+
+    if (!properties.scriptHash.isEmpty() &&
+            !m_scripts.contains(properties.scriptHash)) {
+        m_scripts[properties.scriptHash] = properties.scriptText;
+    }
+
+    // Keeps the checkpoints of resumable jobs on disk.
+    m_journal.updateJob(properties);
+    emit signalJobChanged(properties);
 }
 
 // END OF
@@ -409,13 +514,31 @@ void JobsManager::slotJobStateChanged(JobState a_newState, JobState a_oldState)
         return;
     }
 
-    saveJobs();
+    int jobIndex = indexOfJob(pJob->id());
+
+    if (jobIndex >= 0) {
+        updateDependents(jobIndex, a_oldState, a_newState);
+        updateJobQueues(jobIndex);
+    }
+
+    m_journal.updateJob(pJob->properties());
     emit signalJobStateChanged(pJob->id(), a_newState);
 
+    if ((jobIndex >= 0) && m_tickets[jobIndex].preempted &&
+            (a_newState == JobState::Paused)) {
+        // The job has made room for one of a higher priority.
+        startReadyJobs();
+        return;
+    }
+
     if (vsedit::contains(ACTIVE_JOB_STATES, a_newState)) {
         return;
     }
 
+    if (jobIndex >= 0) {
+        m_tickets[jobIndex].preempted = false;
+    }
+
     // Recursion
     if (a_newState == JobState::DependencyNotMet) {
         return;
@@ -426,13 +549,17 @@ void JobsManager::slotJobStateChanged(JobState a_newState, JobState a_oldState)
         return;
     }
 
-    int jobIndex = indexOfJob(pJob->id());
-
-    if (m_tickets[jobIndex].whenDone == JobWantTo::RunNext) {
-        startFirstReadyJob(jobIndex + 1);
+    if (jobIndex < 0) {
+        return;
     }
 
+    JobWantTo whenDone = m_tickets[jobIndex].whenDone;
     m_tickets[jobIndex].whenDone = JobWantTo::Nothing;
+
+    // The job has given its threads and memory back.
+    if (whenDone == JobWantTo::RunNext) {
+        startReadyJobs();
+    }
 }
 
 // END OF
@@ -446,8 +573,7 @@ void JobsManager::slotJobProgressChanged()
         return;
     }
 
-    emit signalJobProgressChanged(pJob->id(), pJob->framesProcessed(),
-                                  pJob->fps());
+    emit signalJobProgressChanged(pJob->properties());
 }
 
 // END OF
@@ -506,14 +632,7 @@ bool JobsManager::canModifyJob(int a_index) const
 
 int JobsManager::indexOfJob(const QUuid &a_uuid) const
 {
-    QVector<JobTicket>::const_iterator it =
-        std::find_if(m_tickets.cbegin(), m_tickets.cend(),
-    [&](const JobTicket & a_ticket)->bool {
-        return (a_ticket.pJob->id() == a_uuid);
-    });
-
-    return (it == m_tickets.cend()) ?
-           -1 : std::distance(m_tickets.cbegin(), it);
+    return m_jobIndexes.value(a_uuid, -1);
 }
 
 // END OF
@@ -526,6 +645,8 @@ void JobsManager::clearJobs()
     }
 
     m_tickets.clear();
+    m_scripts.clear();
+    rebuildJobQueues();
 }
 
 // END OF
@@ -546,41 +667,17 @@ bool JobsManager::checkCanModifyJobAndNotify(int a_index)
 // END OF
 //==============================================================================
 
-JobsManager::DependenciesState JobsManager::dependenciesState(int a_index)
+vsedit::Job *JobsManager::newJob(const JobProperties &a_properties)
 {
-    if ((a_index < 0) || (a_index >= (int)m_tickets.size())) {
-        return DependenciesState::Failed;
-    }
-
-    JobState failStates[] = {JobState::Aborted, JobState::Aborting,
-                             JobState::DependencyNotMet, JobState::Failed, JobState::FailedCleanUp
-                            };
-
-    bool incomplete = false;
-
-    for (const QUuid &id : m_tickets[a_index].pJob->dependsOnJobIds()) {
-        int dependencyIndex = indexOfJob(id);
-
-        if ((dependencyIndex < 0) || (dependencyIndex >= (int)m_tickets.size())) {
-            return DependenciesState::Failed;
-        }
+    JobProperties properties = storeScript(a_properties);
 
-        const vsedit::Job *pDependentJob = m_tickets[dependencyIndex].pJob;
-
-        if (pDependentJob->state() != JobState::Completed) {
-            incomplete = true;
-        }
-
-        if (vsedit::contains(failStates, pDependentJob->state())) {
-            return DependenciesState::Failed;
-        }
-    }
-
-    if (incomplete) {
-        return DependenciesState::Incomplete;
+    if (m_pSettingsManager->getJobsRunInWorkers()) {
+        return new WorkerJob(properties, m_pSettingsManager,
+                             m_pVSScriptLibrary, this);
     }
 
-    return DependenciesState::Complete;
+    return new vsedit::Job(properties, m_pSettingsManager,
+                           m_pVSScriptLibrary, this);
 }
 
 // END OF
@@ -605,40 +702,473 @@ void JobsManager::connectJob(vsedit::Job *a_pJob)
 // END OF
 //==============================================================================
 
-void JobsManager::startFirstReadyJob(int a_fromIndex)
+JobProperties JobsManager::storeScript(const JobProperties &a_properties)
+{
+    JobProperties properties = a_properties;
+
+    // A client may refer to a script the server has by its hash alone.
+    if (properties.scriptText.isEmpty()) {
+        properties.scriptText = m_scripts.value(properties.scriptHash);
+    }
+
+    if (properties.scriptText.isEmpty()) {
+        properties.scriptHash.clear();
+        return properties;
+    }
+
+    // The hash sent along is not trusted.
+    properties.scriptHash = JobProperties::hashScript(properties.scriptText);
+    QHash<QString, QString>::const_iterator it =
+        m_scripts.constFind(properties.scriptHash);
+
+    if (it == m_scripts.constEnd()) {
+        m_scripts[properties.scriptHash] = properties.scriptText;
+    } else {
+        properties.scriptText = it.value();
+    }
+
+    return properties;
+}
+
+// END OF
+//==============================================================================
+
+void JobsManager::dropUnusedScripts()
+{
+    QSet<QString> usedScripts;
+
+    for (const JobTicket &ticket : m_tickets) {
+        usedScripts.insert(ticket.pJob->properties().scriptHash);
+    }
+
+    QHash<QString, QString>::iterator it = m_scripts.begin();
+
+    while (it != m_scripts.end()) {
+        if (usedScripts.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_scripts.erase(it);
+        }
+    }
+}
+
+// END OF
+//==============================================================================
+
+void JobsManager::startReadyJobs()
+{
+    // A job that fails right away or is paused for another one
+    // asks for a new round from its state change, so the budget is
+    // counted anew for every job.
+    if (m_startingJobs) {
+        m_startJobsAgain = true;
+        return;
+    }
+
+    m_startingJobs = true;
+
+    do {
+        m_startJobsAgain = false;
+
+        while (startNextReadyJob()) {
+        }
+    } while (m_startJobsAgain);
+
+    m_startingJobs = false;
+}
+
+// END OF
+//==============================================================================
+
+bool JobsManager::startNextReadyJob()
+{
+    // Jobs whose dependencies have failed can not run any more.
+    // Marking them fails their own dependents in turn.
+    while (!m_blockedJobs.empty()) {
+        int index = *m_blockedJobs.begin();
+        m_blockedJobs.erase(m_blockedJobs.begin());
+        m_tickets[index].pJob->setState(JobState::DependencyNotMet);
+    }
+
+    int threadsBudget = m_pSettingsManager->getJobsThreadsBudget();
+
+    if (threadsBudget <= 0) {
+        threadsBudget = std::max(QThread::idealThreadCount(), 1);
+    }
+
+    size_t memoryBudget =
+        (size_t)std::max(m_pSettingsManager->getJobsMemoryBudget(), 0) *
+        1024u * 1024u;
+
+    // Paused jobs keep their threads and frames to be resumed. Jobs
+    // paused for ones of a higher priority only keep their frames.
+    int threadsUsed = 0;
+    size_t memoryUsed = 0;
+    bool anyActive = !m_activeJobs.empty();
+    int preemptedIndex = -1;
+
+    for (int index : m_activeJobs) {
+        const JobTicket &ticket = m_tickets[index];
+        memoryUsed += ticket.pJob->framesMemoryBudget();
+
+        if (ticket.preempted && (ticket.pJob->state() == JobState::Paused)) {
+            if ((preemptedIndex < 0) || (ticket.pJob->priority() >
+                                         m_tickets[preemptedIndex].pJob->priority())) {
+                preemptedIndex = index;
+            }
+
+            continue;
+        }
+
+        threadsUsed += jobThreads(ticket.pJob, threadsBudget);
+    }
+
+    int nextIndex = nextReadyJob();
+
+    // Preempted jobs resume before any ready job of their own
+    // or a lower priority starts.
+    if ((preemptedIndex >= 0) && ((nextIndex < 0) ||
+                                  (m_tickets[preemptedIndex].pJob->priority() >=
+                                   m_tickets[nextIndex].pJob->priority()))) {
+        JobTicket &ticket = m_tickets[preemptedIndex];
+        int threads = jobThreads(ticket.pJob, threadsBudget);
+
+        if ((threadsUsed > 0) && (threadsUsed + threads > threadsBudget)) {
+            return false;
+        }
+
+        ticket.preempted = false;
+        emit signalLogMessage(tr("Job %1 is resumed.").arg(preemptedIndex + 1));
+        ticket.pJob->setScriptThreads(std::min(threads, threadsBudget));
+        ticket.pJob->start();
+        return (ticket.pJob->state() != JobState::Paused);
+    }
+
+    if (nextIndex < 0) {
+        return false;
+    }
+
+    // The jobs behind one that does not fit wait as well, so a big job
+    // is not held back forever by smaller ones. A job bigger than
+    // the whole budget runs alone.
+    vsedit::Job *pNextJob = m_tickets[nextIndex].pJob;
+    int threads = jobThreads(pNextJob, threadsBudget);
+
+    if ((threadsUsed > 0) && (threadsUsed + threads > threadsBudget)) {
+        preemptJobs(nextIndex, threadsUsed + threads - threadsBudget,
+                    threadsBudget);
+        return false;
+    }
+
+    pNextJob->setFramesMemoryBudget(0);
+
+    if (memoryBudget > 0) {
+        size_t memoryLeft = (memoryBudget > memoryUsed) ?
+                            (memoryBudget - memoryUsed) : 0;
+
+        if (anyActive && (memoryLeft < MIN_JOB_FRAMES_MEMORY)) {
+            return false;
+        }
+
+        memoryLeft = std::max(memoryLeft, MIN_JOB_FRAMES_MEMORY);
+
+        if (pNextJob->framesMemoryBudget() > memoryLeft) {
+            pNextJob->setFramesMemoryBudget(memoryLeft);
+        }
+    }
+
+    // The script core keeps to the threads the job is given.
+    pNextJob->setScriptThreads(std::min(threads, threadsBudget));
+
+    m_tickets[nextIndex].whenDone = JobWantTo::RunNext;
+    pNextJob->start();
+    return true;
+}
+
+// END OF
+//==============================================================================
+
+int JobsManager::nextReadyJob() const
 {
-    if ((a_fromIndex < 0) || (a_fromIndex >= (int)m_tickets.size())) {
+    for (int level = PRIORITY_LEVELS - 1; level >= 0; --level) {
+        if (!m_readyJobs[level].empty()) {
+            return *m_readyJobs[level].begin();
+        }
+    }
+
+    return -1;
+}
+
+// END OF
+//==============================================================================
+
+void JobsManager::preemptJobs(int a_index, int a_threadsNeeded,
+                              int a_threadsBudget)
+{
+    JobPriority priority = m_tickets[a_index].pJob->priority();
+    int threadsFreed = 0;
+    std::vector<int> candidates;
+
+    for (int index : m_activeJobs) {
+        const JobTicket &ticket = m_tickets[index];
+        JobState state = ticket.pJob->state();
+
+        // Already on the way to make room.
+        if (ticket.preempted && (state == JobState::Pausing)) {
+            threadsFreed += jobThreads(ticket.pJob, a_threadsBudget);
+            continue;
+        }
+
+        // Shell commands can not be paused.
+        if ((state == JobState::Running) &&
+                (ticket.pJob->priority() < priority) &&
+                (ticket.pJob->type() != JobType::RunShellCommand)) {
+            candidates.push_back(index);
+        }
+    }
+
+    if (threadsFreed >= a_threadsNeeded) {
         return;
     }
 
-    JobState validStates[] = {JobState::Waiting, JobState::Paused};
+    // Lowest priority first and the last in the queue among equal ones.
+    std::sort(candidates.begin(), candidates.end(),
+              [this](int a_index1, int a_index2) {
+        JobPriority priority1 = m_tickets[a_index1].pJob->priority();
+        JobPriority priority2 = m_tickets[a_index2].pJob->priority();
+
+        if (priority1 != priority2) {
+            return priority1 < priority2;
+        }
+
+        return a_index1 > a_index2;
+    });
 
-    for (int i = a_fromIndex; i < (a_fromIndex + (int)m_tickets.size()); ++i) {
-        int nextIndex = i % m_tickets.size();
-        vsedit::Job *pNextJob = m_tickets[nextIndex].pJob;
+    std::vector<int> victims;
 
-        if (pNextJob->isActive()) {
-            return;
+    for (int index : candidates) {
+        if (threadsFreed >= a_threadsNeeded) {
+            break;
         }
 
-        if (!vsedit::contains(validStates, pNextJob->state())) {
+        victims.push_back(index);
+        threadsFreed += jobThreads(m_tickets[index].pJob, a_threadsBudget);
+    }
+
+    // Pausing jobs that still leave too few threads would only stall them.
+    if (threadsFreed < a_threadsNeeded) {
+        return;
+    }
+
+    for (int index : victims) {
+        JobTicket &ticket = m_tickets[index];
+        // Marked before it is paused, the state change may come at once.
+        ticket.preempted = true;
+        ticket.pJob->pause();
+        JobState state = ticket.pJob->state();
+
+        if ((state != JobState::Pausing) && (state != JobState::Paused)) {
+            ticket.preempted = false;
             continue;
         }
 
-        DependenciesState jobDependenciesState = dependenciesState(i);
+        emit signalLogMessage(tr("Job %1 is paused for job %2 "
+                                 "of a higher priority.").arg(index + 1).arg(a_index + 1));
+    }
+}
 
-        if (jobDependenciesState == DependenciesState::Failed) {
-            pNextJob->setState(JobState::DependencyNotMet);
+// END OF
+//==============================================================================
+
+int JobsManager::jobThreads(const vsedit::Job *a_cpJob,
+                            int a_threadsBudget) const
+{
+    int threads = a_cpJob->threads();
+
+    if (threads <= 0) {
+        return a_threadsBudget;
+    }
+
+    return threads;
+}
+
+// END OF
+//==============================================================================
+
+bool JobsManager::createsCycle(const QUuid &a_jobID,
+                               const QVector<QUuid> &a_dependencies) const
+{
+    QSet<QUuid> visited;
+    QVector<QUuid> stack = a_dependencies;
+
+    while (!stack.isEmpty()) {
+        QUuid id = stack.takeLast();
+
+        if (id == a_jobID) {
+            return true;
         }
 
-        if (jobDependenciesState != DependenciesState::Complete) {
+        if (visited.contains(id)) {
             continue;
         }
 
-        m_tickets[nextIndex].whenDone = JobWantTo::RunNext;
-        pNextJob->start();
+        visited.insert(id);
+        int index = indexOfJob(id);
+
+        if (index >= 0) {
+            stack += m_tickets[index].pJob->dependsOnJobIds();
+        }
+    }
+
+    return false;
+}
+
+// END OF
+//==============================================================================
+
+void JobsManager::linkDependencies(int a_index)
+{
+    JobTicket &ticket = m_tickets[a_index];
+    QUuid jobID = ticket.pJob->id();
+    ticket.unmetDependencies = 0;
+    ticket.failedDependencies = 0;
+
+    for (const QUuid &id : ticket.pJob->dependsOnJobIds()) {
+        int dependencyIndex = indexOfJob(id);
+
+        // A missing dependency can never complete.
+        if (dependencyIndex < 0) {
+            ticket.unmetDependencies++;
+            ticket.failedDependencies++;
+            continue;
+        }
+
+        m_dependentJobs[id].push_back(jobID);
+        JobState dependencyState = m_tickets[dependencyIndex].pJob->state();
+
+        if (dependencyState != JobState::Completed) {
+            ticket.unmetDependencies++;
+        }
+
+        if (isFailState(dependencyState)) {
+            ticket.failedDependencies++;
+        }
+    }
+}
+
+// END OF
+//==============================================================================
+
+void JobsManager::unlinkDependencies(int a_index)
+{
+    JobTicket &ticket = m_tickets[a_index];
+    QUuid jobID = ticket.pJob->id();
+
+    for (const QUuid &id : ticket.pJob->dependsOnJobIds()) {
+        QHash<QUuid, QVector<QUuid>>::iterator it = m_dependentJobs.find(id);
+
+        if (it == m_dependentJobs.end()) {
+            continue;
+        }
+
+        it->removeOne(jobID);
+
+        if (it->isEmpty()) {
+            m_dependentJobs.erase(it);
+        }
+    }
+
+    ticket.unmetDependencies = 0;
+    ticket.failedDependencies = 0;
+}
+
+// END OF
+//==============================================================================
+
+void JobsManager::rebuildJobQueues()
+{
+    m_jobIndexes.clear();
+    m_dependentJobs.clear();
+
+    for (std::set<int> &readyJobs : m_readyJobs) {
+        readyJobs.clear();
+    }
+
+    m_blockedJobs.clear();
+    m_activeJobs.clear();
+
+    m_jobIndexes.reserve(m_tickets.size());
+
+    for (int i = 0; i < (int)m_tickets.size(); ++i) {
+        m_jobIndexes[m_tickets[i].pJob->id()] = i;
+    }
+
+    for (int i = 0; i < (int)m_tickets.size(); ++i) {
+        linkDependencies(i);
+        updateJobQueues(i);
+    }
+}
+
+// END OF
+//==============================================================================
+
+void JobsManager::updateJobQueues(int a_index)
+{
+    for (std::set<int> &readyJobs : m_readyJobs) {
+        readyJobs.erase(a_index);
+    }
+
+    m_blockedJobs.erase(a_index);
+    m_activeJobs.erase(a_index);
+
+    const JobTicket &ticket = m_tickets[a_index];
+    JobState state = ticket.pJob->state();
+
+    if (vsedit::contains(ACTIVE_JOB_STATES, state)) {
+        m_activeJobs.insert(a_index);
+        return;
+    }
+
+    if (state != JobState::Waiting) {
         return;
     }
+
+    if (ticket.failedDependencies > 0) {
+        m_blockedJobs.insert(a_index);
+    } else if (ticket.unmetDependencies == 0) {
+        m_readyJobs[priorityLevel(ticket.pJob->priority())].insert(a_index);
+    }
+}
+
+// END OF
+//==============================================================================
+
+void JobsManager::updateDependents(int a_index, JobState a_oldState,
+                                   JobState a_newState)
+{
+    int unmetChange = (int)(a_oldState == JobState::Completed) -
+                      (int)(a_newState == JobState::Completed);
+    int failedChange = (int)isFailState(a_newState) -
+                       (int)isFailState(a_oldState);
+
+    if ((unmetChange == 0) && (failedChange == 0)) {
+        return;
+    }
+
+    const QVector<QUuid> dependents =
+        m_dependentJobs.value(m_tickets[a_index].pJob->id());
+
+    for (const QUuid &id : dependents) {
+        int index = indexOfJob(id);
+
+        if (index < 0) {
+            continue;
+        }
+
+        m_tickets[index].unmetDependencies += unmetChange;
+        m_tickets[index].failedDependencies += failedChange;
+        updateJobQueues(index);
+    }
 }
 
 // END OF
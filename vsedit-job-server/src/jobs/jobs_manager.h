@@ -3,9 +3,12 @@
 
 #include "../../../common-src/jobs/job.h"
 #include "job_definitions.h"
+#include "jobs_journal.h"
 #include "../../../common-src/log/vs_editor_log_definitions.h"
 
 #include <QObject>
+#include <QHash>
+#include <set>
 #include <vector>
 
 class SettingsManagerCore;
@@ -23,6 +26,8 @@ public:
 
     QVector<JobProperties> jobsProperties() const;
 
+    int jobsCount() const;
+
     int createJob(const JobProperties &a_jobProperties = JobProperties());
 
     bool swapJobs(const QUuid &a_jobID1, const QUuid &a_jobID2);
@@ -33,7 +38,6 @@ public:
     bool changeJob(const JobProperties &a_jobProperties);
 
     bool loadJobs();
-    bool saveJobs();
 
     bool hasActiveJobs();
 
@@ -44,6 +48,11 @@ public:
     void resetJobs(const QVector<QUuid> &a_ids);
     void deleteJobs(const QVector<QUuid> &a_ids);
 
+public slots:
+
+    // Compacts the journal into the current jobs.
+    bool saveJobs();
+
 signals:
 
     void signalLogMessage(const QString &a_message,
@@ -51,8 +60,7 @@ signals:
     void signalJobCreated(const JobProperties &a_properties);
     void signalJobChanged(const JobProperties &a_properties);
     void signalJobStateChanged(const QUuid &a_jobID, JobState a_state);
-    void signalJobProgressChanged(const QUuid &a_jobID, int a_progress,
-                                  double a_fps);
+    void signalJobProgressChanged(const JobProperties &a_properties);
     void signalJobStartTimeChanged(const QUuid &a_jobID,
                                    const QDateTime &a_time);
     void signalJobEndTimeChanged(const QUuid &a_jobID,
@@ -76,12 +84,6 @@ private slots:
 
 private:
 
-    enum class DependenciesState {
-        Incomplete,
-        Complete,
-        Failed,
-    };
-
     bool canModifyJob(int a_index) const;
 
     int indexOfJob(const QUuid &a_uuid) const;
@@ -90,14 +92,76 @@ private:
 
     bool checkCanModifyJobAndNotify(int a_index);
 
-    DependenciesState dependenciesState(int a_index);
+    // True if the job would depend on itself through the dependencies.
+    bool createsCycle(const QUuid &a_jobID,
+                      const QVector<QUuid> &a_dependencies) const;
+
+    // Counts the unmet dependencies of the job and registers it
+    // as a dependent of each of them, or undoes that.
+    void linkDependencies(int a_index);
+    void unlinkDependencies(int a_index);
+
+    void rebuildJobQueues();
+
+    // Files the job into the ready, blocked or active set by its state.
+    void updateJobQueues(int a_index);
+
+    void updateDependents(int a_index, JobState a_oldState,
+                          JobState a_newState);
+
+    // Encoding jobs run in worker processes if the settings say so.
+    vsedit::Job *newJob(const JobProperties &a_properties);
 
     void connectJob(vsedit::Job *a_pJob);
 
-    void startFirstReadyJob(int a_fromIndex = 0);
+    // Keeps the script of the job by its hash. The same script of another
+    // job is shared, and a script known by its hash is filled in.
+    JobProperties storeScript(const JobProperties &a_properties);
+
+    void dropUnusedScripts();
+
+    // Starts waiting jobs in order for as long as their threads and memory
+    // fit into what the active jobs leave of the budget.
+    void startReadyJobs();
+
+    bool startNextReadyJob();
+
+    int nextReadyJob() const;
+
+    // Pauses running jobs of a lower priority than the job until they
+    // free a_threadsNeeded threads. Nothing is paused if they can not.
+    void preemptJobs(int a_index, int a_threadsNeeded, int a_threadsBudget);
+
+    int jobThreads(const vsedit::Job *a_cpJob, int a_threadsBudget) const;
 
     QVector<JobTicket> m_tickets;
 
+    // Dependency graph of the jobs. Rebuilt when jobs are removed or
+    // reordered and updated in place when a job changes its state,
+    // so only the dependents of that job are visited.
+    QHash<QUuid, int> m_jobIndexes;
+    QHash<QUuid, QVector<QUuid>> m_dependentJobs;
+
+    static const int PRIORITY_LEVELS = (int)JobPriority::High + 1;
+
+    // Queue positions of waiting jobs whose dependencies have all
+    // completed by priority, of waiting jobs with a failed dependency
+    // and of active jobs.
+    std::set<int> m_readyJobs[PRIORITY_LEVELS];
+    std::set<int> m_blockedJobs;
+    std::set<int> m_activeJobs;
+
+    // Set while ready jobs are being started, so the state changes
+    // of the jobs only ask for another round instead of recursing.
+    bool m_startingJobs;
+    bool m_startJobsAgain;
+
+    // Scripts of the jobs by their hashes.
+    QHash<QString, QString> m_scripts;
+
+    // Changes of the jobs are appended to it as they happen.
+    JobsJournal m_journal;
+
     SettingsManagerCore *m_pSettingsManager;
     VSScriptLibrary *m_pVSScriptLibrary;
 };
@@ -0,0 +1,126 @@
+#include "worker_channel.h"
+
+#include "../../../common-src/helpers.h"
+
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QtEndian>
+
+//==============================================================================
+
+// Anything longer is taken for a broken stream.
+static const quint32 MAX_MESSAGE_BYTES = 64u * 1024u * 1024u;
+
+static const int LENGTH_BYTES = (int)sizeof(quint32);
+
+//==============================================================================
+
+WorkerChannel::WorkerChannel(QLocalSocket *a_pSocket, QObject *a_pParent) :
+    QObject(a_pParent)
+    , m_pSocket(a_pSocket)
+{
+    Q_ASSERT(m_pSocket);
+    m_pSocket->setParent(this);
+
+    connect(m_pSocket, SIGNAL(readyRead()), this, SLOT(slotReadyRead()));
+    connect(m_pSocket, SIGNAL(disconnected()),
+            this, SIGNAL(signalDisconnected()));
+}
+
+// END OF WorkerChannel::WorkerChannel(QLocalSocket *a_pSocket,
+//		QObject *a_pParent)
+//==============================================================================
+
+WorkerChannel::~WorkerChannel()
+{
+    disconnect(m_pSocket, SIGNAL(disconnected()),
+               this, SIGNAL(signalDisconnected()));
+    m_pSocket->abort();
+}
+
+// END OF WorkerChannel::~WorkerChannel()
+//==============================================================================
+
+bool WorkerChannel::isConnected() const
+{
+    return (m_pSocket->state() == QLocalSocket::ConnectedState);
+}
+
+// END OF bool WorkerChannel::isConnected() const
+//==============================================================================
+
+void WorkerChannel::send(const QString &a_command,
+                         const QJsonObject &a_arguments)
+{
+    if (!isConnected()) {
+        return;
+    }
+
+    QByteArray message = vsedit::jsonMessage(a_command, a_arguments);
+    char length[LENGTH_BYTES];
+    qToBigEndian<quint32>((quint32)message.size(), length);
+    m_pSocket->write(length, LENGTH_BYTES);
+    m_pSocket->write(message);
+}
+
+// END OF void WorkerChannel::send(const QString &a_command,
+//		const QJsonObject &a_arguments)
+//==============================================================================
+
+void WorkerChannel::receivePending()
+{
+    while (m_pSocket->waitForReadyRead(0)) {
+    }
+
+    slotReadyRead();
+}
+
+// END OF void WorkerChannel::receivePending()
+//==============================================================================
+
+void WorkerChannel::flush(int a_msecs)
+{
+    while ((m_pSocket->bytesToWrite() > 0) &&
+            m_pSocket->waitForBytesWritten(a_msecs)) {
+    }
+}
+
+// END OF void WorkerChannel::flush(int a_msecs)
+//==============================================================================
+
+void WorkerChannel::slotReadyRead()
+{
+    m_buffer += m_pSocket->readAll();
+
+    while (m_buffer.size() >= LENGTH_BYTES) {
+        quint32 length = qFromBigEndian<quint32>(m_buffer.constData());
+
+        if (length > MAX_MESSAGE_BYTES) {
+            m_buffer.clear();
+            m_pSocket->abort();
+            return;
+        }
+
+        if ((quint32)m_buffer.size() < LENGTH_BYTES + length) {
+            return;
+        }
+
+        QByteArray message = m_buffer.mid(LENGTH_BYTES, (int)length);
+        m_buffer.remove(0, LENGTH_BYTES + (int)length);
+
+        QString command = QString::fromUtf8(message);
+        QByteArray arguments;
+        int spaceIndex = message.indexOf(' ');
+
+        if (spaceIndex >= 0) {
+            command = QString::fromUtf8(message.left(spaceIndex));
+            arguments = message.mid(spaceIndex + 1);
+        }
+
+        emit signalMessageReceived(command,
+                                   QJsonDocument::fromJson(arguments).object());
+    }
+}
+
+// END OF void WorkerChannel::slotReadyRead()
+//==============================================================================
@@ -0,0 +1,53 @@
+#ifndef WORKER_CHANNEL_H_INCLUDED
+#define WORKER_CHANNEL_H_INCLUDED
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+class QLocalSocket;
+
+// Messages between the job server and a job worker over a local socket.
+// Each message is a command with JSON arguments as in the watcher protocol,
+// preceded by its length since the socket is a plain stream.
+class WorkerChannel : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    // Takes ownership of the connected socket.
+    WorkerChannel(QLocalSocket *a_pSocket, QObject *a_pParent = nullptr);
+    virtual ~WorkerChannel();
+
+    bool isConnected() const;
+
+    void send(const QString &a_command,
+              const QJsonObject &a_arguments = QJsonObject());
+
+    // Handles whatever the other side has sent and the event loop
+    // has not picked up yet.
+    void receivePending();
+
+    // Blocks until everything sent is written, before the process exits.
+    void flush(int a_msecs);
+
+signals:
+
+    void signalMessageReceived(const QString &a_command,
+                               const QJsonObject &a_arguments);
+    void signalDisconnected();
+
+private slots:
+
+    void slotReadyRead();
+
+private:
+
+    QLocalSocket *m_pSocket;
+
+    QByteArray m_buffer;
+};
+
+#endif // WORKER_CHANNEL_H_INCLUDED
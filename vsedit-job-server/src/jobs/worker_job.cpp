@@ -0,0 +1,446 @@
+#include "worker_job.h"
+
+#include "worker_channel.h"
+#include "../../../common-src/ipc_defines.h"
+#include "../../../common-src/helpers.h"
+
+#include <QCoreApplication>
+#include <QLocalSocket>
+#include <QUuid>
+
+//==============================================================================
+
+// Milliseconds a worker is given to abort its job before it is killed.
+static const int WORKER_ABORT_TIMEOUT = 10000;
+
+// Milliseconds to wait for a killed worker to exit.
+static const int WORKER_KILL_TIMEOUT = 3000;
+
+//==============================================================================
+
+WorkerJob::WorkerJob(const JobProperties &a_properties,
+                     SettingsManagerCore *a_pSettingsManager,
+                     VSScriptLibrary *a_pVSScriptLibrary, QObject *a_pParent) :
+    vsedit::Job(a_properties, a_pSettingsManager, a_pVSScriptLibrary,
+                a_pParent)
+    , m_inWorker(false)
+    , m_pChannel(nullptr)
+{
+    // Whatever the worker prints ends up in the output of the server.
+    m_workerProcess.setProcessChannelMode(QProcess::ForwardedChannels);
+
+    m_abortTimer.setSingleShot(true);
+    m_abortTimer.setInterval(WORKER_ABORT_TIMEOUT);
+
+    connect(&m_localServer, SIGNAL(newConnection()),
+            this, SLOT(slotNewConnection()));
+    connect(&m_workerProcess, SIGNAL(finished(int, QProcess::ExitStatus)),
+            this, SLOT(slotWorkerFinished(int, QProcess::ExitStatus)));
+    connect(&m_workerProcess, SIGNAL(error(QProcess::ProcessError)),
+            this, SLOT(slotWorkerError(QProcess::ProcessError)));
+    connect(&m_abortTimer, SIGNAL(timeout()), this, SLOT(slotAbortTimeout()));
+}
+
+// END OF WorkerJob::WorkerJob(const JobProperties &a_properties,
+//		SettingsManagerCore *a_pSettingsManager,
+//		VSScriptLibrary *a_pVSScriptLibrary, QObject *a_pParent)
+//==============================================================================
+
+WorkerJob::~WorkerJob()
+{
+    stopWorker();
+}
+
+// END OF WorkerJob::~WorkerJob()
+//==============================================================================
+
+void WorkerJob::start()
+{
+    if (m_inWorker) {
+        JobState resumableStates[] = {JobState::Paused, JobState::Pausing};
+
+        if (vsedit::contains(resumableStates, state())) {
+            changeStateAndNotify(JobState::Running);
+            sendToWorker(WKMSG_RESUME_JOB);
+        }
+
+        return;
+    }
+
+    if (isActive() || (type() != JobType::EncodeScriptCLI)) {
+        vsedit::Job::start();
+        return;
+    }
+
+    // The state changes at once, as for a job running in the server,
+    // so the scheduler counts the job as active from now on.
+    m_inWorker = true;
+    m_properties.timeStarted = QDateTime::currentDateTimeUtc();
+    changeStateAndNotify(JobState::Running);
+    emit signalStartTimeChanged();
+
+    if (!startWorker()) {
+        changeStateAndNotify(JobState::Failed);
+    }
+}
+
+// END OF void WorkerJob::start()
+//==============================================================================
+
+void WorkerJob::pause()
+{
+    if (!m_inWorker) {
+        vsedit::Job::pause();
+        return;
+    }
+
+    if (state() != JobState::Running) {
+        return;
+    }
+
+    // The worker reports the job running again if it can not be paused.
+    changeStateAndNotify(JobState::Pausing);
+    sendToWorker(WKMSG_PAUSE_JOB);
+}
+
+// END OF void WorkerJob::pause()
+//==============================================================================
+
+void WorkerJob::abort()
+{
+    if (!m_inWorker) {
+        vsedit::Job::abort();
+        return;
+    }
+
+    if (!isActive()) {
+        return;
+    }
+
+    changeStateAndNotify(JobState::Aborting);
+
+    if (!m_pChannel) {
+        stopWorker();
+        changeStateAndNotify(JobState::Aborted);
+        return;
+    }
+
+    sendToWorker(WKMSG_ABORT_JOB);
+    m_abortTimer.start();
+}
+
+// END OF void WorkerJob::abort()
+//==============================================================================
+
+bool WorkerJob::setScriptThreads(int a_threads)
+{
+    if (!vsedit::Job::setScriptThreads(a_threads)) {
+        return false;
+    }
+
+    if (m_inWorker) {
+        QJsonObject jsThreads;
+        jsThreads[WK_SCRIPT_THREADS] = a_threads;
+        sendToWorker(WKMSG_SET_SCRIPT_THREADS, jsThreads);
+    }
+
+    return true;
+}
+
+// END OF bool WorkerJob::setScriptThreads(int a_threads)
+//==============================================================================
+
+void WorkerJob::slotNewConnection()
+{
+    QLocalSocket *pSocket = m_localServer.nextPendingConnection();
+
+    if (!pSocket) {
+        return;
+    }
+
+    // Only the worker started for the job is expected.
+    m_localServer.close();
+
+    if (m_pChannel || !m_inWorker) {
+        pSocket->abort();
+        pSocket->deleteLater();
+        return;
+    }
+
+    m_pChannel = new WorkerChannel(pSocket, this);
+    connect(m_pChannel,
+            SIGNAL(signalMessageReceived(const QString &, const QJsonObject &)),
+            this,
+            SLOT(slotWorkerMessageReceived(const QString &, const QJsonObject &)));
+    connect(m_pChannel, SIGNAL(signalDisconnected()),
+            this, SLOT(slotWorkerDisconnected()));
+
+    // The worker starts the job anew from the properties it is given,
+    // including what an interrupted job has completed.
+    JobProperties properties = m_properties;
+    properties.jobState = JobState::Waiting;
+
+    QJsonObject jsStart;
+    jsStart[WK_PROPERTIES] = properties.toJson();
+    jsStart[WK_FRAMES_MEMORY_BUDGET] = (double)framesMemoryBudget();
+    jsStart[WK_SCRIPT_THREADS] = scriptThreads();
+    m_pChannel->send(WKMSG_START_JOB, jsStart);
+
+    for (const std::pair<QString, QJsonObject> &message : m_pendingMessages) {
+        m_pChannel->send(message.first, message.second);
+    }
+
+    m_pendingMessages.clear();
+}
+
+// END OF void WorkerJob::slotNewConnection()
+//==============================================================================
+
+void WorkerJob::slotWorkerMessageReceived(const QString &a_command,
+        const QJsonObject &a_arguments)
+{
+    if (!m_inWorker) {
+        return;
+    }
+
+    if (a_command == QString(WKSMSG_JOB_STATE_UPDATE)) {
+        if (a_arguments.contains(JP_JOB_STATE)) {
+            changeStateAndNotify((JobState)a_arguments[JP_JOB_STATE].toInt());
+        }
+
+        return;
+    }
+
+    if (a_command == QString(WKSMSG_JOB_PROGRESS_UPDATE)) {
+        m_properties.progressFromJson(a_arguments);
+        emit signalProgressChanged();
+        return;
+    }
+
+    if (a_command == QString(WKSMSG_JOB_UPDATE)) {
+        QDateTime timeStarted = m_properties.timeStarted;
+        QDateTime timeEnded = m_properties.timeEnded;
+        updateProperties(a_arguments);
+
+        if (m_properties.timeStarted != timeStarted) {
+            emit signalStartTimeChanged();
+        }
+
+        if (m_properties.timeEnded != timeEnded) {
+            emit signalEndTimeChanged();
+        }
+
+        emit signalPropertiesChanged();
+        return;
+    }
+
+    if (a_command == QString(WKSMSG_LOG_MESSAGE)) {
+        LogEntry entry = LogEntry::fromJson(a_arguments);
+        emit signalLogMessage(entry.text, entry.style);
+        return;
+    }
+}
+
+// END OF void WorkerJob::slotWorkerMessageReceived(const QString &a_command,
+//		const QJsonObject &a_arguments)
+//==============================================================================
+
+void WorkerJob::slotWorkerDisconnected()
+{
+    if (!m_pChannel) {
+        return;
+    }
+
+    // The exit of the worker process decides what became of the job.
+    m_pChannel->deleteLater();
+    m_pChannel = nullptr;
+}
+
+// END OF void WorkerJob::slotWorkerDisconnected()
+//==============================================================================
+
+void WorkerJob::slotWorkerFinished(int a_exitCode,
+                                   QProcess::ExitStatus a_exitStatus)
+{
+    // The final state may still wait in the socket.
+    if (m_pChannel) {
+        m_pChannel->receivePending();
+    }
+
+    if (!m_inWorker) {
+        return;
+    }
+
+    if (a_exitStatus == QProcess::CrashExit) {
+        failWorker(tr("The worker process of the job has crashed."));
+    } else {
+        failWorker(tr("The worker process of the job has exited with "
+                      "code %1 before the job was over.").arg(a_exitCode));
+    }
+}
+
+// END OF void WorkerJob::slotWorkerFinished(int a_exitCode,
+//		QProcess::ExitStatus a_exitStatus)
+//==============================================================================
+
+void WorkerJob::slotWorkerError(QProcess::ProcessError a_error)
+{
+    // Other errors come with the exit of the process.
+    if (a_error != QProcess::FailedToStart) {
+        return;
+    }
+
+    if (!m_inWorker) {
+        return;
+    }
+
+    failWorker(tr("Could not start a worker process for the job. %1")
+               .arg(m_workerProcess.errorString()));
+}
+
+// END OF void WorkerJob::slotWorkerError(QProcess::ProcessError a_error)
+//==============================================================================
+
+void WorkerJob::slotAbortTimeout()
+{
+    if (!m_inWorker || (state() != JobState::Aborting)) {
+        return;
+    }
+
+    emit signalLogMessage(tr("The worker process did not abort the job "
+                             "in time and was killed."), LOG_STYLE_WARNING);
+    stopWorker();
+    changeStateAndNotify(JobState::Aborted);
+}
+
+// END OF void WorkerJob::slotAbortTimeout()
+//==============================================================================
+
+void WorkerJob::changeStateAndNotify(JobState a_state)
+{
+    if (m_inWorker && !vsedit::contains(ACTIVE_JOB_STATES, a_state)) {
+        // The worker exits on its own once it has reported the end.
+        m_inWorker = false;
+        m_abortTimer.stop();
+        m_pendingMessages.clear();
+    }
+
+    vsedit::Job::changeStateAndNotify(a_state);
+}
+
+// END OF void WorkerJob::changeStateAndNotify(JobState a_state)
+//==============================================================================
+
+bool WorkerJob::startWorker()
+{
+    stopWorker();
+
+    // The first connection is taken for the worker. A random name and
+    // a socket only the user can open keep others from taking its place.
+    QString serverName = QString(JOB_WORKER_SERVER_NAME_PREFIX) +
+                         QString(QUuid::createUuid().toRfc4122().toHex());
+    m_localServer.setSocketOptions(QLocalServer::UserAccessOption);
+
+    if (!m_localServer.listen(serverName)) {
+        emit signalLogMessage(tr("Could not listen for the worker process "
+                                 "of the job. %1").arg(m_localServer.errorString()),
+                              LOG_STYLE_ERROR);
+        return false;
+    }
+
+    m_workerProcess.setProgram(QCoreApplication::applicationFilePath());
+    m_workerProcess.setArguments({JOB_WORKER_ARGUMENT, serverName});
+    m_workerProcess.start();
+    return true;
+}
+
+// END OF bool WorkerJob::startWorker()
+//==============================================================================
+
+void WorkerJob::stopWorker()
+{
+    delete m_pChannel;
+    m_pChannel = nullptr;
+    m_localServer.close();
+    m_pendingMessages.clear();
+
+    if (m_workerProcess.state() == QProcess::NotRunning) {
+        return;
+    }
+
+    // The job is ended by the caller, not by the exit of the worker.
+    m_workerProcess.blockSignals(true);
+    m_workerProcess.kill();
+    m_workerProcess.waitForFinished(WORKER_KILL_TIMEOUT);
+    m_workerProcess.blockSignals(false);
+}
+
+// END OF void WorkerJob::stopWorker()
+//==============================================================================
+
+void WorkerJob::sendToWorker(const QString &a_command,
+                             const QJsonObject &a_arguments)
+{
+    if (m_pChannel) {
+        m_pChannel->send(a_command, a_arguments);
+        return;
+    }
+
+    m_pendingMessages.push_back(std::make_pair(a_command, a_arguments));
+}
+
+// END OF void WorkerJob::sendToWorker(const QString &a_command,
+//		const QJsonObject &a_arguments)
+//==============================================================================
+
+void WorkerJob::updateProperties(const QJsonObject &a_object)
+{
+    m_properties.progressFromJson(a_object);
+
+    if (a_object.contains(JP_TIME_STARTED))
+        m_properties.timeStarted = QDateTime::fromMSecsSinceEpoch(
+                                       a_object[JP_TIME_STARTED].toVariant().toLongLong());
+
+    if (a_object.contains(JP_TIME_ENDED))
+        m_properties.timeEnded = QDateTime::fromMSecsSinceEpoch(
+                                     a_object[JP_TIME_ENDED].toVariant().toLongLong());
+
+    if (a_object.contains(JP_FIRST_FRAME_REAL)) {
+        m_properties.firstFrameReal = a_object[JP_FIRST_FRAME_REAL].toInt();
+    }
+
+    if (a_object.contains(JP_LAST_FRAME_REAL)) {
+        m_properties.lastFrameReal = a_object[JP_LAST_FRAME_REAL].toInt();
+    }
+
+    if (a_object.contains(JP_ENCODER_LOG_FILE)) {
+        m_properties.encoderLogFile = a_object[JP_ENCODER_LOG_FILE].toString();
+    }
+
+    // The worker reads the script from its file when the job has no text.
+    QString scriptHash = a_object[JP_SCRIPT_HASH].toString();
+
+    if (!scriptHash.isEmpty() && (scriptHash != m_properties.scriptHash) &&
+            a_object.contains(JP_SCRIPT_TEXT)) {
+        m_properties.scriptText = a_object[JP_SCRIPT_TEXT].toString();
+        m_properties.scriptHash = scriptHash;
+    }
+}
+
+// END OF void WorkerJob::updateProperties(const QJsonObject &a_object)
+//==============================================================================
+
+void WorkerJob::failWorker(const QString &a_reason)
+{
+    stopWorker();
+    emit signalLogMessage(a_reason, LOG_STYLE_ERROR);
+
+    if (state() == JobState::Aborting) {
+        changeStateAndNotify(JobState::Aborted);
+    } else {
+        changeStateAndNotify(JobState::Failed);
+    }
+}
+
+// END OF void WorkerJob::failWorker(const QString &a_reason)
+//==============================================================================
@@ -0,0 +1,84 @@
+#ifndef WORKER_JOB_H_INCLUDED
+#define WORKER_JOB_H_INCLUDED
+
+#include "../../../common-src/jobs/job.h"
+
+#include <QLocalServer>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTimer>
+#include <utility>
+#include <vector>
+
+class WorkerChannel;
+
+// Runs an encoding job in a worker process of its own, so a crashing
+// plugin only takes that job down and every job evaluates its script in
+// its own Python interpreter. The job mirrors the state and progress the
+// worker reports and passes start, pause and abort on to it.
+// Jobs of other types run in the server as before.
+class WorkerJob : public vsedit::Job
+{
+    Q_OBJECT
+
+public:
+
+    WorkerJob(const JobProperties &a_properties = JobProperties(),
+              SettingsManagerCore *a_pSettingsManager = nullptr,
+              VSScriptLibrary *a_pVSScriptLibrary = nullptr,
+              QObject *a_pParent = nullptr);
+    virtual ~WorkerJob();
+
+    // Passed on to the worker once the job runs there.
+    virtual bool setScriptThreads(int a_threads) override;
+
+public slots:
+
+    virtual void start() override;
+    virtual void pause() override;
+    virtual void abort() override;
+
+private slots:
+
+    void slotNewConnection();
+    void slotWorkerMessageReceived(const QString &a_command,
+                                   const QJsonObject &a_arguments);
+    void slotWorkerDisconnected();
+    void slotWorkerFinished(int a_exitCode, QProcess::ExitStatus a_exitStatus);
+    void slotWorkerError(QProcess::ProcessError a_error);
+    void slotAbortTimeout();
+
+protected:
+
+    virtual void changeStateAndNotify(JobState a_state) override;
+
+private:
+
+    bool startWorker();
+
+    void stopWorker();
+
+    void sendToWorker(const QString &a_command,
+                      const QJsonObject &a_arguments = QJsonObject());
+
+    // Takes the properties the worker changes while running the job from
+    // a full update it has sent. The rest are kept by the server.
+    void updateProperties(const QJsonObject &a_object);
+
+    // Ends the job when its worker is gone before the job has finished.
+    void failWorker(const QString &a_reason);
+
+    // True from the start of the job in a worker until the job is over.
+    bool m_inWorker;
+
+    QLocalServer m_localServer;
+    QProcess m_workerProcess;
+    WorkerChannel *m_pChannel;
+
+    // Sent to the worker once it has connected.
+    std::vector<std::pair<QString, QJsonObject>> m_pendingMessages;
+
+    QTimer m_abortTimer;
+};
+
+#endif // WORKER_JOB_H_INCLUDED
@@ -1,10 +1,12 @@
 #include "job_server.h"
+#include "job_worker.h"
 
 #include "../../common-src/application_instance_file_guard/application_instance_file_guard.h"
 #include "../../common-src/ipc_defines.h"
 #include <vapoursynth/VapourSynth.h>
 
 #include <QCoreApplication>
+#include <QStringList>
 
 Q_DECLARE_OPAQUE_POINTER(const VSFrameRef *)
 Q_DECLARE_OPAQUE_POINTER(VSNodeRef *)
@@ -16,6 +18,23 @@ int main(int argc, char *argv[])
     qRegisterMetaType<const VSFrameRef *>("const VSFrameRef *");
     qRegisterMetaType<VSNodeRef *>("VSNodeRef *");
 
+    // The server starts itself as a worker for a job of its own.
+    QStringList arguments = application.arguments();
+
+    if ((arguments.size() > 2) && (arguments[1] == JOB_WORKER_ARGUMENT)) {
+        JobWorker jobWorker(arguments[2]);
+
+        application.connect(&jobWorker, &JobWorker::finish,
+                            &application, &QCoreApplication::quit);
+
+        if (!jobWorker.start()) {
+            qCritical("Couldn't connect to the job server.");
+            return 1;
+        }
+
+        return application.exec();
+    }
+
     ApplicationInstanceFileGuard guard("vsedit_job_server_running");
 
     if (!guard.isLocked()) {
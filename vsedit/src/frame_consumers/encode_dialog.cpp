@@ -42,6 +42,11 @@ EncodeDialog::EncodeDialog(SettingsManager *a_pSettingsManager,
     m_ui.feedbackTextEdit->setSettingsManager(m_pSettingsManager);
     m_ui.feedbackTextEdit->loadSettings();
 
+    m_ui.outputTypeComboBox->addItem(tr("Encoder"),
+                                     (int)EncodingType::CLI);
+    m_ui.outputTypeComboBox->addItem(tr("File"),
+                                     (int)EncodingType::Raw);
+
     m_ui.headerTypeComboBox->addItem(tr("No header"),
                                      (int)EncodingHeaderType::NoHeader);
     m_ui.headerTypeComboBox->addItem(tr("Y4M"),
@@ -61,6 +66,8 @@ EncodeDialog::EncodeDialog(SettingsManager *a_pSettingsManager,
             this, SLOT(slotExecutableBrowseButtonPressed()));
     connect(m_ui.argumentsHelpButton, SIGNAL(clicked()),
             this, SLOT(slotArgumentsHelpButtonPressed()));
+    connect(m_ui.outputTypeComboBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(slotOutputTypeChanged(int)));
 
     connect(m_pJob, &vsedit::Job::signalStateChanged,
             this, &EncodeDialog::slotJobStateChanged);
@@ -223,6 +230,8 @@ void EncodeDialog::slotStartEncodeButtonPressed()
 
     m_pJob->setFirstFrame(firstFrame);
     m_pJob->setLastFrame(lastFrame);
+    m_pJob->setEncodingType((EncodingType)
+                            m_ui.outputTypeComboBox->currentData().toInt());
     m_pJob->setExecutablePath(vsedit::findExecutable(m_ui.executablePathEdit->text()));
     m_pJob->setArguments(m_ui.argumentsTextEdit->toPlainText());
     m_pJob->setEncodingHeaderType((EncodingHeaderType)
@@ -266,6 +275,8 @@ void EncodeDialog::slotArgumentsHelpButtonPressed()
     }
     argumentsHelpString += QLatin1String("\n\n") +
             tr("You can also use %{foo} to replace with variables created with `#define foo bar` in the script.");
+    argumentsHelpString += QLatin1String("\n\n") +
+            tr("When the output is a file, arguments are the path of that file.");
 
     QString title = tr("Encoder arguments");
     QMessageBox::information(this, title, argumentsHelpString);
@@ -274,6 +285,19 @@ void EncodeDialog::slotArgumentsHelpButtonPressed()
 // END OF void EncodeDialog::slotArgumentsHelpButtonPressed()
 //==============================================================================
 
+void EncodeDialog::slotOutputTypeChanged(int a_index)
+{
+    EncodingType outputType =
+        (EncodingType)m_ui.outputTypeComboBox->itemData(a_index).toInt();
+    bool useEncoder = (outputType == EncodingType::CLI);
+
+    m_ui.executablePathEdit->setEnabled(useEncoder);
+    m_ui.executableBrowseButton->setEnabled(useEncoder);
+}
+
+// END OF void EncodeDialog::slotOutputTypeChanged(int a_index)
+//==============================================================================
+
 void EncodeDialog::slotEncodingPresetSaveButtonPressed()
 {
     EncodingPreset preset(m_ui.encodingPresetComboBox->currentText());
@@ -284,6 +308,9 @@ void EncodeDialog::slotEncodingPresetSaveButtonPressed()
         return;
     }
 
+    preset.type = (EncodingType)
+                  m_ui.outputTypeComboBox->currentData().toInt();
+
     if (preset.type == EncodingType::CLI) {
         preset.executablePath = m_ui.executablePathEdit->text();
 
@@ -295,6 +322,15 @@ void EncodeDialog::slotEncodingPresetSaveButtonPressed()
         }
 
         preset.arguments = m_ui.argumentsTextEdit->toPlainText();
+    } else if (preset.type == EncodingType::Raw) {
+        preset.arguments = m_ui.argumentsTextEdit->toPlainText();
+
+        if (preset.arguments.trimmed().isEmpty()) {
+            m_ui.feedbackTextEdit->addEntry(
+                tr("Output file path must not be empty."),
+                LOG_STYLE_WARNING);
+            return;
+        }
     }
 
     preset.headerType = (EncodingHeaderType)
@@ -399,6 +435,17 @@ void EncodeDialog::slotEncodingPresetComboBoxActivated(const QString &a_text)
     m_ui.executablePathEdit->setText(preset.executablePath);
     m_ui.argumentsTextEdit->setPlainText(preset.arguments);
 
+    int outputTypeIndex =
+        m_ui.outputTypeComboBox->findData((int)preset.type);
+
+    if (outputTypeIndex < 0) {
+        m_ui.feedbackTextEdit->addEntry(tr("Error. Preset \'%1\' "
+                                           "has unknown output type.").arg(preset.name), LOG_STYLE_ERROR);
+        outputTypeIndex = 0;
+    }
+
+    m_ui.outputTypeComboBox->setCurrentIndex(outputTypeIndex);
+
     int headerTypeIndex =
         m_ui.headerTypeComboBox->findData((int)preset.headerType);
 
@@ -516,7 +563,25 @@ void EncodeDialog::slotJobProgressChanged()
         }
     }
 
+    text += tr("; waiting for script: %1, for encoder: %2")
+            .arg(vsedit::timeToString(properties.scriptWaitTime))
+            .arg(vsedit::timeToString(properties.pipeStallTime));
+    text += tr(", packing: %1")
+            .arg(vsedit::timeToString(properties.packingTime));
+
+    if (properties.encoderCpuTime >= 0.0) {
+        text += tr("; encoder CPU time: %1")
+                .arg(vsedit::timeToString(properties.encoderCpuTime));
+    }
+
+    if (properties.encoderFps > 0.0) {
+        text += tr("; encoder reports %1 fps, %2 kb/s")
+                .arg(properties.encoderFps, 0, 'f', 2)
+                .arg(properties.encoderBitrate, 0, 'f', 2);
+    }
+
     m_ui.metricsEdit->setText(text);
+    m_ui.bottleneckLabel->setText(properties.bottleneck());
 
     int percentage = (int)((double)properties.framesProcessed * 100.0 /
                            (double)properties.framesTotal());
@@ -52,6 +52,8 @@ private slots:
 
     void slotArgumentsHelpButtonPressed();
 
+    void slotOutputTypeChanged(int a_index);
+
     void slotEncodingPresetSaveButtonPressed();
     void slotEncodingPresetDeleteButtonPressed();
     void slotEncodingPresetComboBoxActivated(const QString &a_text);
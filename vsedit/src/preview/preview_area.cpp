@@ -1,8 +1,8 @@
 #include "preview_area.h"
 
 #include "scroll_navigator.h"
+#include "preview_canvas.h"
 
-#include <QLabel>
 #include <QKeyEvent>
 #include <QWheelEvent>
 #include <QMouseEvent>
@@ -12,16 +12,14 @@
 //==============================================================================
 
 PreviewArea::PreviewArea(QWidget *a_pParent) : QScrollArea(a_pParent)
-    , m_pPreviewLabel(nullptr)
+    , m_pPreviewCanvas(nullptr)
     , m_pScrollNavigator(nullptr)
     , m_draggingPreview(false)
     , m_lastCursorPos(0, 0)
     , m_lastPreviewLabelPos(0, 0)
 {
-    m_pPreviewLabel = new QLabel(this);
-    m_pPreviewLabel->clear();
-    m_pPreviewLabel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
-    QScrollArea::setWidget(m_pPreviewLabel);
+    m_pPreviewCanvas = new PreviewCanvas(this);
+    QScrollArea::setWidget(m_pPreviewCanvas);
     setWidgetResizable(true);
 
     m_pScrollNavigator = new ScrollNavigator(this);
@@ -31,7 +29,7 @@ PreviewArea::PreviewArea(QWidget *a_pParent) : QScrollArea(a_pParent)
     m_pScrollNavigator->setVisible(false);
 
     setMouseTracking(true);
-    m_pPreviewLabel->setMouseTracking(true);
+    m_pPreviewCanvas->setMouseTracking(true);
 }
 
 // END OF PreviewArea::PreviewArea(QWidget * a_pParent)
@@ -47,11 +45,7 @@ PreviewArea::~PreviewArea()
 
 QSize PreviewArea::pixmapSize() const
 {
-#if QT_VERSION >= QT_VERSION_CHECK(5,15,0)
-    return m_pPreviewLabel->pixmap(Qt::ReturnByValue).size();
-#else
-    return m_pPreviewLabel->pixmap()->size();
-#endif
+    return m_pPreviewCanvas->contentsSize();
 }
 
 // END OF const QImage * PreviewArea::pixmap() const
@@ -59,19 +53,41 @@ QSize PreviewArea::pixmapSize() const
 
 void PreviewArea::setPixmap(const QImage &a_pixmap)
 {
-    m_pPreviewLabel->setPixmap(QPixmap::fromImage(a_pixmap));
+    m_pPreviewCanvas->setFrameImage(a_pixmap, a_pixmap.rect(), 1.0,
+                                    Qt::FastTransformation);
 }
 
 // END OF void PreviewArea::setPixmap(const QPixmap & a_pixmap)
 //==============================================================================
 
+void PreviewArea::setPreviewImage(const QImage &a_frameImage,
+                                  const QRect &a_sourceRect, double a_scale,
+                                  Qt::TransformationMode a_scaleMode)
+{
+    m_pPreviewCanvas->setFrameImage(a_frameImage, a_sourceRect, a_scale,
+                                    a_scaleMode);
+}
+
+// END OF void PreviewArea::setPreviewImage(const QImage & a_frameImage,
+//		const QRect & a_sourceRect, double a_scale,
+//		Qt::TransformationMode a_scaleMode)
+//==============================================================================
+
+void PreviewArea::clearPreviewImage()
+{
+    m_pPreviewCanvas->clearFrameImage();
+}
+
+// END OF void PreviewArea::clearPreviewImage()
+//==============================================================================
+
 void PreviewArea::checkMouseOverPreview(const QPoint &a_globalMousePos)
 {
-    if (!m_pPreviewLabel->underMouse()) {
+    if (!m_pPreviewCanvas->underMouse()) {
         return;
     }
 
-    QPoint imagePoint = m_pPreviewLabel->mapFromGlobal(a_globalMousePos);
+    QPoint imagePoint = m_pPreviewCanvas->mapFromGlobal(a_globalMousePos);
 
     const QSize previewSize = pixmapSize();
     int pixmapWidth = previewSize.width();
@@ -82,8 +98,17 @@ void PreviewArea::checkMouseOverPreview(const QPoint &a_globalMousePos)
         return;
     }
 
-    float normX = (float)imagePoint.x() / (float)pixmapWidth;
-    float normY = (float)imagePoint.y() / (float)pixmapHeight;
+    const QImage &frameImage = m_pPreviewCanvas->frameImage();
+
+    if (frameImage.isNull()) {
+        return;
+    }
+
+    // Normalize to the whole frame, so the point stays correct when only
+    // a cropped part of the frame is shown.
+    QPointF framePoint = m_pPreviewCanvas->mapToFrame(imagePoint);
+    float normX = (float)framePoint.x() / (float)frameImage.width();
+    float normY = (float)framePoint.y() / (float)frameImage.height();
 
     emit signalMouseOverPoint(normX, normY);
 }
@@ -180,7 +205,7 @@ void PreviewArea::mousePressEvent(QMouseEvent *a_pEvent)
     if (a_pEvent->buttons() == Qt::LeftButton) {
         m_draggingPreview = true;
         m_lastCursorPos = a_pEvent->globalPos();
-        m_lastPreviewLabelPos = m_pPreviewLabel->pos();
+        m_lastPreviewLabelPos = m_pPreviewCanvas->pos();
         m_pScrollNavigator->setVisible(true);
         drawScrollNavigator();
         a_pEvent->accept();
@@ -244,8 +269,8 @@ void PreviewArea::drawScrollNavigator()
     const QSize previewSize = pixmapSize();
     int contentsWidth = previewSize.width();
     int contentsHeight = previewSize.height();
-    int viewportX = -m_pPreviewLabel->x();
-    int viewportY = -m_pPreviewLabel->y();
+    int viewportX = -m_pPreviewCanvas->x();
+    int viewportY = -m_pPreviewCanvas->y();
     int viewportWidth = viewport()->width();
     int viewportHeight = viewport()->height();
 
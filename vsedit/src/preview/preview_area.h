@@ -5,7 +5,7 @@
 #include <QPixmap>
 #include <QPoint>
 
-class QLabel;
+class PreviewCanvas;
 class ScrollNavigator;
 class QKeyEvent;
 class QWheelEvent;
@@ -27,6 +27,13 @@ public:
 
     void setPixmap(const QImage &a_pixmap);
 
+    void setPreviewImage(const QImage &a_frameImage,
+                         const QRect &a_sourceRect, double a_scale,
+                         Qt::TransformationMode a_scaleMode);
+
+    // Blanks the shown image while keeping its dimensions.
+    void clearPreviewImage();
+
     void checkMouseOverPreview(const QPoint &a_globalMousePos);
 
 public slots:
@@ -57,7 +64,7 @@ private:
 
     void drawScrollNavigator();
 
-    QLabel *m_pPreviewLabel;
+    PreviewCanvas *m_pPreviewCanvas;
 
     ScrollNavigator *m_pScrollNavigator;
 
@@ -0,0 +1,341 @@
+#include "preview_canvas.h"
+
+#include <QPaintEvent>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+//==============================================================================
+
+namespace {
+
+// Fixed point precision of the bilinear weights.
+const int WEIGHT_BITS = 8;
+const int WEIGHT_ONE = 1 << WEIGHT_BITS;
+
+// Packed 32-bit pixel with three channels of Bits each, starting from LSB.
+// Padding bits are set to ones the same way libp2p fills alpha.
+template <unsigned Bits>
+inline uint32_t lerpPixel(uint32_t a_p0, uint32_t a_p1, int a_weight)
+{
+    const uint32_t channelMask = (1u << Bits) - 1u;
+    const uint32_t paddingMask = ~((1u << (Bits * 3)) - 1u);
+    uint32_t result = paddingMask;
+
+    for (unsigned shift = 0; shift < Bits * 3; shift += Bits) {
+        uint32_t c0 = (a_p0 >> shift) & channelMask;
+        uint32_t c1 = (a_p1 >> shift) & channelMask;
+        uint32_t c = (c0 * (WEIGHT_ONE - a_weight) + c1 * a_weight +
+                      (WEIGHT_ONE >> 1)) >> WEIGHT_BITS;
+        result |= c << shift;
+    }
+
+    return result;
+}
+
+template <unsigned Bits>
+void blendRow(const uint32_t *a_cpRow0, const uint32_t *a_cpRow1,
+              int a_rowWeight, const int *a_cpColumnIndex,
+              const int *a_cpColumnWeight, uint32_t *a_pDst, int a_width)
+{
+    for (int x = 0; x < a_width; ++x) {
+        int x0 = a_cpColumnIndex[x * 2];
+        int x1 = a_cpColumnIndex[x * 2 + 1];
+        int weight = a_cpColumnWeight[x];
+        uint32_t top = lerpPixel<Bits>(a_cpRow0[x0], a_cpRow0[x1], weight);
+        uint32_t bottom = lerpPixel<Bits>(a_cpRow1[x0], a_cpRow1[x1], weight);
+        a_pDst[x] = lerpPixel<Bits>(top, bottom, a_rowWeight);
+    }
+}
+
+// Averages the source pixels covered by each destination pixel. Column spans
+// are stored as [begin, end) pairs.
+template <unsigned Bits>
+void averageRow(const QImage &a_image, int a_rowBegin, int a_rowEnd,
+                const int *a_cpColumnSpan, uint32_t *a_pDst, int a_width)
+{
+    const uint32_t channelMask = (1u << Bits) - 1u;
+    const uint32_t paddingMask = ~((1u << (Bits * 3)) - 1u);
+
+    for (int x = 0; x < a_width; ++x) {
+        int columnBegin = a_cpColumnSpan[x * 2];
+        int columnEnd = a_cpColumnSpan[x * 2 + 1];
+        uint64_t sums[3] = {0, 0, 0};
+
+        for (int y = a_rowBegin; y < a_rowEnd; ++y) {
+            const uint32_t *cpRow = reinterpret_cast<const uint32_t *>(
+                                        a_image.constScanLine(y));
+            for (int sourceX = columnBegin; sourceX < columnEnd; ++sourceX) {
+                uint32_t pixel = cpRow[sourceX];
+                sums[0] += pixel & channelMask;
+                sums[1] += (pixel >> Bits) & channelMask;
+                sums[2] += (pixel >> (Bits * 2)) & channelMask;
+            }
+        }
+
+        uint64_t count = (uint64_t)(a_rowEnd - a_rowBegin) *
+                         (uint64_t)(columnEnd - columnBegin);
+        uint32_t result = paddingMask;
+        for (unsigned channel = 0; channel < 3; ++channel) {
+            uint32_t c = (uint32_t)((sums[channel] + count / 2) / count);
+            result |= c << (Bits * channel);
+        }
+        a_pDst[x] = result;
+    }
+}
+
+} // namespace
+
+//==============================================================================
+
+PreviewCanvas::PreviewCanvas(QWidget *a_pParent) : QWidget(a_pParent)
+    , m_scale(1.0)
+    , m_scaleMode(Qt::FastTransformation)
+{
+}
+
+// END OF PreviewCanvas::PreviewCanvas(QWidget * a_pParent)
+//==============================================================================
+
+PreviewCanvas::~PreviewCanvas()
+{
+
+}
+
+// END OF PreviewCanvas::~PreviewCanvas()
+//==============================================================================
+
+void PreviewCanvas::setFrameImage(const QImage &a_frameImage,
+                                  const QRect &a_sourceRect, double a_scale,
+                                  Qt::TransformationMode a_scaleMode)
+{
+    QSize oldSize = contentsSize();
+
+    m_frameImage = a_frameImage;
+    m_sourceRect = a_sourceRect & a_frameImage.rect();
+    m_scale = (a_scale > 0.0) ? a_scale : 1.0;
+    m_scaleMode = a_scaleMode;
+
+    if (contentsSize() != oldSize) {
+        updateGeometry();
+    }
+
+    update();
+}
+
+// END OF void PreviewCanvas::setFrameImage(const QImage & a_frameImage,
+//		const QRect & a_sourceRect, double a_scale,
+//		Qt::TransformationMode a_scaleMode)
+//==============================================================================
+
+void PreviewCanvas::clearFrameImage()
+{
+    m_frameImage = QImage();
+    update();
+}
+
+// END OF void PreviewCanvas::clearFrameImage()
+//==============================================================================
+
+QSize PreviewCanvas::contentsSize() const
+{
+    return QSize((int)std::floor(m_sourceRect.width() * m_scale),
+                 (int)std::floor(m_sourceRect.height() * m_scale));
+}
+
+// END OF QSize PreviewCanvas::contentsSize() const
+//==============================================================================
+
+QSize PreviewCanvas::sizeHint() const
+{
+    return contentsSize();
+}
+
+// END OF QSize PreviewCanvas::sizeHint() const
+//==============================================================================
+
+QSize PreviewCanvas::minimumSizeHint() const
+{
+    return contentsSize();
+}
+
+// END OF QSize PreviewCanvas::minimumSizeHint() const
+//==============================================================================
+
+QPointF PreviewCanvas::mapToFrame(const QPoint &a_point) const
+{
+    return QPointF(m_sourceRect.x() + (a_point.x() + 0.5) / m_scale,
+                   m_sourceRect.y() + (a_point.y() + 0.5) / m_scale);
+}
+
+// END OF QPointF PreviewCanvas::mapToFrame(const QPoint & a_point) const
+//==============================================================================
+
+const QImage &PreviewCanvas::frameImage() const
+{
+    return m_frameImage;
+}
+
+// END OF const QImage & PreviewCanvas::frameImage() const
+//==============================================================================
+
+void PreviewCanvas::paintEvent(QPaintEvent *a_pEvent)
+{
+    QRect rect = a_pEvent->rect() & QRect(QPoint(0, 0), contentsSize());
+
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    QPainter painter(this);
+
+    if (m_frameImage.isNull()) {
+        painter.fillRect(rect, Qt::black);
+        return;
+    }
+
+    if ((m_tile.format() != m_frameImage.format()) ||
+            (m_tile.width() < rect.width()) ||
+            (m_tile.height() < rect.height())) {
+        QSize tileSize = rect.size().expandedTo(m_tile.size());
+        m_tile = QImage(tileSize, m_frameImage.format());
+    }
+
+    if ((m_scaleMode == Qt::SmoothTransformation) && (m_scale > 1.0)) {
+        renderBilinear(rect);
+    } else if ((m_scaleMode == Qt::SmoothTransformation) &&
+               (m_scale < 1.0)) {
+        // Two taps would skip source pixels below 50%, so average the
+        // whole footprint instead.
+        renderArea(rect);
+    } else {
+        renderNearest(rect);
+    }
+
+    painter.drawImage(rect.topLeft(), m_tile,
+                      QRect(0, 0, rect.width(), rect.height()));
+}
+
+// END OF void PreviewCanvas::paintEvent(QPaintEvent * a_pEvent)
+//==============================================================================
+
+void PreviewCanvas::renderNearest(const QRect &a_rect)
+{
+    int left = m_sourceRect.left();
+    int right = m_sourceRect.right();
+    int top = m_sourceRect.top();
+    int bottom = m_sourceRect.bottom();
+
+    m_columnIndex.resize(a_rect.width());
+
+    for (int x = 0; x < a_rect.width(); ++x) {
+        int sourceX = left + (int)((a_rect.x() + x + 0.5) / m_scale);
+        m_columnIndex[x] = std::min(std::max(sourceX, left), right);
+    }
+
+    for (int y = 0; y < a_rect.height(); ++y) {
+        int sourceY = top + (int)((a_rect.y() + y + 0.5) / m_scale);
+        sourceY = std::min(std::max(sourceY, top), bottom);
+
+        const uint32_t *cpSrc = reinterpret_cast<const uint32_t *>(
+                                    m_frameImage.constScanLine(sourceY));
+        uint32_t *pDst = reinterpret_cast<uint32_t *>(m_tile.scanLine(y));
+
+        for (int x = 0; x < a_rect.width(); ++x) {
+            pDst[x] = cpSrc[m_columnIndex[x]];
+        }
+    }
+}
+
+// END OF void PreviewCanvas::renderNearest(const QRect & a_rect)
+//==============================================================================
+
+void PreviewCanvas::renderBilinear(const QRect &a_rect)
+{
+    int left = m_sourceRect.left();
+    int right = m_sourceRect.right();
+    int top = m_sourceRect.top();
+    int bottom = m_sourceRect.bottom();
+
+    m_columnIndex.resize(a_rect.width() * 2);
+    m_columnWeight.resize(a_rect.width());
+
+    for (int x = 0; x < a_rect.width(); ++x) {
+        double position = left + (a_rect.x() + x + 0.5) / m_scale - 0.5;
+        double floorPosition = std::floor(position);
+        int x0 = (int)floorPosition;
+        m_columnIndex[x * 2] = std::min(std::max(x0, left), right);
+        m_columnIndex[x * 2 + 1] = std::min(std::max(x0 + 1, left), right);
+        m_columnWeight[x] = (int)((position - floorPosition) * WEIGHT_ONE);
+    }
+
+    bool is10Bits = (m_frameImage.format() == QImage::Format_RGB30);
+
+    for (int y = 0; y < a_rect.height(); ++y) {
+        double position = top + (a_rect.y() + y + 0.5) / m_scale - 0.5;
+        double floorPosition = std::floor(position);
+        int y0 = (int)floorPosition;
+        int rowWeight = (int)((position - floorPosition) * WEIGHT_ONE);
+
+        const uint32_t *cpRow0 = reinterpret_cast<const uint32_t *>(
+                                     m_frameImage.constScanLine(
+                                         std::min(std::max(y0, top), bottom)));
+        const uint32_t *cpRow1 = reinterpret_cast<const uint32_t *>(
+                                     m_frameImage.constScanLine(
+                                         std::min(std::max(y0 + 1, top), bottom)));
+        uint32_t *pDst = reinterpret_cast<uint32_t *>(m_tile.scanLine(y));
+
+        if (is10Bits) {
+            blendRow<10>(cpRow0, cpRow1, rowWeight, m_columnIndex.data(),
+                         m_columnWeight.data(), pDst, a_rect.width());
+        } else {
+            blendRow<8>(cpRow0, cpRow1, rowWeight, m_columnIndex.data(),
+                        m_columnWeight.data(), pDst, a_rect.width());
+        }
+    }
+}
+
+// END OF void PreviewCanvas::renderBilinear(const QRect & a_rect)
+//==============================================================================
+
+void PreviewCanvas::renderArea(const QRect &a_rect)
+{
+    int left = m_sourceRect.left();
+    int right = m_sourceRect.right();
+    int top = m_sourceRect.top();
+    int bottom = m_sourceRect.bottom();
+
+    m_columnIndex.resize(a_rect.width() * 2);
+
+    for (int x = 0; x < a_rect.width(); ++x) {
+        int begin = left + (int)std::floor((a_rect.x() + x) / m_scale);
+        int end = left + (int)std::floor((a_rect.x() + x + 1) / m_scale);
+        begin = std::min(std::max(begin, left), right);
+        end = std::min(std::max(end, begin + 1), right + 1);
+        m_columnIndex[x * 2] = begin;
+        m_columnIndex[x * 2 + 1] = end;
+    }
+
+    bool is10Bits = (m_frameImage.format() == QImage::Format_RGB30);
+
+    for (int y = 0; y < a_rect.height(); ++y) {
+        int begin = top + (int)std::floor((a_rect.y() + y) / m_scale);
+        int end = top + (int)std::floor((a_rect.y() + y + 1) / m_scale);
+        begin = std::min(std::max(begin, top), bottom);
+        end = std::min(std::max(end, begin + 1), bottom + 1);
+
+        uint32_t *pDst = reinterpret_cast<uint32_t *>(m_tile.scanLine(y));
+
+        if (is10Bits) {
+            averageRow<10>(m_frameImage, begin, end, m_columnIndex.data(),
+                           pDst, a_rect.width());
+        } else {
+            averageRow<8>(m_frameImage, begin, end, m_columnIndex.data(),
+                          pDst, a_rect.width());
+        }
+    }
+}
+
+// END OF void PreviewCanvas::renderArea(const QRect & a_rect)
+//==============================================================================
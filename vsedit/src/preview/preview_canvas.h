@@ -0,0 +1,68 @@
+#ifndef PREVIEWCANVAS_H
+#define PREVIEWCANVAS_H
+
+#include <QWidget>
+#include <QImage>
+#include <QRect>
+#include <QPointF>
+#include <vector>
+
+class QPaintEvent;
+
+// Widget that shows a part of a frame at arbitrary zoom. Only the exposed
+// region is resampled on each paint, so the memory used does not depend on
+// the zoom ratio. The frame image is expected to be a shallow QImage wrapping
+// the packed preview frame (Format_RGB32 or Format_RGB30).
+class PreviewCanvas : public QWidget
+{
+    Q_OBJECT
+
+public:
+
+    PreviewCanvas(QWidget *a_pParent = nullptr);
+
+    virtual ~PreviewCanvas();
+
+    void setFrameImage(const QImage &a_frameImage,
+                       const QRect &a_sourceRect, double a_scale,
+                       Qt::TransformationMode a_scaleMode);
+
+    // Drop the frame reference but keep the canvas size.
+    void clearFrameImage();
+
+    QSize contentsSize() const;
+
+    QSize sizeHint() const override;
+
+    QSize minimumSizeHint() const override;
+
+    // Maps a point in canvas coordinates to the frame image coordinates.
+    QPointF mapToFrame(const QPoint &a_point) const;
+
+    const QImage &frameImage() const;
+
+protected:
+
+    void paintEvent(QPaintEvent *a_pEvent) override;
+
+private:
+
+    void renderNearest(const QRect &a_rect);
+
+    void renderBilinear(const QRect &a_rect);
+
+    void renderArea(const QRect &a_rect);
+
+    QImage m_frameImage;
+    QRect m_sourceRect;
+    double m_scale;
+    Qt::TransformationMode m_scaleMode;
+
+    // Tile reused between paint events. Its size is bounded by the
+    // viewport, not by the zoomed frame.
+    QImage m_tile;
+    std::vector<int> m_columnIndex;
+    std::vector<int> m_columnWeight;
+};
+
+#endif // PREVIEWCANVAS_H
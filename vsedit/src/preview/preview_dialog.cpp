@@ -280,13 +280,13 @@ void PreviewDialog::stopAndCleanUp()
 
     m_frameShown = -1;
     m_framePixmap = QImage();
-    // Replace shown image with a blank one of the same dimension:
+    // Blank the shown image but keep its dimension:
     // -helps to keep the scrolling position when refreshing the script;
     // -leaves the image blank on sudden error;
     // -creates a blinking effect indicating the script is being refreshed.
-    QImage blackPixmap(m_ui.previewArea->pixmapSize(), QImage::Format_Mono);
-    blackPixmap.fill(Qt::black);
-    m_ui.previewArea->setPixmap(blackPixmap);
+    // It also drops the preview area reference to the frame data
+    // before the frame is freed.
+    m_ui.previewArea->clearPreviewImage();
 
     if (m_cpFrameRef) {
         Q_ASSERT(m_cpVSAPI);
@@ -401,7 +401,13 @@ void PreviewDialog::slotReceiveFrame(int a_frameNumber, int a_outputIndex,
     if (m_playing) {
         Frame newFrame(a_frameNumber, a_outputIndex,
                        cpOutputFrameRef, cpPreviewFrameRef);
-        m_framesCache.push_back(newFrame);
+
+        if (!m_framesCache.insert(newFrame)) {
+            m_cpVSAPI->freeFrame(cpOutputFrameRef);
+            m_cpVSAPI->freeFrame(cpPreviewFrameRef);
+            return;
+        }
+
         slotProcessPlayQueue();
     } else {
         setCurrentFrame(cpOutputFrameRef, cpPreviewFrameRef);
@@ -1254,6 +1260,14 @@ void PreviewDialog::slotPlay(bool a_play)
     if (m_playing) {
         m_pActionPlay->setIcon(m_iconPause);
         m_lastFrameRequestedForPlay = m_frameShown;
+        // Playback loops, so frame numbers wrap around. The window never
+        // reaches the shown frame to avoid requesting a frame twice.
+        int numFrames = m_cpVideoInfo->numFrames;
+        size_t window = std::min(m_cachedFramesLimit,
+                                 (size_t)std::max(numFrames - 1, 1));
+        clearFramesCache();
+        m_framesCache.reset((m_frameShown + 1) % numFrames, window,
+                            numFrames);
         slotProcessPlayQueue();
     } else {
         clearFramesCache();
@@ -1278,16 +1292,9 @@ void PreviewDialog::slotProcessPlayQueue()
     m_processingPlayQueue = true;
 
     int nextFrame = (m_frameShown + 1) % m_cpVideoInfo->numFrames;
-    Frame referenceFrame(nextFrame, 0, nullptr);
-
-    while (!m_framesCache.empty()) {
-        QList<Frame>::iterator it =
-            std::find(m_framesCache.begin(), m_framesCache.end(),
-                      referenceFrame);
 
-        if (it == m_framesCache.end()) {
-            break;
-        }
+    while (m_framesCache.frontReady()) {
+        Q_ASSERT(m_framesCache.baseFrame() == nextFrame);
 
         hr_time_point now = hr_clock::now();
         double passed = duration_to_double(now - m_lastFrameShowTime);
@@ -1299,23 +1306,22 @@ void PreviewDialog::slotProcessPlayQueue()
             break;
         }
 
-        setCurrentFrame(it->cpOutputFrameRef, it->cpPreviewFrameRef);
+        Frame frame = m_framesCache.popFront();
+        setCurrentFrame(frame.cpOutputFrameRef, frame.cpPreviewFrameRef);
         m_lastFrameShowTime = hr_clock::now();
 
         m_frameShown = nextFrame;
         m_frameExpected = m_frameShown;
         m_ui.frameNumberSpinBox->setValue(m_frameExpected);
         m_ui.frameNumberSlider->setFrame(m_frameExpected);
-        m_framesCache.erase(it);
         nextFrame = (m_frameShown + 1) % m_cpVideoInfo->numFrames;
-        referenceFrame.number = nextFrame;
     }
 
     nextFrame = (m_lastFrameRequestedForPlay + 1) %
                 m_cpVideoInfo->numFrames;
 
     while (((m_framesInQueue + m_framesInProcess) < m_maxThreads) &&
-            (m_framesCache.size() <= m_cachedFramesLimit)) {
+            m_framesCache.fits(nextFrame)) {
         m_pVapourSynthScriptProcessor->requestFrameAsync(nextFrame, 0, true);
         m_lastFrameRequestedForPlay = nextFrame;
         nextFrame = (nextFrame + 1) % m_cpVideoInfo->numFrames;
@@ -1929,54 +1935,43 @@ bool PreviewDialog::requestShowFrame(int a_frameNumber)
 
 void PreviewDialog::setPreviewPixmap()
 {
+    // The preview area resamples only the visible part of the frame, so no
+    // scaled or cropped copy of the whole frame is made here.
     if (m_ui.cropPanel->isVisible()) {
-        int cropLeft = m_ui.cropLeftSpinBox->value();
-        int cropTop = m_ui.cropTopSpinBox->value();
-        int cropWidth = m_ui.cropWidthSpinBox->value();
-        int cropHeight = m_ui.cropHeightSpinBox->value();
-        QImage croppedImage = m_framePixmap.copy(cropLeft, cropTop,
-                                cropWidth, cropHeight);
+        QRect cropRect(m_ui.cropLeftSpinBox->value(),
+                       m_ui.cropTopSpinBox->value(),
+                       m_ui.cropWidthSpinBox->value(),
+                       m_ui.cropHeightSpinBox->value());
         int ratio = m_ui.cropZoomRatioSpinBox->value();
-
-        if (ratio == 1) {
-            m_ui.previewArea->setPixmap(croppedImage);
-            return;
-        }
-
-        QImage zoomedImage = croppedImage.scaled(
-                                   croppedImage.width() * ratio, croppedImage.height() * ratio,
-                                   Qt::KeepAspectRatio, Qt::FastTransformation);
-        m_ui.previewArea->setPixmap(croppedImage);
+        m_ui.previewArea->setPreviewImage(m_framePixmap, cropRect, ratio,
+                                          Qt::FastTransformation);
         return;
     }
 
     ZoomMode zoomMode = (ZoomMode)m_ui.zoomModeComboBox->currentData().toInt();
 
-    if (zoomMode == ZoomMode::NoZoom) {
+    if ((zoomMode == ZoomMode::NoZoom) || m_framePixmap.isNull()) {
         m_ui.previewArea->setPixmap(m_framePixmap);
         return;
     }
 
-    QImage previewPixmap;
-    int frameWidth = 0;
-    int frameHeight = 0;
+    double scale = 1.0;
     Qt::TransformationMode scaleMode = (Qt::TransformationMode)
                                        m_ui.scaleModeComboBox->currentData().toInt();
 
     if (zoomMode == ZoomMode::FixedRatio) {
-        double ratio = m_ui.zoomRatioSpinBox->value();
-        frameWidth = m_framePixmap.width() * ratio;
-        frameHeight = m_framePixmap.height() * ratio;
+        scale = m_ui.zoomRatioSpinBox->value();
     } else {
         QRect previewRect = m_ui.previewArea->geometry();
         int cropSize = m_ui.previewArea->frameWidth() * 2;
-        frameWidth = previewRect.width() - cropSize;
-        frameHeight = previewRect.height() - cropSize;
+        double frameWidth = previewRect.width() - cropSize;
+        double frameHeight = previewRect.height() - cropSize;
+        scale = std::min(frameWidth / m_framePixmap.width(),
+                         frameHeight / m_framePixmap.height());
     }
 
-    previewPixmap = m_framePixmap.scaled(frameWidth, frameHeight,
-                                         Qt::KeepAspectRatio, scaleMode);
-    m_ui.previewArea->setPixmap(previewPixmap);
+    m_ui.previewArea->setPreviewImage(m_framePixmap, m_framePixmap.rect(),
+                                      scale, scaleMode);
 }
 
 // END OF bool void PreviewDialog::setPreviewPixmap()
@@ -103,6 +103,8 @@ void SettingsDialog::slotCall()
         m_pSettingsManager->getPromptToSaveChanges());
     m_ui.portableModeCheckBox->setChecked(
         m_pSettingsManager->getPortableMode());
+    m_ui.unbufferedFileOutputCheckBox->setChecked(
+        m_pSettingsManager->getUnbufferedFileOutput());
     m_ui.maxRecentFilesSpinBox->setValue(
         m_pSettingsManager->getMaxRecentFilesNumber());
     m_ui.charactersTypedToStartCompletionSpinBox->setValue(
@@ -208,6 +210,8 @@ void SettingsDialog::slotApply()
         m_ui.promptToSaveChangesCheckBox->isChecked());
     m_pSettingsManager->setPortableMode(
         m_ui.portableModeCheckBox->isChecked());
+    m_pSettingsManager->setUnbufferedFileOutput(
+        m_ui.unbufferedFileOutputCheckBox->isChecked());
     m_pSettingsManager->setMaxRecentFilesNumber(
         m_ui.maxRecentFilesSpinBox->value());
     m_pSettingsManager->setCharactersTypedToStartCompletion(
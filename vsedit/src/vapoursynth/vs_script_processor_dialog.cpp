@@ -240,12 +240,10 @@ void VSScriptProcessorDialog::clearFramesCache()
 
     Q_ASSERT(m_cpVSAPI);
 
-    for (Frame &frame : m_framesCache) {
+    for (Frame &frame : m_framesCache.takeAll()) {
         m_cpVSAPI->freeFrame(frame.cpOutputFrameRef);
         m_cpVSAPI->freeFrame(frame.cpPreviewFrameRef);
     }
-
-    m_framesCache.clear();
 }
 
 // END OF void VSScriptProcessorDialog::stopAndCleanUp()
@@ -2,6 +2,7 @@
 #define VS_SCRIPT_PROCESSOR_DIALOG_H_INCLUDED
 
 #include "../../../common-src/vapoursynth/vs_script_processor_structures.h"
+#include "../../../common-src/vapoursynth/frame_reorder_buffer.h"
 #include "../script_status_bar_widget/script_status_bar_widget.h"
 
 #include <QDialog>
@@ -105,7 +106,7 @@ protected:
     QPixmap m_busyPixmap;
     QPixmap m_errorPixmap;
 
-    QList<Frame> m_framesCache;
+    FrameReorderBuffer m_framesCache;
     size_t m_cachedFramesLimit;
 };
 